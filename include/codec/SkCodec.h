@@ -27,6 +27,7 @@
 class SkAndroidCodec;
 class SkColorSpace;
 class SkData;
+class SkExecutor;
 class SkFrameHolder;
 class SkImage;
 class SkPngChunkReader;
@@ -289,6 +290,7 @@ public:
             , fSubset(nullptr)
             , fFrameIndex(0)
             , fPriorFrame(kNoFrame)
+            , fExecutor(nullptr)
         {}
 
         ZeroInitialized            fZeroInitialized;
@@ -332,6 +334,16 @@ public:
          *  If set to kNoFrame, the codec will decode any necessary required frame(s) first.
          */
         int                        fPriorFrame;
+
+        /**
+         *  If not NULL, getPixels() may use this executor to convert decoded rows (swizzling and
+         *  color transforming them) on other threads while the next rows are decoded. The
+         *  result is identical to a decode without an executor.
+         *
+         *  Currently used by the JPEG and PNG codecs. Ignored by scanline and incremental
+         *  decodes. The executor must outlive the call to getPixels().
+         */
+        SkExecutor*                fExecutor;
     };
 
     /**
@@ -11,6 +11,7 @@
 #include "include/core/SkRefCnt.h"
 
 class SkData;
+class SkExecutor;
 class SkImageGenerator;
 class SkTraceMemoryDump;
 
@@ -144,6 +145,130 @@ public:
      *  Call early in main() to allow Skia to use a JIT to accelerate CPU-bound operations.
      */
     static void AllowJIT();
+
+    /**
+     *  Abstract class to cache the programs the CPU backend compiles for each combination of
+     *  shader, color filter, blend mode and destination, so they can be reused across process
+     *  restarts. This works like GrContextOptions::PersistentCache does for GPU shaders: keys
+     *  and data are opaque, and the client is free to keep them in memory or on disk.
+     *
+     *  Data is only valid for the build of Skia that stored it, and load() may be handed data
+     *  from another build or a corrupt file; such data is detected and ignored. Data is checked
+     *  against a digest Skia stores with it, and each program's instructions are checked to be
+     *  well formed and to read uniforms only within the buffers Skia passes it. The digest is
+     *  not keyed and those checks do not bound everything a program may compute, so they catch
+     *  corruption, not tampering: keep the cache's storage somewhere only Skia writes to.
+     *
+     *  load() and store() may be called concurrently from any thread that draws.
+     */
+    class SK_API ProgramCache {
+    public:
+        virtual ~ProgramCache() = default;
+
+        /**
+         *  Returns the data previously stored for this key, or nullptr.
+         */
+        virtual sk_sp<SkData> load(const SkData& key) = 0;
+
+        virtual void store(const SkData& key, const SkData& data) = 0;
+
+    protected:
+        ProgramCache() = default;
+        ProgramCache(const ProgramCache&) = delete;
+        ProgramCache& operator=(const ProgramCache&) = delete;
+    };
+
+    /**
+     *  Install a cache for compiled CPU programs, or nullptr to stop using one. Does not take
+     *  ownership; the cache must outlive any drawing that may use it.
+     *
+     *  If cacheJITCode is true and AllowJIT() has been called, the JIT's machine code is stored
+     *  alongside each program and reused on compatible CPUs, skipping code generation on load.
+     *  That code is executed as stored, so only set cacheJITCode if nobody but Skia can write to
+     *  the cache's storage: the digest catches corruption, not tampering.
+     */
+    static void SetProgramCache(ProgramCache*, bool cacheJITCode = false);
+
+    /**
+     *  Allow Skia to split large pieces of CPU work into tasks on this executor:
+     *    - antialiased fills of very large paths (many thousands of points), in horizontal bands;
+     *    - blurs of large masks (e.g. blur mask filters and drop shadows) and of large images (the
+     *      raster blur image filter), in tiles;
+     *    - the mipmap levels of large images, in bands of rows;
+     *    - path ops (Op(), Simplify() and SkOpBuilder) on inputs with many contours;
+     *    - the glyph images that raster text draws of many glyphs are missing (e.g. the first
+     *      frame of a page of text), each task with its own scaler context.
+     *  None of the results depend on the number of threads. Pass nullptr (the default) to do all
+     *  of this work on the calling thread.
+     *
+     *  Work that is already running in a task on this executor (e.g. drawing one tile of a
+     *  picture) is done inline, so the executor does not need to support borrow().
+     *
+     *  Does not take ownership; the executor must outlive any work that may use it.
+     */
+    static void SetExecutor(SkExecutor*);
+
+    /**
+     *  Abstract class to keep rasterized glyphs (metrics, masks and paths) across process
+     *  restarts, so text drawn by a new process does not need to be rasterized again. Like
+     *  ProgramCache, keys and data are opaque; each entry holds the glyphs of one strike (a
+     *  typeface at one size, transform and set of effects).
+     *
+     *  Strikes are looked up when first used, and their glyphs copied out only as they are
+     *  drawn. The data is laid out to be used in place, so load() may return data that maps a
+     *  file (see SkData::MakeFromFileName()).
+     *
+     *  Data is only valid for the build of Skia that stored it; data from another build or for
+     *  another typeface misses. Skia checks that the glyph table is well formed and that every
+     *  offset and size stays inside the data, so a truncated or corrupt file cannot make it read
+     *  out of bounds. The data carries no digest, though: a corrupted mask, advance or metric is
+     *  drawn as stored, so keep the cache's storage somewhere only Skia writes to.
+     *
+     *  load() and store() may be called concurrently from any thread that draws text.
+     */
+    class SK_API GlyphCache {
+    public:
+        virtual ~GlyphCache() = default;
+
+        /**
+         *  Returns a cache that keeps each strike in its own file in the directory at path,
+         *  creating the directory if needed, and maps the files to load them. Returns nullptr if
+         *  the directory cannot be created.
+         *
+         *  Files are written on a thread owned by the cache, and destroying the cache waits for
+         *  pending writes. When the files in the directory add up to more than maxBytes, the
+         *  least recently used are deleted.
+         */
+        static std::unique_ptr<GlyphCache> MakeDirectory(const char* path,
+                                                         size_t maxBytes = 64 * 1024 * 1024);
+
+        /**
+         *  Returns the data previously stored for this key, or nullptr.
+         */
+        virtual sk_sp<SkData> load(const SkData& key) = 0;
+
+        virtual void store(const SkData& key, const SkData& data) = 0;
+
+    protected:
+        GlyphCache() = default;
+        GlyphCache(const GlyphCache&) = delete;
+        GlyphCache& operator=(const GlyphCache&) = delete;
+    };
+
+    /**
+     *  Install a cache for rasterized glyphs, or nullptr to stop using one. Does not take
+     *  ownership; the cache must outlive any drawing that may use it.
+     *
+     *  Strikes with new glyphs are stored when they are purged from the font cache, and by
+     *  FlushGlyphCache().
+     */
+    static void SetGlyphCache(GlyphCache*);
+
+    /**
+     *  Store every strike in the font cache that has glyphs the installed GlyphCache does not.
+     *  Call this e.g. before the process exits.
+     */
+    static void FlushGlyphCache();
 };
 
 class SkAutoGraphics {
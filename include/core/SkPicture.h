@@ -82,6 +82,26 @@ public:
     static sk_sp<SkPicture> MakeFromData(const void* data, size_t size,
                                          const SkDeserialProcs* procs = nullptr);
 
+    /** Recreates SkPicture that was serialized into data, such as a file mapped with
+        SkData::MakeFromFD(), without copying it into a recording first. Returns nullptr
+        if data's header, or the tables its commands refer to, are not valid.
+
+        The returned SkPicture plays its commands back from data, and only decodes paths and
+        text blobs the first time they are drawn. So unlike MakeFromData(), a non-null result
+        does not mean the commands, paths and text blobs are valid: they are checked as they
+        are played back, and playback stops at the first invalid one, leaving a corrupt
+        picture partly drawn. If data was serialized with
+        SkSerialProcs::fAlignForMapping, commands and encoded images are also read from data
+        where they lie instead of being copied. data must not change while the SkPicture, or
+        any image drawn from it, is alive.
+
+        @param data   container for serial data
+        @param procs  custom serial data decoders; may be nullptr
+        @return       SkPicture constructed from data
+    */
+    static sk_sp<SkPicture> MakeFromMappedData(sk_sp<SkData> data,
+                                               const SkDeserialProcs* procs = nullptr);
+
     /** \class SkPicture::AbortCallback
         AbortCallback is an abstract class. An implementation of AbortCallback may
         passed as a parameter to SkPicture::playback, to stop it before all drawing
@@ -239,13 +259,15 @@ private:
     SkPicture();
     friend class SkBigPicture;
     friend class SkEmptyPicture;
+    friend class SkMappedPicture;
     friend class SkPicturePriv;
     template <typename> friend class SkMiniPicture;
 
     void serialize(SkWStream*, const SkSerialProcs*, class SkRefCntSet* typefaces,
         bool textBlobsOnly=false) const;
     static sk_sp<SkPicture> MakeFromStream(SkStream*, const SkDeserialProcs*,
-                                           class SkTypefacePlayback*);
+                                           class SkTypefacePlayback*,
+                                           const SkData* mapping = nullptr);
     friend class SkPictureData;
 
     /** Return true if the SkStream/Buffer represents a serialized picture, and
@@ -31,6 +31,13 @@ public:
     ~SkPictureRecorder();
 
     enum FinishFlags {
+        /** Spend more time finishing the recording to make playback faster: merge runs of image
+            draws that share a paint into batched draws, merge runs of rects that share a paint
+            into one record (still drawn one rect at a time), and drop draws that later opaque
+            draws completely cover. Draws covered this way may differ from the unoptimized picture in
+            pixels along the edge of an antialiased clip applied at playback.
+        */
+        kOptimizeForPlayback_FinishFlag = 1 << 0,
     };
 
     /** Returns the canvas that records the drawing commands.
@@ -63,8 +70,10 @@ public:
      *  these will have been "drawn" into a recording canvas, so that this resulting picture will
      *  reflect their current state, but will not contain a live reference to the drawables
      *  themselves.
+     *
+     *  @param finishFlags  optional FinishFlags
      */
-    sk_sp<SkPicture> finishRecordingAsPicture();
+    sk_sp<SkPicture> finishRecordingAsPicture(uint32_t finishFlags = 0);
 
     /**
      *  Signal that the caller is done recording, and update the cull rect to use for bounding
@@ -73,9 +82,11 @@ public:
      *  into beginRecording.
      *  @param cullRect the new culling rectangle to use as the overall bound for BBH generation
      *                  and subsequent culling operations.
+     *  @param finishFlags  optional FinishFlags
      *  @return the picture containing the recorded content.
      */
-    sk_sp<SkPicture> finishRecordingAsPictureWithCull(const SkRect& cullRect);
+    sk_sp<SkPicture> finishRecordingAsPictureWithCull(const SkRect& cullRect,
+                                                      uint32_t finishFlags = 0);
 
     /**
      *  Signal that the caller is done recording. This invalidates the canvas returned by
@@ -86,11 +97,14 @@ public:
      *  may contain live references to other drawables (if they were added to the recording canvas)
      *  and therefore this drawable will reflect the current state of those nested drawables anytime
      *  it is drawn or a new picture is snapped from it (by calling drawable->newPictureSnapshot()).
+     *
+     *  @param finishFlags  optional FinishFlags
      */
-    sk_sp<SkDrawable> finishRecordingAsDrawable();
+    sk_sp<SkDrawable> finishRecordingAsDrawable(uint32_t finishFlags = 0);
 
 private:
     void reset();
+    void optimize(uint32_t finishFlags);
 
     /** Replay the current (partially recorded) operation stream into
         canvas. This call doesn't close the current recording.
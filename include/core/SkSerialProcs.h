@@ -56,6 +56,13 @@ struct SK_API SkSerialProcs {
 
     SkSerialTypefaceProc fTypefaceProc = nullptr;
     void*                fTypefaceCtx = nullptr;
+
+    /**
+     *  If true, SkPicture::serialize() pads the data so that SkPicture::MakeFromMappedData()
+     *  can play its ops back and share its images where they lie, rather than copying them.
+     *  Readers that predate this option fail to load such data.
+     */
+    bool fAlignForMapping = false;
 };
 
 struct SK_API SkDeserialProcs {
@@ -11,6 +11,7 @@
 #include "include/core/SkDataTable.h"
 #include "include/encode/SkEncoder.h"
 
+class SkExecutor;
 class SkPngEncoderMgr;
 class SkWStream;
 
@@ -53,6 +54,18 @@ public:
          */
         int fZLibLevel = 6;
 
+        /**
+         *  If set, Skia filters and compresses the rows itself instead of handing them to
+         *  libpng, splitting the image into blocks that are filtered and compressed in
+         *  parallel on this executor.  Filter selection per row uses the same heuristic as
+         *  libpng, restricted to fFilterFlags.  The result is a valid png a little larger than
+         *  the serial encoder's at the same fZLibLevel, and does not depend on the number of
+         *  threads.
+         *
+         *  The executor must outlive the encoder.
+         */
+        SkExecutor* fExecutor = nullptr;
+
         /**
          *  Represents comments in the tEXt ancillary chunk of the png.
          *  The 2i-th entry is the keyword for the i-th comment,
@@ -23,6 +23,14 @@ public:
         SkDEBUGCODE(fOwner = SkGetThreadID();)
     }
 
+    bool tryAcquire() SK_TRY_ACQUIRE(true) {
+        if (!fSemaphore.try_wait()) {
+            return false;
+        }
+        SkDEBUGCODE(fOwner = SkGetThreadID();)
+        return true;
+    }
+
     void release() SK_RELEASE_CAPABILITY() {
         this->assertHeld();
         SkDEBUGCODE(fOwner = kIllegalThreadID;)
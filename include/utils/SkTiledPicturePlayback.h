@@ -0,0 +1,62 @@
+/*
+ * Copyright 2021 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkTiledPicturePlayback_DEFINED
+#define SkTiledPicturePlayback_DEFINED
+
+#include "include/core/SkMatrix.h"
+#include "include/core/SkSurfaceProps.h"
+#include "include/core/SkTypes.h"
+
+class SkExecutor;
+class SkPicture;
+class SkPixmap;
+class SkSurface;
+
+/**
+ *  Plays back an SkPicture into raster pixels by splitting the destination into tiles and
+ *  drawing the tiles concurrently on an SkExecutor.
+ *
+ *  Every tile draws the whole picture through its own SkCanvas, which wraps the full destination
+ *  pixels but is clipped to the tile. Device coordinates are therefore the same as for a single
+ *  threaded draw (no per-tile translate), and the output matches
+ *  canvas->drawPicture(picture, &matrix, nullptr) except for antialiasing along tile edges:
+ *  clipping curves and antialiased edges to a tile can move their coverage slightly. The output
+ *  does not depend on the number of threads. Pictures recorded with an SkRTreeFactory have their
+ *  ops culled per tile by the bounding box hierarchy.
+ *
+ *  The picture must be safe to play back from several threads at once. This is true for any
+ *  picture returned by SkPictureRecorder or SkPicture::MakeFromData/MakeFromStream.
+ */
+class SK_API SkTiledPicturePlayback {
+public:
+    struct Options {
+        // Tile dimensions in device pixels. Taller tiles are usually better; each tile replays
+        // the picture's state changes (save/restore/concat), so tiny tiles waste work.
+        int fTileWidth  = 512;
+        int fTileHeight = 256;
+
+        // Executor to run the tiles on. If null, SkExecutor::GetDefault() is used.
+        SkExecutor* fExecutor = nullptr;
+    };
+
+    /**
+     *  Draw the picture into the pixels, transformed by matrix, using the given surface props.
+     *  Returns false if there is nothing to draw into (e.g. no pixels).
+     */
+    static bool Draw(const SkPixmap& dst, const SkPicture*, const SkMatrix& matrix,
+                     const SkSurfaceProps& props, const Options&);
+
+    /**
+     *  Draw the picture into a raster surface, transformed by matrix. The matrix is applied in
+     *  the surface's device space; the current state of surface->getCanvas() is ignored.
+     *  Returns false if the surface is not CPU-backed (peekPixels() fails).
+     */
+    static bool Draw(SkSurface*, const SkPicture*, const SkMatrix& matrix, const Options&);
+};
+
+#endif
@@ -8,7 +8,9 @@
 #ifndef Skottie_DEFINED
 #define Skottie_DEFINED
 
+#include "include/core/SkColor.h"
 #include "include/core/SkFontMgr.h"
+#include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkSize.h"
 #include "include/core/SkString.h"
@@ -21,7 +23,7 @@
 #include <vector>
 
 class SkCanvas;
-struct SkRect;
+class SkData;
 class SkStream;
 
 namespace skjson { class ObjectValue; }
@@ -133,6 +135,33 @@ public:
         sk_sp<Animation> make(const char* data, size_t length);
         sk_sp<Animation> makeFromFile(const char path[]);
 
+        /**
+         * Converts Lottie JSON to a binary snapshot, which the factories accept in its place.
+         * Loading a snapshot skips JSON parsing only: the snapshot is copied into the parsed
+         * document (so a mapped file is read once, not used in place), and keyframes, paths and
+         * the rest of the scene are still built from that document on every load.
+         *
+         * Snapshots are tied to the Skia build's pointer size and snapshot format version, and
+         * fail to load (like malformed JSON) elsewhere; keep the JSON to regenerate them.
+         *
+         * Returns nullptr if the JSON cannot be parsed.
+         */
+        static sk_sp<SkData> MakeSnapshot(const char* data, size_t length);
+
+        /**
+         * Builds count independent instances of the same animation, parsing the JSON once.
+         *
+         * An Animation holds the state of its scene graph, so a single instance cannot seek or
+         * render on several threads at once; separate instances can. The instances share the
+         * resource provider and font manager, and any image assets the provider shares between
+         * loads (e.g. a CachingResourceProvider); animated ones must then tolerate concurrent
+         * getFrame() calls.
+         *
+         * Only the first instance is reported to the property observer, marker observer and
+         * logger. Returns an empty vector if the animation cannot be parsed.
+         */
+        std::vector<sk_sp<Animation>> makeInstances(const char* data, size_t length, int count);
+
     private:
         const uint32_t          fFlags;
 
@@ -181,6 +210,35 @@ public:
     void render(SkCanvas* canvas, const SkRect* dst = nullptr) const;
     void render(SkCanvas* canvas, const SkRect* dst, RenderFlags) const;
 
+    struct DamageOptions {
+        // Two damaged areas are redrawn as one rect when that rect is at most this many times
+        // their combined area. Larger values mean fewer, larger rects.
+        float   fMergeRatio = 1.5f;
+
+        // The most rects to redraw; beyond this, the pairs that grow least are merged.
+        int     fMaxRects   = 16;
+
+        // Damaged areas are cleared to this color before they are redrawn. It should match what
+        // the destination was cleared to when the animation was first drawn into it.
+        SkColor fBackground = SK_ColorTRANSPARENT;
+    };
+
+    /**
+     * Like render(), but only redraws the parts of the current frame that changed, leaving the
+     * rest of the canvas untouched. This updates a destination that still holds an earlier frame
+     * of this animation, drawn with the same dst and flags.
+     *
+     * damage must hold the invalidations from every seek*() call since that frame (pass the same
+     * controller to each of them, and reset it after rendering). Drawing outside the damaged
+     * areas is skipped entirely, not just clipped.
+     *
+     * @return the bounds of the device pixels redrawn, which may be empty
+     */
+    SkIRect renderDamage(SkCanvas* canvas, const sksg::InvalidationController& damage,
+                         const SkRect* dst = nullptr) const;
+    SkIRect renderDamage(SkCanvas* canvas, const sksg::InvalidationController& damage,
+                         const SkRect* dst, RenderFlags, const DamageOptions&) const;
+
     /**
      * [Deprecated: use one of the other versions.]
      *
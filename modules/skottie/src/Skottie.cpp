@@ -13,6 +13,7 @@
 #include "include/core/SkImage.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkPoint.h"
+#include "include/core/SkRegion.h"
 #include "include/core/SkStream.h"
 #include "include/private/SkTArray.h"
 #include "include/private/SkTPin.h"
@@ -36,6 +37,7 @@
 
 #include <chrono>
 #include <cmath>
+#include <limits>
 #include <memory>
 
 #include "stdlib.h"
@@ -355,8 +357,19 @@ sk_sp<Animation> Animation::Builder::make(SkStream* stream) {
 }
 
 sk_sp<Animation> Animation::Builder::make(const char* data, size_t data_len) {
+    auto animations = this->makeInstances(data, data_len, 1);
+
+    return animations.empty() ? nullptr : std::move(animations[0]);
+}
+
+std::vector<sk_sp<Animation>> Animation::Builder::makeInstances(const char* data, size_t data_len,
+                                                                int count) {
     TRACE_EVENT0("skottie", TRACE_FUNC);
 
+    if (count < 1) {
+        return {};
+    }
+
     // Sanitize factory args.
     class NullResourceProvider final : public ResourceProvider {
         sk_sp<SkData> load(const char[], const char[]) const override { return nullptr; }
@@ -369,13 +382,13 @@ sk_sp<Animation> Animation::Builder::make(const char* data, size_t data_len) {
     fStats.fJsonSize = data_len;
     const auto t0 = std::chrono::steady_clock::now();
 
-    const skjson::DOM dom(data, data_len);
+    const skjson::DOM dom(data, data_len, skjson::DOM::Format::kJSONOrSnapshot);
     if (!dom.root().is<skjson::ObjectValue>()) {
         // TODO: more error info.
         if (fLogger) {
             fLogger->log(Logger::Level::kError, "Failed to parse JSON input.\n");
         }
-        return nullptr;
+        return {};
     }
     const auto& json = dom.root().as<skjson::ObjectValue>();
 
@@ -399,40 +412,55 @@ sk_sp<Animation> Animation::Builder::make(const char* data, size_t data_len) {
                          version.c_str(), size.width(), size.height(), fps, inPoint, outPoint);
             fLogger->log(Logger::Level::kError, msg.c_str());
         }
-        return nullptr;
+        return {};
     }
 
     SkASSERT(resolvedProvider);
-    internal::AnimationBuilder builder(std::move(resolvedProvider), fFontMgr,
-                                       std::move(fPropertyObserver),
-                                       std::move(fLogger),
-                                       std::move(fMarkerObserver),
-                                       std::move(fPrecompInterceptor),
-                                       &fStats, size, duration, fps, fFlags);
-    auto ainfo = builder.parse(json);
-
-    const auto t2 = std::chrono::steady_clock::now();
-    fStats.fSceneParseTimeMS = std::chrono::duration<float, std::milli>{t2-t1}.count();
-    fStats.fTotalLoadTimeMS  = std::chrono::duration<float, std::milli>{t2-t0}.count();
+    std::vector<sk_sp<Animation>> animations;
+    animations.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        // Observers and the logger only see the first instance; the others are built from the
+        // same JSON, so they would only hear the same things again.
+        const bool first = i == 0;
+        Stats instanceStats;
+        internal::AnimationBuilder builder(resolvedProvider, fFontMgr,
+                                           first ? std::move(fPropertyObserver) : nullptr,
+                                           first ? fLogger : nullptr,
+                                           first ? std::move(fMarkerObserver) : nullptr,
+                                           fPrecompInterceptor,
+                                           first ? &fStats : &instanceStats,
+                                           size, duration, fps, fFlags);
+        auto ainfo = builder.parse(json);
+
+        if (first) {
+            const auto t2 = std::chrono::steady_clock::now();
+            fStats.fSceneParseTimeMS = std::chrono::duration<float, std::milli>{t2-t1}.count();
+            fStats.fTotalLoadTimeMS  = std::chrono::duration<float, std::milli>{t2-t0}.count();
+
+            if (!ainfo.fScene && fLogger) {
+                fLogger->log(Logger::Level::kError, "Could not parse animation.\n");
+            }
+        }
 
-    if (!ainfo.fScene && fLogger) {
-        fLogger->log(Logger::Level::kError, "Could not parse animation.\n");
-    }
+        uint32_t flags = 0;
+        if (builder.hasNontrivialBlending()) {
+            flags |= Animation::Flags::kRequiresTopLevelIsolation;
+        }
 
-    uint32_t flags = 0;
-    if (builder.hasNontrivialBlending()) {
-        flags |= Animation::Flags::kRequiresTopLevelIsolation;
+        animations.push_back(sk_sp<Animation>(new Animation(std::move(ainfo.fScene),
+                                                            std::move(ainfo.fAnimators),
+                                                            version,
+                                                            size,
+                                                            inPoint,
+                                                            outPoint,
+                                                            duration,
+                                                            fps,
+                                                            flags)));
     }
+    fLogger.reset();
+    fPrecompInterceptor.reset();
 
-    return sk_sp<Animation>(new Animation(std::move(ainfo.fScene),
-                                          std::move(ainfo.fAnimators),
-                                          std::move(version),
-                                          size,
-                                          inPoint,
-                                          outPoint,
-                                          duration,
-                                          fps,
-                                          flags));
+    return animations;
 }
 
 sk_sp<Animation> Animation::Builder::makeFromFile(const char path[]) {
@@ -442,6 +470,18 @@ sk_sp<Animation> Animation::Builder::makeFromFile(const char path[]) {
                 : nullptr;
 }
 
+sk_sp<SkData> Animation::Builder::MakeSnapshot(const char* data, size_t data_len) {
+    TRACE_EVENT0("skottie", TRACE_FUNC);
+
+    const skjson::DOM dom(data, data_len);
+    if (!dom.root().is<skjson::ObjectValue>()) {
+        return nullptr;
+    }
+
+    SkDynamicMemoryWStream stream;
+    return dom.writeSnapshot(&stream) ? stream.detachAsData() : nullptr;
+}
+
 Animation::Animation(std::unique_ptr<sksg::Scene> scene,
                      std::vector<sk_sp<internal::Animator>>&& animators,
                      SkString version, const SkSize& size,
@@ -489,6 +529,107 @@ void Animation::render(SkCanvas* canvas, const SkRect* dstR, RenderFlags renderF
     fScene->render(canvas);
 }
 
+namespace {
+
+int64_t area(const SkIRect& r) {
+    return static_cast<int64_t>(r.width()) * r.height();
+}
+
+// Coalesces damaged device rects, so the frame is redrawn through a few clip rects rather than
+// many small (and often overlapping) ones.
+std::vector<SkIRect> merge_damage(const std::vector<SkIRect>& damage,
+                                  float merge_ratio, size_t max_rects) {
+    std::vector<SkIRect> merged;
+    for (SkIRect r : damage) {
+        // Keep absorbing rects that are cheap to merge with; each merge grows r, which can make
+        // earlier rects cheap to merge too.
+        for (bool grew = true; grew;) {
+            grew = false;
+            for (size_t i = 0; i < merged.size(); ++i) {
+                SkIRect u = r;
+                u.join(merged[i]);
+                if (area(u) <= merge_ratio * (area(r) + area(merged[i]))) {
+                    r = u;
+                    merged[i] = merged.back();
+                    merged.pop_back();
+                    grew = true;
+                    break;
+                }
+            }
+        }
+        merged.push_back(r);
+    }
+
+    while (merged.size() > std::max<size_t>(max_rects, 1)) {
+        size_t best_i = 0,
+               best_j = 1;
+        int64_t best_growth = std::numeric_limits<int64_t>::max();
+        for (size_t i = 0; i < merged.size(); ++i) {
+            for (size_t j = i + 1; j < merged.size(); ++j) {
+                SkIRect u = merged[i];
+                u.join(merged[j]);
+                const auto growth = area(u) - area(merged[i]) - area(merged[j]);
+                if (growth < best_growth) {
+                    best_growth = growth;
+                    best_i = i;
+                    best_j = j;
+                }
+            }
+        }
+        merged[best_i].join(merged[best_j]);
+        merged[best_j] = merged.back();
+        merged.pop_back();
+    }
+
+    return merged;
+}
+
+} // namespace
+
+SkIRect Animation::renderDamage(SkCanvas* canvas, const sksg::InvalidationController& damage,
+                                const SkRect* dstR) const {
+    return this->renderDamage(canvas, damage, dstR, 0, DamageOptions());
+}
+
+SkIRect Animation::renderDamage(SkCanvas* canvas, const sksg::InvalidationController& damage,
+                                const SkRect* dstR, RenderFlags renderFlags,
+                                const DamageOptions& options) const {
+    TRACE_EVENT0("skottie", TRACE_FUNC);
+
+    // Damage is in animation coordinates; clip in device space, rounded out to whole pixels plus
+    // a pixel for antialiasing.
+    auto ctm = canvas->getTotalMatrix();
+    if (dstR) {
+        ctm.preConcat(SkMatrix::RectToRect(SkRect::MakeSize(this->size()), *dstR,
+                                           SkMatrix::kCenter_ScaleToFit));
+    }
+    const auto clip = canvas->getDeviceClipBounds();
+
+    std::vector<SkIRect> device_damage;
+    for (const auto& r : damage) {
+        auto device_rect = ctm.mapRect(r).roundOut().makeOutset(1, 1);
+        if (device_rect.intersect(clip)) {
+            device_damage.push_back(device_rect);
+        }
+    }
+    if (device_damage.empty()) {
+        return SkIRect::MakeEmpty();
+    }
+
+    SkRegion region;
+    for (const auto& r : merge_damage(device_damage, options.fMergeRatio,
+                                      SkToSizeT(std::max(options.fMaxRects, 1)))) {
+        region.op(r, SkRegion::kUnion_Op);
+    }
+
+    SkAutoCanvasRestore restore(canvas, true);
+    canvas->clipRegion(region);
+    canvas->drawColor(options.fBackground, SkBlendMode::kSrc);
+    this->render(canvas, dstR, renderFlags);
+
+    return region.getBounds();
+}
+
 void Animation::seekFrame(double t, sksg::InvalidationController* ic) {
     TRACE_EVENT0("skottie", TRACE_FUNC);
 
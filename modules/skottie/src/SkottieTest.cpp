@@ -5,6 +5,9 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkData.h"
 #include "include/core/SkFontMgr.h"
 #include "include/core/SkMatrix.h"
 #include "include/core/SkStream.h"
@@ -37,6 +40,49 @@ DEF_TEST(Skottie_OssFuzz8956, reporter) {
     auto animation = Animation::Make(&stream);
 }
 
+DEF_TEST(Skottie_Snapshot, reporter) {
+    static constexpr char json[] =
+        R"({"v":"5.2.1","w":32,"h":32,"fr":10,"ip":0,"op":10,
+            "layers":[{"ty":1,"sw":16,"sh":16,"sc":"#00ff00","ip":0,"op":10,
+                       "ks":{"p":{"a":1,"k":[{"t":0,"s":[0,0],"e":[16,16]},{"t":10}]}}}]})";
+
+    const auto snapshot = Animation::Builder::MakeSnapshot(json, strlen(json));
+    REPORTER_ASSERT(reporter, snapshot);
+    REPORTER_ASSERT(reporter, !Animation::Builder::MakeSnapshot("{", 1));
+    if (!snapshot) {
+        return;
+    }
+
+    auto fromJson     = Animation::Make(json, strlen(json));
+    auto fromSnapshot = Animation::Make(static_cast<const char*>(snapshot->data()),
+                                        snapshot->size());
+    REPORTER_ASSERT(reporter, fromJson && fromSnapshot);
+    if (!fromSnapshot) {
+        return;
+    }
+    REPORTER_ASSERT(reporter, fromSnapshot->version().equals(fromJson->version()));
+    REPORTER_ASSERT(reporter, fromSnapshot->size() == fromJson->size());
+    REPORTER_ASSERT(reporter, fromSnapshot->duration() == fromJson->duration());
+
+    SkBitmap a, b;
+    a.allocN32Pixels(32, 32);
+    b.allocN32Pixels(32, 32);
+    SkCanvas ca(a), cb(b);
+    for (double frame : {0.0, 3.5, 9.0}) {
+        fromJson->seekFrame(frame);
+        fromSnapshot->seekFrame(frame);
+        a.eraseColor(SK_ColorTRANSPARENT);
+        b.eraseColor(SK_ColorTRANSPARENT);
+        fromJson->render(&ca);
+        fromSnapshot->render(&cb);
+        REPORTER_ASSERT(reporter, !memcmp(a.getPixels(), b.getPixels(), a.computeByteSize()));
+    }
+
+    // A truncated snapshot fails like malformed JSON.
+    REPORTER_ASSERT(reporter, !Animation::Make(static_cast<const char*>(snapshot->data()),
+                                               snapshot->size() - 1));
+}
+
 DEF_TEST(Skottie_Properties, reporter) {
     auto test_typeface = ToolUtils::create_portable_typeface();
     REPORTER_ASSERT(reporter, test_typeface);
@@ -9,77 +9,96 @@
 
 #include "modules/skottie/src/SkottieJson.h"
 
+#include <algorithm>
+
 #define DUMP_KF_RECORDS 0
 
 namespace skottie::internal {
 
+namespace {
+
+template <typename T, typename F>
+std::vector<T> split(const std::vector<Keyframe>& kfs, F&& field) {
+    std::vector<T> result;
+    result.reserve(kfs.size());
+    for (const auto& kf : kfs) {
+        result.push_back(field(kf));
+    }
+    return result;
+}
+
+} // namespace
+
+KeyframeAnimator::KeyframeAnimator(const std::vector<Keyframe>& kfs, std::vector<SkCubicMap> cms)
+    : fTimes   (split<float>          (kfs, [](const Keyframe& kf) { return kf.t;       }))
+    , fValues  (split<Keyframe::Value>(kfs, [](const Keyframe& kf) { return kf.v;       }))
+    , fMappings(split<uint32_t>       (kfs, [](const Keyframe& kf) { return kf.mapping; }))
+    , fCMs(std::move(cms)) {}
+
 KeyframeAnimator::~KeyframeAnimator() = default;
 
 KeyframeAnimator::LERPInfo KeyframeAnimator::getLERPInfo(float t) const {
-    SkASSERT(!fKFs.empty());
+    SkASSERT(!fTimes.empty());
 
-    if (t <= fKFs.front().t) {
+    if (t <= fTimes.front()) {
         // Constant/clamped segment.
-        return { 0, fKFs.front().v, fKFs.front().v };
+        return { 0, fValues.front(), fValues.front() };
     }
-    if (t >= fKFs.back().t) {
+    if (t >= fTimes.back()) {
         // Constant/clamped segment.
-        return { 0, fKFs.back().v, fKFs.back().v };
+        return { 0, fValues.back(), fValues.back() };
     }
 
-    // Cache the current segment (most queries have good locality).
-    if (!fCurrentSegment.contains(t)) {
-        fCurrentSegment = this->find_segment(t);
-    }
-    SkASSERT(fCurrentSegment.contains(t));
+    const auto seg = this->find_segment(t);
 
-    if (fCurrentSegment.kf0->mapping == Keyframe::kConstantMapping) {
+    if (fMappings[seg] == Keyframe::kConstantMapping) {
         // Constant/hold segment.
-        return { 0, fCurrentSegment.kf0->v, fCurrentSegment.kf0->v };
+        return { 0, fValues[seg], fValues[seg] };
     }
 
     return {
-        this->compute_weight(fCurrentSegment, t),
-        fCurrentSegment.kf0->v,
-        fCurrentSegment.kf1->v,
+        this->compute_weight(seg, t),
+        fValues[seg],
+        fValues[seg + 1],
     };
 }
 
-KeyframeAnimator::KFSegment KeyframeAnimator::find_segment(float t) const {
-    SkASSERT(fKFs.size() > 1);
-    SkASSERT(t > fKFs.front().t);
-    SkASSERT(t < fKFs.back().t);
-
-    auto kf0 = &fKFs.front(),
-         kf1 = &fKFs.back();
+size_t KeyframeAnimator::find_segment(float t) const {
+    SkASSERT(fTimes.size() > 1);
+    SkASSERT(t > fTimes.front());
+    SkASSERT(t < fTimes.back());
 
-    // Binary-search, until we reduce to sequential keyframes.
-    while (kf0 + 1 != kf1) {
-        SkASSERT(kf0 < kf1);
-        SkASSERT(kf0->t <= t && t < kf1->t);
-
-        const auto mid_kf = kf0 + (kf1 - kf0) / 2;
+    // Most queries hit the cached segment, and sequential playback moves on to a neighboring one.
+    auto seg = fCurrentSegment;
+    if (this->segment_contains(seg, t)) {
+        return seg;
+    }
 
-        if (t >= mid_kf->t) {
-            kf0 = mid_kf;
-        } else {
-            kf1 = mid_kf;
-        }
+    if (seg + 2 < fTimes.size() && this->segment_contains(seg + 1, t)) {
+        seg += 1;
+    } else if (seg > 0 && this->segment_contains(seg - 1, t)) {
+        seg -= 1;
+    } else {
+        // Binary-search for the first inner keyframe past t; the segment ends there.
+        const auto kf1 = std::upper_bound(fTimes.cbegin() + 1, fTimes.cend() - 1, t);
+        seg = SkToSizeT(kf1 - fTimes.cbegin()) - 1;
     }
+    SkASSERT(this->segment_contains(seg, t));
 
-    return {kf0, kf1};
+    fCurrentSegment = seg;
+    return seg;
 }
 
-float KeyframeAnimator::compute_weight(const KFSegment &seg, float t) const {
-    SkASSERT(seg.contains(t));
+float KeyframeAnimator::compute_weight(size_t seg, float t) const {
+    SkASSERT(this->segment_contains(seg, t));
 
     // Linear weight.
-    auto w = (t - seg.kf0->t) / (seg.kf1->t - seg.kf0->t);
+    auto w = (t - fTimes[seg]) / (fTimes[seg + 1] - fTimes[seg]);
 
     // Optional cubic mapper.
-    if (seg.kf0->mapping >= Keyframe::kCubicIndexOffset) {
-        SkASSERT(seg.kf0->v != seg.kf1->v);
-        const auto mapper_index = SkToSizeT(seg.kf0->mapping - Keyframe::kCubicIndexOffset);
+    if (fMappings[seg] >= Keyframe::kCubicIndexOffset) {
+        SkASSERT(fValues[seg] != fValues[seg + 1]);
+        const auto mapper_index = SkToSizeT(fMappings[seg] - Keyframe::kCubicIndexOffset);
         w = fCMs[mapper_index].computeYFromX(w);
     }
 
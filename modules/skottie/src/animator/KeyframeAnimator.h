@@ -58,16 +58,14 @@ public:
     ~KeyframeAnimator() override;
 
     bool isConstant() const {
-        SkASSERT(!fKFs.empty());
+        SkASSERT(!fTimes.empty());
 
         // parseKeyFrames() ensures we only keep a single frame for constant properties.
-        return fKFs.size() == 1;
+        return fTimes.size() == 1;
     }
 
 protected:
-    KeyframeAnimator(std::vector<Keyframe> kfs, std::vector<SkCubicMap> cms)
-        : fKFs(std::move(kfs))
-        , fCMs(std::move(cms)) {}
+    KeyframeAnimator(const std::vector<Keyframe>& kfs, std::vector<SkCubicMap> cms);
 
     struct LERPInfo {
         float           weight; // vrec0/vrec1 weight [0..1]
@@ -80,28 +78,27 @@ protected:
     LERPInfo getLERPInfo(float t) const;
 
 private:
-    // Two sequential KFRecs determine how the value varies within [kf0 .. kf1)
-    struct KFSegment {
-        const Keyframe* kf0;
-        const Keyframe* kf1;
+    // Two sequential keyframes i, i+1 determine how the value varies within [t_i .. t_i+1).
+    bool segment_contains(size_t i, float t) const {
+        SkASSERT(i + 1 < fTimes.size());
 
-        bool contains(float t) const {
-            SkASSERT(!!kf0 == !!kf1);
-            SkASSERT(!kf0 || kf1 == kf0 + 1);
+        return fTimes[i] <= t && t < fTimes[i + 1];
+    }
 
-            return kf0 && kf0->t <= t && t < kf1->t;
-        }
-    };
+    // Find the segment containing |t|.
+    size_t find_segment(float t) const;
 
-    // Find the KFSegment containing |t|.
-    KFSegment find_segment(float t) const;
+    // Given a |t| and a containing segment, compute the local interpolation weight.
+    float compute_weight(size_t seg, float t) const;
 
-    // Given a |t| and a containing KFSegment, compute the local interpolation weight.
-    float compute_weight(const KFSegment& seg, float t) const;
+    // Keyframe records, one per AE/Lottie keyframe, stored as parallel arrays: segment lookups
+    // only touch the (contiguous) times.
+    const std::vector<float>           fTimes;
+    const std::vector<Keyframe::Value> fValues;
+    const std::vector<uint32_t>        fMappings;
 
-    const std::vector<Keyframe>   fKFs; // Keyframe records, one per AE/Lottie keyframe.
-    const std::vector<SkCubicMap> fCMs; // Optional cubic mappers (Bezier interpolation).
-    mutable KFSegment             fCurrentSegment = { nullptr, nullptr }; // Cached segment.
+    const std::vector<SkCubicMap>      fCMs; // Optional cubic mappers (Bezier interpolation).
+    mutable size_t                     fCurrentSegment = 0; // Cached segment.
 };
 
 class KeyframeAnimatorBuilder : public SkNoncopyable {
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "modules/skottie/include/Skottie.h"
+#include "modules/sksg/include/SkSGInvalidationController.h"
+#include "tests/Test.h"
+
+#include <cstring>
+
+using namespace skottie;
+
+namespace {
+
+// Two small solids moving in opposite corners, over a static one.
+static constexpr char gTwoSolidsJson[] =
+    R"({
+         "v": "5.2.1",
+         "w": 128,
+         "h": 96,
+         "fr": 30,
+         "ip": 0,
+         "op": 30,
+         "layers": [
+           {
+             "ty": 1, "sw": 8, "sh": 8, "sc": "#ff0000", "ip": 0, "op": 30,
+             "ks": { "p": { "a": 1, "k": [
+               { "t": 0, "s": [4, 4], "e": [24, 12] }, { "t": 30 }
+             ]}}
+           },
+           {
+             "ty": 1, "sw": 8, "sh": 8, "sc": "#0000ff", "ip": 0, "op": 30,
+             "ks": { "p": { "a": 1, "k": [
+               { "t": 0, "s": [100, 80], "e": [120, 64] }, { "t": 30 }
+             ]}}
+           },
+           {
+             "ty": 1, "sw": 32, "sh": 32, "sc": "#00ff00", "ip": 0, "op": 30,
+             "ks": { "p": { "a": 0, "k": [48, 32] }}
+           }
+         ]
+       })";
+
+bool same_pixels(const SkBitmap& a, const SkBitmap& b) {
+    return a.computeByteSize() == b.computeByteSize() &&
+           0 == memcmp(a.getPixels(), b.getPixels(), a.computeByteSize());
+}
+
+} // namespace
+
+DEF_TEST(Skottie_RenderDamage, r) {
+    auto anim = Animation::Make(gTwoSolidsJson, strlen(gTwoSolidsJson));
+    auto reference = Animation::Make(gTwoSolidsJson, strlen(gTwoSolidsJson));
+    REPORTER_ASSERT(r, anim && reference);
+    if (!anim || !reference) {
+        return;
+    }
+
+    const SkRect dst = SkRect::MakeXYWH(8, 4, 256, 192);
+    for (int maxRects : {16, 1}) {
+        Animation::DamageOptions options;
+        options.fMaxRects   = maxRects;
+        options.fBackground = SK_ColorWHITE;
+
+        SkBitmap incremental, full;
+        incremental.allocN32Pixels(272, 200);
+        full.allocN32Pixels(272, 200);
+        incremental.eraseColor(SK_ColorWHITE);
+        SkCanvas incrementalCanvas(incremental),
+                 fullCanvas(full);
+
+        anim->seekFrame(0);
+        anim->render(&incrementalCanvas, &dst);
+
+        sksg::InvalidationController damage;
+        for (int frame = 1; frame < 30; frame += 3) {
+            // Mark a pixel of the static solid, which lies between the moving ones.
+            const SkColor staticColor = incremental.getColor(136, 100);
+            *incremental.getAddr32(136, 100) = 0xff123456;
+
+            anim->seekFrame(frame, &damage);
+            const SkIRect redrawn = anim->renderDamage(&incrementalCanvas, damage, &dst, 0,
+                                                       options);
+            damage.reset();
+            REPORTER_ASSERT(r, !redrawn.isEmpty());
+            REPORTER_ASSERT(r, SkIRect::MakeWH(272, 200).contains(redrawn));
+
+            // Unless everything is merged into one rect, the static solid is not redrawn.
+            REPORTER_ASSERT(r, (incremental.getColor(136, 100) == staticColor) == (maxRects == 1));
+            incremental.eraseArea(SkIRect::MakeXYWH(136, 100, 1, 1), staticColor);
+
+            reference->seekFrame(frame);
+            full.eraseColor(SK_ColorWHITE);
+            reference->render(&fullCanvas, &dst);
+            REPORTER_ASSERT(r, same_pixels(incremental, full), "frame %d", frame);
+        }
+
+        // Seeking to the same frame damages nothing.
+        anim->seekFrame(28, &damage);
+        REPORTER_ASSERT(r, anim->renderDamage(&incrementalCanvas, damage, &dst).isEmpty());
+    }
+}
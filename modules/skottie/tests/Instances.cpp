@@ -0,0 +1,124 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
+#include "modules/skottie/include/Skottie.h"
+#include "modules/skottie/utils/SkottieUtils.h"
+#include "tests/Test.h"
+
+#include <cstring>
+#include <vector>
+
+using namespace skottie;
+
+namespace {
+
+// A solid that slides across the frame while fading in.
+static constexpr char gSlidingSolidJson[] =
+    R"({
+         "v": "5.2.1",
+         "w": 64,
+         "h": 48,
+         "fr": 30,
+         "ip": 0,
+         "op": 30,
+         "layers": [{
+           "ty": 1,
+           "sw": 16,
+           "sh": 16,
+           "sc": "#ff8000",
+           "ip": 0,
+           "op": 30,
+           "ks": {
+             "p": { "a": 1, "k": [
+               { "t": 0, "s": [0, 0], "e": [48, 32],
+                 "i": { "x": [0.4], "y": [1] }, "o": { "x": [0.6], "y": [0] } },
+               { "t": 30 }
+             ]},
+             "o": { "a": 1, "k": [
+               { "t": 0, "s": [20], "e": [100] },
+               { "t": 30 }
+             ]}
+           }
+         }]
+       })";
+
+SkBitmap render_frame(const Animation& anim) {
+    SkBitmap bm;
+    bm.allocN32Pixels(64, 48);
+    bm.eraseColor(SK_ColorWHITE);
+    SkCanvas canvas(bm);
+    anim.render(&canvas);
+    return bm;
+}
+
+bool same_pixels(const SkBitmap& a, const SkBitmap& b) {
+    return a.computeByteSize() == b.computeByteSize() &&
+           0 == memcmp(a.getPixels(), b.getPixels(), a.computeByteSize());
+}
+
+} // namespace
+
+DEF_TEST(Skottie_Instances, r) {
+    const size_t len = strlen(gSlidingSolidJson);
+    auto instances = Animation::Builder().makeInstances(gSlidingSolidJson, len, 3);
+    REPORTER_ASSERT(r, instances.size() == 3);
+
+    // Each instance seeks on its own.
+    for (size_t i = 0; i < instances.size(); ++i) {
+        instances[i]->seekFrame(10.0 * i);
+    }
+    auto reference = Animation::Make(gSlidingSolidJson, len);
+    for (size_t i = 0; i < instances.size(); ++i) {
+        reference->seekFrame(10.0 * i);
+        REPORTER_ASSERT(r, same_pixels(render_frame(*instances[i]), render_frame(*reference)));
+    }
+
+    REPORTER_ASSERT(r, Animation::Builder().makeInstances("{", 1, 2).empty());
+    REPORTER_ASSERT(r, Animation::Builder().makeInstances(gSlidingSolidJson, len, 0).empty());
+}
+
+DEF_TEST(Skottie_FrameRenderer, r) {
+    const size_t len = strlen(gSlidingSolidJson);
+    Animation::Builder builder;
+    auto renderer = skottie_utils::FrameRenderer::Make(builder, gSlidingSolidJson, len, 4);
+    REPORTER_ASSERT(r, renderer && renderer->workerCount() == 4);
+    if (!renderer) {
+        return;
+    }
+
+    std::vector<double> frames;
+    for (int i = 0; i < 60; ++i) {
+        frames.push_back(i * 0.5);
+    }
+
+    auto executor = SkExecutor::MakeFIFOThreadPool(4);
+    std::vector<SkBitmap> parallel(frames.size());
+    std::vector<int> drawnBy(frames.size(), -1);
+    renderer->renderFrames(frames, executor.get(),
+                           [&](int worker, size_t i, const Animation& anim) {
+        parallel[i] = render_frame(anim);
+        drawnBy[i] = worker;
+    });
+
+    auto reference = Animation::Make(gSlidingSolidJson, len);
+    for (size_t i = 0; i < frames.size(); ++i) {
+        REPORTER_ASSERT(r, drawnBy[i] >= 0 && drawnBy[i] < renderer->workerCount());
+        reference->seekFrame(frames[i]);
+        REPORTER_ASSERT(r, same_pixels(parallel[i], render_frame(*reference)), "frame %zu", i);
+    }
+
+    // Without an executor every frame is drawn on this thread.
+    size_t count = 0;
+    renderer->renderFrames(frames, nullptr, [&](int worker, size_t i, const Animation&) {
+        REPORTER_ASSERT(r, worker == 0 && i == count);
+        count++;
+    });
+    REPORTER_ASSERT(r, count == frames.size());
+}
@@ -5,6 +5,8 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkString.h"
+#include "include/private/SkTPin.h"
 #include "modules/skottie/include/ExternalLayer.h"
 #include "modules/skottie/src/SkottiePriv.h"
 #include "modules/skottie/src/SkottieValue.h"
@@ -12,6 +14,7 @@
 #include "src/utils/SkJSON.h"
 #include "tests/Test.h"
 
+#include <algorithm>
 #include <cmath>
 
 using namespace skottie;
@@ -135,3 +138,37 @@ DEF_TEST(Skottie_Keyframe, reporter) {
         REPORTER_ASSERT(reporter, SkScalarNearlyEqual(prop(4  ), 4));
     }
 }
+
+DEF_TEST(Skottie_KeyframeSeekOrder, reporter) {
+    // v(t) = t * t at integer t, linear in between.
+    SkString json(R"({ "a": 1, "k": [)");
+    static constexpr int kCount = 64;
+    for (int i = 0; i < kCount; ++i) {
+        json.appendf(R"(%s{ "t": %d, "s": %d })", i ? "," : "", i, i * i);
+    }
+    json.append("]}");
+
+    MockProperty<ScalarValue> prop(json.c_str());
+    REPORTER_ASSERT(reporter, prop);
+
+    const auto expected = [](float t) {
+        t = SkTPin(t, 0.0f, kCount - 1.0f);
+        const auto i = std::min(static_cast<int>(t), kCount - 2);
+        return i * i + (t - i) * ((i + 1) * (i + 1) - i * i);
+    };
+    const auto check = [&](float t) {
+        REPORTER_ASSERT(reporter, SkScalarNearlyEqual(prop(t), expected(t), 0.001f),
+                        "t: %f, v: %f, expected: %f", t, prop(t), expected(t));
+    };
+
+    // Forward and backward playback, then jumps.
+    for (float t = -1; t <= kCount; t += 0.25f) {
+        check(t);
+    }
+    for (float t = kCount; t >= -1; t -= 0.25f) {
+        check(t);
+    }
+    for (float t : { 10.5f, 50.25f, 3.75f, 3.25f, 62.9f, 0.1f, 31.5f, 32.5f, 30.5f }) {
+        check(t);
+    }
+}
@@ -7,6 +7,11 @@
 
 #include "modules/skottie/utils/SkottieUtils.h"
 
+#include "src/core/SkTaskGroup.h"
+
+#include <algorithm>
+#include <atomic>
+
 namespace skottie_utils {
 
 class CustomPropertyManager::PropertyInterceptor final : public skottie::PropertyObserver {
@@ -241,4 +246,36 @@ sk_sp<skottie::ExternalLayer> ExternalAnimationPrecompInterceptor::onLoadPrecomp
                 : nullptr;
 }
 
+std::unique_ptr<FrameRenderer> FrameRenderer::Make(skottie::Animation::Builder& builder,
+                                                   const char* data, size_t length,
+                                                   int workerCount) {
+    auto instances = builder.makeInstances(data, length, std::max(workerCount, 1));
+
+    if (instances.empty()) {
+        return nullptr;
+    }
+
+    return std::unique_ptr<FrameRenderer>(new FrameRenderer(std::move(instances)));
+}
+
+void FrameRenderer::renderFrames(const std::vector<double>& frames, SkExecutor* executor,
+                                 const DrawFrameProc& drawFrame) const {
+    std::atomic<size_t> next{0};
+    auto work = [&](int worker) {
+        auto* anim = fInstances[worker].get();
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < frames.size();) {
+            anim->seekFrame(frames[i]);
+            drawFrame(worker, i, *anim);
+        }
+    };
+
+    if (!executor || fInstances.size() == 1) {
+        work(0);
+        return;
+    }
+
+    // Tasks that start after the queue is drained just return.
+    SkTaskGroup(*executor).batch(this->workerCount(), work);
+}
+
 } // namespace skottie_utils
@@ -12,11 +12,14 @@
 #include "modules/skottie/include/Skottie.h"
 #include "modules/skottie/include/SkottieProperty.h"
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+class SkExecutor;
+
 namespace skottie_utils {
 
 /**
@@ -126,6 +129,51 @@ private:
     const SkString                             fPrefix;
 };
 
+/**
+ * Seeks and draws many frames of one animation in parallel, e.g. to export it.
+ *
+ * Each worker owns its own instance of the animation (see Animation::Builder::makeInstances()),
+ * and takes the next frame from a shared queue whenever it finishes one, so workers stay busy
+ * even when some frames cost much more than others.
+ */
+class FrameRenderer final {
+public:
+    /**
+     * Builds workerCount instances of the animation with builder. Returns nullptr if the
+     * animation cannot be parsed.
+     */
+    static std::unique_ptr<FrameRenderer> Make(skottie::Animation::Builder& builder,
+                                               const char* data, size_t length, int workerCount);
+
+    /**
+     * The first worker's instance, e.g. for its size() and duration(). It must not be seeked
+     * while renderFrames() runs.
+     */
+    skottie::Animation* animation() const { return fInstances[0].get(); }
+
+    int workerCount() const { return static_cast<int>(fInstances.size()); }
+
+    /**
+     * Called with an instance seeked to frames[index]. worker is in [0, workerCount()), and no
+     * two concurrent calls share one, so it can index per-worker state such as surfaces.
+     */
+    using DrawFrameProc =
+            std::function<void(int worker, size_t index, const skottie::Animation&)>;
+
+    /**
+     * Seeks to each of frames (in Animation::seekFrame() units) and calls drawFrame, on the
+     * executor's threads if it is not null, else on this one. Frames are started in order.
+     * Returns once every frame has been drawn.
+     */
+    void renderFrames(const std::vector<double>& frames, SkExecutor*,
+                      const DrawFrameProc& drawFrame) const;
+
+private:
+    explicit FrameRenderer(std::vector<sk_sp<skottie::Animation>> instances)
+        : fInstances(std::move(instances)) {}
+
+    const std::vector<sk_sp<skottie::Animation>> fInstances;
+};
 
 } // namespace skottie_utils
 
@@ -39,7 +39,10 @@ public:
     void enableFontFallback();
     bool fontFallbackEnabled() { return fEnableFontFallback; }
 
-    ParagraphCache* getParagraphCache() { return &fParagraphCache; }
+    ParagraphCache* getParagraphCache() { return fParagraphCache.get(); }
+    // Shares a cache with other collections (nullptr gives this one a cache of its own). Only
+    // collections that resolve font families to the same typefaces find each other's paragraphs.
+    void setParagraphCache(sk_sp<ParagraphCache> cache);
 
     void clearCaches();
 
@@ -72,7 +75,7 @@ private:
     sk_sp<SkFontMgr> fTestFontManager;
 
     std::vector<SkString> fDefaultFamilyNames;
-    ParagraphCache fParagraphCache;
+    sk_sp<ParagraphCache> fParagraphCache;
 };
 }  // namespace textlayout
 }  // namespace skia
@@ -2,11 +2,14 @@
 #ifndef ParagraphCache_DEFINED
 #define ParagraphCache_DEFINED
 
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkString.h"
 #include "include/private/SkMutex.h"
 #include "src/core/SkLRUCache.h"
+#include <atomic>
 #include <functional>  // std::function
-
-#define PARAGRAPH_CACHE_STATS
+#include <memory>
+#include <vector>
 
 namespace skia {
 namespace textlayout {
@@ -24,54 +27,100 @@ enum InternalState {
 class ParagraphImpl;
 class ParagraphCacheKey;
 class ParagraphCacheValue;
+struct ShapedRuns;
+struct ShapedRunsKey;
 
 bool operator==(const ParagraphCacheKey& a, const ParagraphCacheKey& b);
 
-class ParagraphCache {
+// Caches shaped paragraphs and, for paragraphs that miss (e.g. ones being edited), the runs
+// shaped for each of their style blocks.
+//
+// A cache can be shared by several FontCollections, on any number of threads. Paragraphs are keyed
+// by the typefaces their font families resolve to and by the fallback font manager, so
+// collections sharing a cache only share paragraphs they would shape with the same fonts.
+class ParagraphCache : public SkRefCnt {
 public:
+    static constexpr int    kDefaultMaxEntries    = 128;
+    static constexpr int    kDefaultMaxRunEntries = 1024;
+    static constexpr size_t kDefaultMaxBytes      = 32 * 1024 * 1024;
+
+    struct Options {
+        int    fMaxEntries    = kDefaultMaxEntries;    // Paragraphs kept.
+        int    fMaxRunEntries = kDefaultMaxRunEntries; // Shaped run sequences kept; 0 disables.
+        size_t fMaxBytes      = kDefaultMaxBytes;      // Approximate budget for both.
+        // The cache is split into this many independently locked shards (at most fMaxEntries),
+        // which split the limits above between them exactly; eviction is least recently used
+        // within a shard. Use more shards when many threads share a cache.
+        int    fShardCount    = 1;
+    };
+
     ParagraphCache();
-    ~ParagraphCache();
+    explicit ParagraphCache(const Options&);
+    ~ParagraphCache() override;
 
     void abandon();
     void reset();
     bool updateParagraph(ParagraphImpl* paragraph);
     bool findParagraph(ParagraphImpl* paragraph);
 
+    // Run-level cache, used while shaping paragraphs that missed.
+    std::shared_ptr<const ShapedRuns> findShapedRuns(const ShapedRunsKey&);
+    void updateShapedRuns(const ShapedRunsKey&, std::shared_ptr<const ShapedRuns>);
+
+    struct Stats {
+        int    fHits       = 0, // Paragraph lookups.
+               fMisses     = 0,
+               fRunHits    = 0, // Shaped run lookups.
+               fRunMisses  = 0;
+        int    fEntries    = 0,
+               fRunEntries = 0;
+        size_t fBytes      = 0;
+    };
+    Stats stats() const;
+
     // For testing
     void setChecker(std::function<void(ParagraphImpl* impl, const char*, bool)> checker) {
         fChecker = std::move(checker);
     }
     void printStatistics();
     void turnOn(bool value) { fCacheIsOn = value; }
-    int count() { return fLRUCacheMap.count(); }
+    int count() { return this->stats().fEntries; }
 
     bool isPossiblyTextEditing(ParagraphImpl* paragraph);
 
  private:
 
     struct Entry;
+    struct RunEntry;
+    struct Shard;
     void updateFrom(const ParagraphImpl* paragraph, Entry* entry);
     void updateTo(ParagraphImpl* paragraph, const Entry* entry);
 
-     mutable SkMutex fParagraphMutex;
-     std::function<void(ParagraphImpl* impl, const char*, bool)> fChecker;
+    Shard& shardFor(uint32_t hash) const;
 
-    static const int kMaxEntries = 128;
+    std::function<void(ParagraphImpl* impl, const char*, bool)> fChecker;
 
     struct KeyHash {
         uint32_t mix(uint32_t hash, uint32_t data) const;
         uint32_t operator()(const ParagraphCacheKey& key) const;
     };
 
-    SkLRUCache<ParagraphCacheKey, std::unique_ptr<Entry>, KeyHash> fLRUCacheMap;
-    bool fCacheIsOn;
-    ParagraphCacheValue* fLastCachedValue;
+    struct RunKeyHash {
+        uint32_t operator()(const ShapedRunsKey& key) const;
+    };
+
+    const Options fOptions;
+    std::vector<std::unique_ptr<Shard>> fShards;
+    std::atomic<bool> fCacheIsOn;
+
+    // The text of the last paragraph added, for isPossiblyTextEditing().
+    SkMutex  fLastCachedMutex;
+    SkString fLastCachedText;
 
-#ifdef PARAGRAPH_CACHE_STATS
-    int fTotalRequests;
-    int fCacheMisses;
-    int fHashMisses; // cache hit but hash table missed
-#endif
+    std::atomic<int> fHits;
+    std::atomic<int> fMisses;
+    std::atomic<int> fRunHits;
+    std::atomic<int> fRunMisses;
 };
 
 }  // namespace textlayout
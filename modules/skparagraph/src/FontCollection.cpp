@@ -24,7 +24,8 @@ size_t FontCollection::FamilyKey::Hasher::operator()(const FontCollection::Famil
 
 FontCollection::FontCollection()
         : fEnableFontFallback(true)
-        , fDefaultFamilyNames({SkString(DEFAULT_FONT_FAMILY)}) { }
+        , fDefaultFamilyNames({SkString(DEFAULT_FONT_FAMILY)})
+        , fParagraphCache(sk_make_sp<ParagraphCache>()) { }
 
 size_t FontCollection::getFontManagersCount() const { return this->getFontManagerOrder().size(); }
 
@@ -166,8 +167,12 @@ sk_sp<SkTypeface> FontCollection::defaultFallback() {
 void FontCollection::disableFontFallback() { fEnableFontFallback = false; }
 void FontCollection::enableFontFallback() { fEnableFontFallback = true; }
 
+void FontCollection::setParagraphCache(sk_sp<ParagraphCache> cache) {
+    fParagraphCache = cache ? std::move(cache) : sk_make_sp<ParagraphCache>();
+}
+
 void FontCollection::clearCaches() {
-    fParagraphCache.reset();
+    fParagraphCache->reset();
     fTypefaces.reset();
     SkShaper::PurgeCaches();
 }
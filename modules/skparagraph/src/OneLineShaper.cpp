@@ -1,5 +1,7 @@
 // Copyright 2019 Google LLC.
 
+#include "modules/skparagraph/include/FontCollection.h"
+#include "modules/skparagraph/include/ParagraphCache.h"
 #include "modules/skparagraph/src/Iterators.h"
 #include "modules/skparagraph/src/OneLineShaper.h"
 #include "src/utils/SkUTF.h"
@@ -14,6 +16,73 @@ static inline SkUnichar nextUtf8Unit(const char** ptr, const char* end) {
 namespace skia {
 namespace textlayout {
 
+namespace {
+// Passes SkShaper's output on to another handler, keeping a copy of the runs for the
+// paragraph cache.
+class RunRecorder final : public SkShaper::RunHandler {
+public:
+    explicit RunRecorder(SkShaper::RunHandler* handler)
+        : fHandler(handler), fRuns(std::make_shared<ShapedRuns>()) {}
+
+    std::shared_ptr<const ShapedRuns> detachRuns() { return std::move(fRuns); }
+
+    void beginLine() override { fHandler->beginLine(); }
+    void runInfo(const RunInfo& info) override { fHandler->runInfo(info); }
+    void commitRunInfo() override { fHandler->commitRunInfo(); }
+    void commitLine() override { fHandler->commitLine(); }
+
+    Buffer runBuffer(const RunInfo& info) override {
+        fBuffer = fHandler->runBuffer(info);
+        SkASSERT(fBuffer.offsets == nullptr);
+        return fBuffer;
+    }
+
+    void commitRunBuffer(const RunInfo& info) override {
+        ShapedRuns::ShapedRun run;
+        run.fFont = info.fFont;
+        run.fBidiLevel = info.fBidiLevel;
+        run.fAdvance = info.fAdvance;
+        run.fUtf8Range = info.utf8Range;
+        run.fGlyphs.assign(fBuffer.glyphs, fBuffer.glyphs + info.glyphCount);
+        run.fPositions.resize(info.glyphCount);
+        for (size_t i = 0; i < info.glyphCount; ++i) {
+            run.fPositions[i] = fBuffer.positions[i] - fBuffer.point;
+        }
+        if (fBuffer.clusters != nullptr) {
+            run.fClusters.assign(fBuffer.clusters, fBuffer.clusters + info.glyphCount);
+        }
+        fRuns->fRuns.push_back(std::move(run));
+        fHandler->commitRunBuffer(info);
+    }
+
+private:
+    SkShaper::RunHandler* fHandler;
+    std::shared_ptr<ShapedRuns> fRuns;
+    Buffer fBuffer;
+};
+}  // namespace
+
+void OneLineShaper::replay(const ShapedRuns& runs) {
+    for (auto& run : runs.fRuns) {
+        const RunInfo info = {
+            run.fFont,
+            run.fBidiLevel,
+            run.fAdvance,
+            run.fGlyphs.size(),
+            run.fUtf8Range
+        };
+        Buffer buffer = this->runBuffer(info);
+        std::copy(run.fGlyphs.begin(), run.fGlyphs.end(), buffer.glyphs);
+        for (size_t i = 0; i < run.fPositions.size(); ++i) {
+            buffer.positions[i] = run.fPositions[i] + buffer.point;
+        }
+        if (buffer.clusters != nullptr) {
+            std::copy(run.fClusters.begin(), run.fClusters.end(), buffer.clusters);
+        }
+        this->commitRunBuffer(info);
+    }
+}
+
 void OneLineShaper::commitRunBuffer(const RunInfo&) {
 
     fCurrentRun->commit();
@@ -635,8 +704,9 @@ bool OneLineShaper::shape() {
             return false;
         }
 
+        auto cache = fParagraph->fontCollection()->getParagraphCache();
         iterateThroughFontStyles(textRange, styleSpan,
-                [this, &shaper, defaultBidiLevel, limitlessWidth, &advanceX]
+                [this, &shaper, cache, defaultBidiLevel, limitlessWidth, &advanceX]
                 (Block block, SkTArray<SkShaper::Feature> features) {
             auto blockSpan = SkSpan<Block>(&block, 1);
 
@@ -679,18 +749,33 @@ bool OneLineShaper::shape() {
                         continue;
                     }
                     auto unresolvedText = fParagraph->text(unresolvedRange);
-
-                    SkShaper::TrivialFontRunIterator fontIter(font, unresolvedText.size());
-                    LangIterator langIter(unresolvedText, blockSpan,
-                                      fParagraph->paragraphStyle().getTextStyle());
-                    SkShaper::TrivialBiDiRunIterator bidiIter(defaultBidiLevel, unresolvedText.size());
-                    auto scriptIter = SkShaper::MakeSkUnicodeHbScriptRunIterator
-                                     (fParagraph->getUnicode(), unresolvedText.begin(), unresolvedText.size());
                     fCurrentText = unresolvedRange;
-                    shaper->shape(unresolvedText.begin(), unresolvedText.size(),
-                            fontIter, bidiIter,*scriptIter, langIter,
-                            features.data(), features.size(),
-                            limitlessWidth, this);
+
+                    // Text edited in one place leaves the other style blocks as they were,
+                    // so look for runs shaped for the same input before shaping again
+                    ShapedRunsKey key{SkString(unresolvedText.begin(), unresolvedText.size()),
+                                      font,
+                                      defaultBidiLevel,
+                                      block.fStyle.getLocale(),
+                                      std::vector<SkShaper::Feature>(features.begin(),
+                                                                     features.end())};
+                    auto runs = cache->findShapedRuns(key);
+                    if (runs != nullptr) {
+                        this->replay(*runs);
+                    } else {
+                        SkShaper::TrivialFontRunIterator fontIter(font, unresolvedText.size());
+                        LangIterator langIter(unresolvedText, blockSpan,
+                                          fParagraph->paragraphStyle().getTextStyle());
+                        SkShaper::TrivialBiDiRunIterator bidiIter(defaultBidiLevel, unresolvedText.size());
+                        auto scriptIter = SkShaper::MakeSkUnicodeHbScriptRunIterator
+                                         (fParagraph->getUnicode(), unresolvedText.begin(), unresolvedText.size());
+                        RunRecorder recorder(this);
+                        shaper->shape(unresolvedText.begin(), unresolvedText.size(),
+                                fontIter, bidiIter,*scriptIter, langIter,
+                                features.data(), features.size(),
+                                limitlessWidth, &recorder);
+                        cache->updateShapedRuns(key, recorder.detachRuns());
+                    }
 
                     // Take off the queue the block we tried to resolved -
                     // whatever happened, we have now smaller pieces of it to deal with
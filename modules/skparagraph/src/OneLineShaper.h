@@ -4,6 +4,8 @@
 
 #include <functional>  // std::function
 #include <queue>
+#include <vector>
+#include "include/core/SkFont.h"
 #include "include/core/SkSpan.h"
 #include "modules/skparagraph/include/TextStyle.h"
 #include "modules/skparagraph/src/ParagraphImpl.h"
@@ -12,6 +14,35 @@
 namespace skia {
 namespace textlayout {
 
+// Everything SkShaper is given when OneLineShaper shapes a piece of text. Feature ranges are kept
+// as passed to the shaper.
+struct ShapedRunsKey {
+    SkString fText;
+    SkFont fFont;
+    uint8_t fBidiLevel;
+    SkString fLocale;
+    std::vector<SkShaper::Feature> fFeatures;
+
+    bool operator==(const ShapedRunsKey& other) const;
+};
+
+// The runs SkShaper produced for a ShapedRunsKey, with positions relative to the start of each
+// run's buffer.
+struct ShapedRuns {
+    struct ShapedRun {
+        SkFont fFont;
+        uint8_t fBidiLevel;
+        SkVector fAdvance;
+        SkShaper::RunHandler::Range fUtf8Range;
+        std::vector<SkGlyphID> fGlyphs;
+        std::vector<SkPoint> fPositions;
+        std::vector<uint32_t> fClusters;
+    };
+    std::vector<ShapedRun> fRuns;
+
+    size_t bytes() const;
+};
+
 class ParagraphImpl;
 class OneLineShaper : public SkShaper::RunHandler {
 public:
@@ -72,6 +103,10 @@ private:
 #endif
     void finish(const Block& block, SkScalar height, SkScalar& advanceX);
 
+    // Feeds runs shaped earlier for the same input through runBuffer() and commitRunBuffer(),
+    // as SkShaper would.
+    void replay(const ShapedRuns& runs);
+
     void beginLine() override {}
     void runInfo(const RunInfo&) override {}
     void commitRunInfo() override {}
@@ -1,7 +1,10 @@
 // Copyright 2019 Google LLC.
 #include <memory>
 
+#include "include/private/SkChecksum.h"
+#include "modules/skparagraph/include/FontCollection.h"
 #include "modules/skparagraph/include/ParagraphCache.h"
+#include "modules/skparagraph/src/OneLineShaper.h"
 #include "modules/skparagraph/src/ParagraphImpl.h"
 
 namespace skia {
@@ -29,12 +32,45 @@ public:
         : fText(paragraph->fText.c_str(), paragraph->fText.size())
         , fPlaceholders(paragraph->fPlaceholders)
         , fTextStyles(paragraph->fTextStyles)
-        , fParagraphStyle(paragraph->paragraphStyle()) { }
+        , fParagraphStyle(paragraph->paragraphStyle())
+        , fResolvedFonts(ResolveFonts(paragraph))
+        , fFallbackFontManager(paragraph->fontCollection()->fontFallbackEnabled()
+                                       ? paragraph->fontCollection()->getFallbackManager()
+                                       : nullptr) { }
 
     SkString fText;
     SkTArray<Placeholder, true> fPlaceholders;
     SkTArray<Block, true> fTextStyles;
     ParagraphStyle fParagraphStyle;
+    // How the font collection resolved the styles above; see ResolveFonts().
+    std::vector<SkFontID> fResolvedFonts;
+    // Characters missing from those fonts come from here (held so the pointer is not reused).
+    sk_sp<SkFontMgr> fFallbackFontManager;
+
+private:
+    // The unique IDs of the typefaces the paragraph's font families resolve to, block by block
+    // (each block's list ends with 0), then those of the strut. Typeface IDs are never reused, so
+    // collections sharing a cache only share entries when they would shape with the same fonts.
+    static std::vector<SkFontID> ResolveFonts(const ParagraphImpl* paragraph) {
+        sk_sp<FontCollection> fontCollection = paragraph->fontCollection();
+        std::vector<SkFontID> ids;
+        auto resolve = [&](const std::vector<SkString>& families, SkFontStyle style) {
+            for (auto& typeface : fontCollection->findTypefaces(families, style)) {
+                ids.push_back(typeface->uniqueID());
+            }
+            ids.push_back(0);
+        };
+        for (auto& block : paragraph->fTextStyles) {
+            if (!block.fStyle.isPlaceholder()) {
+                resolve(block.fStyle.getFontFamilies(), block.fStyle.getFontStyle());
+            }
+        }
+        auto& strutStyle = paragraph->paragraphStyle().getStrutStyle();
+        if (strutStyle.getStrutEnabled()) {
+            resolve(strutStyle.getFontFamilies(), strutStyle.getFontStyle());
+        }
+        return ids;
+    }
 };
 
 class ParagraphCacheValue {
@@ -48,6 +84,9 @@ public:
         , fUTF8IndexForUTF16Index(paragraph->fUTF8IndexForUTF16Index)
         , fUTF16IndexForUTF8Index(paragraph->fUTF16IndexForUTF8Index) { }
 
+    // Roughly the memory held by this value.
+    size_t bytes() const;
+
     // Input == key
     ParagraphCacheKey fKey;
 
@@ -121,6 +160,11 @@ uint32_t ParagraphCache::KeyHash::operator()(const ParagraphCacheKey& key) const
         }
     }
 
+    for (SkFontID id : key.fResolvedFonts) {
+        hash = mix(hash, id);
+    }
+    hash = mix(hash, SkGoodHash()(key.fFallbackFontManager.get()));
+
     hash = mix(hash, SkGoodHash()(key.fText));
     return hash;
 }
@@ -138,6 +182,10 @@ bool operator==(const ParagraphCacheKey& a, const ParagraphCacheKey& b) {
     if (a.fTextStyles.size() != b.fTextStyles.size()) {
         return false;
     }
+    if (a.fResolvedFonts != b.fResolvedFonts ||
+        a.fFallbackFontManager != b.fFallbackFontManager) {
+        return false;
+    }
 
     // There is no need to compare default paragraph styles - they are included into fTextStyles
     if (!exactlyEqual(a.fParagraphStyle.getHeight(), b.fParagraphStyle.getHeight())) {
@@ -187,26 +235,157 @@ bool operator==(const ParagraphCacheKey& a, const ParagraphCacheKey& b) {
     return true;
 }
 
+size_t ParagraphCacheValue::bytes() const {
+    size_t bytes = sizeof(*this) + fKey.fText.size() +
+                   fKey.fResolvedFonts.size() * sizeof(SkFontID) +
+                   fKey.fTextStyles.count() * sizeof(Block) +
+                   fKey.fPlaceholders.count() * sizeof(Placeholder);
+    for (auto& run : fRuns) {
+        bytes += sizeof(Run) + run.size() * (sizeof(SkGlyphID) + 2 * sizeof(SkPoint) +
+                                             sizeof(uint32_t) + sizeof(SkRect) + sizeof(SkScalar));
+    }
+    bytes += fCodeUnitProperties.count() * sizeof(CodeUnitFlags) +
+             fWords.size() * sizeof(size_t) +
+             fBidiRegions.size() * sizeof(SkUnicode::BidiRegion) +
+             fUTF8IndexForUTF16Index.count() * sizeof(TextIndex) +
+             fUTF16IndexForUTF8Index.count() * sizeof(size_t);
+    return bytes;
+}
+
+bool ShapedRunsKey::operator==(const ShapedRunsKey& other) const {
+    if (fText != other.fText || fFont != other.fFont || fBidiLevel != other.fBidiLevel ||
+        fLocale != other.fLocale || fFeatures.size() != other.fFeatures.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < fFeatures.size(); ++i) {
+        auto& a = fFeatures[i];
+        auto& b = other.fFeatures[i];
+        if (a.tag != b.tag || a.value != b.value || a.start != b.start || a.end != b.end) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t ShapedRuns::bytes() const {
+    size_t bytes = sizeof(*this);
+    for (auto& run : fRuns) {
+        bytes += sizeof(run) + run.fGlyphs.size() * sizeof(SkGlyphID) +
+                 run.fPositions.size() * sizeof(SkPoint) +
+                 run.fClusters.size() * sizeof(uint32_t);
+    }
+    return bytes;
+}
+
+uint32_t ParagraphCache::RunKeyHash::operator()(const ShapedRunsKey& key) const {
+    KeyHash h;
+    uint32_t hash = 0;
+    hash = h.mix(hash, SkGoodHash()(key.fText));
+    hash = h.mix(hash, key.fFont.getTypeface() ? key.fFont.getTypeface()->uniqueID() : 0);
+    hash = h.mix(hash, SkGoodHash()(key.fFont.getSize()));
+    hash = h.mix(hash, SkGoodHash()(key.fFont.getScaleX()));
+    hash = h.mix(hash, SkGoodHash()(key.fFont.getSkewX()));
+    hash = h.mix(hash, SkGoodHash()(key.fFont.isEmbolden()));
+    hash = h.mix(hash, SkGoodHash()(key.fBidiLevel));
+    hash = h.mix(hash, SkGoodHash()(key.fLocale));
+    for (auto& feature : key.fFeatures) {
+        hash = h.mix(hash, SkGoodHash()(feature.tag));
+        hash = h.mix(hash, SkGoodHash()(feature.value));
+    }
+    return hash;
+}
+
+namespace {
+    // Charges an entry's size to its shard for as long as the entry lives, so entries evicted by
+    // count or dropped by reset() give their bytes back.
+    class ShardCharge {
+    public:
+        ShardCharge(size_t bytes, size_t* total) : fBytes(bytes), fTotal(total) {
+            *fTotal += fBytes;
+        }
+        ~ShardCharge() { *fTotal -= fBytes; }
+
+        ShardCharge(const ShardCharge&) = delete;
+        ShardCharge& operator=(const ShardCharge&) = delete;
+
+    private:
+        const size_t fBytes;
+        size_t* const fTotal;
+    };
+}  // namespace
+
 struct ParagraphCache::Entry {
 
-    Entry(ParagraphCacheValue* value) : fValue(value) {}
+    Entry(std::unique_ptr<ParagraphCacheValue> value, size_t bytes, size_t* shardBytes)
+        : fValue(std::move(value)), fCharge(bytes, shardBytes) {}
     std::unique_ptr<ParagraphCacheValue> fValue;
+    ShardCharge fCharge;
+};
+
+struct ParagraphCache::RunEntry {
+
+    RunEntry(std::shared_ptr<const ShapedRuns> runs, size_t bytes, size_t* shardBytes)
+        : fRuns(std::move(runs)), fCharge(bytes, shardBytes) {}
+    std::shared_ptr<const ShapedRuns> fRuns;
+    ShardCharge fCharge;
+};
+
+struct ParagraphCache::Shard {
+
+    Shard(int maxEntries, int maxRunEntries, size_t maxBytes)
+        : fMaxBytes(maxBytes)
+        , fParagraphs(maxEntries)
+        , fRuns(maxRunEntries) { }
+
+    // Evicts the least recently used runs, then paragraphs, until the shard fits its budget.
+    void purge() {
+        while (fBytes > fMaxBytes && fRuns.count() > 0) {
+            fRuns.removeLRU();
+        }
+        while (fBytes > fMaxBytes && fParagraphs.count() > 0) {
+            fParagraphs.removeLRU();
+        }
+    }
+
+    SkMutex fMutex;
+    const size_t fMaxBytes;
+    // Declared before the caches so the entries can still uncharge it when they are destroyed.
+    size_t fBytes = 0;
+    SkLRUCache<ParagraphCacheKey, std::unique_ptr<Entry>, KeyHash> fParagraphs;
+    SkLRUCache<ShapedRunsKey, std::unique_ptr<RunEntry>, RunKeyHash> fRuns;
 };
 
-ParagraphCache::ParagraphCache()
+ParagraphCache::ParagraphCache() : ParagraphCache(Options()) { }
+
+ParagraphCache::ParagraphCache(const Options& options)
     : fChecker([](ParagraphImpl* impl, const char*, bool){ })
-    , fLRUCacheMap(kMaxEntries)
+    , fOptions(options)
     , fCacheIsOn(true)
-    , fLastCachedValue(nullptr)
-#ifdef PARAGRAPH_CACHE_STATS
-    , fTotalRequests(0)
-    , fCacheMisses(0)
-    , fHashMisses(0)
-#endif
-{ }
+    , fHits(0)
+    , fMisses(0)
+    , fRunHits(0)
+    , fRunMisses(0) {
+    // Every shard keeps at least one paragraph, so there are no more shards than paragraphs.
+    const int shards = SkTPin(fOptions.fShardCount, 1, std::max(1, fOptions.fMaxEntries));
+    // Splits a limit exactly: the shares add up to the limit, and differ by at most one.
+    auto share = [shards](auto limit, int i) {
+        return limit / shards + (i < SkToInt(limit % shards) ? 1 : 0);
+    };
+    for (int i = 0; i < shards; ++i) {
+        fShards.push_back(std::make_unique<Shard>(share(std::max(1, fOptions.fMaxEntries), i),
+                                                  share(std::max(0, fOptions.fMaxRunEntries), i),
+                                                  share(fOptions.fMaxBytes, i)));
+    }
+}
 
 ParagraphCache::~ParagraphCache() { }
 
+ParagraphCache::Shard& ParagraphCache::shardFor(uint32_t hash) const {
+    // The caches inside a shard index by the low bits of the same hash, so pick the shard by a
+    // mix of it to keep them evenly used.
+    return *fShards[SkChecksum::Mix(hash) % fShards.size()];
+}
+
 void ParagraphCache::updateTo(ParagraphImpl* paragraph, const Entry* entry) {
 
     paragraph->fRuns.reset();
@@ -221,13 +400,34 @@ void ParagraphCache::updateTo(ParagraphImpl* paragraph, const Entry* entry) {
     }
 }
 
+ParagraphCache::Stats ParagraphCache::stats() const {
+    Stats stats;
+    stats.fHits = fHits;
+    stats.fMisses = fMisses;
+    stats.fRunHits = fRunHits;
+    stats.fRunMisses = fRunMisses;
+    for (auto& shard : fShards) {
+        SkAutoMutexExclusive lock(shard->fMutex);
+        stats.fEntries += shard->fParagraphs.count();
+        stats.fRunEntries += shard->fRuns.count();
+        stats.fBytes += shard->fBytes;
+    }
+    return stats;
+}
+
 void ParagraphCache::printStatistics() {
+    Stats stats = this->stats();
+    int requests = stats.fHits + stats.fMisses;
+    int runRequests = stats.fRunHits + stats.fRunMisses;
     SkDebugf("--- Paragraph Cache ---\n");
-    SkDebugf("Total requests: %d\n", fTotalRequests);
-    SkDebugf("Cache misses: %d\n", fCacheMisses);
-    SkDebugf("Cache miss %%: %f\n", (fTotalRequests > 0) ? 100.f * fCacheMisses / fTotalRequests : 0.f);
-    int cacheHits = fTotalRequests - fCacheMisses;
-    SkDebugf("Hash miss %%: %f\n", (cacheHits > 0) ? 100.f * fHashMisses / cacheHits : 0.f);
+    SkDebugf("Total requests: %d\n", requests);
+    SkDebugf("Cache misses: %d\n", stats.fMisses);
+    SkDebugf("Cache miss %%: %f\n", (requests > 0) ? 100.f * stats.fMisses / requests : 0.f);
+    SkDebugf("Run requests: %d\n", runRequests);
+    SkDebugf("Run cache miss %%: %f\n",
+             (runRequests > 0) ? 100.f * stats.fRunMisses / runRequests : 0.f);
+    SkDebugf("Entries: %d paragraphs, %d runs, %zu bytes\n",
+             stats.fEntries, stats.fRunEntries, stats.fBytes);
     SkDebugf("---------------------\n");
 }
 
@@ -236,35 +436,35 @@ void ParagraphCache::abandon() {
 }
 
 void ParagraphCache::reset() {
-    SkAutoMutexExclusive lock(fParagraphMutex);
-#ifdef PARAGRAPH_CACHE_STATS
-    fTotalRequests = 0;
-    fCacheMisses = 0;
-    fHashMisses = 0;
-#endif
-    fLRUCacheMap.reset();
-    fLastCachedValue = nullptr;
+    for (auto& shard : fShards) {
+        SkAutoMutexExclusive lock(shard->fMutex);
+        shard->fParagraphs.reset();
+        shard->fRuns.reset();
+    }
+    fHits = 0;
+    fMisses = 0;
+    fRunHits = 0;
+    fRunMisses = 0;
+    SkAutoMutexExclusive lock(fLastCachedMutex);
+    fLastCachedText.reset();
 }
 
 bool ParagraphCache::findParagraph(ParagraphImpl* paragraph) {
     if (!fCacheIsOn) {
         return false;
     }
-#ifdef PARAGRAPH_CACHE_STATS
-    ++fTotalRequests;
-#endif
-    SkAutoMutexExclusive lock(fParagraphMutex);
     ParagraphCacheKey key(paragraph);
-    std::unique_ptr<Entry>* entry = fLRUCacheMap.find(key);
+    Shard& shard = this->shardFor(KeyHash()(key));
+    SkAutoMutexExclusive lock(shard.fMutex);
+    std::unique_ptr<Entry>* entry = shard.fParagraphs.find(key);
 
     if (!entry) {
         // We have a cache miss
-#ifdef PARAGRAPH_CACHE_STATS
-        ++fCacheMisses;
-#endif
+        ++fMisses;
         fChecker(paragraph, "missingParagraph", true);
         return false;
     }
+    ++fHits;
     updateTo(paragraph, entry->get());
     fChecker(paragraph, "foundParagraph", true);
     return true;
@@ -274,23 +474,29 @@ bool ParagraphCache::updateParagraph(ParagraphImpl* paragraph) {
     if (!fCacheIsOn) {
         return false;
     }
-#ifdef PARAGRAPH_CACHE_STATS
-    ++fTotalRequests;
-#endif
-    SkAutoMutexExclusive lock(fParagraphMutex);
-
     ParagraphCacheKey key(paragraph);
-    std::unique_ptr<Entry>* entry = fLRUCacheMap.find(key);
+    Shard& shard = this->shardFor(KeyHash()(key));
+    SkAutoMutexExclusive lock(shard.fMutex);
+
+    std::unique_ptr<Entry>* entry = shard.fParagraphs.find(key);
     if (!entry) {
         // isTooMuchMemoryWasted(paragraph) not needed for now
         if (isPossiblyTextEditing(paragraph)) {
             // Skip this paragraph
             return false;
         }
-        ParagraphCacheValue* value = new ParagraphCacheValue(paragraph);
-        fLRUCacheMap.insert(key, std::make_unique<Entry>(value));
+        auto value = std::make_unique<ParagraphCacheValue>(paragraph);
+        size_t bytes = value->bytes();
+        if (bytes > shard.fMaxBytes) {
+            // It would push everything else out
+            return false;
+        }
+        shard.fParagraphs.insert(key, std::make_unique<Entry>(std::move(value), bytes,
+                                                              &shard.fBytes));
+        shard.purge();
         fChecker(paragraph, "addedParagraph", true);
-        fLastCachedValue = value;
+        SkAutoMutexExclusive lastLock(fLastCachedMutex);
+        fLastCachedText = key.fText;
         return true;
     } else {
         // We do not have to update the paragraph
@@ -298,14 +504,45 @@ bool ParagraphCache::updateParagraph(ParagraphImpl* paragraph) {
     }
 }
 
+std::shared_ptr<const ShapedRuns> ParagraphCache::findShapedRuns(const ShapedRunsKey& key) {
+    if (!fCacheIsOn || fOptions.fMaxRunEntries <= 0) {
+        return nullptr;
+    }
+    Shard& shard = this->shardFor(RunKeyHash()(key));
+    SkAutoMutexExclusive lock(shard.fMutex);
+    std::unique_ptr<RunEntry>* entry = shard.fRuns.find(key);
+    if (!entry) {
+        ++fRunMisses;
+        return nullptr;
+    }
+    ++fRunHits;
+    return (*entry)->fRuns;
+}
+
+void ParagraphCache::updateShapedRuns(const ShapedRunsKey& key,
+                                      std::shared_ptr<const ShapedRuns> runs) {
+    if (!fCacheIsOn || fOptions.fMaxRunEntries <= 0 || !runs) {
+        return;
+    }
+    Shard& shard = this->shardFor(RunKeyHash()(key));
+    size_t bytes = sizeof(key) + key.fText.size() + runs->bytes();
+    if (bytes > shard.fMaxBytes) {
+        return;
+    }
+    SkAutoMutexExclusive lock(shard.fMutex);
+    if (shard.fRuns.find(key)) {
+        // Another paragraph shaped the same text first
+        return;
+    }
+    shard.fRuns.insert(key, std::make_unique<RunEntry>(std::move(runs), bytes, &shard.fBytes));
+    shard.purge();
+}
+
 // Special situation: (very) long paragraph that is close to the last formatted paragraph
 #define NOCACHE_PREFIX_LENGTH 40
 bool ParagraphCache::isPossiblyTextEditing(ParagraphImpl* paragraph) {
-    if (fLastCachedValue == nullptr) {
-        return false;
-    }
-
-    auto& lastText = fLastCachedValue->fKey.fText;
+    SkAutoMutexExclusive lock(fLastCachedMutex);
+    auto& lastText = fLastCachedText;
     auto& text = paragraph->fText;
 
     if ((lastText.size() < NOCACHE_PREFIX_LENGTH) || (text.size() < NOCACHE_PREFIX_LENGTH)) {
@@ -99,15 +99,17 @@ public:
         }
 
         if (testOnly) {
-            this->setTestFontManager(std::move(fFontProvider));
+            this->setTestFontManager(fFontProvider);
         } else {
-            this->setAssetFontManager(std::move(fFontProvider));
+            this->setAssetFontManager(fFontProvider);
         }
         this->disableFontFallback();
     }
 
     size_t resolvedFonts() const { return fResolvedFonts; }
 
+    sk_sp<TypefaceFontProvider> fontProvider() const { return fFontProvider; }
+
     // TODO: temp solution until we check in fonts
     bool fontsFound() const { return fFontsFound; }
 
@@ -5107,6 +5109,84 @@ DEF_TEST(SkParagraph_CacheStyles, reporter) {
     test(2, false);
 }
 
+DEF_TEST(SkParagraph_CacheShared, reporter) {
+    sk_sp<ResourceFontCollection> fontCollection1 = sk_make_sp<ResourceFontCollection>();
+    if (!fontCollection1->fontsFound()) return;
+    // Shares collection1's fonts
+    auto fontCollection2 = sk_make_sp<FontCollection>();
+    fontCollection2->setAssetFontManager(fontCollection1->fontProvider());
+    fontCollection2->disableFontFallback();
+    // Has typefaces of its own, made from the same files
+    sk_sp<ResourceFontCollection> fontCollection3 = sk_make_sp<ResourceFontCollection>();
+    sk_sp<ResourceFontCollection> uncached = sk_make_sp<ResourceFontCollection>();
+    uncached->getParagraphCache()->turnOn(false);
+
+    ParagraphCache::Options options;
+    options.fShardCount = 4;
+    auto cache = sk_make_sp<ParagraphCache>(options);
+    fontCollection1->setParagraphCache(cache);
+    fontCollection2->setParagraphCache(cache);
+    fontCollection3->setParagraphCache(cache);
+
+    ParagraphStyle paragraph_style;
+    paragraph_style.turnHintingOff();
+
+    TextStyle text_style;
+    text_style.setFontFamilies({SkString("Roboto")});
+    text_style.setColor(SK_ColorBLACK);
+
+    auto layout = [&](sk_sp<FontCollection> fontCollection, const char* text1,
+                      const char* text2) {
+        ParagraphBuilderImpl builder(paragraph_style, fontCollection);
+        text_style.setFontSize(14);
+        builder.pushStyle(text_style);
+        builder.addText(text1);
+        builder.pop();
+        text_style.setFontSize(20);
+        builder.pushStyle(text_style);
+        builder.addText(text2);
+        builder.pop();
+        auto paragraph = builder.Build();
+        paragraph->layout(TestCanvasWidth);
+        return paragraph->getMaxIntrinsicWidth();
+    };
+
+    auto width = layout(fontCollection1, "Hello ", "world");
+    auto stats = cache->stats();
+    REPORTER_ASSERT(reporter, stats.fHits == 0 && stats.fMisses == 1 && stats.fEntries == 1);
+    REPORTER_ASSERT(reporter, stats.fRunHits == 0 && stats.fRunMisses >= 2);
+    REPORTER_ASSERT(reporter, stats.fRunEntries == stats.fRunMisses && stats.fBytes > 0);
+    const auto runMisses = stats.fRunMisses;
+
+    // Another collection sharing the cache finds the whole paragraph
+    REPORTER_ASSERT(reporter, layout(fontCollection2, "Hello ", "world") == width);
+    stats = cache->stats();
+    REPORTER_ASSERT(reporter, stats.fHits == 1 && stats.fMisses == 1);
+    REPORTER_ASSERT(reporter, stats.fRunHits == 0 && stats.fRunMisses == runMisses);
+
+    // Editing one span only shapes that span again
+    width = layout(fontCollection2, "Hello ", "world!");
+    REPORTER_ASSERT(reporter, width == layout(uncached, "Hello ", "world!"));
+    stats = cache->stats();
+    REPORTER_ASSERT(reporter, stats.fMisses == 2 && stats.fEntries == 2);
+    REPORTER_ASSERT(reporter, stats.fRunHits >= 1 && stats.fRunMisses > runMisses);
+
+    // A collection with other typefaces does not find paragraphs shaped with collection1's
+    REPORTER_ASSERT(reporter, layout(fontCollection3, "Hello ", "world") ==
+                              layout(uncached, "Hello ", "world"));
+    stats = cache->stats();
+    REPORTER_ASSERT(reporter, stats.fHits == 1 && stats.fMisses == 3 && stats.fEntries == 3);
+
+    cache->reset();
+    stats = cache->stats();
+    REPORTER_ASSERT(reporter, stats.fHits == 0 && stats.fMisses == 0 && stats.fRunHits == 0);
+    REPORTER_ASSERT(reporter, stats.fEntries == 0 && stats.fRunEntries == 0 && stats.fBytes == 0);
+
+    fontCollection1->setParagraphCache(nullptr);
+    REPORTER_ASSERT(reporter, fontCollection1->getParagraphCache() != cache.get());
+    REPORTER_ASSERT(reporter, fontCollection2->getParagraphCache() == cache.get());
+}
+
 DEF_TEST(SkParagraph_EmptyParagraphWithLineBreak, reporter) {
     sk_sp<ResourceFontCollection> fontCollection = sk_make_sp<ResourceFontCollection>();
     if (!fontCollection->fontsFound()) return;
@@ -40,7 +40,8 @@ void RenderNode::setVisible(bool v) {
 
 void RenderNode::render(SkCanvas* canvas, const RenderContext* ctx) const {
     SkASSERT(!this->hasInval());
-    if (this->isVisible() && !this->bounds().isEmpty()) {
+    // Skip content entirely outside the clip, e.g. when only damaged areas are redrawn.
+    if (this->isVisible() && !this->bounds().isEmpty() && !canvas->quickReject(this->bounds())) {
         this->onRender(canvas, ctx);
     }
     SkASSERT(!this->hasInval());
@@ -8,6 +8,7 @@
 #include "src/codec/SkJpegCodec.h"
 
 #include "include/codec/SkCodec.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkTypes.h"
 #include "include/private/SkColorData.h"
@@ -16,6 +17,7 @@
 #include "src/codec/SkCodecPriv.h"
 #include "src/codec/SkJpegDecoderMgr.h"
 #include "src/codec/SkParseEncodedOrigin.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/pdf/SkJpegInfo.h"
 
 // stdio is needed for libjpeg-turbo
@@ -502,6 +504,85 @@ int SkJpegCodec::readRows(const SkImageInfo& dstInfo, void* dst, size_t rowBytes
     return count;
 }
 
+int SkJpegCodec::readRowsInParallel(const SkImageInfo& dstInfo, void* dst, size_t rowBytes,
+                                    SkExecutor* executor) {
+    SkASSERT(fSwizzler || this->colorXform());
+
+    // libjpeg-turbo decodes bands of rows on this thread, while the previous band is
+    // swizzled and color transformed on the executor, one task per row. Rows are decoded
+    // into the same kind of buffers readRows() uses, just one per row, and two bands of them.
+    constexpr int kBandRows = 32;
+
+    const int dstWidth = fSwizzler ? fSwizzler->swizzleWidth() : dstInfo.width();
+    size_t decodeRowBytes = 0;
+    size_t xformRowBytes = 0;
+    if (fSwizzleSrcRow) {
+        decodeRowBytes = get_row_bytes(fDecoderMgr->dinfo());
+        if (fColorXformSrcRow) {
+            xformRowBytes = dstWidth * sizeof(uint32_t);
+        }
+    } else if (fColorXformSrcRow) {
+        decodeRowBytes = dstWidth * sizeof(uint32_t);
+    }
+    // Without a separate decode buffer we decode straight into dst and convert in place.
+    const size_t bandBytes = kBandRows * (decodeRowBytes + xformRowBytes);
+    SkAutoTMalloc<uint8_t> bands(2 * bandBytes);
+
+    SkTaskGroup taskGroup(*executor);
+    volatile int rowsDecoded = 0;
+
+    // Set the jump location for libjpeg-turbo errors. Tasks already added may still be using
+    // the band buffers, so wait for them before returning.
+    skjpeg_error_mgr::AutoPushJmpBuf jmp(fDecoderMgr->errorMgr());
+    if (setjmp(jmp)) {
+        taskGroup.wait();
+        return rowsDecoded;
+    }
+
+    const int height = dstInfo.height();
+    for (int band = 0; rowsDecoded < height; band++) {
+        const int y = rowsDecoded;
+        const int rows = std::min(kBandRows, height - y);
+        void* dstRow = SkTAddOffset<void>(dst, y * rowBytes);
+
+        uint8_t* decodeBase = decodeRowBytes ? bands.get() + (band % 2) * bandBytes
+                                             : (uint8_t*) dstRow;
+        const size_t decodeStride = decodeRowBytes ? decodeRowBytes : rowBytes;
+        uint8_t* xformBase = decodeBase + kBandRows * decodeRowBytes;
+
+        int decoded = 0;
+        for (; decoded < rows; decoded++) {
+            JSAMPLE* decodeDst = decodeBase + decoded * decodeStride;
+            if (0 == jpeg_read_scanlines(fDecoderMgr->dinfo(), &decodeDst, 1)) {
+                break;
+            }
+        }
+
+        // The previous band is done with the buffers this band will reuse next time around.
+        taskGroup.wait();
+        taskGroup.batch(decoded, [=](int i) {
+            const uint8_t* src = decodeBase + i * decodeStride;
+            void* rowDst = SkTAddOffset<void>(dstRow, i * rowBytes);
+            if (fSwizzler && this->colorXform()) {
+                void* xformSrc = xformRowBytes ? xformBase + i * xformRowBytes : rowDst;
+                fSwizzler->swizzle(xformSrc, src);
+                this->applyColorXform(rowDst, xformSrc, dstWidth);
+            } else if (fSwizzler) {
+                fSwizzler->swizzle(rowDst, src);
+            } else {
+                this->applyColorXform(rowDst, src, dstWidth);
+            }
+        });
+        rowsDecoded = y + decoded;
+        if (decoded < rows) {
+            break;
+        }
+    }
+
+    taskGroup.wait();
+    return rowsDecoded;
+}
+
 /*
  * This is a bit tricky.  We only need the swizzler to do format conversion if the jpeg is
  * encoded as CMYK.
@@ -557,7 +638,13 @@ SkCodec::Result SkJpegCodec::onGetPixels(const SkImageInfo& dstInfo,
         return kInternalError;
     }
 
-    int rows = this->readRows(dstInfo, dst, dstRowBytes, dstInfo.height(), options);
+    // Already on the executor (e.g. decoding for a tile of a picture): waiting for it here could
+    // deadlock, so convert the rows inline.
+    const bool parallel = options.fExecutor && (fSwizzler || this->colorXform()) &&
+                          !SkTaskGroup::IsRunningOn(*options.fExecutor);
+    int rows = parallel
+            ? this->readRowsInParallel(dstInfo, dst, dstRowBytes, options.fExecutor)
+            : this->readRows(dstInfo, dst, dstRowBytes, dstInfo.height(), options);
     if (rows < dstInfo.height()) {
         *rowsDecoded = rows;
         return fDecoderMgr->returnFailure("Incomplete image data", kIncompleteInput);
@@ -108,6 +108,7 @@ private:
                             bool needsCMYKToRGB);
     bool SK_WARN_UNUSED_RESULT allocateStorage(const SkImageInfo& dstInfo);
     int readRows(const SkImageInfo& dstInfo, void* dst, size_t rowBytes, int count, const Options&);
+    int readRowsInParallel(const SkImageInfo& dstInfo, void* dst, size_t rowBytes, SkExecutor*);
 
     /*
      * Scanline decoding.
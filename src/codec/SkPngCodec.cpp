@@ -7,6 +7,7 @@
 
 #include "include/core/SkBitmap.h"
 #include "include/core/SkColorSpace.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkMath.h"
 #include "include/core/SkPoint3.h"
 #include "include/core/SkSize.h"
@@ -20,6 +21,7 @@
 #include "src/codec/SkPngPriv.h"
 #include "src/codec/SkSwizzler.h"
 #include "src/core/SkOpts.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/core/SkUtils.h"
 
 #include "png.h"
@@ -430,6 +432,7 @@ std::unique_ptr<SkEncodedInfo::ICCProfile> read_color_profile(png_structp png_pt
 }
 
 void SkPngCodec::allocateStorage(const SkImageInfo& dstInfo) {
+    fColorXformSrcRowBytes = 0;
     switch (fXformMode) {
         case kSwizzleOnly_XformMode:
             break;
@@ -446,6 +449,7 @@ void SkPngCodec::allocateStorage(const SkImageInfo& dstInfo) {
             const size_t colorXformBytes = dstInfo.width() * bytesPerPixel;
             fStorage.reset(colorXformBytes);
             fColorXformSrcRow = fStorage.get();
+            fColorXformSrcRowBytes = colorXformBytes;
             break;
         }
     }
@@ -467,6 +471,10 @@ static skcms_PixelFormat png_select_xform_format(const SkEncodedInfo& info) {
 }
 
 void SkPngCodec::applyXformRow(void* dst, const void* src) {
+    this->applyXformRow(dst, src, fColorXformSrcRow);
+}
+
+void SkPngCodec::applyXformRow(void* dst, const void* src, void* colorXformSrcRow) const {
     switch (fXformMode) {
         case kSwizzleOnly_XformMode:
             fSwizzler->swizzle(dst, (const uint8_t*) src);
@@ -475,8 +483,8 @@ void SkPngCodec::applyXformRow(void* dst, const void* src) {
             this->applyColorXform(dst, src, fXformWidth);
             break;
         case kSwizzleColor_XformMode:
-            fSwizzler->swizzle(fColorXformSrcRow, (const uint8_t*) src);
-            this->applyColorXform(dst, fColorXformSrcRow, fXformWidth);
+            fSwizzler->swizzle(colorXformSrcRow, (const uint8_t*) src);
+            this->applyColorXform(dst, colorXformSrcRow, fXformWidth);
             break;
     }
 }
@@ -499,12 +507,18 @@ public:
         , fRowBytes(0)
         , fFirstRow(0)
         , fLastRow(0)
+        , fTaskGroup(nullptr)
     {}
 
     static void AllRowsCallback(png_structp png_ptr, png_bytep row, png_uint_32 rowNum, int /*pass*/) {
         GetDecoder(png_ptr)->allRowsCallback(row, rowNum);
     }
 
+    static void ParallelRowsCallback(png_structp png_ptr, png_bytep row, png_uint_32 rowNum,
+                                     int /*pass*/) {
+        GetDecoder(png_ptr)->parallelRowsCallback(row, rowNum);
+    }
+
     static void RowCallback(png_structp png_ptr, png_bytep row, png_uint_32 rowNum, int /*pass*/) {
         GetDecoder(png_ptr)->rowCallback(row, rowNum);
     }
@@ -519,6 +533,17 @@ private:
     int                         fLastRow;
     int                         fRowsNeeded;
 
+    // Variables for decoding all rows with an executor. libpng inflates and unfilters rows
+    // into bands on this thread, while the previous band is swizzled and color transformed
+    // on the executor, one task per row.
+    static constexpr int        kBandRows = 32;
+    SkTaskGroup*                fTaskGroup;
+    SkAutoTMalloc<uint8_t>      fBands;
+    size_t                      fBandRowBytes;      // libpng's row, then color xform scratch
+    size_t                      fSrcRowBytes;
+    int                         fBandIndex;
+    int                         fBandRowCount;
+
     using INHERITED = SkPngCodec;
 
     static SkPngNormalDecoder* GetDecoder(png_structp png_ptr) {
@@ -527,7 +552,6 @@ private:
 
     Result decodeAllRows(void* dst, size_t rowBytes, int* rowsDecoded) override {
         const int height = this->dimensions().height();
-        png_set_progressive_read_fn(this->png_ptr(), this, nullptr, AllRowsCallback, nullptr);
         fDst = dst;
         fRowBytes = rowBytes;
 
@@ -535,7 +559,31 @@ private:
         fFirstRow = 0;
         fLastRow = height - 1;
 
-        const bool success = this->processData();
+        bool success;
+        // Already on the executor (e.g. decoding for a tile of a picture): waiting for it here
+        // could deadlock, so convert the rows inline.
+        SkExecutor* executor = this->options().fExecutor;
+        if (executor && !SkTaskGroup::IsRunningOn(*executor)) {
+            SkTaskGroup taskGroup(*executor);
+            fTaskGroup = &taskGroup;
+            fSrcRowBytes = png_get_rowbytes(this->png_ptr(), this->info_ptr());
+            fBandRowBytes = fSrcRowBytes + fColorXformSrcRowBytes;
+            fBands.reset(2 * kBandRows * fBandRowBytes);
+            fBandIndex = 0;
+            fBandRowCount = 0;
+            png_set_progressive_read_fn(this->png_ptr(), this, nullptr, ParallelRowsCallback,
+                                        nullptr);
+
+            success = this->processData();
+            // Convert whatever rows made it into the last band, even after an error.
+            this->flushBand();
+            taskGroup.wait();
+            fTaskGroup = nullptr;
+        } else {
+            png_set_progressive_read_fn(this->png_ptr(), this, nullptr, AllRowsCallback, nullptr);
+            success = this->processData();
+        }
+
         if (success && fRowsWrittenToOutput == height) {
             return kSuccess;
         }
@@ -554,6 +602,33 @@ private:
         fDst = SkTAddOffset<void>(fDst, fRowBytes);
     }
 
+    void parallelRowsCallback(png_bytep row, int rowNum) {
+        SkASSERT(rowNum == fRowsWrittenToOutput);
+        uint8_t* band = fBands.get() + (fBandIndex % 2) * kBandRows * fBandRowBytes;
+        memcpy(band + fBandRowCount * fBandRowBytes, row, fSrcRowBytes);
+        fRowsWrittenToOutput++;
+        if (++fBandRowCount == kBandRows) {
+            this->flushBand();
+        }
+    }
+
+    void flushBand() {
+        // The previous band is done with the buffer the next band will reuse.
+        fTaskGroup->wait();
+        uint8_t* band = fBands.get() + (fBandIndex % 2) * kBandRows * fBandRowBytes;
+        void* dst = fDst;
+        const size_t rowBytes = fRowBytes,
+                     bandRowBytes = fBandRowBytes,
+                     srcRowBytes = fSrcRowBytes;
+        fTaskGroup->batch(fBandRowCount, [=](int i) {
+            uint8_t* src = band + i * bandRowBytes;
+            this->applyXformRow(SkTAddOffset<void>(dst, i * rowBytes), src, src + srcRowBytes);
+        });
+        fDst = SkTAddOffset<void>(fDst, fBandRowCount * fRowBytes);
+        fBandIndex++;
+        fBandRowCount = 0;
+    }
+
     void setRange(int firstRow, int lastRow, void* dst, size_t rowBytes) override {
         png_set_progressive_read_fn(this->png_ptr(), this, nullptr, RowCallback, nullptr);
         fFirstRow = firstRow;
@@ -683,11 +758,24 @@ private:
 
         const bool success = this->processData();
         png_bytep srcRow = fInterlaceBuffer.get();
-        // FIXME: When resuming, this may rewrite rows that did not change.
-        for (int rowNum = 0; rowNum < fLinesDecoded; rowNum++) {
-            this->applyXformRow(dst, srcRow);
-            dst = SkTAddOffset<void>(dst, rowBytes);
-            srcRow = SkTAddOffset<png_byte>(srcRow, fPng_rowbytes);
+        // As in SkPngNormalDecoder, convert inline when already on the executor.
+        SkExecutor* executor = this->options().fExecutor;
+        if (executor && !SkTaskGroup::IsRunningOn(*executor)) {
+            // Every pass is in, so the rows can all be converted at once.
+            SkAutoTMalloc<uint8_t> scratch(fLinesDecoded * fColorXformSrcRowBytes);
+            const size_t scratchRowBytes = fColorXformSrcRowBytes;
+            SkTaskGroup(*executor).batch(fLinesDecoded, [&](int rowNum) {
+                this->applyXformRow(SkTAddOffset<void>(dst, rowNum * rowBytes),
+                                    srcRow + rowNum * fPng_rowbytes,
+                                    scratch.get() + rowNum * scratchRowBytes);
+            });
+        } else {
+            // FIXME: When resuming, this may rewrite rows that did not change.
+            for (int rowNum = 0; rowNum < fLinesDecoded; rowNum++) {
+                this->applyXformRow(dst, srcRow);
+                dst = SkTAddOffset<void>(dst, rowBytes);
+                srcRow = SkTAddOffset<png_byte>(srcRow, fPng_rowbytes);
+            }
         }
         if (success && fInterlacedComplete) {
             return kSuccess;
@@ -975,6 +1063,7 @@ SkPngCodec::SkPngCodec(SkEncodedInfo&& encodedInfo, std::unique_ptr<SkStream> st
     , fPng_ptr(png_ptr)
     , fInfo_ptr(info_ptr)
     , fColorXformSrcRow(nullptr)
+    , fColorXformSrcRowBytes(0)
     , fBitDepth(bitDepth)
     , fIdatLength(0)
     , fDecodedIdat(false)
@@ -54,6 +54,9 @@ protected:
 
     SkSampler* getSampler(bool createIfNecessary) override;
     void applyXformRow(void* dst, const void* src);
+    // As above, but thread safe: colorXformSrcRow replaces fColorXformSrcRow as scratch space,
+    // and must hold fColorXformSrcRowBytes.
+    void applyXformRow(void* dst, const void* src, void* colorXformSrcRow) const;
 
     voidp png_ptr() { return fPng_ptr; }
     voidp info_ptr() { return fInfo_ptr; }
@@ -84,6 +87,7 @@ protected:
     std::unique_ptr<SkSwizzler> fSwizzler;
     SkAutoTMalloc<uint8_t>      fStorage;
     void*                       fColorXformSrcRow;
+    size_t                      fColorXformSrcRowBytes;
     const int                   fBitDepth;
 
 private:
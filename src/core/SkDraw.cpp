@@ -34,7 +34,9 @@
 #include "src/core/SkRectPriv.h"
 #include "src/core/SkSamplingPriv.h"
 #include "src/core/SkScan.h"
+#include "src/core/SkScanPriv.h"
 #include "src/core/SkStroke.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/core/SkTLazy.h"
 #include "src/core/SkUtils.h"
 
@@ -817,11 +819,67 @@ SkScalar SkDraw::ComputeResScaleForStroking(const SkMatrix& matrix) {
     return 1;
 }
 
+// Antialiased fills of very large paths (map tiles, CAD drawings) can be split into horizontal
+// bands and scan converted in parallel. Each band clips the path's edges to itself when building
+// its edge list, and gets its own blitter. The band height is fixed, so which pixels belong to
+// which band -- and hence the output -- never depends on the number of threads.
+static constexpr int kBandedAAMinPoints  = 4096;
+static constexpr int kBandedAABandHeight = 128;
+
+static bool draw_banded_anti_path(const SkDraw& draw, const SkPath& devPath,
+                                  const SkPaint& paint, bool drawCoverage) {
+    SkExecutor* executor = SkGraphicsExecutor();
+    if (!executor || devPath.countPoints() < kBandedAAMinPoints || !draw.fRC->isBW() ||
+        !devPath.isFinite()) {
+        return false;
+    }
+
+    const SkRegion& clip = draw.fRC->bwRgn();
+    SkIRect bounds = clip.getBounds();
+    if (!devPath.isInverseFillType() && !bounds.intersect(devPath.getBounds().roundOut())) {
+        return false;
+    }
+    // Leave anything the supersampler can't handle in one piece to AntiFillPath's own fallbacks.
+    constexpr int32_t kMaxAACoord = 32767 >> SK_SUPERSAMPLE_SHIFT;
+    if (bounds.fLeft < -kMaxAACoord || bounds.fTop    < -kMaxAACoord ||
+        bounds.fRight > kMaxAACoord || bounds.fBottom >  kMaxAACoord) {
+        return false;
+    }
+
+    const int bands = (bounds.height() + kBandedAABandHeight - 1) / kBandedAABandHeight;
+    if (bands < 2) {
+        return false;
+    }
+
+    // Resolve the path's lazily computed state before sharing it between threads.
+    (void)devPath.getBounds();
+    (void)devPath.isConvex();
+
+    auto fillBand = [&](int i) {
+        int top = bounds.fTop + i * kBandedAABandHeight;
+        SkIRect band = SkIRect::MakeLTRB(bounds.fLeft, top,
+                                         bounds.fRight,
+                                         std::min(top + kBandedAABandHeight, bounds.fBottom));
+        SkRegion bandClip;
+        if (!bandClip.op(clip, band, SkRegion::kIntersect_Op)) {
+            return;
+        }
+        SkAutoBlitterChoose blitter(draw, nullptr, paint, drawCoverage);
+        SkScan::AntiFillPath(devPath, SkRasterClip(bandClip), blitter.get());
+    };
+    SkTaskGroup(*executor).batch(bands, fillBand);
+    return true;
+}
+
 void SkDraw::drawDevPath(const SkPath& devPath, const SkPaint& paint, bool drawCoverage,
                          SkBlitter* customBlitter, bool doFill) const {
     if (SkPathPriv::TooBigForMath(devPath)) {
         return;
     }
+    if (!customBlitter && doFill && paint.isAntiAlias() && !paint.getMaskFilter() &&
+        draw_banded_anti_path(*this, devPath, paint, drawCoverage)) {
+        return;
+    }
     SkBlitter* blitter = nullptr;
     SkAutoBlitterChoose blitterStorage;
     if (nullptr == customBlitter) {
@@ -19,14 +19,18 @@
 #include "src/core/SkBlitter.h"
 #include "src/core/SkCpu.h"
 #include "src/core/SkGeometry.h"
+#include "src/core/SkImageFilterCache.h"
 #include "src/core/SkImageFilter_Base.h"
 #include "src/core/SkOpts.h"
+#include "src/core/SkPersistentStrike.h"
 #include "src/core/SkResourceCache.h"
 #include "src/core/SkScalerContext.h"
 #include "src/core/SkStrikeCache.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/core/SkTSearch.h"
 #include "src/core/SkTypefaceCache.h"
 
+#include <atomic>
 #include <stdlib.h>
 
 void SkGraphics::Init() {
@@ -40,6 +44,7 @@ void SkGraphics::Init() {
 void SkGraphics::DumpMemoryStatistics(SkTraceMemoryDump* dump) {
   SkResourceCache::DumpMemoryStatistics(dump);
   SkStrikeCache::DumpMemoryStatistics(dump);
+  SkImageFilterCache::Get()->dumpMemoryStatistics(dump, "skia/sk_image_filter_cache");
 }
 
 void SkGraphics::PurgeAllCaches() {
@@ -130,3 +135,23 @@ extern bool gSkVMAllowJIT;
 void SkGraphics::AllowJIT() {
     gSkVMAllowJIT = true;
 }
+
+extern std::atomic<SkGraphics::ProgramCache*> gSkVMProgramCache;
+extern std::atomic<bool>                      gSkVMProgramCacheJIT;
+
+void SkGraphics::SetProgramCache(ProgramCache* cache, bool cacheJITCode) {
+    gSkVMProgramCacheJIT.store(cacheJITCode);
+    gSkVMProgramCache.store(cache);
+}
+
+void SkGraphics::SetExecutor(SkExecutor* executor) {
+    gSkGraphicsExecutor.store(executor);
+}
+
+void SkGraphics::SetGlyphCache(GlyphCache* cache) {
+    gSkGlyphCache.store(cache);
+}
+
+void SkGraphics::FlushGlyphCache() {
+    SkStrikeCache::GlobalStrikeCache()->flushGlyphCache();
+}
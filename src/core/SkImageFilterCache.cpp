@@ -11,6 +11,7 @@
 
 #include "include/core/SkImageFilter.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkTraceMemoryDump.h"
 #include "include/private/SkMutex.h"
 #include "include/private/SkOnce.h"
 #include "include/private/SkTHash.h"
@@ -30,18 +31,28 @@ namespace {
 class CacheImpl : public SkImageFilterCache {
 public:
     typedef SkImageFilterCacheKey Key;
-    CacheImpl(size_t maxBytes) : fMaxBytes(maxBytes), fCurrentBytes(0) { }
+    CacheImpl(size_t rasterMaxBytes, size_t gpuMaxBytes)
+        : fMaxBytes{rasterMaxBytes, gpuMaxBytes}, fCurrentBytes{0, 0} { }
     ~CacheImpl() override {
         fLookup.foreach([&](Value* v) { delete v; });
     }
+
+    enum Backend { kRaster_Backend, kGpu_Backend, kLast_Backend = kGpu_Backend };
+    static constexpr int kBackendCount = kLast_Backend + 1;
+
     struct Value {
         Value(const Key& key, const skif::FilterResult<For::kOutput>& image,
               const SkImageFilter* filter)
-            : fKey(key), fImage(image), fFilter(filter) {}
+            : fKey(key), fImage(image), fFilter(filter)
+            , fBackend(image.image() && image.image()->isTextureBacked() ? kGpu_Backend
+                                                                         : kRaster_Backend)
+            , fBytes(image.image() ? image.image()->getSize() : 0) {}
 
         Key fKey;
         skif::FilterResult<For::kOutput> fImage;
         const SkImageFilter* fFilter;
+        Backend fBackend;
+        size_t fBytes;
         static const Key& GetKey(const Value& v) {
             return v.fKey;
         }
@@ -56,14 +67,12 @@ public:
 
         SkAutoMutexExclusive mutex(fMutex);
         if (Value* v = fLookup.find(key)) {
-            if (v != fLRU.head()) {
-                fLRU.remove(v);
-                fLRU.addToHead(v);
-            }
-
+            this->touch(v);
             *result = v->fImage;
+            fStats.fHits++;
             return true;
         }
+        fStats.fMisses++;
         return false;
     }
 
@@ -75,30 +84,31 @@ public:
         }
         Value* v = new Value(key, result, filter);
         fLookup.add(v);
-        fLRU.addToHead(v);
-        fCurrentBytes += result.image() ? result.image()->getSize() : 0;
+        fLRU[v->fBackend].addToHead(v);
+        fCurrentBytes[v->fBackend] += v->fBytes;
         if (auto* values = fImageFilterValues.find(filter)) {
             values->push_back(v);
         } else {
             fImageFilterValues.set(filter, {v});
         }
 
-        while (fCurrentBytes > fMaxBytes) {
-            Value* tail = fLRU.tail();
+        while (fCurrentBytes[v->fBackend] > fMaxBytes[v->fBackend]) {
+            Value* tail = fLRU[v->fBackend].tail();
             SkASSERT(tail);
             if (tail == v) {
                 break;
             }
             this->removeInternal(tail);
+            fStats.fEvictions++;
         }
     }
 
     void purge() override {
         SkAutoMutexExclusive mutex(fMutex);
-        while (fCurrentBytes > 0) {
-            Value* tail = fLRU.tail();
-            SkASSERT(tail);
-            this->removeInternal(tail);
+        for (auto& lru : fLRU) {
+            while (Value* tail = lru.tail()) {
+                this->removeInternal(tail);
+            }
         }
     }
 
@@ -118,41 +128,81 @@ public:
     }
 
     SkDEBUGCODE(int count() const override { return fLookup.count(); })
+
+    Stats stats() const override {
+        SkAutoMutexExclusive mutex(fMutex);
+        Stats stats = fStats;
+        stats.fCount       = fLookup.count();
+        stats.fRasterBytes = fCurrentBytes[kRaster_Backend];
+        stats.fGpuBytes    = fCurrentBytes[kGpu_Backend];
+        return stats;
+    }
+
+    void dumpMemoryStatistics(SkTraceMemoryDump* dump, const char* dumpName) const override {
+        Stats stats = this->stats();
+        dump->dumpNumericValue(dumpName, "size", "bytes", stats.fRasterBytes + stats.fGpuBytes);
+        dump->dumpNumericValue(dumpName, "raster_size", "bytes", stats.fRasterBytes);
+        dump->dumpNumericValue(dumpName, "gpu_size", "bytes", stats.fGpuBytes);
+        dump->dumpNumericValue(dumpName, "raster_budget_size", "bytes",
+                               fMaxBytes[kRaster_Backend]);
+        dump->dumpNumericValue(dumpName, "gpu_budget_size", "bytes", fMaxBytes[kGpu_Backend]);
+        dump->dumpNumericValue(dumpName, "result_count", "objects", stats.fCount);
+        dump->dumpNumericValue(dumpName, "hit_count", "objects", stats.fHits);
+        dump->dumpNumericValue(dumpName, "miss_count", "objects", stats.fMisses);
+        dump->dumpNumericValue(dumpName, "eviction_count", "objects", stats.fEvictions);
+    }
+
 private:
+    void touch(Value* v) const {
+        if (v != fLRU[v->fBackend].head()) {
+            fLRU[v->fBackend].remove(v);
+            fLRU[v->fBackend].addToHead(v);
+        }
+    }
+
+    static void RemoveFromList(std::vector<Value*>* values, Value* v) {
+        for (auto it = values->begin(); it != values->end(); ++it) {
+            if (*it == v) {
+                values->erase(it);
+                break;
+            }
+        }
+    }
+
     void removeInternal(Value* v) {
         if (v->fFilter) {
             if (auto* values = fImageFilterValues.find(v->fFilter)) {
                 if (values->size() == 1 && (*values)[0] == v) {
                     fImageFilterValues.remove(v->fFilter);
                 } else {
-                    for (auto it = values->begin(); it != values->end(); ++it) {
-                        if (*it == v) {
-                            values->erase(it);
-                            break;
-                        }
-                    }
+                    RemoveFromList(values, v);
                 }
             }
         }
-        fCurrentBytes -= v->fImage.image() ? v->fImage.image()->getSize() : 0;
-        fLRU.remove(v);
+        fCurrentBytes[v->fBackend] -= v->fBytes;
+        fLRU[v->fBackend].remove(v);
         fLookup.remove(v->fKey);
         delete v;
     }
 private:
     SkTDynamicHash<Value, Key>                            fLookup;
-    mutable SkTInternalLList<Value>                       fLRU;
+    mutable SkTInternalLList<Value>                       fLRU[kBackendCount];
     // Value* always points to an item in fLookup.
     SkTHashMap<const SkImageFilter*, std::vector<Value*>> fImageFilterValues;
-    size_t                                                fMaxBytes;
-    size_t                                                fCurrentBytes;
+    size_t                                                fMaxBytes[kBackendCount];
+    size_t                                                fCurrentBytes[kBackendCount];
+    mutable Stats                                         fStats;
     mutable SkMutex                                       fMutex;
 };
 
 } // namespace
 
 SkImageFilterCache* SkImageFilterCache::Create(size_t maxBytes) {
-    return new CacheImpl(maxBytes);
+    return new CacheImpl(maxBytes, maxBytes);
+}
+
+SkImageFilterCache* SkImageFilterCache::Create(size_t rasterMaxBytes, size_t gpuMaxBytes) {
+    return new CacheImpl(rasterMaxBytes, gpuMaxBytes);
 }
 
 SkImageFilterCache* SkImageFilterCache::Get() {
@@ -14,6 +14,7 @@
 
 struct SkIPoint;
 class SkImageFilter;
+class SkTraceMemoryDump;
 
 struct SkImageFilterCacheKey {
     SkImageFilterCacheKey(const uint32_t uniqueID, const SkMatrix& matrix,
@@ -49,6 +50,9 @@ struct SkImageFilterCacheKey {
 // This cache maps from (filter's unique ID + CTM + clipBounds + src bitmap generation ID) to result
 // NOTE: this is the _specific_ unique ID of the image filter, so refiltering the same image with a
 // copy of the image filter (with exactly the same parameters) will not yield a cache hit.
+//
+// Raster and GPU-backed results are budgeted separately, so neither backend can evict the other's
+// results.
 class SkImageFilterCache : public SkRefCnt {
 public:
     SK_USE_FLUENT_IMAGE_FILTER_TYPES_IN_CLASS
@@ -56,11 +60,20 @@ public:
     enum { kDefaultTransientSize = 32 * 1024 * 1024 };
 
     ~SkImageFilterCache() override {}
+    // Gives both raster and GPU-backed results a budget of maxBytes.
     static SkImageFilterCache* Create(size_t maxBytes);
+    static SkImageFilterCache* Create(size_t rasterMaxBytes, size_t gpuMaxBytes);
     static SkImageFilterCache* Get();
 
     // Returns true on cache hit and updates 'result' to be the cached result. Returns false when
     // not in the cache, in which case 'result' is not modified.
+    //
+    // Only an exact key match is a hit. Filter output depends on the clip bounds (crop rects,
+    // lighting borders and blur tile modes all apply at the clipped edge), and filters that read
+    // the source see it pinned at the layer origin, so a result cached for larger or translated
+    // clip bounds is not reused. Reusing part of a result would need each filter to report that
+    // its output is independent of the clip and to filter only the area left uncovered; the cache
+    // does not attempt it.
     virtual bool get(const SkImageFilterCacheKey& key,
                      skif::FilterResult<For::kOutput>* result) const = 0;
     // 'filter' is included in the caching to allow the purging of all of an image filter's cached
@@ -70,6 +83,19 @@ public:
     virtual void purge() = 0;
     virtual void purgeByImageFilter(const SkImageFilter*) = 0;
     SkDEBUGCODE(virtual int count() const = 0;)
+
+    struct Stats {
+        uint64_t fHits        = 0;  // get() found the exact key.
+        uint64_t fMisses      = 0;
+        uint64_t fEvictions   = 0;  // Results dropped to stay within a budget.
+        int      fCount       = 0;
+        size_t   fRasterBytes = 0;
+        size_t   fGpuBytes    = 0;
+    };
+    virtual Stats stats() const = 0;
+
+    // Reports the budgets, the bytes used and the Stats under dumpName.
+    virtual void dumpMemoryStatistics(SkTraceMemoryDump*, const char* dumpName) const = 0;
 };
 
 #endif
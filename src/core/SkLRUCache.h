@@ -80,6 +80,12 @@ public:
         return fMap.count();
     }
 
+    // Removes the least recently used entry. The cache must not be empty.
+    void removeLRU() {
+        SkASSERT(fLRU.tail());
+        this->remove(fLRU.tail()->fKey);
+    }
+
     template <typename Fn>  // f(K*, V*)
     void foreach(Fn&& fn) {
         typename SkTInternalLList<Entry>::Iter iter;
@@ -15,13 +15,20 @@
 #include "include/private/SkTo.h"
 #include "src/core/SkArenaAlloc.h"
 #include "src/core/SkGaussFilter.h"
+#include "src/core/SkTaskGroup.h"
 
+#include <algorithm>
 #include <cmath>
 #include <climits>
 
 namespace {
 static const double kPi = 3.14159265358979323846264338327950288;
 
+// The large sigma blur runs this many rows through the three box filters at once, one per lane.
+static constexpr int kLanes = 4;
+using U8s  = SkNx<kLanes, uint8_t>;
+using U32s = SkNx<kLanes, uint32_t>;
+
 class PlanGauss final {
 public:
     explicit PlanGauss(double sigma) {
@@ -83,7 +90,9 @@ public:
         auto window3 = window2 * window;
         auto divisor = (window & 1) == 1 ? window3 : window3 + window2;
 
-        fWeight = static_cast<uint64_t>(round(1.0 / divisor * (1ull << 32)));
+        // The weight of a window of one would be 2^32, but Scan never scales that case.
+        fWeight = static_cast<uint32_t>(
+                std::min(round(1.0 / divisor * (1ull << 32)), (double)UINT32_MAX));
     }
 
     size_t bufferSize() const { return fPass0Size + fPass1Size + fPass2Size; }
@@ -91,12 +100,15 @@ public:
     int    border()     const { return fBorder; }
 
 public:
+    // Blurs kLanes rows at once, one per SIMD lane. The source rows are interleaved, so pixel i
+    // of lane k is src[i * kLanes + k]. Output pixel i of every lane is stored as consecutive
+    // bytes at dst + i * dstStride, which transposes the result as it is written.
     class Scan {
     public:
-        Scan(uint64_t weight, int noChangeCount,
-             uint32_t* buffer0, uint32_t* buffer0End,
-             uint32_t* buffer1, uint32_t* buffer1End,
-             uint32_t* buffer2, uint32_t* buffer2End)
+        Scan(uint32_t weight, int noChangeCount,
+             U32s* buffer0, U32s* buffer0End,
+             U32s* buffer1, U32s* buffer1End,
+             U32s* buffer2, U32s* buffer2End)
             : fWeight{weight}
             , fNoChangeCount{noChangeCount}
             , fBuffer0{buffer0}
@@ -107,113 +119,114 @@ public:
             , fBuffer2End{buffer2End}
         { }
 
-        template <typename AlphaIter> void blur(const AlphaIter srcBegin, const AlphaIter srcEnd,
-                    uint8_t* dst, int dstStride, uint8_t* dstEnd) const {
-            auto buffer0Cursor = fBuffer0;
-            auto buffer1Cursor = fBuffer1;
-            auto buffer2Cursor = fBuffer2;
+        // Only the first `lanes` bytes of each output pixel are written.
+        void blur(const uint8_t* src, int srcCount,
+                  uint8_t* dst, size_t dstStride, int dstCount, int lanes) const {
+            // A window of one leaves the pixels alone, and has no trailing edges to buffer.
+            if (fBuffer0 == fBuffer2End) {
+                for (int i = 0; i < std::min(srcCount, dstCount); ++i) {
+                    store_lanes(dst + i * dstStride, U8s::Load(src + i * kLanes), lanes);
+                }
+                return;
+            }
 
-            std::memset(fBuffer0, 0x00, (fBuffer2End - fBuffer0) * sizeof(*fBuffer0));
+            std::fill(fBuffer0, fBuffer2End, U32s(0));
 
-            uint32_t sum0 = 0;
-            uint32_t sum1 = 0;
-            uint32_t sum2 = 0;
+            Sums sums{fBuffer0, fBuffer1, fBuffer2};
 
             // Consume the source generating pixels.
-            for (AlphaIter src = srcBegin; src < srcEnd; ++src, dst += dstStride) {
-                uint32_t leadingEdge = *src;
-                sum0 += leadingEdge;
-                sum1 += sum0;
-                sum2 += sum1;
-
-                *dst = this->finalScale(sum2);
-
-                sum2 -= *buffer2Cursor;
-                *buffer2Cursor = sum1;
-                buffer2Cursor = (buffer2Cursor + 1) < fBuffer2End ? buffer2Cursor + 1 : fBuffer2;
-
-                sum1 -= *buffer1Cursor;
-                *buffer1Cursor = sum0;
-                buffer1Cursor = (buffer1Cursor + 1) < fBuffer1End ? buffer1Cursor + 1 : fBuffer1;
-
-                sum0 -= *buffer0Cursor;
-                *buffer0Cursor = leadingEdge;
-                buffer0Cursor = (buffer0Cursor + 1) < fBuffer0End ? buffer0Cursor + 1 : fBuffer0;
+            int dstIdx = 0;
+            for (int srcIdx = 0; srcIdx < srcCount && dstIdx < dstCount; ++srcIdx, ++dstIdx) {
+                store_lanes(dst + dstIdx * dstStride,
+                            this->processValue(&sums, load_lanes(src, srcIdx)), lanes);
             }
 
             // The leading edge is off the right side of the mask.
-            for (int i = 0; i < fNoChangeCount; i++) {
-                uint32_t leadingEdge = 0;
-                sum0 += leadingEdge;
-                sum1 += sum0;
-                sum2 += sum1;
-
-                *dst = this->finalScale(sum2);
-
-                sum2 -= *buffer2Cursor;
-                *buffer2Cursor = sum1;
-                buffer2Cursor = (buffer2Cursor + 1) < fBuffer2End ? buffer2Cursor + 1 : fBuffer2;
-
-                sum1 -= *buffer1Cursor;
-                *buffer1Cursor = sum0;
-                buffer1Cursor = (buffer1Cursor + 1) < fBuffer1End ? buffer1Cursor + 1 : fBuffer1;
-
-                sum0 -= *buffer0Cursor;
-                *buffer0Cursor = leadingEdge;
-                buffer0Cursor = (buffer0Cursor + 1) < fBuffer0End ? buffer0Cursor + 1 : fBuffer0;
-
-                dst += dstStride;
+            for (int i = 0; i < fNoChangeCount && dstIdx < dstCount; ++i, ++dstIdx) {
+                store_lanes(dst + dstIdx * dstStride, this->processValue(&sums, 0), lanes);
             }
 
             // Starting from the right, fill in the rest of the buffer.
-            std::memset(fBuffer0, 0, (fBuffer2End - fBuffer0) * sizeof(*fBuffer0));
-
-            sum0 = sum1 = sum2 = 0;
+            std::fill(fBuffer0, fBuffer2End, U32s(0));
 
-            uint8_t* dstCursor = dstEnd;
-            AlphaIter src = srcEnd;
-            while (dstCursor > dst) {
-                dstCursor -= dstStride;
-                uint32_t leadingEdge = *(--src);
-                sum0 += leadingEdge;
-                sum1 += sum0;
-                sum2 += sum1;
+            sums.sum0 = sums.sum1 = sums.sum2 = 0;
 
-                *dstCursor = this->finalScale(sum2);
+            for (int i = dstCount - 1, srcIdx = srcCount - 1; i >= dstIdx; --i, --srcIdx) {
+                store_lanes(dst + i * dstStride,
+                            this->processValue(&sums, load_lanes(src, srcIdx)), lanes);
+            }
+        }
 
-                sum2 -= *buffer2Cursor;
-                *buffer2Cursor = sum1;
-                buffer2Cursor = (buffer2Cursor + 1) < fBuffer2End ? buffer2Cursor + 1 : fBuffer2;
+    private:
+        // The running sums of the three passes, and where each pass's trailing edge is stored.
+        struct Sums {
+            U32s* buffer0Cursor;
+            U32s* buffer1Cursor;
+            U32s* buffer2Cursor;
+            U32s  sum0 = 0;
+            U32s  sum1 = 0;
+            U32s  sum2 = 0;
+        };
+
+        SK_ALWAYS_INLINE U8s processValue(Sums* s, const U32s& leadingEdge) const {
+            s->sum0 += leadingEdge;
+            s->sum1 += s->sum0;
+            s->sum2 += s->sum1;
+
+            U8s value = this->finalScale(s->sum2);
+
+            s->sum2 -= *s->buffer2Cursor;
+            *s->buffer2Cursor = s->sum1;
+            s->buffer2Cursor = (s->buffer2Cursor + 1) < fBuffer2End ? s->buffer2Cursor + 1
+                                                                    : fBuffer2;
+
+            s->sum1 -= *s->buffer1Cursor;
+            *s->buffer1Cursor = s->sum0;
+            s->buffer1Cursor = (s->buffer1Cursor + 1) < fBuffer1End ? s->buffer1Cursor + 1
+                                                                    : fBuffer1;
+
+            s->sum0 -= *s->buffer0Cursor;
+            *s->buffer0Cursor = leadingEdge;
+            s->buffer0Cursor = (s->buffer0Cursor + 1) < fBuffer0End ? s->buffer0Cursor + 1
+                                                                    : fBuffer0;
+
+            return value;
+        }
 
-                sum1 -= *buffer1Cursor;
-                *buffer1Cursor = sum0;
-                buffer1Cursor = (buffer1Cursor + 1) < fBuffer1End ? buffer1Cursor + 1 : fBuffer1;
+        SK_ALWAYS_INLINE static U32s load_lanes(const uint8_t* src, int i) {
+            return SkNx_cast<uint32_t>(U8s::Load(src + i * kLanes));
+        }
 
-                sum0 -= *buffer0Cursor;
-                *buffer0Cursor = leadingEdge;
-                buffer0Cursor = (buffer0Cursor + 1) < fBuffer0End ? buffer0Cursor + 1 : fBuffer0;
+        SK_ALWAYS_INLINE static void store_lanes(uint8_t* dst, const U8s& v, int lanes) {
+            if (lanes == kLanes) {
+                v.store(dst);
+            } else {
+                uint8_t bytes[kLanes];
+                v.store(bytes);
+                std::memcpy(dst, bytes, lanes);
             }
         }
 
-    private:
-        static constexpr uint64_t kHalf = static_cast<uint64_t>(1) << 31;
-
-        uint8_t finalScale(uint32_t sum) const {
-            return SkTo<uint8_t>((fWeight * sum + kHalf) >> 32);
+        SK_ALWAYS_INLINE U8s finalScale(const U32s& sum) const {
+            // (sum * fWeight + 2^31) >> 32, without 64 bit lanes: adding 2^31 carries into the
+            // high half exactly when the top bit of the low half is set.
+            U32s hi = sum.mulHi(fWeight),
+                 lo = sum * fWeight;
+            return SkNx_cast<uint8_t>(hi + (lo >> 31));
         }
 
-        uint64_t  fWeight;
-        int       fNoChangeCount;
-        uint32_t* fBuffer0;
-        uint32_t* fBuffer0End;
-        uint32_t* fBuffer1;
-        uint32_t* fBuffer1End;
-        uint32_t* fBuffer2;
-        uint32_t* fBuffer2End;
+        uint32_t fWeight;
+        int      fNoChangeCount;
+        U32s*    fBuffer0;
+        U32s*    fBuffer0End;
+        U32s*    fBuffer1;
+        U32s*    fBuffer1End;
+        U32s*    fBuffer2;
+        U32s*    fBuffer2End;
     };
 
-    Scan makeBlurScan(int width, uint32_t* buffer) const {
-        uint32_t* buffer0, *buffer0End, *buffer1, *buffer1End, *buffer2, *buffer2End;
+    Scan makeBlurScan(int width, U32s* buffer) const {
+        U32s* buffer0, *buffer0End, *buffer1, *buffer1End, *buffer2, *buffer2End;
         buffer0 = buffer;
         buffer0End = buffer1 = buffer0 + fPass0Size;
         buffer1End = buffer2 = buffer1 + fPass1Size;
@@ -227,7 +240,8 @@ public:
             buffer2, buffer2End);
     }
 
-    uint64_t fWeight;
+private:
+    uint32_t fWeight;
     int      fBorder;
     int      fSlidingWindow;
     int      fPass0Size;
@@ -952,6 +966,61 @@ static SkIPoint small_blur(double sigmaX, double sigmaY, const SkMask& src, SkMa
     return {radiusX, radiusY};
 }
 
+// Copies `lanes` rows, starting at `row`, into interleaved so that pixel x of row + k is at
+// interleaved[x * kLanes + k]. Missing lanes are zeroed.
+template <typename AlphaIter>
+static void interleave_rows(AlphaIter rowStart, size_t rowBytes, int row, int lanes, int width,
+                            uint8_t* interleaved) {
+    rowStart >>= SkToU32(row * rowBytes);
+    for (int k = 0; k < lanes; ++k, rowStart >>= SkToU32(rowBytes)) {
+        AlphaIter src = rowStart;
+        for (int x = 0; x < width; ++x, ++src) {
+            interleaved[x * kLanes + k] = *src;
+        }
+    }
+    for (int k = lanes; k < kLanes; ++k) {
+        for (int x = 0; x < width; ++x) {
+            interleaved[x * kLanes + k] = 0;
+        }
+    }
+}
+
+// Blurs `rows` rows of srcCount pixels with plan, kLanes rows at a time. Pixel i of row r is
+// written to dst[i * dstStride + r]. When a blur executor is set, large masks are split into
+// tiles of kTileRows rows which are blurred in parallel; each tile has its own buffers and
+// writes its own bytes of dst, and tiling does not change the result.
+template <typename Interleave>
+static void blur_and_transpose(const PlanGauss& plan, int rows, int srcCount,
+                               Interleave&& interleave,
+                               uint8_t* dst, size_t dstStride, int dstCount) {
+    static constexpr int kTileRows = 8 * kLanes;
+    static constexpr int kMinParallelPixels = 256 * 256;
+
+    auto blurTile = [&](int tile) {
+        SkSTArenaAlloc<1024> alloc;
+        U32s* buffer = alloc.makeArrayDefault<U32s>(plan.bufferSize());
+        uint8_t* interleaved = alloc.makeArrayDefault<uint8_t>(srcCount * kLanes);
+        auto scan = plan.makeBlurScan(srcCount, buffer);
+
+        int end = std::min(rows, (tile + 1) * kTileRows);
+        for (int row = tile * kTileRows; row < end; row += kLanes) {
+            int lanes = std::min(kLanes, end - row);
+            interleave(row, lanes, interleaved);
+            scan.blur(interleaved, srcCount, dst + row, dstStride, dstCount, lanes);
+        }
+    };
+
+    int tiles = (rows + kTileRows - 1) / kTileRows;
+    SkExecutor* executor = SkGraphicsExecutor();
+    if (executor && tiles > 1 && (int64_t)rows * dstCount >= kMinParallelPixels) {
+        SkTaskGroup(*executor).batch(tiles, blurTile);
+    } else {
+        for (int tile = 0; tile < tiles; ++tile) {
+            blurTile(tile);
+        }
+    }
+}
+
 // TODO: assuming sigmaW = sigmaH. Allow different sigmas. Right now the
 // API forces the sigmas to be the same.
 SkIPoint SkMaskBlurFilter::blur(const SkMask& src, SkMask* dst) const {
@@ -985,9 +1054,6 @@ SkIPoint SkMaskBlurFilter::blur(const SkMask& src, SkMask* dst) const {
         dstH = dst->fBounds.height();
     SkASSERT(srcW >= 0 && srcH >= 0 && dstW >= 0 && dstH >= 0);
 
-    auto bufferSize = std::max(planW.bufferSize(), planH.bufferSize());
-    auto buffer = alloc.makeArrayDefault<uint32_t>(bufferSize);
-
     // Blur both directions.
     int tmpW = srcH,
         tmpH = dstW;
@@ -999,58 +1065,41 @@ SkIPoint SkMaskBlurFilter::blur(const SkMask& src, SkMask* dst) const {
     auto tmp = alloc.makeArrayDefault<uint8_t>(tmpW * tmpH);
 
     // Blur horizontally, and transpose.
-    const PlanGauss::Scan& scanW = planW.makeBlurScan(srcW, buffer);
+    auto blurRows = [&](auto rowStart) {
+        blur_and_transpose(planW, srcH, srcW,
+                           [&](int row, int lanes, uint8_t* interleaved) {
+                               interleave_rows(rowStart, src.fRowBytes, row, lanes, srcW,
+                                               interleaved);
+                           },
+                           tmp, tmpW, tmpH);
+    };
     switch (src.fFormat) {
-        case SkMask::kBW_Format: {
-            const uint8_t* bwStart = src.fImage;
-            auto start = SkMask::AlphaIter<SkMask::kBW_Format>(bwStart, 0);
-            auto end = SkMask::AlphaIter<SkMask::kBW_Format>(bwStart + (srcW / 8), srcW % 8);
-            for (int y = 0; y < srcH; ++y, start >>= src.fRowBytes, end >>= src.fRowBytes) {
-                auto tmpStart = &tmp[y];
-                scanW.blur(start, end, tmpStart, tmpW, tmpStart + tmpW * tmpH);
-            }
-        } break;
-        case SkMask::kA8_Format: {
-            const uint8_t* a8Start = src.fImage;
-            auto start = SkMask::AlphaIter<SkMask::kA8_Format>(a8Start);
-            auto end = SkMask::AlphaIter<SkMask::kA8_Format>(a8Start + srcW);
-            for (int y = 0; y < srcH; ++y, start >>= src.fRowBytes, end >>= src.fRowBytes) {
-                auto tmpStart = &tmp[y];
-                scanW.blur(start, end, tmpStart, tmpW, tmpStart + tmpW * tmpH);
-            }
-        } break;
-        case SkMask::kARGB32_Format: {
-            const uint32_t* argbStart = reinterpret_cast<const uint32_t*>(src.fImage);
-            auto start = SkMask::AlphaIter<SkMask::kARGB32_Format>(argbStart);
-            auto end = SkMask::AlphaIter<SkMask::kARGB32_Format>(argbStart + srcW);
-            for (int y = 0; y < srcH; ++y, start >>= src.fRowBytes, end >>= src.fRowBytes) {
-                auto tmpStart = &tmp[y];
-                scanW.blur(start, end, tmpStart, tmpW, tmpStart + tmpW * tmpH);
-            }
-        } break;
-        case SkMask::kLCD16_Format: {
-            const uint16_t* lcdStart = reinterpret_cast<const uint16_t*>(src.fImage);
-            auto start = SkMask::AlphaIter<SkMask::kLCD16_Format>(lcdStart);
-            auto end = SkMask::AlphaIter<SkMask::kLCD16_Format>(lcdStart + srcW);
-            for (int y = 0; y < srcH; ++y, start >>= src.fRowBytes, end >>= src.fRowBytes) {
-                auto tmpStart = &tmp[y];
-                scanW.blur(start, end, tmpStart, tmpW, tmpStart + tmpW * tmpH);
-            }
-        } break;
+        case SkMask::kBW_Format:
+            blurRows(SkMask::AlphaIter<SkMask::kBW_Format>(src.fImage, 0));
+            break;
+        case SkMask::kA8_Format:
+            blurRows(SkMask::AlphaIter<SkMask::kA8_Format>(src.fImage));
+            break;
+        case SkMask::kARGB32_Format:
+            blurRows(SkMask::AlphaIter<SkMask::kARGB32_Format>(
+                    reinterpret_cast<const uint32_t*>(src.fImage)));
+            break;
+        case SkMask::kLCD16_Format:
+            blurRows(SkMask::AlphaIter<SkMask::kLCD16_Format>(
+                    reinterpret_cast<const uint16_t*>(src.fImage)));
+            break;
         default:
             SK_ABORT("Unhandled format.");
     }
 
     // Blur vertically (scan in memory order because of the transposition),
     // and transpose back to the original orientation.
-    const PlanGauss::Scan& scanH = planH.makeBlurScan(tmpW, buffer);
-    for (int y = 0; y < tmpH; y++) {
-        auto tmpStart = &tmp[y * tmpW];
-        auto dstStart = &dst->fImage[y];
-
-        scanH.blur(tmpStart, tmpStart + tmpW,
-                   dstStart, dst->fRowBytes, dstStart + dst->fRowBytes * dstH);
-    }
+    blur_and_transpose(planH, tmpH, tmpW,
+                       [&](int row, int lanes, uint8_t* interleaved) {
+                           interleave_rows(SkMask::AlphaIter<SkMask::kA8_Format>(tmp), tmpW,
+                                           row, lanes, tmpW, interleaved);
+                       },
+                       dst->fImage, dst->fRowBytes, dstH);
 
     return {SkTo<int32_t>(borderW), SkTo<int32_t>(borderH)};
 }
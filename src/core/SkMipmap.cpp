@@ -11,11 +11,14 @@
 #include "include/private/SkHalf.h"
 #include "include/private/SkImageInfoPriv.h"
 #include "include/private/SkNx.h"
+#include "include/private/SkTemplates.h"
 #include "include/private/SkTo.h"
 #include "include/private/SkVx.h"
 #include "src/core/SkMathPriv.h"
 #include "src/core/SkMipmap.h"
 #include "src/core/SkMipmapBuilder.h"
+#include "src/core/SkOpts.h"
+#include "src/core/SkTaskGroup.h"
 #include <new>
 
 //
@@ -417,7 +420,7 @@ SkMipmap* SkMipmap::Build(const SkPixmap& src, SkDiscardableFactoryProc fact,
             proc_1_2 = downsample_1_2<ColorTypeFilter_8888>;
             proc_1_3 = downsample_1_3<ColorTypeFilter_8888>;
             proc_2_1 = downsample_2_1<ColorTypeFilter_8888>;
-            proc_2_2 = downsample_2_2<ColorTypeFilter_8888>;
+            proc_2_2 = SkOpts::downsample_2_2_8888;
             proc_2_3 = downsample_2_3<ColorTypeFilter_8888>;
             proc_3_1 = downsample_3_1<ColorTypeFilter_8888>;
             proc_3_2 = downsample_3_2<ColorTypeFilter_8888>;
@@ -448,7 +451,7 @@ SkMipmap* SkMipmap::Build(const SkPixmap& src, SkDiscardableFactoryProc fact,
             proc_1_2 = downsample_1_2<ColorTypeFilter_8>;
             proc_1_3 = downsample_1_3<ColorTypeFilter_8>;
             proc_2_1 = downsample_2_1<ColorTypeFilter_8>;
-            proc_2_2 = downsample_2_2<ColorTypeFilter_8>;
+            proc_2_2 = SkOpts::downsample_2_2_a8;
             proc_2_3 = downsample_2_3<ColorTypeFilter_8>;
             proc_3_1 = downsample_3_1<ColorTypeFilter_8>;
             proc_3_2 = downsample_3_2<ColorTypeFilter_8>;
@@ -459,7 +462,7 @@ SkMipmap* SkMipmap::Build(const SkPixmap& src, SkDiscardableFactoryProc fact,
             proc_1_2 = downsample_1_2<ColorTypeFilter_RGBA_F16>;
             proc_1_3 = downsample_1_3<ColorTypeFilter_RGBA_F16>;
             proc_2_1 = downsample_2_1<ColorTypeFilter_RGBA_F16>;
-            proc_2_2 = downsample_2_2<ColorTypeFilter_RGBA_F16>;
+            proc_2_2 = SkOpts::downsample_2_2_f16;
             proc_2_3 = downsample_2_3<ColorTypeFilter_RGBA_F16>;
             proc_3_1 = downsample_3_1<ColorTypeFilter_RGBA_F16>;
             proc_3_2 = downsample_3_2<ColorTypeFilter_RGBA_F16>;
@@ -584,12 +587,12 @@ SkMipmap* SkMipmap::Build(const SkPixmap& src, SkDiscardableFactoryProc fact,
     int         width = src.width();
     int         height = src.height();
     uint32_t    rowBytes;
-    SkPixmap    srcPM(src);
 
     // Depending on architecture and other factors, the pixel data alignment may need to be as
     // large as 8 (for F16 pixels). See the comment on SkMipmap::Level.
     SkASSERT(SkIsAlign8((uintptr_t)addr));
 
+    SkAutoSTMalloc<32, FilterProc*> procs(countLevels);
     for (int i = 0; i < countLevels; ++i) {
         FilterProc* proc;
         if (height & 1) {
@@ -632,22 +635,61 @@ SkMipmap* SkMipmap::Build(const SkPixmap& src, SkDiscardableFactoryProc fact,
         levels[i].fScale  = SkSize::Make(SkIntToScalar(width)  / src.width(),
                                          SkIntToScalar(height) / src.height());
 
-        const SkPixmap& dstPM = levels[i].fPixmap;
-        if (computeContents) {
-            const void* srcBasePtr = srcPM.addr();
-            void* dstBasePtr = dstPM.writable_addr();
+        procs[i] = proc;
+        addr += height * rowBytes;
+    }
+    SkASSERT(addr == baseAddr + size);
+
+    if (computeContents) {
+        // Fills rows [y0,y1) of level i from the level above it.
+        auto downsampleRows = [&](int i, int y0, int y1) {
+            const SkPixmap& srcPM = i == 0 ? src : levels[i - 1].fPixmap;
+            const SkPixmap& dstPM = levels[i].fPixmap;
+            for (int y = y0; y < y1; ++y) {
+                procs[i](dstPM.writable_addr(0, y), srcPM.addr(0, 2 * y), srcPM.rowBytes(),
+                         dstPM.width());
+            }
+        };
+
+        // A level made by the 2x2 box filter reads only the two rows above each of its rows. So a
+        // band of rows can be carried down through a run of such levels while the band is still
+        // in cache, and the bands of a run don't depend on each other.
+        static constexpr int kMaxFusedLevels = 3;
+        static constexpr int kBandRows = 32;
+        static constexpr int64_t kMinParallelPixels = 256 * 256;
+
+        SkExecutor* executor = SkGraphicsExecutor();
+        for (int first = 0; first < countLevels;) {
+            int last = first;
+            while (last + 1 < countLevels && last + 1 - first < kMaxFusedLevels &&
+                   procs[last + 1] == proc_2_2) {
+                last++;
+            }
 
-            const size_t srcRB = srcPM.rowBytes();
-            for (int y = 0; y < height; y++) {
-                proc(dstBasePtr, srcBasePtr, srcRB, width);
-                srcBasePtr = (char*)srcBasePtr + srcRB * 2; // jump two rows
-                dstBasePtr = (char*)dstBasePtr + dstPM.rowBytes();
+            // Bands are counted in rows of the last level of the run.
+            const int lastHeight = levels[last].fPixmap.height();
+            const int bandRows = std::max(1, kBandRows >> (last - first));
+            const int bands = (lastHeight + bandRows - 1) / bandRows;
+            auto downsampleBand = [&](int band) {
+                const int y0 = band * bandRows,
+                          y1 = std::min(y0 + bandRows, lastHeight);
+                for (int i = first; i <= last; ++i) {
+                    downsampleRows(i, y0 << (last - i), y1 << (last - i));
+                }
+            };
+
+            const SkPixmap& firstPM = levels[first].fPixmap;
+            if (executor && bands > 1 &&
+                (int64_t)firstPM.width() * firstPM.height() >= kMinParallelPixels) {
+                SkTaskGroup(*executor).batch(bands, downsampleBand);
+            } else {
+                for (int band = 0; band < bands; ++band) {
+                    downsampleBand(band);
+                }
             }
+            first = last + 1;
         }
-        srcPM = dstPM;
-        addr += height * rowBytes;
     }
-    SkASSERT(addr == baseAddr + size);
 
     SkASSERT(mipmap->fLevels);
     return mipmap;
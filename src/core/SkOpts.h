@@ -56,6 +56,12 @@ namespace SkOpts {
 
     extern float (*cubic_solver)(float, float, float, float);
 
+    // 2x2 box filters for SkMipmap: make count dst pixels from two rows of 2*count src pixels.
+    typedef void (*Downsample)(void* dst, const void* src, size_t srcRB, int count);
+    extern Downsample downsample_2_2_8888,
+                      downsample_2_2_a8,
+                      downsample_2_2_f16;
+
     static inline uint32_t hash(const void* data, size_t bytes, uint32_t seed=0) {
         return hash_fn(data, bytes, seed);
     }
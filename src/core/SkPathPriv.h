@@ -410,6 +410,13 @@ public:
     static void ReverseAddPath(SkPathBuilder* builder, const SkPath& reverseMe) {
         builder->privateReverseAddPath(reverseMe);
     }
+
+    /**
+     *  Returns how many bytes SkPath::readFromMemory() would consume from storage, without
+     *  decoding the path, or 0 if storage does not start with a serialized path. The points and
+     *  verbs are not checked, so readFromMemory() may still fail.
+     */
+    static size_t SerializedSize(const void* storage, size_t length);
 };
 
 // Lightweight variant of SkPath::Iter that only returns segments (e.g. lines/conics).
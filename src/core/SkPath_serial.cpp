@@ -291,3 +291,39 @@ size_t SkPath::readFromMemory_EQ4Or5(const void* storage, size_t length) {
     *this = std::move(tmp);
     return buffer.pos();
 }
+
+size_t SkPathPriv::SerializedSize(const void* storage, size_t length) {
+    SkRBuffer buffer(storage, length);
+    uint32_t packed;
+    if (!buffer.readU32(&packed)) {
+        return 0;
+    }
+    unsigned version = extract_version(packed);
+    if (version < kMin_Version || version > kCurrent_Version) {
+        return 0;
+    }
+
+    SkSafeMath safe;
+    size_t size = sizeof(uint32_t);
+    switch (extract_serializationtype(packed)) {
+        case SerializationType::kRRect:
+            // packed, rrect, start
+            size = safe.add(size, SkRRect::kSizeInMemory + sizeof(int32_t));
+            break;
+        case SerializationType::kGeneral: {
+            int32_t pts, cnx, vbs;
+            if (!buffer.readS32(&pts) || !buffer.readS32(&cnx) || !buffer.readS32(&vbs) ||
+                pts < 0 || cnx < 0 || vbs < 0) {
+                return 0;
+            }
+            size = safe.add(size, 3 * sizeof(int32_t));
+            size = safe.add(size, safe.mul(pts, sizeof(SkPoint)));
+            size = safe.add(size, safe.mul(cnx, sizeof(SkScalar)));
+            size = safe.add(size, safe.mul(vbs, sizeof(uint8_t)));
+        } break;
+        default:
+            return 0;
+    }
+    size = safe.alignUp(size, 4);
+    return safe && size <= length ? size : 0;
+}
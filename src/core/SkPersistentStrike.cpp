@@ -0,0 +1,563 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkPersistentStrike.h"
+
+#include "include/core/SkExecutor.h"
+#include "include/core/SkMilestone.h"
+#include "include/core/SkPath.h"
+#include "include/core/SkStream.h"
+#include "include/core/SkTime.h"
+#include "include/core/SkTypeface.h"
+#include "include/private/SkMutex.h"
+#include "include/private/SkTDArray.h"
+#include "include/private/SkTHash.h"
+#include "src/core/SkDescriptor.h"
+#include "src/core/SkLRUCache.h"
+#include "src/core/SkMD5.h"
+#include "src/core/SkOSFile.h"
+#include "src/core/SkOpts.h"
+#include "src/core/SkScalerContext.h"
+#include "src/core/SkTInternalLList.h"
+#include "src/utils/SkOSPath.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+std::atomic<SkGraphics::GlyphCache*> gSkGlyphCache{nullptr};
+
+/*
+  Layout, in native byte order. Every section starts on a 4-byte boundary, and every offset is
+  from the start of the data.
+      Header
+      key
+      Record * glyph_count, sorted by packed glyph ID
+      images and serialized paths
+*/
+
+namespace {
+// Bump when the layout changes.
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kMagic = SkSetFourByteTag('s', 'k', 'g', 'c');
+
+struct Header {
+    uint32_t      fMagic;
+    uint32_t      fVersion;
+    uint32_t      fDataSize;
+    uint32_t      fKeySize;
+    uint32_t      fGlyphCount;
+    SkFontMetrics fFontMetrics;
+};
+
+enum RecordFlags : uint8_t {
+    kHasImage_Flag   = 1 << 0,
+    kPathIsSet_Flag  = 1 << 1,  // setPath() was called; the glyph may still have no path.
+    kHasPath_Flag    = 1 << 2,
+};
+
+// Prefixes each key, so changes to how Skia rasterizes glyphs miss rather than load stale data.
+struct KeyPrefix {
+    uint32_t       fMilestone;
+    uint32_t       fVersion;
+    SkMD5::Digest  fTypeface;
+};
+}  // namespace
+
+struct SkPersistentStrike::Record {
+    uint32_t fPackedID;
+    float    fAdvanceX,
+             fAdvanceY;
+    uint16_t fWidth,
+             fHeight;
+    int16_t  fTop,
+             fLeft;
+    uint8_t  fMaskFormat;
+    uint8_t  fFlags;
+    uint16_t fPadding;
+    uint32_t fImageOffset;
+    uint32_t fPathOffset,
+             fPathSize;
+};
+
+// Typefaces are identified by a digest of all of their font data, style and variation rather than
+// their unique ID, which is only valid within a process. Hashing a font costs a read of its data,
+// so digests are remembered for the most recently used typefaces.
+static bool typeface_identity(const SkTypeface& typeface, SkMD5::Digest* identity) {
+    struct Identity {
+        bool          fValid;
+        SkMD5::Digest fDigest;
+    };
+    static constexpr int kMaxIdentities = 256;
+    static SkMutex mutex;
+    static auto* identities = new SkLRUCache<SkFontID, Identity>(kMaxIdentities);
+    {
+        SkAutoMutexExclusive lock(mutex);
+        if (const Identity* found = identities->find(typeface.uniqueID())) {
+            *identity = found->fDigest;
+            return found->fValid;
+        }
+    }
+
+    Identity result = {false, {}};
+    int ttcIndex = 0;
+    std::unique_ptr<SkStreamAsset> stream = typeface.openStream(&ttcIndex);
+    if (stream) {
+        SkFontStyle style = typeface.fontStyle();
+        SkMD5 md5;
+        md5.write(&ttcIndex, sizeof(ttcIndex));
+        md5.write(&style, sizeof(style));
+
+        int coordinateCount = typeface.getVariationDesignPosition(nullptr, 0);
+        if (coordinateCount > 0) {
+            std::vector<SkFontArguments::VariationPosition::Coordinate> coordinates(
+                    coordinateCount);
+            if (typeface.getVariationDesignPosition(coordinates.data(), coordinateCount) ==
+                coordinateCount) {
+                md5.write(coordinates.data(), coordinates.size() * sizeof(coordinates[0]));
+            }
+        }
+
+        static constexpr size_t kBufferSize = 64 * 1024;
+        std::unique_ptr<uint8_t[]> buffer(new uint8_t[kBufferSize]);
+        uint64_t length = 0;
+        while (size_t read = stream->read(buffer.get(), kBufferSize)) {
+            md5.write(buffer.get(), read);
+            length += read;
+        }
+        md5.write(&length, sizeof(length));
+        result.fValid = length > 0 && stream->isAtEnd();
+        result.fDigest = md5.finish();
+    }
+
+    SkAutoMutexExclusive lock(mutex);
+    identities->insert_or_update(typeface.uniqueID(), result);
+    *identity = result.fDigest;
+    return result.fValid;
+}
+
+sk_sp<SkData> SkPersistentStrike::MakeKey(const SkDescriptor& desc, const SkTypeface& typeface) {
+    KeyPrefix prefix = {SK_MILESTONE, kVersion, {}};
+    if (!typeface_identity(typeface, &prefix.fTypeface)) {
+        return nullptr;
+    }
+
+    // Copy the descriptor without the typeface's unique ID.
+    uint32_t recSize;
+    const void* recPtr = desc.findEntry(kRec_SkDescriptorTag, &recSize);
+    if (recPtr == nullptr || recSize != sizeof(SkScalerContextRec)) {
+        return nullptr;
+    }
+    SkScalerContextRec rec;
+    memcpy((void*)&rec, recPtr, sizeof(rec));
+    rec.fFontID = 0;
+
+    uint32_t effectsSize = 0;
+    const void* effects = desc.findEntry(kEffects_SkDescriptorTag, &effectsSize);
+
+    SkAutoDescriptor ad{SkDescriptor::ComputeOverhead(effects ? 2 : 1) + sizeof(rec) +
+                        (effects ? SkAlign4(effectsSize) : 0)};
+    SkDescriptor* keyDesc = ad.getDesc();
+    keyDesc->addEntry(kRec_SkDescriptorTag, sizeof(rec), &rec);
+    if (effects) {
+        keyDesc->addEntry(kEffects_SkDescriptorTag, effectsSize, effects);
+    }
+    keyDesc->computeChecksum();
+
+    sk_sp<SkData> key = SkData::MakeUninitialized(sizeof(prefix) + keyDesc->getLength());
+    memcpy(key->writable_data(), &prefix, sizeof(prefix));
+    memcpy(SkTAddOffset<void>(key->writable_data(), sizeof(prefix)), keyDesc,
+           keyDesc->getLength());
+    return key;
+}
+
+SkGlyph SkPersistentStrike::MakeGlyph(const Record& record) {
+    SkGlyph glyph{SkPackedGlyphID{record.fPackedID}};
+    glyph.fAdvanceX = record.fAdvanceX;
+    glyph.fAdvanceY = record.fAdvanceY;
+    glyph.fWidth = record.fWidth;
+    glyph.fHeight = record.fHeight;
+    glyph.fTop = record.fTop;
+    glyph.fLeft = record.fLeft;
+    glyph.fMaskFormat = static_cast<SkMask::Format>(record.fMaskFormat);
+    return glyph;
+}
+
+std::unique_ptr<SkPersistentStrike> SkPersistentStrike::Make(sk_sp<SkData> data,
+                                                             const SkData& key) {
+    if (!data || data->size() < sizeof(Header)) {
+        return nullptr;
+    }
+    if (!SkIsAlign4(reinterpret_cast<uintptr_t>(data->data()))) {
+        data = SkData::MakeWithCopy(data->data(), data->size());
+    }
+    const size_t size = data->size();
+    const Header* header = static_cast<const Header*>(data->data());
+    if (header->fMagic != kMagic || header->fVersion != kVersion ||
+        header->fDataSize != size || header->fKeySize != key.size() ||
+        size - sizeof(Header) < key.size() ||
+        0 != memcmp(header + 1, key.data(), key.size())) {
+        return nullptr;
+    }
+
+    const size_t recordsOffset = SkAlign4(sizeof(Header) + key.size());
+    if (recordsOffset > size ||
+        header->fGlyphCount > (size - recordsOffset) / sizeof(Record)) {
+        return nullptr;
+    }
+    const Record* records = SkTAddOffset<const Record>(data->data(), recordsOffset);
+    const int count = SkToInt(header->fGlyphCount);
+    for (int i = 0; i < count; ++i) {
+        const Record& record = records[i];
+        if ((i > 0 && record.fPackedID <= records[i - 1].fPackedID) ||
+            SkPackedGlyphID{record.fPackedID}.value() != record.fPackedID ||
+            !SkMask::IsValidFormat(record.fMaskFormat) ||
+            (record.fHeight == 0 && record.fWidth != 0)) {
+            return nullptr;
+        }
+        if (record.fFlags & kHasImage_Flag) {
+            SkGlyph glyph = MakeGlyph(record);
+            if (glyph.isEmpty() || glyph.imageTooLarge() || record.fImageOffset > size ||
+                glyph.imageSize() > size - record.fImageOffset) {
+                return nullptr;
+            }
+        }
+        if ((record.fFlags & kHasPath_Flag) &&
+            (!(record.fFlags & kPathIsSet_Flag) || record.fPathOffset > size ||
+             record.fPathSize > size - record.fPathOffset)) {
+            return nullptr;
+        }
+    }
+    return std::unique_ptr<SkPersistentStrike>(
+            new SkPersistentStrike(std::move(data), records, count));
+}
+
+const SkFontMetrics& SkPersistentStrike::fontMetrics() const {
+    return static_cast<const Header*>(fData->data())->fFontMetrics;
+}
+
+auto SkPersistentStrike::find(SkPackedGlyphID packedID) const -> const Record* {
+    const Record* end = fRecords + fCount;
+    const Record* found = std::lower_bound(fRecords, end, packedID.value(),
+            [](const Record& record, uint32_t id) { return record.fPackedID < id; });
+    return found != end && found->fPackedID == packedID.value() ? found : nullptr;
+}
+
+bool SkPersistentStrike::findGlyph(SkPackedGlyphID packedID, SkGlyph* glyph) const {
+    if (const Record* record = this->find(packedID)) {
+        *glyph = MakeGlyph(*record);
+        return true;
+    }
+    return false;
+}
+
+const void* SkPersistentStrike::findImage(SkPackedGlyphID packedID) const {
+    const Record* record = this->find(packedID);
+    if (record && (record->fFlags & kHasImage_Flag)) {
+        return fData->bytes() + record->fImageOffset;
+    }
+    return nullptr;
+}
+
+bool SkPersistentStrike::findPath(SkPackedGlyphID packedID, SkPath* path, bool* hasPath) const {
+    const Record* record = this->find(packedID);
+    if (!record || !(record->fFlags & kPathIsSet_Flag)) {
+        return false;
+    }
+    *hasPath = false;
+    if (record->fFlags & kHasPath_Flag) {
+        // A path that does not read back is treated as missing, so the scaler makes it again.
+        if (!path->readFromMemory(fData->bytes() + record->fPathOffset, record->fPathSize)) {
+            return false;
+        }
+        *hasPath = true;
+    }
+    return true;
+}
+
+sk_sp<SkData> SkPersistentStrike::Serialize(const SkData& key,
+                                            const SkFontMetrics& fontMetrics,
+                                            SkSpan<SkGlyph* const> glyphs,
+                                            const SkPersistentStrike* previous) {
+    // Each stored glyph comes from the strike, the previous data, or both.
+    struct Source {
+        uint32_t       fPackedID;
+        const SkGlyph* fGlyph;
+        const Record*  fPrevious;
+    };
+    std::vector<Source> sources;
+    sources.reserve(glyphs.size());
+    SkTHashSet<uint32_t> live;
+    for (const SkGlyph* glyph : glyphs) {
+        uint32_t id = glyph->getPackedID().value();
+        live.add(id);
+        sources.push_back({id, glyph, previous ? previous->find(glyph->getPackedID()) : nullptr});
+    }
+    if (previous) {
+        for (int i = 0; i < previous->fCount; ++i) {
+            const Record& record = previous->fRecords[i];
+            if (!live.contains(record.fPackedID)) {
+                sources.push_back({record.fPackedID, nullptr, &record});
+            }
+        }
+    }
+    std::sort(sources.begin(), sources.end(), [](const Source& a, const Source& b) {
+        return a.fPackedID < b.fPackedID;
+    });
+
+    const size_t recordsOffset = SkAlign4(sizeof(Header) + key.size());
+    const size_t payloadOffset = recordsOffset + sources.size() * sizeof(Record);
+    std::vector<Record> records(sources.size());
+    SkDynamicMemoryWStream payload;
+    auto append = [&](const void* bytes, size_t size) {
+        uint32_t offset = SkToU32(payloadOffset + payload.bytesWritten());
+        payload.write(bytes, size);
+        payload.padToAlign4();
+        return offset;
+    };
+    std::vector<uint8_t> pathBuffer;
+    for (size_t i = 0; i < sources.size(); ++i) {
+        const Source& source = sources[i];
+        Record& record = records[i];
+        if (source.fPrevious) {
+            record = *source.fPrevious;
+            record.fFlags = 0;
+            record.fImageOffset = record.fPathOffset = record.fPathSize = 0;
+        } else {
+            const SkGlyph& glyph = *source.fGlyph;
+            record = {source.fPackedID, glyph.advanceX(), glyph.advanceY(),
+                      SkToU16(glyph.width()), SkToU16(glyph.height()),
+                      SkToS16(glyph.top()), SkToS16(glyph.left()),
+                      SkToU8(glyph.maskFormat()), 0, 0, 0, 0, 0};
+        }
+
+        const SkGlyph* glyph = source.fGlyph;
+        const uint8_t* previousData = previous ? previous->fData->bytes() : nullptr;
+        if (glyph && glyph->setImageHasBeenCalled() && glyph->image()) {
+            record.fFlags |= kHasImage_Flag;
+            record.fImageOffset = append(glyph->image(), glyph->imageSize());
+        } else if (source.fPrevious && (source.fPrevious->fFlags & kHasImage_Flag)) {
+            record.fFlags |= kHasImage_Flag;
+            record.fImageOffset = append(previousData + source.fPrevious->fImageOffset,
+                                         MakeGlyph(*source.fPrevious).imageSize());
+        }
+
+        if (glyph && glyph->setPathHasBeenCalled()) {
+            record.fFlags |= kPathIsSet_Flag;
+            if (const SkPath* path = glyph->path()) {
+                pathBuffer.resize(path->writeToMemory(nullptr));
+                path->writeToMemory(pathBuffer.data());
+                record.fFlags |= kHasPath_Flag;
+                record.fPathSize = SkToU32(pathBuffer.size());
+                record.fPathOffset = append(pathBuffer.data(), pathBuffer.size());
+            }
+        } else if (source.fPrevious && (source.fPrevious->fFlags & kPathIsSet_Flag)) {
+            record.fFlags |= kPathIsSet_Flag;
+            if (source.fPrevious->fFlags & kHasPath_Flag) {
+                record.fFlags |= kHasPath_Flag;
+                record.fPathSize = source.fPrevious->fPathSize;
+                record.fPathOffset = append(previousData + source.fPrevious->fPathOffset,
+                                            source.fPrevious->fPathSize);
+            }
+        }
+    }
+
+    const size_t size = payloadOffset + payload.bytesWritten();
+    if (size > UINT32_MAX) {
+        return nullptr;
+    }
+    sk_sp<SkData> data = SkData::MakeUninitialized(size);
+    void* base = data->writable_data();
+    // Zero the padding too, so the same glyphs always store the same bytes.
+    sk_bzero(base, payloadOffset);
+    Header header = {kMagic, kVersion, SkToU32(size), SkToU32(key.size()),
+                     SkToU32(sources.size()), fontMetrics};
+    memcpy(base, &header, sizeof(header));
+    memcpy(SkTAddOffset<void>(base, sizeof(header)), key.data(), key.size());
+    memcpy(SkTAddOffset<void>(base, recordsOffset), records.data(),
+           records.size() * sizeof(Record));
+    payload.copyTo(SkTAddOffset<void>(base, payloadOffset));
+    return data;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+// Keeps each strike in its own file, named for a hash of its key. The files hold their keys, so a
+// hash collision is a miss rather than wrong glyphs.
+//
+// Files are written by a thread of the cache's own, so draws that purge strikes do not wait on the
+// disk; until a write lands, load() returns the data from memory. Once the files add up to more
+// than the budget, the least recently loaded or stored are deleted.
+class DirectoryGlyphCache final : public SkGraphics::GlyphCache {
+public:
+    DirectoryGlyphCache(const char* path, size_t maxBytes)
+            : fPath{path}
+            , fMaxBytes{maxBytes}
+            , fWriter{SkExecutor::MakeFIFOThreadPool(1, /*allowBorrowing=*/false)} {
+        // Files already in the directory count against the budget, as older than any use.
+        fWriter->add([this] { this->addExistingFiles(); });
+    }
+
+    // fWriter is destroyed first, which finishes any pending writes.
+    ~DirectoryGlyphCache() override = default;
+
+    sk_sp<SkData> load(const SkData& key) override {
+        SkString name = NameFor(key);
+        {
+            SkAutoMutexExclusive lock{fMutex};
+            if (sk_sp<SkData>* pending = fPending.find(name)) {
+                return *pending;
+            }
+        }
+        sk_sp<SkData> data = SkData::MakeFromFileName(this->pathFor(name).c_str());
+        if (data) {
+            SkAutoMutexExclusive lock{fMutex};
+            this->use(name, data->size());
+        }
+        return data;
+    }
+
+    void store(const SkData& key, const SkData& data) override {
+        SkString name = NameFor(key);
+        sk_sp<SkData> ref = sk_ref_sp(&data);
+        {
+            SkAutoMutexExclusive lock{fMutex};
+            fPending.set(name, ref);
+        }
+        fWriter->add([this, name, ref] { this->write(name, *ref); });
+    }
+
+private:
+    struct File {
+        SkString fName;
+        size_t   fSize;
+        SK_DECLARE_INTERNAL_LLIST_INTERFACE(File);
+    };
+
+    static SkString NameFor(const SkData& key) {
+        return SkStringPrintf("%08x%08x.skglyphs",
+                              SkOpts::hash(key.data(), key.size(), 0),
+                              SkOpts::hash(key.data(), key.size(), 1));
+    }
+
+    SkString pathFor(const SkString& name) const {
+        return SkOSPath::Join(fPath.c_str(), name.c_str());
+    }
+
+    // Makes name the most recently used file, of the given size.
+    void use(const SkString& name, size_t size) SK_REQUIRES(fMutex) {
+        File* file;
+        if (std::unique_ptr<File>* found = fFiles.find(name)) {
+            file = found->get();
+            fBytes -= file->fSize;
+            fLRU.remove(file);
+        } else {
+            file = fFiles.set(name, std::make_unique<File>(File{name, 0}))->get();
+        }
+        file->fSize = size;
+        fBytes += size;
+        fLRU.addToHead(file);
+    }
+
+    // Runs on fWriter.
+    void addExistingFiles() {
+        SkOSFile::Iter iter{fPath.c_str(), ".skglyphs"};
+        SkString name;
+        while (iter.next(&name)) {
+            FILE* file = sk_fopen(this->pathFor(name).c_str(), kRead_SkFILE_Flag);
+            if (!file) {
+                continue;
+            }
+            size_t size = sk_fgetsize(file);
+            sk_fclose(file);
+
+            SkAutoMutexExclusive lock{fMutex};
+            if (!fFiles.find(name)) {
+                File* entry = fFiles.set(name, std::make_unique<File>(File{name, size}))->get();
+                fBytes += size;
+                fLRU.addToTail(entry);
+            }
+        }
+        this->evict();
+    }
+
+    // Runs on fWriter.
+    void write(const SkString& name, const SkData& data) {
+        // Write a temporary file and rename it over the old one, so readers (including other
+        // processes) never see a partially written strike.
+        SkString path = this->pathFor(name);
+        SkString temp = SkStringPrintf("%s.%llx.tmp", path.c_str(),
+                                       (unsigned long long)SkTime::GetNSecs());
+        bool written;
+        {
+            SkFILEWStream file(temp.c_str());
+            written = file.isValid() && file.write(data.data(), data.size());
+        }
+        if (written && 0 != std::rename(temp.c_str(), path.c_str())) {
+            // Some platforms will not rename over an existing file.
+            std::remove(path.c_str());
+            written = 0 == std::rename(temp.c_str(), path.c_str());
+        }
+        if (!written) {
+            std::remove(temp.c_str());
+        }
+
+        {
+            SkAutoMutexExclusive lock{fMutex};
+            // A later store() of the same key replaces the pending data; leave that for its write.
+            sk_sp<SkData>* pending = fPending.find(name);
+            if (pending && pending->get() == &data) {
+                fPending.remove(name);
+            }
+            if (written) {
+                this->use(name, data.size());
+            }
+        }
+        this->evict();
+    }
+
+    // Runs on fWriter, which is the only thread that deletes files.
+    void evict() {
+        std::vector<SkString> victims;
+        {
+            SkAutoMutexExclusive lock{fMutex};
+            // Never evict the file just written, even if it alone is over the budget.
+            while (fBytes > fMaxBytes && fLRU.tail() != fLRU.head()) {
+                File* file = fLRU.tail();
+                fLRU.remove(file);
+                fBytes -= file->fSize;
+                victims.push_back(file->fName);
+                fFiles.remove(victims.back());
+            }
+        }
+        for (const SkString& name : victims) {
+            std::remove(this->pathFor(name).c_str());
+        }
+    }
+
+    const SkString fPath;
+    const size_t   fMaxBytes;
+
+    SkMutex fMutex;
+    SkTHashMap<SkString, sk_sp<SkData>>     fPending SK_GUARDED_BY(fMutex);
+    SkTHashMap<SkString, std::unique_ptr<File>> fFiles SK_GUARDED_BY(fMutex);
+    SkTInternalLList<File>                  fLRU SK_GUARDED_BY(fMutex);
+    size_t                                  fBytes SK_GUARDED_BY(fMutex) = 0;
+
+    // Last, so it is destroyed first.
+    std::unique_ptr<SkExecutor> fWriter;
+};
+}  // namespace
+
+std::unique_ptr<SkGraphics::GlyphCache> SkGraphics::GlyphCache::MakeDirectory(const char* path,
+                                                                             size_t maxBytes) {
+    if (!path || (!sk_isdir(path) && !sk_mkdir(path))) {
+        return nullptr;
+    }
+    return std::make_unique<DirectoryGlyphCache>(path, maxBytes);
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkPersistentStrike_DEFINED
+#define SkPersistentStrike_DEFINED
+
+#include "include/core/SkData.h"
+#include "include/core/SkFontMetrics.h"
+#include "include/core/SkGraphics.h"
+#include "include/core/SkSpan.h"
+#include "src/core/SkGlyph.h"
+
+#include <atomic>
+#include <memory>
+
+class SkDescriptor;
+class SkPath;
+class SkTypeface;
+
+// Set by SkGraphics::SetGlyphCache().
+extern std::atomic<SkGraphics::GlyphCache*> gSkGlyphCache;
+
+// The glyphs of one strike as stored in an SkGraphics::GlyphCache by an earlier process. The data
+// is used in place, so it may map a file: the glyphs are sorted by packed ID for binary search,
+// and images and paths are only copied out when a strike asks for them.
+class SkPersistentStrike {
+public:
+    // Returns the key for the strike, or nullptr if the typeface cannot be identified across
+    // processes (e.g. it has no font data). The key does not depend on the typeface's unique ID.
+    static sk_sp<SkData> MakeKey(const SkDescriptor&, const SkTypeface&);
+
+    // Returns nullptr unless data was stored for this key by this version of Skia and all of its
+    // offsets and sizes are in bounds. The glyph contents themselves are not checked.
+    static std::unique_ptr<SkPersistentStrike> Make(sk_sp<SkData> data, const SkData& key);
+
+    // Stores the metrics, images and paths of glyphs, along with those of previous (if not null)
+    // that are not among glyphs.
+    static sk_sp<SkData> Serialize(const SkData& key,
+                                   const SkFontMetrics&,
+                                   SkSpan<SkGlyph* const> glyphs,
+                                   const SkPersistentStrike* previous);
+
+    const SkFontMetrics& fontMetrics() const;
+
+    // Sets glyph's metrics if they were stored.
+    bool findGlyph(SkPackedGlyphID, SkGlyph* glyph) const;
+
+    // Returns the stored image for a glyph, or nullptr.
+    const void* findImage(SkPackedGlyphID) const;
+
+    // Returns true if the glyph's path was stored, setting *hasPath to whether it has one.
+    bool findPath(SkPackedGlyphID, SkPath* path, bool* hasPath) const;
+
+    struct Record;
+
+private:
+    SkPersistentStrike(sk_sp<SkData> data, const Record* records, int count)
+            : fData{std::move(data)}, fRecords{records}, fCount{count} {}
+
+    const Record* find(SkPackedGlyphID) const;
+    static SkGlyph MakeGlyph(const Record&);
+
+    const sk_sp<SkData> fData;
+    const Record* const fRecords;
+    const int           fCount;
+};
+
+#endif  // SkPersistentStrike_DEFINED
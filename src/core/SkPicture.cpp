@@ -10,6 +10,7 @@
 #include "include/core/SkImageGenerator.h"
 #include "include/core/SkPictureRecorder.h"
 #include "include/core/SkSerialProcs.h"
+#include "include/private/SkOnce.h"
 #include "include/private/SkTo.h"
 #include "src/core/SkCanvasPriv.h"
 #include "src/core/SkMathPriv.h"
@@ -18,6 +19,7 @@
 #include "src/core/SkPicturePlayback.h"
 #include "src/core/SkPicturePriv.h"
 #include "src/core/SkPictureRecord.h"
+#include "src/core/SkReadBuffer.h"
 #include "src/core/SkResourceCache.h"
 #include <atomic>
 
@@ -28,9 +30,10 @@
 //          1 : PictureData
 //         <0 : -size of the custom data
 enum {
-    kFailure_TrailingStreamByteAfterPictInfo     = 0,   // nothing follows
-    kPictureData_TrailingStreamByteAfterPictInfo = 1,   // SkPictureData follows
-    kCustom_TrailingStreamByteAfterPictInfo      = 2,   // -size32 follows
+    kFailure_TrailingStreamByteAfterPictInfo            = 0,   // nothing follows
+    kPictureData_TrailingStreamByteAfterPictInfo        = 1,   // SkPictureData follows
+    kCustom_TrailingStreamByteAfterPictInfo             = 2,   // -size32 follows
+    kAlignedPictureData_TrailingStreamByteAfterPictInfo = 3,   // pad8, pad8 zeros, SkPictureData
 };
 
 /* SkPicture impl.  This handles generic responsibilities like unique IDs and serialization. */
@@ -138,6 +141,67 @@ sk_sp<SkPicture> SkPicture::MakeFromStream(SkStream* stream, const SkDeserialPro
     return MakeFromStream(stream, procs, nullptr);
 }
 
+// Plays SkPictureData loaded by MakeFromMappedData() straight back, rather than recording it into
+// an SkBigPicture first like Forwardport() does.
+class SkMappedPicture final : public SkPicture {
+public:
+    SkMappedPicture(const SkRect& cull, std::unique_ptr<SkPictureData> data)
+            : fCull(cull), fData(std::move(data)) {}
+
+    void playback(SkCanvas* canvas, AbortCallback* callback) const override {
+        SkPicturePlayback(fData.get()).draw(canvas, callback, nullptr);
+    }
+
+    SkRect cullRect() const override { return fCull; }
+
+    int approximateOpCount(bool nested) const override {
+        // Walking the ops touches all of them, so only do it when asked.
+        fOpCountOnce([this] {
+            SkReadBuffer reader(fData->opData()->data(), fData->opData()->size());
+            while (!reader.eof() && reader.isValid()) {
+                // See SkPictureRecord::addDraw(): large ops store their size in a second word,
+                // and count it as one more byte.
+                const size_t start = reader.offset();
+                uint32_t size = reader.readInt() & 0xffffff;
+                if (size == 0xffffff) {
+                    size = reader.readInt();
+                }
+                if (!reader.validate(size > 0 && start + size >= reader.offset())) {
+                    break;
+                }
+                reader.skip(start + size - reader.offset());
+                fOpCount++;
+            }
+        });
+        int count = fOpCount;
+        if (nested) {
+            for (const auto& pic : fData->pictures()) {
+                count += pic->approximateOpCount(true);
+            }
+        }
+        return count;
+    }
+
+    size_t approximateBytesUsed() const override {
+        return sizeof(*this) + fData->opData()->size();
+    }
+
+private:
+    const SkRect                         fCull;
+    const std::unique_ptr<SkPictureData> fData;
+    mutable SkOnce                       fOpCountOnce;
+    mutable int                          fOpCount = 0;
+};
+
+sk_sp<SkPicture> SkPicture::MakeFromMappedData(sk_sp<SkData> data,
+                                               const SkDeserialProcs* procs) {
+    if (!data) {
+        return nullptr;
+    }
+    SkMemoryStream stream(data);
+    return MakeFromStream(&stream, procs, nullptr, data.get());
+}
+
 sk_sp<SkPicture> SkPicture::MakeFromData(const void* data, size_t size,
                                          const SkDeserialProcs* procs) {
     if (!data) {
@@ -156,7 +220,7 @@ sk_sp<SkPicture> SkPicture::MakeFromData(const SkData* data, const SkDeserialPro
 }
 
 sk_sp<SkPicture> SkPicture::MakeFromStream(SkStream* stream, const SkDeserialProcs* procsPtr,
-                                           SkTypefacePlayback* typefaces) {
+                                           SkTypefacePlayback* typefaces, const SkData* mapping) {
     SkPictInfo info;
     if (!StreamIsSKP(stream, &info)) {
         return nullptr;
@@ -170,9 +234,21 @@ sk_sp<SkPicture> SkPicture::MakeFromStream(SkStream* stream, const SkDeserialPro
     uint8_t trailingStreamByteAfterPictInfo;
     if (!stream->readU8(&trailingStreamByteAfterPictInfo)) { return nullptr; }
     switch (trailingStreamByteAfterPictInfo) {
+        case kAlignedPictureData_TrailingStreamByteAfterPictInfo: {
+            uint8_t pad;
+            if (!stream->readU8(&pad) || pad > 3 || stream->skip(pad) != pad) {
+                return nullptr;
+            }
+        }   [[fallthrough]];
         case kPictureData_TrailingStreamByteAfterPictInfo: {
             std::unique_ptr<SkPictureData> data(
-                    SkPictureData::CreateFromStream(stream, info, procs, typefaces));
+                    SkPictureData::CreateFromStream(stream, info, procs, typefaces, mapping));
+            if (mapping) {
+                if (!data || !data->opData()) {
+                    return nullptr;
+                }
+                return sk_make_sp<SkMappedPicture>(info.fCullRect, std::move(data));
+            }
             return Forwardport(info, data.get(), nullptr);
         }
         case kCustom_TrailingStreamByteAfterPictInfo: {
@@ -287,7 +363,16 @@ void SkPicture::serialize(SkWStream* stream, const SkSerialProcs* procsPtr,
 
     std::unique_ptr<SkPictureData> data(this->backport());
     if (data) {
-        stream->write8(kPictureData_TrailingStreamByteAfterPictInfo);
+        if (procs.fAlignForMapping) {
+            // Pad so the ops start on a 4-byte boundary (tags and their sizes are 4-byte
+            // multiples).
+            stream->write8(kAlignedPictureData_TrailingStreamByteAfterPictInfo);
+            uint8_t pad = (4 - (stream->bytesWritten() + 1) % 4) % 4;
+            stream->write8(pad);
+            stream->write("\0\0\0", pad);
+        } else {
+            stream->write8(kPictureData_TrailingStreamByteAfterPictInfo);
+        }
         data->serialize(stream, procs, typefaceSet, textBlobsOnly);
     } else {
         stream->write8(kFailure_TrailingStreamByteAfterPictInfo);
@@ -10,7 +10,7 @@
 #include "include/core/SkImageGenerator.h"
 #include "include/core/SkTypeface.h"
 #include "include/private/SkTo.h"
-#include "src/core/SkAutoMalloc.h"
+#include "src/core/SkPathPriv.h"
 #include "src/core/SkPicturePriv.h"
 #include "src/core/SkPictureRecord.h"
 #include "src/core/SkReadBuffer.h"
@@ -241,6 +241,14 @@ void SkPictureData::serialize(SkWStream* stream, const SkSerialProcs& procs,
     // paints would just write indices into our typeface set.
     WriteTypefaces(stream, *typefaceSet, procs);
 
+    if (procs.fAlignForMapping) {
+        // Start the buffer on a 4-byte boundary, so a mapped reader can use it where it lies.
+        // (Tags and their sizes are 4-byte multiples.)
+        uint32_t pad = (4 - stream->bytesWritten() % 4) % 4;
+        write_tag_size(stream, SK_PICT_ALIGN_TAG, pad);
+        stream->write("\0\0\0", pad);
+    }
+
     // Write the buffer.
     write_tag_size(stream, SK_PICT_BUFFER_SIZE_TAG, buffer.bytesWritten());
     buffer.writeToStream(stream);
@@ -281,19 +289,40 @@ void SkPictureData::flatten(SkWriteBuffer& buffer) const {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// Reads the next size bytes of stream, which reads mapping. SkReadBuffer needs them 4-byte
+// aligned, so they are shared with mapping when they are, and copied when they are not.
+static sk_sp<SkData> read_mapped(SkStream* stream, const SkData* mapping, size_t size) {
+    SkASSERT(stream->getMemoryBase() == mapping->data());
+    const size_t offset = stream->getPosition();
+    if (!SkIsAlign4((uintptr_t)mapping->bytes() + offset) || size > mapping->size() - offset) {
+        return SkData::MakeFromStream(stream, size);
+    }
+    if (stream->skip(size) != size) {
+        return nullptr;
+    }
+    return SkData::MakeSubset(mapping, offset, size);
+}
+
 bool SkPictureData::parseStreamTag(SkStream* stream,
                                    uint32_t tag,
                                    uint32_t size,
                                    const SkDeserialProcs& procs,
-                                   SkTypefacePlayback* topLevelTFPlayback) {
+                                   SkTypefacePlayback* topLevelTFPlayback,
+                                   const SkData* mapping) {
     switch (tag) {
         case SK_PICT_READER_TAG:
             SkASSERT(nullptr == fOpData);
-            fOpData = SkData::MakeFromStream(stream, size);
+            fOpData = mapping ? read_mapped(stream, mapping, size)
+                              : SkData::MakeFromStream(stream, size);
             if (!fOpData) {
                 return false;
             }
             break;
+        case SK_PICT_ALIGN_TAG:
+            if (size > 3 || stream->skip(size) != size) {
+                return false;
+            }
+            break;
         case SK_PICT_FACTORY_TAG: {
             if (!stream->readU32(&size)) { return false; }
             fFactoryPlayback = std::make_unique<SkFactoryPlayback>(size);
@@ -330,7 +359,7 @@ bool SkPictureData::parseStreamTag(SkStream* stream,
             fPictures.reserve_back(SkToInt(size));
 
             for (uint32_t i = 0; i < size; i++) {
-                auto pic = SkPicture::MakeFromStream(stream, &procs, topLevelTFPlayback);
+                auto pic = SkPicture::MakeFromStream(stream, &procs, topLevelTFPlayback, mapping);
                 if (!pic) {
                     return false;
                 }
@@ -338,12 +367,19 @@ bool SkPictureData::parseStreamTag(SkStream* stream,
             }
         } break;
         case SK_PICT_BUFFER_SIZE_TAG: {
-            SkAutoMalloc storage(size);
-            if (stream->read(storage.get(), size) != size) {
+            sk_sp<SkData> storage = mapping ? read_mapped(stream, mapping, size)
+                                            : SkData::MakeFromStream(stream, size);
+            if (!storage) {
                 return false;
             }
 
-            SkReadBuffer buffer(storage.get(), size);
+            // A mapped picture keeps the buffer around: images share it, and paths and text
+            // blobs are decoded from it later.
+            if (mapping) {
+                fLazySource = storage;
+            }
+            SkReadBuffer buffer = mapping ? SkReadBuffer(storage)
+                                          : SkReadBuffer(storage->data(), storage->size());
             buffer.setVersion(fInfo.getVersion());
 
             if (!fFactoryPlayback) {
@@ -352,12 +388,16 @@ bool SkPictureData::parseStreamTag(SkStream* stream,
             fFactoryPlayback->setupBuffer(buffer);
             buffer.setDeserialProcs(procs);
 
-            if (fTFPlayback.count() > 0) {
-                // .skp files <= v43 have typefaces serialized with each sub picture.
-                fTFPlayback.setupBuffer(buffer);
-            } else {
-                // Newer .skp files serialize all typefaces with the top picture.
-                topLevelTFPlayback->setupBuffer(buffer);
+            // .skp files <= v43 have typefaces serialized with each sub picture.
+            // Newer .skp files serialize all typefaces with the top picture.
+            SkTypefacePlayback* tfPlayback = fTFPlayback.count() > 0 ? &fTFPlayback
+                                                                     : topLevelTFPlayback;
+            tfPlayback->setupBuffer(buffer);
+            if (fLazySource) {
+                fLazyTypefaces.setCount(tfPlayback->count());
+                for (size_t i = 0; i < tfPlayback->count(); ++i) {
+                    fLazyTypefaces[i] = (*tfPlayback)[i];
+                }
             }
 
             while (!buffer.eof() && buffer.isValid()) {
@@ -427,6 +467,10 @@ void SkPictureData::parseBufferTag(SkReadBuffer& buffer, uint32_t tag, uint32_t
                 if (!buffer.validate(count >= 0)) {
                     return;
                 }
+                if (fLazySource) {
+                    this->skipLazyPaths(buffer, count);
+                    return;
+                }
                 for (int i = 0; i < count; i++) {
                     buffer.readPath(&fPaths.push_back());
                     if (!buffer.isValid()) {
@@ -435,7 +479,11 @@ void SkPictureData::parseBufferTag(SkReadBuffer& buffer, uint32_t tag, uint32_t
                 }
             } break;
         case SK_PICT_TEXTBLOB_BUFFER_TAG:
-            new_array_from_buffer(buffer, size, fTextBlobs, SkTextBlobPriv::MakeFromBuffer);
+            if (fLazySource) {
+                this->skipLazyTextBlobs(buffer, size);
+            } else {
+                new_array_from_buffer(buffer, size, fTextBlobs, SkTextBlobPriv::MakeFromBuffer);
+            }
             break;
         case SK_PICT_VERTICES_BUFFER_TAG:
             new_array_from_buffer(buffer, size, fVertices, SkVerticesPriv::Decode);
@@ -469,16 +517,74 @@ void SkPictureData::parseBufferTag(SkReadBuffer& buffer, uint32_t tag, uint32_t
     }
 }
 
+void SkPictureData::skipLazyPaths(SkReadBuffer& buffer, int count) {
+    // Every path takes at least 4 bytes.
+    if (!buffer.validate(fPaths.empty() && buffer.validateCanReadN<uint32_t>(count))) {
+        return;
+    }
+    fPaths.reset(count);
+    fLazyPaths.reset(new LazyItem[count]);
+    for (int i = 0; i < count; ++i) {
+        fLazyPaths[i].fOffset = buffer.offset();
+        size_t size = SkPathPriv::SerializedSize(fLazySource->bytes() + buffer.offset(),
+                                                 buffer.available());
+        if (!buffer.validate(size != 0)) {
+            return;
+        }
+        buffer.skip(size);
+    }
+}
+
+void SkPictureData::skipLazyTextBlobs(SkReadBuffer& buffer, uint32_t count) {
+    if (!buffer.validate(fTextBlobs.empty() && SkTFitsIn<int>(count) &&
+                         buffer.validateCanReadN<uint32_t>(count))) {
+        return;
+    }
+    fTextBlobs.reset(SkToInt(count));
+    fLazyTextBlobs.reset(new LazyItem[count]);
+    for (uint32_t i = 0; i < count; ++i) {
+        fLazyTextBlobs[i].fOffset = buffer.offset();
+        if (!SkTextBlobPriv::SkipFromBuffer(buffer)) {
+            return;
+        }
+    }
+}
+
+bool SkPictureData::decodePath(int index) const {
+    LazyItem& item = fLazyPaths[index];
+    item.fOnce([&] {
+        const size_t size = fLazySource->size() - item.fOffset;
+        item.fValid = fPaths[index].readFromMemory(fLazySource->bytes() + item.fOffset, size);
+        // Playback may happen on several threads at once, so like initForPlayback(), compute
+        // the bounds while we still own the path.
+        fPaths[index].updateBoundsCache();
+    });
+    return item.fValid;
+}
+
+const SkTextBlob* SkPictureData::decodeTextBlob(int index) const {
+    LazyItem& item = fLazyTextBlobs[index];
+    item.fOnce([&] {
+        SkReadBuffer buffer(fLazySource->bytes() + item.fOffset,
+                            fLazySource->size() - item.fOffset);
+        buffer.setVersion(fInfo.getVersion());
+        fLazyTypefaces.setupBuffer(buffer);
+        fTextBlobs[index] = SkTextBlobPriv::MakeFromBuffer(buffer);
+    });
+    return fTextBlobs[index].get();
+}
+
 SkPictureData* SkPictureData::CreateFromStream(SkStream* stream,
                                                const SkPictInfo& info,
                                                const SkDeserialProcs& procs,
-                                               SkTypefacePlayback* topLevelTFPlayback) {
+                                               SkTypefacePlayback* topLevelTFPlayback,
+                                               const SkData* mapping) {
     std::unique_ptr<SkPictureData> data(new SkPictureData(info));
     if (!topLevelTFPlayback) {
         topLevelTFPlayback = &data->fTFPlayback;
     }
 
-    if (!data->parseStream(stream, procs, topLevelTFPlayback)) {
+    if (!data->parseStream(stream, procs, topLevelTFPlayback, mapping)) {
         return nullptr;
     }
     return data.release();
@@ -497,7 +603,8 @@ SkPictureData* SkPictureData::CreateFromBuffer(SkReadBuffer& buffer,
 
 bool SkPictureData::parseStream(SkStream* stream,
                                 const SkDeserialProcs& procs,
-                                SkTypefacePlayback* topLevelTFPlayback) {
+                                SkTypefacePlayback* topLevelTFPlayback,
+                                const SkData* mapping) {
     for (;;) {
         uint32_t tag;
         if (!stream->readU32(&tag)) { return false; }
@@ -507,7 +614,7 @@ bool SkPictureData::parseStream(SkStream* stream,
 
         uint32_t size;
         if (!stream->readU32(&size)) { return false; }
-        if (!this->parseStreamTag(stream, tag, size, procs, topLevelTFPlayback)) {
+        if (!this->parseStreamTag(stream, tag, size, procs, topLevelTFPlayback, mapping)) {
             return false; // we're invalid
         }
     }
@@ -11,6 +11,7 @@
 #include "include/core/SkBitmap.h"
 #include "include/core/SkDrawable.h"
 #include "include/core/SkPicture.h"
+#include "include/private/SkOnce.h"
 #include "include/private/SkTArray.h"
 #include "src/core/SkPictureFlat.h"
 
@@ -54,6 +55,8 @@ public:
 #define SK_PICT_TYPEFACE_TAG   SkSetFourByteTag('t', 'p', 'f', 'c')
 #define SK_PICT_PICTURE_TAG    SkSetFourByteTag('p', 'c', 't', 'r')
 #define SK_PICT_DRAWABLE_TAG   SkSetFourByteTag('d', 'r', 'a', 'w')
+// Zero to three bytes of padding, only written when SkSerialProcs::fAlignForMapping is set
+#define SK_PICT_ALIGN_TAG      SkSetFourByteTag('a', 'l', 'g', 'n')
 
 // This tag specifies the size of the ReadBuffer, needed for the following tags
 #define SK_PICT_BUFFER_SIZE_TAG     SkSetFourByteTag('a', 'r', 'a', 'y')
@@ -77,22 +80,27 @@ class SkPictureData {
 public:
     SkPictureData(const SkPictureRecord& record, const SkPictInfo&);
     // Does not affect ownership of SkStream.
+    // If mapping is set, the stream must be an SkMemoryStream reading it. Ops and images then
+    // share its bytes where they are aligned well enough, and paths and text blobs are only
+    // decoded when playback first uses them.
     static SkPictureData* CreateFromStream(SkStream*,
                                            const SkPictInfo&,
                                            const SkDeserialProcs&,
-                                           SkTypefacePlayback*);
+                                           SkTypefacePlayback*,
+                                           const SkData* mapping = nullptr);
     static SkPictureData* CreateFromBuffer(SkReadBuffer&, const SkPictInfo&);
 
     void serialize(SkWStream*, const SkSerialProcs&, SkRefCntSet*, bool textBlobsOnly=false) const;
     void flatten(SkWriteBuffer&) const;
 
     const sk_sp<SkData>& opData() const { return fOpData; }
+    const SkTArray<sk_sp<const SkPicture>>& pictures() const { return fPictures; }
 
 protected:
     explicit SkPictureData(const SkPictInfo& info);
 
     // Does not affect ownership of SkStream.
-    bool parseStream(SkStream*, const SkDeserialProcs&, SkTypefacePlayback*);
+    bool parseStream(SkStream*, const SkDeserialProcs&, SkTypefacePlayback*, const SkData* mapping);
     bool parseBuffer(SkReadBuffer& buffer);
 
 public:
@@ -104,8 +112,13 @@ public:
 
     const SkPath& getPath(SkReadBuffer* reader) const {
         int index = reader->readInt();
-        return reader->validate(index > 0 && index <= fPaths.count()) ?
-                fPaths[index - 1] : fEmptyPath;
+        if (!reader->validate(index > 0 && index <= fPaths.count())) {
+            return fEmptyPath;
+        }
+        if (fLazyPaths && !reader->validate(this->decodePath(index - 1))) {
+            return fEmptyPath;
+        }
+        return fPaths[index - 1];
     }
 
     const SkPicture* getPicture(SkReadBuffer* reader) const {
@@ -124,7 +137,15 @@ public:
     const SkPaint& requiredPaint(SkReadBuffer* reader) const;
 
     const SkTextBlob* getTextBlob(SkReadBuffer* reader) const {
-        return read_index_base_1_or_null(reader, fTextBlobs);
+        if (!fLazyTextBlobs) {
+            return read_index_base_1_or_null(reader, fTextBlobs);
+        }
+        int index = reader->readInt();
+        if (!reader->validate(index > 0 && index <= fTextBlobs.count())) {
+            return nullptr;
+        }
+        const SkTextBlob* blob = this->decodeTextBlob(index - 1);
+        return reader->validate(blob != nullptr) ? blob : nullptr;
     }
 
     const SkVertices* getVertices(SkReadBuffer* reader) const {
@@ -135,12 +156,17 @@ private:
     // these help us with reading/writing
     // Does not affect ownership of SkStream.
     bool parseStreamTag(SkStream*, uint32_t tag, uint32_t size,
-                        const SkDeserialProcs&, SkTypefacePlayback*);
+                        const SkDeserialProcs&, SkTypefacePlayback*, const SkData* mapping);
     void parseBufferTag(SkReadBuffer&, uint32_t tag, uint32_t size);
+    void skipLazyPaths(SkReadBuffer&, int count);
+    void skipLazyTextBlobs(SkReadBuffer&, uint32_t count);
+    bool decodePath(int index) const;
+    const SkTextBlob* decodeTextBlob(int index) const;
     void flattenToBuffer(SkWriteBuffer&, bool textBlobsOnly) const;
 
     SkTArray<SkPaint>  fPaints;
-    SkTArray<SkPath>   fPaths;
+    // Filled in by decodePath() when fLazyPaths is set.
+    mutable SkTArray<SkPath> fPaths;
 
     sk_sp<SkData>   fOpData;    // opcodes and parameters
 
@@ -149,13 +175,26 @@ private:
 
     SkTArray<sk_sp<const SkPicture>>   fPictures;
     SkTArray<sk_sp<SkDrawable>>        fDrawables;
-    SkTArray<sk_sp<const SkTextBlob>>  fTextBlobs;
+    // Filled in by decodeTextBlob() when fLazyTextBlobs is set.
+    mutable SkTArray<sk_sp<const SkTextBlob>> fTextBlobs;
     SkTArray<sk_sp<const SkVertices>>  fVertices;
     SkTArray<sk_sp<const SkImage>>     fImages;
 
     SkTypefacePlayback                 fTFPlayback;
     std::unique_ptr<SkFactoryPlayback> fFactoryPlayback;
 
+    // When loaded from a mapping, this holds the ARRAYS buffer (usually a subset of the mapping),
+    // and we note where each path and text blob starts in it instead of decoding them up front.
+    sk_sp<SkData> fLazySource;
+    struct LazyItem {
+        SkOnce fOnce;
+        size_t fOffset = 0;
+        bool   fValid = false;
+    };
+    std::unique_ptr<LazyItem[]> fLazyPaths;
+    std::unique_ptr<LazyItem[]> fLazyTextBlobs;
+    SkTypefacePlayback          fLazyTypefaces;  // What text blobs refer to.
+
     const SkPictInfo fInfo;
 
     static void WriteFactories(SkWStream* stream, const SkFactorySet& rec);
@@ -50,7 +50,15 @@ SkCanvas* SkPictureRecorder::getRecordingCanvas() {
     return fActivelyRecording ? fRecorder.get() : nullptr;
 }
 
-sk_sp<SkPicture> SkPictureRecorder::finishRecordingAsPicture() {
+void SkPictureRecorder::optimize(uint32_t finishFlags) {
+    if (finishFlags & kOptimizeForPlayback_FinishFlag) {
+        SkRecordOptimizeForPlayback(fRecord.get());
+    } else {
+        SkRecordOptimize(fRecord.get());
+    }
+}
+
+sk_sp<SkPicture> SkPictureRecorder::finishRecordingAsPicture(uint32_t finishFlags) {
     fActivelyRecording = false;
     fRecorder->restoreToCount(1);  // If we were missing any restores, add them now.
 
@@ -67,7 +75,7 @@ sk_sp<SkPicture> SkPictureRecorder::finishRecordingAsPicture() {
     }
 
     // TODO: delay as much of this work until just before first playback?
-    SkRecordOptimize(fRecord.get());
+    this->optimize(finishFlags);
 
     SkDrawableList* drawableList = fRecorder->getDrawableList();
     std::unique_ptr<SkBigPicture::SnapshotArray> pictList{
@@ -102,9 +110,10 @@ sk_sp<SkPicture> SkPictureRecorder::finishRecordingAsPicture() {
                                     subPictureBytes);
 }
 
-sk_sp<SkPicture> SkPictureRecorder::finishRecordingAsPictureWithCull(const SkRect& cullRect) {
+sk_sp<SkPicture> SkPictureRecorder::finishRecordingAsPictureWithCull(const SkRect& cullRect,
+                                                                     uint32_t finishFlags) {
     fCullRect = cullRect;
-    return this->finishRecordingAsPicture();
+    return this->finishRecordingAsPicture(finishFlags);
 }
 
 
@@ -123,12 +132,12 @@ void SkPictureRecorder::partialReplay(SkCanvas* canvas) const {
     SkRecordDraw(*fRecord, canvas, nullptr, drawables, drawableCount, nullptr/*bbh*/, nullptr/*callback*/);
 }
 
-sk_sp<SkDrawable> SkPictureRecorder::finishRecordingAsDrawable() {
+sk_sp<SkDrawable> SkPictureRecorder::finishRecordingAsDrawable(uint32_t finishFlags) {
     fActivelyRecording = false;
     fRecorder->flushMiniRecorder();
     fRecorder->restoreToCount(1);  // If we were missing any restores, add them now.
 
-    SkRecordOptimize(fRecord.get());
+    this->optimize(finishFlags);
 
     if (fBBH) {
         SkAutoTMalloc<SkRect> bounds(fRecord->count());
@@ -7,6 +7,9 @@
 
 #include "src/core/SkRTree.h"
 
+#include "include/private/SkVx.h"
+#include "src/core/SkMathPriv.h"
+
 SkRTree::SkRTree() : fCount(0) {}
 
 void SkRTree::insert(const SkRect boundsArray[], int N) {
@@ -23,7 +26,7 @@ void SkRTree::insert(const SkRect boundsArray[], int N) {
 
         Branch b;
         b.fBounds = bounds;
-        b.fOpIndex = i;
+        b.fIndex = i;
         branches.push_back(b);
     }
 
@@ -31,11 +34,10 @@ void SkRTree::insert(const SkRect boundsArray[], int N) {
     if (fCount) {
         if (1 == fCount) {
             fNodes.reserve(1);
-            Node* n = this->allocateNodeAtLevel(0);
-            n->fNumChildren = 1;
-            n->fChildren[0] = branches[0];
-            fRoot.fSubtree = n;
-            fRoot.fBounds  = branches[0].fBounds;
+            int n = this->allocateNodeAtLevel(0);
+            fNodes[n].addChild(branches[0]);
+            fRoot.fIndex  = n;
+            fRoot.fBounds = branches[0].fBounds;
         } else {
             fNodes.reserve(CountNodes(fCount));
             fRoot = this->bulkLoad(&branches);
@@ -43,14 +45,29 @@ void SkRTree::insert(const SkRect boundsArray[], int N) {
     }
 }
 
-SkRTree::Node* SkRTree::allocateNodeAtLevel(uint16_t level) {
+int SkRTree::allocateNodeAtLevel(uint16_t level) {
     SkDEBUGCODE(Node* p = fNodes.data());
     fNodes.push_back(Node{});
     Node& out = fNodes.back();
     SkASSERT(fNodes.data() == p);  // If this fails, we didn't reserve() enough.
+    for (int i = 0; i < kLanes; i++) {
+        out.fLeft[i] = out.fTop[i]    = +SK_FloatInfinity;
+        out.fRight[i] = out.fBottom[i] = -SK_FloatInfinity;
+        out.fChildren[i] = -1;
+    }
     out.fNumChildren = 0;
     out.fLevel = level;
-    return &out;
+    return (int)fNodes.size() - 1;
+}
+
+void SkRTree::Node::addChild(const Branch& branch) {
+    SkASSERT(fNumChildren < kMaxChildren);
+    fLeft  [fNumChildren] = branch.fBounds.fLeft;
+    fTop   [fNumChildren] = branch.fBounds.fTop;
+    fRight [fNumChildren] = branch.fBounds.fRight;
+    fBottom[fNumChildren] = branch.fBounds.fBottom;
+    fChildren[fNumChildren] = branch.fIndex;
+    fNumChildren++;
 }
 
 // This function parallels bulkLoad, but just counts how many nodes bulkLoad would allocate.
@@ -125,17 +142,15 @@ SkRTree::Branch SkRTree::bulkLoad(std::vector<Branch>* branches, int level) {
                 remainder -= kMaxChildren - kMinChildren;
             }
         }
-        Node* n = allocateNodeAtLevel(level);
-        n->fNumChildren = 1;
-        n->fChildren[0] = (*branches)[currentBranch];
+        int n = this->allocateNodeAtLevel(level);
+        fNodes[n].addChild((*branches)[currentBranch]);
         Branch b;
         b.fBounds = (*branches)[currentBranch].fBounds;
-        b.fSubtree = n;
+        b.fIndex = n;
         ++currentBranch;
         for (int k = 1; k < incrementBy && currentBranch < (int)branches->size(); ++k) {
             b.fBounds.join((*branches)[currentBranch].fBounds);
-            n->fChildren[k] = (*branches)[currentBranch];
-            ++n->fNumChildren;
+            fNodes[n].addChild((*branches)[currentBranch]);
             ++currentBranch;
         }
         (*branches)[newBranches] = b;
@@ -146,18 +161,41 @@ SkRTree::Branch SkRTree::bulkLoad(std::vector<Branch>* branches, int level) {
 }
 
 void SkRTree::search(const SkRect& query, std::vector<int>* results) const {
-    if (fCount > 0 && SkRect::Intersects(fRoot.fBounds, query)) {
-        this->search(fRoot.fSubtree, query, results);
+    if (fCount == 0 || !SkRect::Intersects(fRoot.fBounds, query)) {
+        return;
     }
-}
 
-void SkRTree::search(Node* node, const SkRect& query, std::vector<int>* results) const {
-    for (int i = 0; i < node->fNumChildren; ++i) {
-        if (SkRect::Intersects(node->fChildren[i].fBounds, query)) {
-            if (0 == node->fLevel) {
-                results->push_back(node->fChildren[i].fOpIndex);
-            } else {
-                this->search(node->fChildren[i].fSubtree, query, results);
+    using F4 = skvx::Vec<4, float>;
+    const F4 qLeft = query.fLeft, qTop = query.fTop, qRight = query.fRight, qBottom = query.fBottom;
+
+    // Every level pushes at most kMaxChildren nodes, and a tree of 2^31 ops at kMinChildren
+    // per node is well under 16 levels deep.
+    int stack[16 * kMaxChildren];
+    int depth = 0;
+    stack[depth++] = fRoot.fIndex;
+    while (depth > 0) {
+        const Node& node = fNodes[stack[--depth]];
+
+        // Same test as SkRect::Intersects(), four children at a time.
+        uint32_t hits = 0;
+        for (int i = 0; i < kLanes; i += 4) {
+            F4 l = max(F4::Load(node.fLeft   + i), qLeft),
+               t = max(F4::Load(node.fTop    + i), qTop),
+               r = min(F4::Load(node.fRight  + i), qRight),
+               b = min(F4::Load(node.fBottom + i), qBottom);
+            auto bits = ((l < r) & (t < b)) & skvx::Vec<4, int32_t>{1, 2, 4, 8};
+            hits |= (uint32_t)(bits[0] | bits[1] | bits[2] | bits[3]) << i;
+        }
+
+        if (0 == node.fLevel) {
+            for (; hits; hits &= hits - 1) {
+                results->push_back(node.fChildren[SkCTZ(hits)]);
+            }
+        } else {
+            // Push in reverse so children pop, and results come out, in order.
+            for (; hits; hits &= ~(1u << (31 - SkCLZ(hits)))) {
+                SkASSERT(depth < (int)SK_ARRAY_COUNT(stack));
+                stack[depth++] = node.fChildren[31 - SkCLZ(hits)];
             }
         }
     }
@@ -11,6 +11,8 @@
 #include "include/core/SkBBHFactory.h"
 #include "include/core/SkRect.h"
 
+#include <vector>
+
 /**
  * An R-Tree implementation. In short, it is a balanced n-ary tree containing a hierarchy of
  * bounding rectangles.
@@ -18,6 +20,10 @@
  * It only supports bulk-loading, i.e. creation from a batch of bounding rectangles.
  * This performs a bottom-up bulk load using the STR (sort-tile-recursive) algorithm.
  *
+ * Nodes are stored flat in one array, each holding its children's bounds as four arrays of edges
+ * (left, top, right, bottom), so search() can test four children at a time with SIMD. search()
+ * walks the tree with an explicit stack, visiting children in order, so results come out sorted.
+ *
  * TODO: Experiment with other bulk-load algorithms (in particular the Hilbert pack variant,
  * which groups rects by position on the Hilbert curve, is probably worth a look). There also
  * exist top-down bulk load variants (VAMSplit, TopDownGreedy, etc).
@@ -38,7 +44,7 @@ public:
     // Methods and constants below here are only public for tests.
 
     // Return the depth of the tree structure.
-    int getDepth() const { return fCount ? fRoot.fSubtree->fLevel + 1 : 0; }
+    int getDepth() const { return fCount ? fNodes[fRoot.fIndex].fLevel + 1 : 0; }
     // Insertion count (not overall node count, which may be greater).
     int getCount() const { return fCount; }
 
@@ -47,23 +53,23 @@ public:
                      kMaxChildren = 11;
 
 private:
-    struct Node;
+    // Children per node, rounded up to a whole number of 4-wide SIMD tests.
+    static constexpr int kLanes = (kMaxChildren + 3) & ~3;
 
     struct Branch {
-        union {
-            Node* fSubtree;
-            int fOpIndex;
-        };
+        int fIndex;     // Into fNodes, or an op index at level 0.
         SkRect fBounds;
     };
 
     struct Node {
+        // Unused lanes are left inverted infinitely far out, so they never intersect a query.
+        float fLeft[kLanes], fTop[kLanes], fRight[kLanes], fBottom[kLanes];
+        int fChildren[kLanes];   // Into fNodes, or op indices at level 0.
         uint16_t fNumChildren;
         uint16_t fLevel;
-        Branch fChildren[kMaxChildren];
-    };
 
-    void search(Node* root, const SkRect& query, std::vector<int>* results) const;
+        void addChild(const Branch&);
+    };
 
     // Consumes the input array.
     Branch bulkLoad(std::vector<Branch>* branches, int level = 0);
@@ -71,7 +77,7 @@ private:
     // How many times will bulkLoad() call allocateNodeAtLevel()?
     static int CountNodes(int branches);
 
-    Node* allocateNodeAtLevel(uint16_t level);
+    int allocateNodeAtLevel(uint16_t level);
 
     // This is the count of data elements (rather than total nodes in the tree)
     int fCount;
@@ -299,6 +299,12 @@ sk_sp<SkData> SkReadBuffer::readByteArrayAsData() {
         return nullptr;
     }
 
+    if (fData) {
+        const char* bytes = (const char*)this->skipByteArray(nullptr);
+        return this->isValid() ? SkData::MakeSubset(fData.get(), bytes - fBase, numBytes)
+                               : nullptr;
+    }
+
     SkAutoMalloc buffer(numBytes);
     if (!this->readByteArray(buffer.get(), numBytes)) {
         return nullptr;
@@ -8,6 +8,7 @@
 #ifndef SkReadBuffer_DEFINED
 #define SkReadBuffer_DEFINED
 
+#include "include/core/SkData.h"
 #include "include/core/SkFont.h"
 #include "include/core/SkImageFilter.h"
 #include "include/core/SkPath.h"
@@ -27,7 +28,6 @@
 #include "include/core/SkDrawLooper.h"
 #endif
 
-class SkData;
 class SkImage;
 
 class SkReadBuffer {
@@ -36,6 +36,11 @@ public:
     SkReadBuffer(const void* data, size_t size) {
         this->setMemory(data, size);
     }
+    // Reads all of data, keeping a ref on it. readByteArrayAsData() (and so readImage()) then
+    // return subsets of data instead of copies.
+    explicit SkReadBuffer(sk_sp<SkData> data) : SkReadBuffer(data->data(), data->size()) {
+        fData = std::move(data);
+    }
 
     void setMemory(const void*, size_t);
 
@@ -218,6 +223,8 @@ private:
     const char* fStop = nullptr;  // end of buffer
     const char* fBase = nullptr;  // beginning of buffer
 
+    sk_sp<SkData> fData;          // owns [fBase, fStop), if set
+
     // Only used if we do not have an fFactoryArray.
     SkTHashMap<uint32_t, SkFlattenable::Factory> fFlattenableDict;
 
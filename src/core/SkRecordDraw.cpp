@@ -130,6 +130,16 @@ DRAW(DrawPicture, drawPicture(r.picture.get(), &r.matrix, r.paint));
 DRAW(DrawPoints, drawPoints(r.mode, r.count, r.pts, r.paint));
 DRAW(DrawRRect, drawRRect(r.rrect, r.paint));
 DRAW(DrawRect, drawRect(r.rect, r.paint));
+
+// SkCanvas has no call that draws many rects with one paint identically to drawing them one at a
+// time, so a merged run still costs one drawRect() per rect here. Merging only shrinks the record
+// and gives the run a single BBH entry.
+template <> void Draw::draw(const DrawRects& r) {
+    for (int i = 0; i < r.count; i++) {
+        fCanvas->drawRect(r.rects[i], r.paint);
+    }
+}
+
 DRAW(DrawRegion, drawRegion(r.region, r.paint));
 DRAW(DrawTextBlob, drawTextBlob(r.blob.get(), r.x, r.y, r.paint));
 DRAW(DrawAtlas, drawAtlas(r.atlas.get(), r.xforms, r.texs, r.colors, r.count, r.mode, r.sampling,
@@ -380,6 +390,13 @@ private:
     Bounds bounds(const NoOp&)  const { return Bounds::MakeEmpty(); }    // NoOps don't draw.
 
     Bounds bounds(const DrawRect& op) const { return this->adjustAndMap(op.rect, &op.paint); }
+    Bounds bounds(const DrawRects& op) const {
+        SkRect rect = SkRect::MakeEmpty();
+        for (int i = 0; i < op.count; i++) {
+            rect.join(this->adjustAndMap(op.rects[i], &op.paint));
+        }
+        return rect;
+    }
     Bounds bounds(const DrawRegion& op) const {
         SkRect rect = SkRect::Make(op.region.getBounds());
         return this->adjustAndMap(rect, &op.paint);
@@ -7,6 +7,8 @@
 
 #include "src/core/SkRecordOpts.h"
 
+#include "include/core/SkMaskFilter.h"
+#include "include/core/SkShader.h"
 #include "include/private/SkTDArray.h"
 #include "src/core/SkCanvasPriv.h"
 #include "src/core/SkRecordPattern.h"
@@ -280,6 +282,245 @@ void SkRecordMergeSvgOpacityAndFilterLayers(SkRecord* record) {
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
+// These passes walk the record directly rather than matching patterns: their runs are unbounded
+// and depend on comparing commands with each other.
+
+// Returns the i-th command if it's a T, or null.
+template <typename T>
+struct As {
+    T* operator()(T* record) { return record; }
+    template <typename U>
+    T* operator()(U*) { return nullptr; }
+};
+
+// Returns the index of the next command after i that isn't a NoOp, or record->count().
+static int next_command(SkRecord* record, int i) {
+    do {
+        i++;
+    } while (i < record->count() && record->mutate(i, As<NoOp>()));
+    return i;
+}
+
+static bool same_optional_paint(const SkPaint* a, const SkPaint* b) {
+    return a == b || (a && b && *a == *b);
+}
+
+static void merge_draw_rects(SkRecord* record, int begin, SkRecordOptStats* stats) {
+    DrawRect* first = record->mutate(begin, As<DrawRect>());
+    SkTDArray<int> run;
+    run.push_back(begin);
+    for (int i = next_command(record, begin); i < record->count(); i = next_command(record, i)) {
+        DrawRect* draw = record->mutate(i, As<DrawRect>());
+        if (!draw || draw->paint != first->paint) {
+            break;
+        }
+        run.push_back(i);
+    }
+    if (run.count() < 2) {
+        return;
+    }
+
+    SkRect* rects = record->alloc<SkRect>(run.count());
+    for (int i = 0; i < run.count(); i++) {
+        rects[i] = record->mutate(run[i], As<DrawRect>())->rect;
+    }
+    SkPaint paint = first->paint;
+    for (int i = 1; i < run.count(); i++) {
+        record->replace<NoOp>(run[i]);
+    }
+    new (record->replace<DrawRects>(begin)) DrawRects{std::move(paint), rects, run.count()};
+
+    stats->fMergedDraws += run.count();
+    stats->fBatches += 1;
+}
+
+// DrawEdgeAAImageSet draws each entry with the set's paint like drawImageRect() would, except
+// that an image filter or mask filter would apply to the whole set at once.
+static void merge_draw_image_rects(SkRecord* record, int begin, SkRecordOptStats* stats) {
+    DrawImageRect* first = record->mutate(begin, As<DrawImageRect>());
+    if (first->paint && (first->paint->getImageFilter() || first->paint->getMaskFilter())) {
+        return;
+    }
+    SkTDArray<int> run;
+    run.push_back(begin);
+    for (int i = next_command(record, begin); i < record->count(); i = next_command(record, i)) {
+        DrawImageRect* draw = record->mutate(i, As<DrawImageRect>());
+        if (!draw || !same_optional_paint(draw->paint, first->paint) ||
+            !(draw->sampling == first->sampling) || draw->constraint != first->constraint) {
+            break;
+        }
+        run.push_back(i);
+    }
+    if (run.count() < 2) {
+        return;
+    }
+
+    const unsigned aaFlags = first->paint && first->paint->isAntiAlias()
+                                   ? SkCanvas::kAll_QuadAAFlags
+                                   : SkCanvas::kNone_QuadAAFlags;
+    SkAutoTArray<SkCanvas::ImageSetEntry> set(run.count());
+    for (int i = 0; i < run.count(); i++) {
+        DrawImageRect* draw = record->mutate(run[i], As<DrawImageRect>());
+        set[i] = SkCanvas::ImageSetEntry(draw->image, draw->src, draw->dst, 1.f, aaFlags);
+    }
+    SkPaint* paint = first->paint ? new (record->alloc<SkPaint>()) SkPaint(*first->paint)
+                                  : nullptr;
+    const SkSamplingOptions sampling = first->sampling;
+    const SkCanvas::SrcRectConstraint constraint = first->constraint;
+    for (int i = 1; i < run.count(); i++) {
+        record->replace<NoOp>(run[i]);
+    }
+    new (record->replace<DrawEdgeAAImageSet>(begin)) DrawEdgeAAImageSet{
+            paint, std::move(set), run.count(), nullptr, nullptr, sampling, constraint};
+
+    stats->fMergedDraws += run.count();
+    stats->fBatches += 1;
+}
+
+void SkRecordMergeDraws(SkRecord* record, SkRecordOptStats* stats) {
+    SkRecordOptStats ignored;
+    stats = stats ? stats : &ignored;
+    for (int i = 0; i < record->count(); i++) {
+        if (record->mutate(i, As<DrawRect>())) {
+            merge_draw_rects(record, i, stats);
+        } else if (record->mutate(i, As<DrawImageRect>())) {
+            merge_draw_image_rects(record, i, stats);
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Does drawing with this paint leave no trace of what was under the covered pixels?
+static bool paint_replaces_dst(const SkPaint& paint) {
+    if (paint.getMaskFilter() || paint.getImageFilter() || paint.getColorFilter() ||
+        paint.getPathEffect()) {
+        return false;
+    }
+    switch (paint.getBlendMode()) {
+        case SkBlendMode::kClear:
+        case SkBlendMode::kSrc:
+            return true;
+        case SkBlendMode::kSrcOver:
+            return paint.getAlpha() == 0xFF && (!paint.getShader() || paint.getShader()->isOpaque());
+        default:
+            return false;
+    }
+}
+
+// Finds the pixels an occluder covers, or the ones an occludee might touch, in local space.
+// Only non-antialiased fills qualify: they touch exactly the pixels whose centers they contain,
+// so one contained in the other touches a subset of its pixels, whatever the matrix.
+struct CoverageBounds {
+    static bool NonAAFill(const SkPaint* paint) {
+        return !paint || (!paint->isAntiAlias() && paint->getStyle() == SkPaint::kFill_Style &&
+                          !paint->getMaskFilter() && !paint->getImageFilter() &&
+                          !paint->getPathEffect());
+    }
+
+    bool operator()(const DrawRect* op)  { return this->set(op->rect, &op->paint); }
+    bool operator()(const DrawRects* op) {
+        fBounds.setEmpty();
+        for (int i = 0; i < op->count; i++) {
+            fBounds.join(op->rects[i].makeSorted());
+        }
+        return NonAAFill(&op->paint);
+    }
+    bool operator()(const DrawOval* op)  { return this->set(op->oval, &op->paint); }
+    bool operator()(const DrawRRect* op) { return this->set(op->rrect.getBounds(), &op->paint); }
+    bool operator()(const DrawPath* op) {
+        return !op->path.isInverseFillType() && this->set(op->path.getBounds(), &op->paint);
+    }
+    bool operator()(const DrawImage* op) {
+        return this->set(SkRect::MakeXYWH(op->left, op->top,
+                                          op->image->width(), op->image->height()), op->paint);
+    }
+    bool operator()(const DrawImageRect* op) { return this->set(op->dst, op->paint); }
+    template <typename T>
+    bool operator()(const T*) { return false; }
+
+    bool set(const SkRect& bounds, const SkPaint* paint) {
+        fBounds = bounds.makeSorted();
+        return fBounds.isFinite() && NonAAFill(paint);
+    }
+
+    SkRect fBounds;
+};
+
+void SkRecordCullOverdrawnDraws(SkRecord* record, SkRecordOptStats* stats) {
+    SkRecordOptStats ignored;
+    stats = stats ? stats : &ignored;
+
+    // Walk backwards, remembering what the draws after this point (and before any change of
+    // matrix, clip or layer) will cover.
+    static constexpr int kMaxOccluders = 8;
+    SkRect occluders[kMaxOccluders];
+    int occluderCount = 0;
+    bool coversAll = false;
+
+    for (int i = record->count() - 1; i >= 0; i--) {
+        if (record->mutate(i, As<NoOp>()) || record->mutate(i, As<DrawAnnotation>())) {
+            continue;
+        }
+        bool isDraw = record->visit(i, [](const auto& op) {
+            return SkToBool(std::remove_reference_t<decltype(op)>::kTags & kDraw_Tag);
+        });
+        // Pictures and drawables may hold layers, and a layer's backdrop filter or blend mode can
+        // read (and spread) the pixels under it, so they end the search like a layer would.
+        bool mayHoldLayers = record->mutate(i, As<DrawPicture>()) ||
+                             record->mutate(i, As<DrawDrawable>());
+        if (!isDraw || mayHoldLayers) {
+            occluderCount = 0;
+            coversAll = false;
+            continue;
+        }
+
+        CoverageBounds coverage;
+        if (record->mutate(i, [&](auto* op) { return coverage(op); })) {
+            bool covered = coversAll;
+            for (int j = 0; !covered && j < occluderCount; j++) {
+                covered = occluders[j].contains(coverage.fBounds);
+            }
+            if (covered) {
+                record->replace<NoOp>(i);
+                stats->fCulledDraws += 1;
+                continue;
+            }
+        }
+
+        if (DrawPaint* op = record->mutate(i, As<DrawPaint>())) {
+            coversAll |= paint_replaces_dst(op->paint);
+        } else if (DrawRect* op = record->mutate(i, As<DrawRect>())) {
+            SkRect rect = op->rect.makeSorted();
+            if (CoverageBounds::NonAAFill(&op->paint) && paint_replaces_dst(op->paint) &&
+                rect.isFinite() && !rect.isEmpty()) {
+                // Keep the biggest occluders.
+                if (occluderCount < kMaxOccluders) {
+                    occluders[occluderCount++] = rect;
+                } else {
+                    SkRect* smallest = std::min_element(occluders, occluders + kMaxOccluders,
+                            [](const SkRect& a, const SkRect& b) {
+                                return a.width() * a.height() < b.width() * b.height();
+                            });
+                    if (smallest->width() * smallest->height() < rect.width() * rect.height()) {
+                        *smallest = rect;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void SkRecordOptimizeForPlayback(SkRecord* record, SkRecordOptStats* stats) {
+    SkRecordOptimize(record);
+    // Cull first, so occluded draws don't break up runs of otherwise mergeable ones.
+    SkRecordCullOverdrawnDraws(record, stats);
+    SkRecordMergeDraws(record, stats);
+    record->defrag();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
 void SkRecordOptimize(SkRecord* record) {
     // This might be useful  as a first pass in the future if we want to weed
     // out junk for other optimization passes.  Right now, nothing needs it,
@@ -301,7 +542,7 @@ void SkRecordOptimize(SkRecord* record) {
     record->defrag();
 }
 
-void SkRecordOptimize2(SkRecord* record) {
+void SkRecordOptimize2(SkRecord* record, SkRecordOptStats* stats) {
     multiple_set_matrices(record);
     SkRecordNoopSaveRestores(record);
     // See why we turn this off in SkRecordOptimize above.
@@ -309,6 +550,8 @@ void SkRecordOptimize2(SkRecord* record) {
     SkRecordNoopSaveLayerDrawRestores(record);
 #endif
     SkRecordMergeSvgOpacityAndFilterLayers(record);
+    SkRecordCullOverdrawnDraws(record, stats);
+    SkRecordMergeDraws(record, stats);
 
     record->defrag();
 }
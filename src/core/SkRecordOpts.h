@@ -10,9 +10,31 @@
 
 #include "src/core/SkRecord.h"
 
+// Counts of what the playback optimizations below changed.
+struct SkRecordOptStats {
+    int fMergedDraws = 0;   // Draws folded into a batched DrawRects or DrawEdgeAAImageSet.
+    int fBatches     = 0;   // Batched draws created.
+    int fCulledDraws = 0;   // Draws removed because a later opaque draw covers them.
+};
+
 // Run all optimizations in recommended order.
 void SkRecordOptimize(SkRecord*);
 
+// SkRecordOptimize(), then the passes below that trade recording time for playback speed.
+void SkRecordOptimizeForPlayback(SkRecord*, SkRecordOptStats* = nullptr);
+
+// Merges runs of DrawRects sharing a paint into one DrawRects, and runs of DrawImageRects sharing
+// a paint, sampling and constraint into one DrawEdgeAAImageSet. Playback draws the same pixels.
+// A DrawRects still plays back as one drawRect() per rect, so merging rects only shrinks the
+// record and its BBH; image sets reach the canvas as one batched call.
+void SkRecordMergeDraws(SkRecord*, SkRecordOptStats* = nullptr);
+
+// Turns draws that a later opaque, non-antialiased fill rect (or a paint) will completely cover
+// into no-ops, when no matrix, clip or layer change, picture or drawable comes between them. Exact
+// unless playback is clipped with antialiasing, where the covered draws could show through
+// partial edge pixels.
+void SkRecordCullOverdrawnDraws(SkRecord*, SkRecordOptStats* = nullptr);
+
 // Turns logical no-op Save-[non-drawing command]*-Restore patterns into actual no-ops.
 void SkRecordNoopSaveRestores(SkRecord*);
 
@@ -27,6 +49,6 @@ void SkRecordNoopSaveLayerDrawRestores(SkRecord*);
 void SkRecordMergeSvgOpacityAndFilterLayers(SkRecord*);
 
 // Experimental optimizers
-void SkRecordOptimize2(SkRecord*);
+void SkRecordOptimize2(SkRecord*, SkRecordOptStats* = nullptr);
 
 #endif//SkRecordOpts_DEFINED
@@ -72,6 +72,7 @@ namespace SkRecords {
     M(DrawPoints)                                                   \
     M(DrawRRect)                                                    \
     M(DrawRect)                                                     \
+    M(DrawRects)                                                    \
     M(DrawRegion)                                                   \
     M(DrawTextBlob)                                                 \
     M(DrawAtlas)                                                    \
@@ -285,6 +286,12 @@ RECORD(DrawRRect, kDraw_Tag|kHasPaint_Tag,
 RECORD(DrawRect, kDraw_Tag|kHasPaint_Tag,
         SkPaint paint;
         SkRect rect);
+// Not recorded directly: SkRecordMergeDraws() makes these from runs of DrawRects sharing a paint.
+// Played back as one drawRect() per rect.
+RECORD(DrawRects, kDraw_Tag|kHasPaint_Tag,
+        SkPaint paint;
+        PODArray<SkRect> rects;
+        int count);
 RECORD(DrawRegion, kDraw_Tag|kHasPaint_Tag,
         SkPaint paint;
         SkRegion region);
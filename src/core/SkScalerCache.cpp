@@ -12,6 +12,10 @@
 #include "include/core/SkTypeface.h"
 #include "src/core/SkEnumerate.h"
 #include "src/core/SkScalerContext.h"
+#include "src/core/SkTaskGroup.h"
+
+// Each parallel task makes its own scaler context, so it should have enough glyphs to pay for that.
+static constexpr int kGlyphsPerTask = 16;
 
 static SkFontMetrics use_or_generate_metrics(
         const SkFontMetrics* metrics, SkScalerContext* context) {
@@ -27,12 +31,16 @@ static SkFontMetrics use_or_generate_metrics(
 SkScalerCache::SkScalerCache(
     const SkDescriptor& desc,
     std::unique_ptr<SkScalerContext> scaler,
-    const SkFontMetrics* fontMetrics)
+    const SkFontMetrics* fontMetrics,
+    sk_sp<SkData> persistentKey,
+    std::unique_ptr<SkPersistentStrike> persistent)
         : fDesc{desc}
         , fScalerContext{std::move(scaler)}
         , fFontMetrics{use_or_generate_metrics(fontMetrics, fScalerContext.get())}
         , fRoundingSpec{fScalerContext->isSubpixel(),
-                        fScalerContext->computeAxisAlignmentForHText()} {
+                        fScalerContext->computeAxisAlignmentForHText()}
+        , fPersistentKey{std::move(persistentKey)}
+        , fPersistent{std::move(persistent)} {
     SkASSERT(fScalerContext != nullptr);
 }
 
@@ -48,7 +56,11 @@ std::tuple<SkGlyphDigest, size_t> SkScalerCache::digest(SkPackedGlyphID packedGl
         return {*digest, 0};
     }
 
-    SkGlyph* glyph = fAlloc.make<SkGlyph>(fScalerContext->makeGlyph(packedGlyphID));
+    SkGlyph* glyph = fAlloc.make<SkGlyph>(packedGlyphID);
+    if (!fPersistent || !fPersistent->findGlyph(packedGlyphID, glyph)) {
+        *glyph = fScalerContext->makeGlyph(packedGlyphID);
+        fHasUnstoredGlyphs = true;
+    }
     return {this->addGlyph(glyph), sizeof(SkGlyph)};
 }
 
@@ -62,8 +74,16 @@ SkGlyphDigest SkScalerCache::addGlyph(SkGlyph* glyph) {
 
 std::tuple<const SkPath*, size_t> SkScalerCache::preparePath(SkGlyph* glyph) {
     size_t delta = 0;
-    if (glyph->setPath(&fAlloc, fScalerContext.get())) {
+    SkPath path;
+    bool hasPath;
+    if (fPersistent && !glyph->setPathHasBeenCalled() &&
+        fPersistent->findPath(glyph->getPackedID(), &path, &hasPath)) {
+        if (glyph->setPath(&fAlloc, hasPath ? &path : nullptr)) {
+            delta = glyph->path()->approximateBytesUsed();
+        }
+    } else if (glyph->setPath(&fAlloc, fScalerContext.get())) {
         delta = glyph->path()->approximateBytesUsed();
+        fHasUnstoredGlyphs = true;
     }
     return {glyph->path(), delta};
 }
@@ -105,12 +125,96 @@ std::tuple<SkSpan<const SkGlyph*>, size_t> SkScalerCache::internalPrepare(
 
 std::tuple<const void*, size_t> SkScalerCache::prepareImage(SkGlyph* glyph) {
     size_t delta = 0;
-    if (glyph->setImage(&fAlloc, fScalerContext.get())) {
+    if (this->loadImage(glyph)) {
         delta = glyph->imageSize();
+    } else if (glyph->setImage(&fAlloc, fScalerContext.get())) {
+        delta = glyph->imageSize();
+        fHasUnstoredGlyphs |= glyph->image() != nullptr;
     }
     return {glyph->image(), delta};
 }
 
+bool SkScalerCache::loadImage(SkGlyph* glyph) {
+    if (fPersistent && !glyph->setImageHasBeenCalled()) {
+        if (const void* image = fPersistent->findImage(glyph->getPackedID())) {
+            return glyph->setImage(&fAlloc, image);
+        }
+    }
+    return false;
+}
+
+bool SkScalerCache::rasterizeInParallel(SkSpan<SkGlyph*> glyphs, SkExecutor* executor,
+                                        size_t* delta) {
+    const int count = SkToInt(glyphs.size());
+    if (!executor || count < 2 * kGlyphsPerTask) {
+        return false;
+    }
+
+    // The tasks rasterize copies of the glyphs, so readers never see a half-written image.
+    std::vector<SkGlyph> copies;
+    {
+        SkAutoMutexExclusive lock{fMu};
+        copies.reserve(count);
+        for (SkGlyph* glyph : glyphs) {
+            copies.push_back(*glyph);
+        }
+    }
+
+    const SkTypeface* typeface = fScalerContext->getTypeface();
+    const SkScalerContextEffects effects = fScalerContext->getEffects();
+    std::atomic<size_t> imageDelta{0};
+    SkTaskGroup(*executor).batch((count + kGlyphsPerTask - 1) / kGlyphsPerTask, [&](int task) {
+        const int begin = task * kGlyphsPerTask,
+                  end   = std::min(begin + kGlyphsPerTask, count);
+        std::unique_ptr<SkScalerContext> scaler =
+                typeface->createScalerContext(effects, fDesc.getDesc());
+        SkArenaAlloc alloc{kMinAllocAmount};
+        for (int i = begin; i < end; ++i) {
+            copies[i].setImage(&alloc, scaler.get());
+        }
+
+        SkAutoMutexExclusive lock{fMu};
+        size_t taskDelta = 0;
+        for (int i = begin; i < end; ++i) {
+            if (copies[i].image() && glyphs[i]->setImage(&fAlloc, copies[i].image())) {
+                taskDelta += glyphs[i]->imageSize();
+                fHasUnstoredGlyphs = true;
+            }
+        }
+        imageDelta += taskDelta;
+    });
+    *delta += imageDelta.load();
+    return true;
+}
+
+size_t SkScalerCache::prefetchImages(SkSpan<const SkPackedGlyphID> glyphIDs,
+                                     SkExecutor* executor) {
+    SkTDArray<SkGlyph*> missing;
+    size_t delta = 0;
+    {
+        SkAutoMutexExclusive lock{fMu};
+        SkTHashSet<SkGlyph*> seen;
+        for (SkPackedGlyphID glyphID : glyphIDs) {
+            auto [glyph, size] = this->glyph(glyphID);
+            delta += size;
+            if (this->loadImage(glyph)) {
+                delta += glyph->imageSize();
+            } else if (!glyph->setImageHasBeenCalled() && !seen.contains(glyph)) {
+                seen.add(glyph);
+                missing.push_back(glyph);
+            }
+        }
+    }
+    if (!this->rasterizeInParallel({missing.begin(), missing.size()}, executor, &delta)) {
+        SkAutoMutexExclusive lock{fMu};
+        for (SkGlyph* glyph : missing) {
+            auto [_, imageSize] = this->prepareImage(glyph);
+            delta += imageSize;
+        }
+    }
+    return delta;
+}
+
 std::tuple<SkGlyph*, size_t> SkScalerCache::mergeGlyphAndImage(
         SkPackedGlyphID toID, const SkGlyph& from) {
     SkAutoMutexExclusive lock{fMu};
@@ -174,7 +278,45 @@ size_t SkScalerCache::commonFilterLoop(SkDrawableGlyphBuffer* drawables, Fn&& fn
     return total;
 }
 
-size_t SkScalerCache::prepareForDrawingMasksCPU(SkDrawableGlyphBuffer* drawables) {
+size_t SkScalerCache::prepareForDrawingMasksCPU(SkDrawableGlyphBuffer* drawables,
+                                                SkExecutor* executor) {
+    // Too few glyphs could be missing to rasterize them in parallel, so skip collecting them.
+    if (executor && drawables->input().size() >= 2 * kGlyphsPerTask) {
+        // Find the glyphs to draw and those missing an image, rasterize the missing ones in
+        // parallel, then add the glyphs to the drawables in their original order.
+        std::vector<std::pair<size_t, SkGlyph*>> toDraw;
+        SkTDArray<SkGlyph*> missing;
+        size_t delta, storedDelta = 0;
+        {
+            SkAutoMutexExclusive lock{fMu};
+            SkTHashSet<SkGlyph*> seen;
+            delta = this->commonFilterLoop(drawables,
+                [&](size_t i, SkGlyphDigest digest, SkPoint pos) SK_REQUIRES(fMu) {
+                    SkGlyph* glyph = fGlyphForIndex[digest.index()];
+                    toDraw.push_back({i, glyph});
+                    if (this->loadImage(glyph)) {
+                        storedDelta += glyph->imageSize();
+                    } else if (!glyph->setImageHasBeenCalled() && !seen.contains(glyph)) {
+                        seen.add(glyph);
+                        missing.push_back(glyph);
+                    }
+                });
+        }
+        delta += storedDelta;
+        this->rasterizeInParallel({missing.begin(), missing.size()}, executor, &delta);
+
+        SkAutoMutexExclusive lock{fMu};
+        for (auto [i, glyph] : toDraw) {
+            // If the glyph is too large, then no image is created.
+            auto [image, imageSize] = this->prepareImage(glyph);
+            if (image != nullptr) {
+                drawables->push_back(glyph, i);
+                delta += imageSize;
+            }
+        }
+        return delta;
+    }
+
     SkAutoMutexExclusive lock{fMu};
     size_t imageDelta = 0;
     size_t delta = this->commonFilterLoop(drawables,
@@ -254,6 +396,22 @@ void SkScalerCache::findIntercepts(const SkScalar bounds[2], SkScalar scale, SkS
     glyph->ensureIntercepts(bounds, scale, xPos, array, count, &fAlloc);
 }
 
+void SkScalerCache::storeGlyphs(SkGraphics::GlyphCache* cache) {
+    sk_sp<SkData> data;
+    {
+        SkAutoMutexExclusive lock{fMu};
+        if (!fPersistentKey || !fHasUnstoredGlyphs) {
+            return;
+        }
+        data = SkPersistentStrike::Serialize(*fPersistentKey, fFontMetrics,
+                                             SkMakeSpan(fGlyphForIndex), fPersistent.get());
+        fHasUnstoredGlyphs = false;
+    }
+    if (data) {
+        cache->store(*fPersistentKey, *data);
+    }
+}
+
 void SkScalerCache::dump() const {
     SkAutoMutexExclusive lock{fMu};
     const SkTypeface* face = fScalerContext->getTypeface();
@@ -9,6 +9,7 @@
 
 #include "include/core/SkFontMetrics.h"
 #include "include/core/SkFontTypes.h"
+#include "include/core/SkGraphics.h"
 #include "include/private/SkMutex.h"
 #include "include/private/SkTHash.h"
 #include "include/private/SkTemplates.h"
@@ -16,9 +17,11 @@
 #include "src/core/SkDescriptor.h"
 #include "src/core/SkGlyph.h"
 #include "src/core/SkGlyphRunPainter.h"
+#include "src/core/SkPersistentStrike.h"
 #include "src/core/SkStrikeForGPU.h"
 #include <memory>
 
+class SkExecutor;
 class SkScalerContext;
 
 // The value stored in fDigestForPackedGlyphID.
@@ -54,7 +57,9 @@ class SkScalerCache {
 public:
     SkScalerCache(const SkDescriptor& desc,
                   std::unique_ptr<SkScalerContext> scaler,
-                  const SkFontMetrics* metrics = nullptr);
+                  const SkFontMetrics* metrics = nullptr,
+                  sk_sp<SkData> persistentKey = nullptr,
+                  std::unique_ptr<SkPersistentStrike> persistent = nullptr);
 
     // Lookup (or create if needed) the toGlyph using toID. If that glyph is not initialized with
     // an image, then use the information in from to initialize the width, height top, left,
@@ -89,7 +94,17 @@ public:
     std::tuple<SkSpan<const SkGlyph*>, size_t> prepareImages(
             SkSpan<const SkPackedGlyphID> glyphIDs, const SkGlyph* results[]) SK_EXCLUDES(fMu);
 
-    size_t prepareForDrawingMasksCPU(SkDrawableGlyphBuffer* drawables) SK_EXCLUDES(fMu);
+    // Generates the images of any of these glyphs that do not have one yet. When there are enough
+    // of them, they are rasterized in parallel on executor, each task with its own scaler context.
+    // This waits for executor, so it must not be one this thread is running a task on; that is
+    // never true of SkGraphicsExecutor().
+    size_t prefetchImages(
+            SkSpan<const SkPackedGlyphID> glyphIDs, SkExecutor* executor) SK_EXCLUDES(fMu);
+
+    // If executor is not null and there are enough glyphs to draw, the missing images are
+    // rasterized as by prefetchImages().
+    size_t prepareForDrawingMasksCPU(
+            SkDrawableGlyphBuffer* drawables, SkExecutor* executor = nullptr) SK_EXCLUDES(fMu);
 
     // SkStrikeForGPU APIs
     const SkGlyphPositionRoundingSpec& roundingSpec() const {
@@ -111,6 +126,10 @@ public:
 
     SkScalerContext* getScalerContext() const { return fScalerContext.get(); }
 
+    // If this strike has a persistent key and glyphs that were made by its scaler since it was
+    // created or last stored, stores all of its glyphs, along with the ones it was created with.
+    void storeGlyphs(SkGraphics::GlyphCache* cache) SK_EXCLUDES(fMu);
+
 private:
     template <typename Fn>
     size_t commonFilterLoop(SkDrawableGlyphBuffer* drawables, Fn&& fn) SK_REQUIRES(fMu);
@@ -126,6 +145,14 @@ private:
 
     std::tuple<const void*, size_t> prepareImage(SkGlyph* glyph) SK_REQUIRES(fMu);
 
+    // Sets the glyph's image from fPersistent if it has one. Returns true if the image was set.
+    bool loadImage(SkGlyph* glyph) SK_REQUIRES(fMu);
+
+    // Sets the images of glyphs, none of which has had setImage() called. Returns false, doing
+    // nothing, if there are too few of them to be worth rasterizing in parallel.
+    bool rasterizeInParallel(SkSpan<SkGlyph*> glyphs, SkExecutor* executor, size_t* delta)
+            SK_EXCLUDES(fMu);
+
     // If the path has never been set, then use the scaler context to add the glyph.
     std::tuple<const SkPath*, size_t> preparePath(SkGlyph*) SK_REQUIRES(fMu);
 
@@ -145,6 +172,11 @@ private:
     const SkFontMetrics                    fFontMetrics;
     const SkGlyphPositionRoundingSpec      fRoundingSpec;
 
+    // The glyphs stored for this strike by an earlier process, if any. Glyphs, images and paths
+    // are copied out of it as they are asked for, instead of being made by fScalerContext.
+    const sk_sp<SkData>                       fPersistentKey;
+    const std::unique_ptr<SkPersistentStrike> fPersistent;
+
     mutable SkMutex fMu;
 
     // Map from a combined GlyphID and sub-pixel position to a SkGlyphDigest. The actual glyph is
@@ -155,6 +187,9 @@ private:
     SkTHashMap<SkPackedGlyphID, SkGlyphDigest> fDigestForPackedGlyphID SK_GUARDED_BY(fMu);
     std::vector<SkGlyph*> fGlyphForIndex SK_GUARDED_BY(fMu);
 
+    // Set when fScalerContext makes a glyph, image or path, so storeGlyphs() has work to do.
+    bool fHasUnstoredGlyphs SK_GUARDED_BY(fMu) = false;
+
     // so we don't grow our arrays a lot
     static constexpr size_t kMinGlyphCount = 8;
     static constexpr size_t kMinGlyphImageSize = 16 /* height */ * 8 /* width */;
@@ -16,6 +16,7 @@
 #include "include/private/SkMutex.h"
 #include "include/private/SkTemplates.h"
 #include "src/core/SkGlyphRunPainter.h"
+#include "src/core/SkPersistentStrike.h"
 #include "src/core/SkScalerCache.h"
 
 bool gSkUseThreadLocalStrikeCaches_IAcknowledgeThisIsIncrediblyExperimental = false;
@@ -31,19 +32,69 @@ SkStrikeCache* SkStrikeCache::GlobalStrikeCache() {
     return cache;
 }
 
+// Locks a shard, counting how often the lock is taken and how often that means waiting.
+class SK_SCOPED_CAPABILITY SkStrikeCache::AutoShardLock {
+public:
+    AutoShardLock(const Shard& shard) SK_ACQUIRE(shard.fLock) : fShard{shard} {
+        if (!fShard.fLock.tryAcquire()) {
+            fShard.fLockContentions.fetch_add(1, std::memory_order_relaxed);
+            fShard.fLock.acquire();
+        }
+        fShard.fLockAcquires.fetch_add(1, std::memory_order_relaxed);
+    }
+    ~AutoShardLock() SK_RELEASE_CAPABILITY() { fShard.fLock.release(); }
+
+private:
+    const Shard& fShard;
+};
+
 auto SkStrikeCache::findOrCreateStrike(const SkDescriptor& desc,
                                        const SkScalerContextEffects& effects,
                                        const SkTypeface& typeface) -> sk_sp<Strike> {
-    SkAutoMutexExclusive ac(fLock);
-    sk_sp<Strike> strike = this->internalFindStrikeOrNull(desc);
+    SkGraphics::GlyphCache* glyphCache = this->glyphCache();
+    sk_sp<Strike> strike;
+    {
+        Shard& shard = this->shardFor(desc);
+        AutoShardLock lock{shard};
+        strike = this->internalFindStrikeOrNull(shard, desc);
+        if (strike == nullptr && glyphCache == nullptr) {
+            auto scaler = typeface.createScalerContext(effects, &desc);
+            strike = this->internalCreateStrike(shard, desc, std::move(scaler));
+        }
+    }
     if (strike == nullptr) {
-        auto scaler = typeface.createScalerContext(effects, &desc);
-        strike = this->internalCreateStrike(desc, std::move(scaler));
+        strike = this->findOrCreatePersistentStrike(glyphCache, desc, effects, typeface);
     }
-    this->internalPurge();
+    this->purge();
     return strike;
 }
 
+auto SkStrikeCache::findOrCreatePersistentStrike(SkGraphics::GlyphCache* glyphCache,
+                                                 const SkDescriptor& desc,
+                                                 const SkScalerContextEffects& effects,
+                                                 const SkTypeface& typeface) -> sk_sp<Strike> {
+    sk_sp<SkData> key = SkPersistentStrike::MakeKey(desc, typeface);
+    std::unique_ptr<SkPersistentStrike> persistent;
+    if (key) {
+        persistent = SkPersistentStrike::Make(glyphCache->load(*key), *key);
+    }
+
+    Shard& shard = this->shardFor(desc);
+    AutoShardLock lock{shard};
+    // Another thread may have made the strike while this one was loading.
+    if (sk_sp<Strike> strike = this->internalFindStrikeOrNull(shard, desc)) {
+        return strike;
+    }
+    auto scaler = typeface.createScalerContext(effects, &desc);
+    SkFontMetrics metrics;
+    if (persistent) {
+        metrics = persistent->fontMetrics();
+    }
+    return this->internalCreateStrike(shard, desc, std::move(scaler),
+                                      persistent ? &metrics : nullptr, nullptr,
+                                      std::move(key), std::move(persistent));
+}
+
 SkScopedStrikeForGPU SkStrikeCache::findOrCreateScopedStrike(const SkDescriptor& desc,
                                                              const SkScalerContextEffects& effects,
                                                              const SkTypeface& typeface) {
@@ -87,6 +138,12 @@ void SkStrikeCache::DumpMemoryStatistics(SkTraceMemoryDump* dump) {
     dump->dumpNumericValue(gGlyphCacheDumpName, "budget_glyph_count", "objects",
                            SkGraphics::GetFontCacheCountLimit());
 
+    SkStrikeCache::LockStats lockStats = GlobalStrikeCache()->getLockStats();
+    dump->dumpNumericValue(gGlyphCacheDumpName, "lock_acquire_count", "objects",
+                           lockStats.fAcquires);
+    dump->dumpNumericValue(gGlyphCacheDumpName, "lock_contention_count", "objects",
+                           lockStats.fContentions);
+
     if (dump->getRequestedDetails() == SkTraceMemoryDump::kLight_LevelOfDetail) {
         dump->setMemoryBacking(gGlyphCacheDumpName, "malloc", nullptr);
         return;
@@ -120,34 +177,41 @@ void SkStrikeCache::DumpMemoryStatistics(SkTraceMemoryDump* dump) {
 }
 
 sk_sp<SkStrike> SkStrikeCache::findStrike(const SkDescriptor& desc) {
-    SkAutoMutexExclusive ac(fLock);
-    sk_sp<SkStrike> result = this->internalFindStrikeOrNull(desc);
-    this->internalPurge();
+    sk_sp<SkStrike> result;
+    {
+        Shard& shard = this->shardFor(desc);
+        AutoShardLock lock{shard};
+        result = this->internalFindStrikeOrNull(shard, desc);
+    }
+    this->purge();
     return result;
 }
 
-auto SkStrikeCache::internalFindStrikeOrNull(const SkDescriptor& desc) -> sk_sp<Strike> {
+auto SkStrikeCache::internalFindStrikeOrNull(Shard& shard, const SkDescriptor& desc)
+        -> sk_sp<Strike> {
 
     // Check head because it is likely the strike we are looking for.
-    if (fHead != nullptr && fHead->getDescriptor() == desc) { return sk_ref_sp(fHead); }
+    if (shard.fHead != nullptr && shard.fHead->getDescriptor() == desc) {
+        return sk_ref_sp(shard.fHead);
+    }
 
     // Do the heavy search looking for the strike.
-    sk_sp<Strike>* strikeHandle = fStrikeLookup.find(desc);
+    sk_sp<Strike>* strikeHandle = shard.fStrikeLookup.find(desc);
     if (strikeHandle == nullptr) { return nullptr; }
     Strike* strikePtr = strikeHandle->get();
     SkASSERT(strikePtr != nullptr);
-    if (fHead != strikePtr) {
+    if (shard.fHead != strikePtr) {
         // Make most recently used
         strikePtr->fPrev->fNext = strikePtr->fNext;
         if (strikePtr->fNext != nullptr) {
             strikePtr->fNext->fPrev = strikePtr->fPrev;
         } else {
-            fTail = strikePtr->fPrev;
+            shard.fTail = strikePtr->fPrev;
         }
-        fHead->fPrev = strikePtr;
-        strikePtr->fNext = fHead;
+        shard.fHead->fPrev = strikePtr;
+        strikePtr->fNext = shard.fHead;
         strikePtr->fPrev = nullptr;
-        fHead = strikePtr;
+        shard.fHead = strikePtr;
     }
     return sk_ref_sp(strikePtr);
 }
@@ -157,53 +221,89 @@ sk_sp<SkStrike> SkStrikeCache::createStrike(
         std::unique_ptr<SkScalerContext> scaler,
         SkFontMetrics* maybeMetrics,
         std::unique_ptr<SkStrikePinner> pinner) {
-    SkAutoMutexExclusive ac(fLock);
-    return this->internalCreateStrike(desc, std::move(scaler), maybeMetrics, std::move(pinner));
+    Shard& shard = this->shardFor(desc);
+    AutoShardLock lock{shard};
+    return this->internalCreateStrike(
+            shard, desc, std::move(scaler), maybeMetrics, std::move(pinner));
 }
 
 auto SkStrikeCache::internalCreateStrike(
+        Shard& shard,
         const SkDescriptor& desc,
         std::unique_ptr<SkScalerContext> scaler,
         SkFontMetrics* maybeMetrics,
-        std::unique_ptr<SkStrikePinner> pinner) -> sk_sp<Strike> {
-    auto strike =
-            sk_make_sp<Strike>(this, desc, std::move(scaler), maybeMetrics, std::move(pinner));
-    this->internalAttachToHead(strike);
+        std::unique_ptr<SkStrikePinner> pinner,
+        sk_sp<SkData> persistentKey,
+        std::unique_ptr<SkPersistentStrike> persistent) -> sk_sp<Strike> {
+    auto strike = sk_make_sp<Strike>(this, desc, std::move(scaler), maybeMetrics,
+                                     std::move(pinner), std::move(persistentKey),
+                                     std::move(persistent));
+    this->internalAttachToHead(shard, strike);
     return strike;
 }
 
 void SkStrikeCache::purgeAll() {
-    SkAutoMutexExclusive ac(fLock);
-    this->internalPurge(fTotalMemoryUsed);
+    std::vector<sk_sp<Strike>> toStore;
+    for (Shard& shard : fShards) {
+        AutoShardLock lock{shard};
+        this->internalPurge(shard, shard.fMemoryUsed, shard.fCacheCount, &toStore);
+    }
+    this->storeGlyphs(toStore);
+}
+
+void SkStrikeCache::flushGlyphCache() {
+    if (this->glyphCache() == nullptr) {
+        return;
+    }
+    std::vector<sk_sp<Strike>> toStore;
+    for (Shard& shard : fShards) {
+        AutoShardLock lock{shard};
+        for (Strike* strike = shard.fHead; strike != nullptr; strike = strike->fNext) {
+            toStore.push_back(sk_ref_sp(strike));
+        }
+    }
+    this->storeGlyphs(toStore);
+}
+
+void SkStrikeCache::setGlyphCacheForTesting(SkGraphics::GlyphCache* glyphCache) {
+    fGlyphCacheForTesting.store(glyphCache);
+}
+
+SkGraphics::GlyphCache* SkStrikeCache::glyphCache() const {
+    if (SkGraphics::GlyphCache* glyphCache = fGlyphCacheForTesting.load()) {
+        return glyphCache;
+    }
+    return gSkGlyphCache.load(std::memory_order_relaxed);
+}
+
+void SkStrikeCache::storeGlyphs(const std::vector<sk_sp<Strike>>& strikes) {
+    if (SkGraphics::GlyphCache* glyphCache = this->glyphCache()) {
+        for (const sk_sp<Strike>& strike : strikes) {
+            strike->fScalerCache.storeGlyphs(glyphCache);
+        }
+    }
 }
 
 size_t SkStrikeCache::getTotalMemoryUsed() const {
-    SkAutoMutexExclusive ac(fLock);
-    return fTotalMemoryUsed;
+    return fTotalMemoryUsed.load(std::memory_order_relaxed);
 }
 
 int SkStrikeCache::getCacheCountUsed() const {
-    SkAutoMutexExclusive ac(fLock);
-    return fCacheCount;
+    return fCacheCount.load(std::memory_order_relaxed);
 }
 
 int SkStrikeCache::getCacheCountLimit() const {
-    SkAutoMutexExclusive ac(fLock);
-    return fCacheCountLimit;
+    return fCacheCountLimit.load(std::memory_order_relaxed);
 }
 
 size_t SkStrikeCache::setCacheSizeLimit(size_t newLimit) {
-    SkAutoMutexExclusive ac(fLock);
-
-    size_t prevLimit = fCacheSizeLimit;
-    fCacheSizeLimit = newLimit;
-    this->internalPurge();
+    size_t prevLimit = fCacheSizeLimit.exchange(newLimit);
+    this->purge();
     return prevLimit;
 }
 
 size_t  SkStrikeCache::getCacheSizeLimit() const {
-    SkAutoMutexExclusive ac(fLock);
-    return fCacheSizeLimit;
+    return fCacheSizeLimit.load(std::memory_order_relaxed);
 }
 
 int SkStrikeCache::setCacheCountLimit(int newCount) {
@@ -211,40 +311,53 @@ int SkStrikeCache::setCacheCountLimit(int newCount) {
         newCount = 0;
     }
 
-    SkAutoMutexExclusive ac(fLock);
-
-    int prevCount = fCacheCountLimit;
-    fCacheCountLimit = newCount;
-    this->internalPurge();
+    int prevCount = fCacheCountLimit.exchange(newCount);
+    this->purge();
     return prevCount;
 }
 
+auto SkStrikeCache::getLockStats() const -> LockStats {
+    LockStats stats = {0, 0};
+    for (const Shard& shard : fShards) {
+        stats.fAcquires    += shard.fLockAcquires.load(std::memory_order_relaxed);
+        stats.fContentions += shard.fLockContentions.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
 void SkStrikeCache::forEachStrike(std::function<void(const Strike&)> visitor) const {
-    SkAutoMutexExclusive ac(fLock);
+    for (const Shard& shard : fShards) {
+        AutoShardLock lock{shard};
 
-    this->validate();
+        this->validate(shard);
 
-    for (Strike* strike = fHead; strike != nullptr; strike = strike->fNext) {
-        visitor(*strike);
+        for (Strike* strike = shard.fHead; strike != nullptr; strike = strike->fNext) {
+            visitor(*strike);
+        }
     }
 }
 
-size_t SkStrikeCache::internalPurge(size_t minBytesNeeded) {
+size_t SkStrikeCache::purge(size_t minBytesNeeded) {
+    const size_t totalMemoryUsed = fTotalMemoryUsed.load(std::memory_order_relaxed);
+    const int    cacheCount      = fCacheCount.load(std::memory_order_relaxed);
+    const size_t cacheSizeLimit  = fCacheSizeLimit.load(std::memory_order_relaxed);
+    const int    cacheCountLimit = fCacheCountLimit.load(std::memory_order_relaxed);
+
     size_t bytesNeeded = 0;
-    if (fTotalMemoryUsed > fCacheSizeLimit) {
-        bytesNeeded = fTotalMemoryUsed - fCacheSizeLimit;
+    if (totalMemoryUsed > cacheSizeLimit) {
+        bytesNeeded = totalMemoryUsed - cacheSizeLimit;
     }
     bytesNeeded = std::max(bytesNeeded, minBytesNeeded);
     if (bytesNeeded) {
         // no small purges!
-        bytesNeeded = std::max(bytesNeeded, fTotalMemoryUsed >> 2);
+        bytesNeeded = std::max(bytesNeeded, totalMemoryUsed >> 2);
     }
 
     int countNeeded = 0;
-    if (fCacheCount > fCacheCountLimit) {
-        countNeeded = fCacheCount - fCacheCountLimit;
+    if (cacheCount > cacheCountLimit) {
+        countNeeded = cacheCount - cacheCountLimit;
         // no small purges!
-        countNeeded = std::max(countNeeded, fCacheCount >> 2);
+        countNeeded = std::max(countNeeded, cacheCount >> 2);
     }
 
     // early exit
@@ -252,12 +365,50 @@ size_t SkStrikeCache::internalPurge(size_t minBytesNeeded) {
         return 0;
     }
 
+    // The budget is soft: if another thread is already trimming, let it do the work.
+    if (fPurging.exchange(true, std::memory_order_acquire)) {
+        return 0;
+    }
+
+    // Every shard gives up its share of the overage, rounded up, from its least recently used
+    // end. Shard totals may have moved since the global totals were read; that's fine.
+    size_t bytesFreed = 0;
+    std::vector<sk_sp<Strike>> toStore;
+    for (Shard& shard : fShards) {
+        AutoShardLock lock{shard};
+        uint64_t shardBytes = totalMemoryUsed == 0 ? 0 :
+                ((uint64_t)shard.fMemoryUsed * bytesNeeded + totalMemoryUsed - 1)
+                        / totalMemoryUsed;
+        int64_t shardCount = cacheCount == 0 ? 0 :
+                ((int64_t)shard.fCacheCount * countNeeded + cacheCount - 1) / cacheCount;
+        bytesFreed += this->internalPurge(shard, (size_t)shardBytes, (int)shardCount, &toStore);
+    }
+
+    fPurging.store(false, std::memory_order_release);
+    this->storeGlyphs(toStore);
+
+#ifdef SPEW_PURGE_STATUS
+    if (bytesFreed) {
+        SkDebugf("purging %dK from font cache\n", (int)(bytesFreed >> 10));
+    }
+#endif
+
+    return bytesFreed;
+}
+
+size_t SkStrikeCache::internalPurge(Shard& shard, size_t bytesNeeded, int countNeeded,
+                                    std::vector<sk_sp<Strike>>* toStore) {
+    if (!countNeeded && !bytesNeeded) {
+        return 0;
+    }
+    const bool keepForStore = this->glyphCache() != nullptr;
+
     size_t  bytesFreed = 0;
     int     countFreed = 0;
 
     // Start at the tail and proceed backwards deleting; the list is in LRU
     // order, with unimportant entries at the tail.
-    Strike* strike = fTail;
+    Strike* strike = shard.fTail;
     while (strike != nullptr && (bytesFreed < bytesNeeded || countFreed < countNeeded)) {
         Strike* prev = strike->fPrev;
 
@@ -265,95 +416,97 @@ size_t SkStrikeCache::internalPurge(size_t minBytesNeeded) {
         if (strike->fPinner == nullptr || strike->fPinner->canDelete()) {
             bytesFreed += strike->fMemoryUsed;
             countFreed += 1;
-            this->internalRemoveStrike(strike);
+            if (keepForStore) {
+                toStore->push_back(sk_ref_sp(strike));
+            }
+            this->internalRemoveStrike(shard, strike);
         }
         strike = prev;
     }
 
-    this->validate();
-
-#ifdef SPEW_PURGE_STATUS
-    if (countFreed) {
-        SkDebugf("purging %dK from font cache [%d entries]\n",
-                 (int)(bytesFreed >> 10), countFreed);
-    }
-#endif
+    this->validate(shard);
 
     return bytesFreed;
 }
 
-void SkStrikeCache::internalAttachToHead(sk_sp<Strike> strike) {
-    SkASSERT(fStrikeLookup.find(strike->getDescriptor()) == nullptr);
+void SkStrikeCache::internalAttachToHead(Shard& shard, sk_sp<Strike> strike) {
+    SkASSERT(shard.fStrikeLookup.find(strike->getDescriptor()) == nullptr);
     Strike* strikePtr = strike.get();
-    fStrikeLookup.set(std::move(strike));
+    shard.fStrikeLookup.set(std::move(strike));
     SkASSERT(nullptr == strikePtr->fPrev && nullptr == strikePtr->fNext);
 
-    fCacheCount += 1;
-    fTotalMemoryUsed += strikePtr->fMemoryUsed;
+    shard.fCacheCount += 1;
+    shard.fMemoryUsed += strikePtr->fMemoryUsed;
+    fCacheCount.fetch_add(1, std::memory_order_relaxed);
+    fTotalMemoryUsed.fetch_add(strikePtr->fMemoryUsed, std::memory_order_relaxed);
 
-    if (fHead != nullptr) {
-        fHead->fPrev = strikePtr;
-        strikePtr->fNext = fHead;
+    if (shard.fHead != nullptr) {
+        shard.fHead->fPrev = strikePtr;
+        strikePtr->fNext = shard.fHead;
     }
 
-    if (fTail == nullptr) {
-        fTail = strikePtr;
+    if (shard.fTail == nullptr) {
+        shard.fTail = strikePtr;
     }
 
-    fHead = strikePtr; // Transfer ownership of strike to the cache list.
+    shard.fHead = strikePtr; // Transfer ownership of strike to the cache list.
 }
 
-void SkStrikeCache::internalRemoveStrike(Strike* strike) {
-    SkASSERT(fCacheCount > 0);
-    fCacheCount -= 1;
-    fTotalMemoryUsed -= strike->fMemoryUsed;
+void SkStrikeCache::internalRemoveStrike(Shard& shard, Strike* strike) {
+    SkASSERT(shard.fCacheCount > 0);
+    shard.fCacheCount -= 1;
+    shard.fMemoryUsed -= strike->fMemoryUsed;
+    fCacheCount.fetch_sub(1, std::memory_order_relaxed);
+    fTotalMemoryUsed.fetch_sub(strike->fMemoryUsed, std::memory_order_relaxed);
 
     if (strike->fPrev) {
         strike->fPrev->fNext = strike->fNext;
     } else {
-        fHead = strike->fNext;
+        shard.fHead = strike->fNext;
     }
     if (strike->fNext) {
         strike->fNext->fPrev = strike->fPrev;
     } else {
-        fTail = strike->fPrev;
+        shard.fTail = strike->fPrev;
     }
 
     strike->fPrev = strike->fNext = nullptr;
     strike->fRemoved = true;
-    fStrikeLookup.remove(strike->getDescriptor());
+    shard.fStrikeLookup.remove(strike->getDescriptor());
 }
 
-void SkStrikeCache::validate() const {
+void SkStrikeCache::validate(const Shard& shard) const {
 #ifdef SK_DEBUG
     size_t computedBytes = 0;
     int computedCount = 0;
 
-    const Strike* strike = fHead;
+    const Strike* strike = shard.fHead;
     while (strike != nullptr) {
         computedBytes += strike->fMemoryUsed;
         computedCount += 1;
-        SkASSERT(fStrikeLookup.findOrNull(strike->getDescriptor()) != nullptr);
+        SkASSERT(shard.fStrikeLookup.findOrNull(strike->getDescriptor()) != nullptr);
         strike = strike->fNext;
     }
 
-    if (fCacheCount != computedCount) {
-        SkDebugf("fCacheCount: %d, computedCount: %d", fCacheCount, computedCount);
+    if (shard.fCacheCount != computedCount) {
+        SkDebugf("fCacheCount: %d, computedCount: %d", shard.fCacheCount, computedCount);
         SK_ABORT("fCacheCount != computedCount");
     }
-    if (fTotalMemoryUsed != computedBytes) {
-        SkDebugf("fTotalMemoryUsed: %d, computedBytes: %d", fTotalMemoryUsed, computedBytes);
-        SK_ABORT("fTotalMemoryUsed == computedBytes");
+    if (shard.fMemoryUsed != computedBytes) {
+        SkDebugf("fMemoryUsed: %zu, computedBytes: %zu", shard.fMemoryUsed, computedBytes);
+        SK_ABORT("fMemoryUsed == computedBytes");
     }
 #endif
 }
 
 void SkStrikeCache::Strike::updateDelta(size_t increase) {
     if (increase != 0) {
-        SkAutoMutexExclusive lock{fStrikeCache->fLock};
+        Shard& shard = fStrikeCache->shardFor(this->getDescriptor());
+        AutoShardLock lock{shard};
         fMemoryUsed += increase;
         if (!fRemoved) {
-            fStrikeCache->fTotalMemoryUsed += increase;
+            shard.fMemoryUsed += increase;
+            fStrikeCache->fTotalMemoryUsed.fetch_add(increase, std::memory_order_relaxed);
         }
     }
 }
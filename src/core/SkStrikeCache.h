@@ -8,13 +8,16 @@
 #ifndef SkStrikeCache_DEFINED
 #define SkStrikeCache_DEFINED
 
+#include <atomic>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "include/private/SkSpinlock.h"
 #include "include/private/SkTemplates.h"
 #include "src/core/SkDescriptor.h"
 #include "src/core/SkScalerCache.h"
+#include "src/core/SkTaskGroup.h"
 
 class SkTraceMemoryDump;
 
@@ -44,9 +47,12 @@ public:
                const SkDescriptor& desc,
                std::unique_ptr<SkScalerContext> scaler,
                const SkFontMetrics* metrics,
-               std::unique_ptr<SkStrikePinner> pinner)
+               std::unique_ptr<SkStrikePinner> pinner,
+               sk_sp<SkData> persistentKey = nullptr,
+               std::unique_ptr<SkPersistentStrike> persistent = nullptr)
                 : fStrikeCache{strikeCache}
-                , fScalerCache{desc, std::move(scaler), metrics}
+                , fScalerCache{desc, std::move(scaler), metrics,
+                               std::move(persistentKey), std::move(persistent)}
                 , fPinner{std::move(pinner)} {}
 
         SkGlyph* mergeGlyphAndImage(SkPackedGlyphID toID, const SkGlyph& from) {
@@ -95,8 +101,17 @@ public:
             return glyphs;
         }
 
+        // Rasterizes the images of these glyphs ahead of drawing them, in parallel on executor
+        // when there are enough of them missing.
+        void prefetchImages(SkSpan<const SkPackedGlyphID> glyphIDs, SkExecutor* executor) {
+            size_t increase = fScalerCache.prefetchImages(glyphIDs, executor);
+            this->updateDelta(increase);
+        }
+
         void prepareForDrawingMasksCPU(SkDrawableGlyphBuffer* drawables) {
-            size_t increase = fScalerCache.prepareForDrawingMasksCPU(drawables);
+            // Pinned (remote) strikes get their images from the server, not from new contexts.
+            SkExecutor* executor = fPinner ? nullptr : SkGraphicsExecutor();
+            size_t increase = fScalerCache.prepareForDrawingMasksCPU(drawables, executor);
             this->updateDelta(increase);
         }
 
@@ -143,23 +158,23 @@ public:
 
     static SkStrikeCache* GlobalStrikeCache();
 
-    sk_sp<Strike> findStrike(const SkDescriptor& desc) SK_EXCLUDES(fLock);
+    sk_sp<Strike> findStrike(const SkDescriptor& desc);
 
     sk_sp<Strike> createStrike(
             const SkDescriptor& desc,
             std::unique_ptr<SkScalerContext> scaler,
             SkFontMetrics* maybeMetrics = nullptr,
-            std::unique_ptr<SkStrikePinner> = nullptr) SK_EXCLUDES(fLock);
+            std::unique_ptr<SkStrikePinner> = nullptr);
 
     sk_sp<Strike> findOrCreateStrike(
             const SkDescriptor& desc,
             const SkScalerContextEffects& effects,
-            const SkTypeface& typeface) SK_EXCLUDES(fLock);
+            const SkTypeface& typeface);
 
     SkScopedStrikeForGPU findOrCreateScopedStrike(
             const SkDescriptor& desc,
             const SkScalerContextEffects& effects,
-            const SkTypeface& typeface) override SK_EXCLUDES(fLock);
+            const SkTypeface& typeface) override;
 
     static void PurgeAll();
     static void Dump();
@@ -168,41 +183,37 @@ public:
     // SkTraceMemoryDump interface.
     static void DumpMemoryStatistics(SkTraceMemoryDump* dump);
 
-    void purgeAll() SK_EXCLUDES(fLock); // does not change budget
+    void purgeAll(); // does not change budget
 
-    int getCacheCountLimit() const SK_EXCLUDES(fLock);
-    int setCacheCountLimit(int limit) SK_EXCLUDES(fLock);
-    int getCacheCountUsed() const SK_EXCLUDES(fLock);
+    // Stores the new glyphs of every strike in the SkGraphics::GlyphCache, if one is set.
+    void flushGlyphCache();
 
-    size_t getCacheSizeLimit() const SK_EXCLUDES(fLock);
-    size_t setCacheSizeLimit(size_t limit) SK_EXCLUDES(fLock);
-    size_t getTotalMemoryUsed() const SK_EXCLUDES(fLock);
+    // Makes this cache load and store strikes with glyphCache instead of the one passed to
+    // SkGraphics::SetGlyphCache(), without changing what other caches use. Pass nullptr to go back
+    // to the global one.
+    void setGlyphCacheForTesting(SkGraphics::GlyphCache* glyphCache);
 
-private:
-    sk_sp<Strike> internalFindStrikeOrNull(const SkDescriptor& desc) SK_REQUIRES(fLock);
-    sk_sp<Strike> internalCreateStrike(
-            const SkDescriptor& desc,
-            std::unique_ptr<SkScalerContext> scaler,
-            SkFontMetrics* maybeMetrics = nullptr,
-            std::unique_ptr<SkStrikePinner> = nullptr) SK_REQUIRES(fLock);
+    int getCacheCountLimit() const;
+    int setCacheCountLimit(int limit);
+    int getCacheCountUsed() const;
 
-    // The following methods can only be called when mutex is already held.
-    void internalRemoveStrike(Strike* strike) SK_REQUIRES(fLock);
-    void internalAttachToHead(sk_sp<Strike> strike) SK_REQUIRES(fLock);
+    size_t getCacheSizeLimit() const;
+    size_t setCacheSizeLimit(size_t limit);
+    size_t getTotalMemoryUsed() const;
 
-    // Checkout budgets, modulated by the specified min-bytes-needed-to-purge,
-    // and attempt to purge caches to match.
-    // Returns number of bytes freed.
-    size_t internalPurge(size_t minBytesNeeded = 0) SK_REQUIRES(fLock);
-
-    // A simple accounting of what each glyph cache reports and the strike cache total.
-    void validate() const SK_REQUIRES(fLock);
+    // Total shard lock acquisitions, and how many of those had to wait for another thread.
+    struct LockStats {
+        uint64_t fAcquires;
+        uint64_t fContentions;
+    };
+    LockStats getLockStats() const;
 
-    void forEachStrike(std::function<void(const Strike&)> visitor) const SK_EXCLUDES(fLock);
+private:
+    // Strikes are spread over independently locked shards by descriptor hash, so threads using
+    // different strikes rarely wait on each other. Each shard keeps its own LRU list, while the
+    // byte and count budgets are global and enforced lazily by trimming every shard's tail.
+    static constexpr int kShardCount = 8;
 
-    mutable SkMutex fLock;
-    Strike* fHead SK_GUARDED_BY(fLock) {nullptr};
-    Strike* fTail SK_GUARDED_BY(fLock) {nullptr};
     struct StrikeTraits {
         static const SkDescriptor& GetKey(const sk_sp<Strike>& strike) {
             return strike->getDescriptor();
@@ -211,12 +222,86 @@ private:
             return descriptor.getChecksum();
         }
     };
-    SkTHashTable<sk_sp<Strike>, SkDescriptor, StrikeTraits> fStrikeLookup SK_GUARDED_BY(fLock);
 
-    size_t  fCacheSizeLimit{SK_DEFAULT_FONT_CACHE_LIMIT};
-    size_t  fTotalMemoryUsed SK_GUARDED_BY(fLock) {0};
-    int32_t fCacheCountLimit{SK_DEFAULT_FONT_CACHE_COUNT_LIMIT};
-    int32_t fCacheCount SK_GUARDED_BY(fLock) {0};
+    struct Shard {
+        mutable SkMutex fLock;
+        Strike* fHead SK_GUARDED_BY(fLock) {nullptr};
+        Strike* fTail SK_GUARDED_BY(fLock) {nullptr};
+        SkTHashTable<sk_sp<Strike>, SkDescriptor, StrikeTraits> fStrikeLookup SK_GUARDED_BY(fLock);
+        size_t  fMemoryUsed SK_GUARDED_BY(fLock) {0};
+        int32_t fCacheCount SK_GUARDED_BY(fLock) {0};
+
+        mutable std::atomic<uint64_t> fLockAcquires{0};
+        mutable std::atomic<uint64_t> fLockContentions{0};
+    };
+
+    class AutoShardLock;
+
+    Shard& shardFor(const SkDescriptor& desc) {
+        // The hash table uses the low bits of the checksum; pick the shard from the high ones.
+        return fShards[desc.getChecksum() >> 29];
+    }
+    static_assert(kShardCount == 1 << (32 - 29), "shardFor() must cover every shard");
+
+    sk_sp<Strike> internalFindStrikeOrNull(Shard& shard, const SkDescriptor& desc)
+            SK_REQUIRES(shard.fLock);
+    sk_sp<Strike> internalCreateStrike(
+            Shard& shard,
+            const SkDescriptor& desc,
+            std::unique_ptr<SkScalerContext> scaler,
+            SkFontMetrics* maybeMetrics = nullptr,
+            std::unique_ptr<SkStrikePinner> = nullptr,
+            sk_sp<SkData> persistentKey = nullptr,
+            std::unique_ptr<SkPersistentStrike> persistent = nullptr) SK_REQUIRES(shard.fLock);
+
+    // Like findOrCreateStrike(), but a new strike starts with the glyphs glyphCache has stored
+    // for it. The shard is not locked while they are loaded.
+    sk_sp<Strike> findOrCreatePersistentStrike(
+            SkGraphics::GlyphCache* glyphCache,
+            const SkDescriptor& desc,
+            const SkScalerContextEffects& effects,
+            const SkTypeface& typeface);
+
+    // The SkGraphics::GlyphCache this cache loads and stores strikes with, if any.
+    SkGraphics::GlyphCache* glyphCache() const;
+
+    // Stores the new glyphs of strikes in the SkGraphics::GlyphCache, if one is set. Call this
+    // without holding any shard's lock, since it may write files.
+    void storeGlyphs(const std::vector<sk_sp<Strike>>& strikes);
+
+    // The following methods can only be called when the shard's mutex is already held.
+    void internalRemoveStrike(Shard& shard, Strike* strike) SK_REQUIRES(shard.fLock);
+    void internalAttachToHead(Shard& shard, sk_sp<Strike> strike) SK_REQUIRES(shard.fLock);
+
+    // Purge unpinned strikes from the tail of shard's LRU list until at least bytesNeeded bytes
+    // and countNeeded strikes are freed, or the list is exhausted. While an SkGraphics::GlyphCache
+    // is set, the purged strikes are kept alive in toStore so their glyphs can be stored once the
+    // shard is unlocked.
+    // Returns number of bytes freed.
+    size_t internalPurge(Shard& shard, size_t bytesNeeded, int countNeeded,
+                         std::vector<sk_sp<Strike>>* toStore) SK_REQUIRES(shard.fLock);
+
+    // Checkout budgets, modulated by the specified min-bytes-needed-to-purge,
+    // and attempt to purge caches to match. Takes each shard's lock in turn.
+    // Returns number of bytes freed.
+    size_t purge(size_t minBytesNeeded = 0);
+
+    // A simple accounting of what each glyph cache reports and the shard total.
+    void validate(const Shard& shard) const SK_REQUIRES(shard.fLock);
+
+    void forEachStrike(std::function<void(const Strike&)> visitor) const;
+
+    Shard fShards[kShardCount];
+
+    std::atomic<size_t>  fCacheSizeLimit{SK_DEFAULT_FONT_CACHE_LIMIT};
+    std::atomic<size_t>  fTotalMemoryUsed{0};
+    std::atomic<int32_t> fCacheCountLimit{SK_DEFAULT_FONT_CACHE_COUNT_LIMIT};
+    std::atomic<int32_t> fCacheCount{0};
+
+    // Set while a thread is trimming the shards to budget; others skip purging meanwhile.
+    std::atomic<bool> fPurging{false};
+
+    std::atomic<SkGraphics::GlyphCache*> fGlyphCacheForTesting{nullptr};
 };
 
 using SkStrike = SkStrikeCache::Strike;
@@ -8,12 +8,68 @@
 #include "include/core/SkExecutor.h"
 #include "src/core/SkTaskGroup.h"
 
+#if defined(SK_TASK_GROUP_HAS_THREAD_LOCAL)
+// The innermost task this thread is running, if any.
+static thread_local const SkTaskGroup::ScopedTask* gCurrentTask = nullptr;
+
+SkTaskGroup::ScopedTask::ScopedTask(const SkExecutor& executor)
+        : fExecutor(&executor), fOuter(gCurrentTask) {
+    gCurrentTask = this;
+}
+
+SkTaskGroup::ScopedTask::~ScopedTask() {
+    SkASSERT(gCurrentTask == this);
+    gCurrentTask = fOuter;
+}
+
+bool SkTaskGroup::IsRunningOn(const SkExecutor& executor) {
+    for (const ScopedTask* task = gCurrentTask; task; task = task->fOuter) {
+        if (task->fExecutor == &executor) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static thread_local const SkAutoGraphicsExecutor* gGraphicsExecutorOverride = nullptr;
+
+SkAutoGraphicsExecutor::SkAutoGraphicsExecutor(SkExecutor* executor)
+        : fExecutor(executor), fOuter(gGraphicsExecutorOverride) {
+    gGraphicsExecutorOverride = this;
+}
+
+SkAutoGraphicsExecutor::~SkAutoGraphicsExecutor() {
+    SkASSERT(gGraphicsExecutorOverride == this);
+    gGraphicsExecutorOverride = fOuter;
+}
+#endif
+
+std::atomic<SkExecutor*> gSkGraphicsExecutor{nullptr};
+
+SkExecutor* SkGraphicsExecutor() {
+#if defined(SK_TASK_GROUP_HAS_THREAD_LOCAL)
+    SkExecutor* executor = gGraphicsExecutorOverride
+                                 ? gGraphicsExecutorOverride->fExecutor
+                                 : gSkGraphicsExecutor.load(std::memory_order_relaxed);
+#else
+    SkExecutor* executor = gSkGraphicsExecutor.load(std::memory_order_relaxed);
+#endif
+    if (executor && SkTaskGroup::IsRunningOn(*executor)) {
+        // e.g. drawing a tile of a picture, or an op in one of SkOpBuilder's tasks.
+        return nullptr;
+    }
+    return executor;
+}
+
 SkTaskGroup::SkTaskGroup(SkExecutor& executor) : fPending(0), fExecutor(executor) {}
 
 void SkTaskGroup::add(std::function<void(void)> fn) {
     fPending.fetch_add(+1, std::memory_order_relaxed);
     fExecutor.add([this, fn{std::move(fn)}] {
-        fn();
+        {
+            ScopedTask task(fExecutor);
+            fn();
+        }
         fPending.fetch_add(-1, std::memory_order_release);
     });
 }
@@ -23,7 +79,10 @@ void SkTaskGroup::batch(int N, std::function<void(int)> fn) {
     fPending.fetch_add(+N, std::memory_order_relaxed);
     for (int i = 0; i < N; i++) {
         fExecutor.add([=] {
-            fn(i);
+            {
+                ScopedTask task(fExecutor);
+                fn(i);
+            }
             fPending.fetch_add(-1, std::memory_order_release);
         });
     }
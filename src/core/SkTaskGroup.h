@@ -14,6 +14,11 @@
 #include <atomic>
 #include <functional>
 
+#if !defined(SK_BUILD_FOR_IOS) || \
+            (defined(__IPHONE_9_0) && __IPHONE_OS_VERSION_MIN_REQUIRED > __IPHONE_9_0)
+    #define SK_TASK_GROUP_HAS_THREAD_LOCAL
+#endif
+
 class SkTaskGroup : SkNoncopyable {
 public:
     // Tasks added to this SkTaskGroup will run on its executor.
@@ -33,6 +38,34 @@ public:
     // Block until done().
     void wait();
 
+    // Marks this thread as running a task on an executor while in scope.  Tasks added through
+    // an SkTaskGroup are marked automatically; code that add()s to an executor directly can
+    // mark its tasks with one of these.
+    class ScopedTask : SkNoncopyable {
+    public:
+#if defined(SK_TASK_GROUP_HAS_THREAD_LOCAL)
+        explicit ScopedTask(const SkExecutor&);
+        ~ScopedTask();
+
+    private:
+        friend class SkTaskGroup;
+        const SkExecutor* fExecutor;
+        const ScopedTask* fOuter;
+#else
+        explicit ScopedTask(const SkExecutor&) {}
+#endif
+    };
+
+    // Is this thread running a task on this executor?  Such a task should do any nested work
+    // inline: waiting for it only makes progress if the executor borrow()s, and an executor
+    // that doesn't deadlocks once all its threads are waiting.
+#if defined(SK_TASK_GROUP_HAS_THREAD_LOCAL)
+    static bool IsRunningOn(const SkExecutor&);
+#else
+    // Without thread_local there is nothing to track tasks with, so nested waits rely on borrow().
+    static bool IsRunningOn(const SkExecutor&) { return false; }
+#endif
+
     // A convenience for testing tools.
     // Creates and owns a thread pool, and passes it to SkExecutor::SetDefault().
     struct Enabler {
@@ -45,4 +78,31 @@ private:
     SkExecutor&          fExecutor;
 };
 
+// Set by SkGraphics::SetExecutor().
+extern std::atomic<SkExecutor*> gSkGraphicsExecutor;
+
+// The executor the CPU backend and path ops may split large pieces of work across on this thread:
+// gSkGraphicsExecutor, or the one an enclosing SkAutoGraphicsExecutor picked. This is null when
+// there is none, and while already running a task on it, so nested work is done inline rather
+// than waiting on the executor.
+SkExecutor* SkGraphicsExecutor();
+
+// While in scope, SkGraphicsExecutor() on this thread returns executor (or none, if it is nullptr)
+// instead of gSkGraphicsExecutor. This lets tests pick an executor without changing process-global
+// state. Without thread_local this does nothing.
+class SkAutoGraphicsExecutor : SkNoncopyable {
+public:
+#if defined(SK_TASK_GROUP_HAS_THREAD_LOCAL)
+    explicit SkAutoGraphicsExecutor(SkExecutor* executor);
+    ~SkAutoGraphicsExecutor();
+
+private:
+    friend SkExecutor* SkGraphicsExecutor();
+    SkExecutor*                   fExecutor;
+    const SkAutoGraphicsExecutor* fOuter;
+#else
+    explicit SkAutoGraphicsExecutor(SkExecutor*) {}
+#endif
+};
+
 #endif//SkTaskGroup_DEFINED
@@ -773,6 +773,54 @@ sk_sp<SkTextBlob> SkTextBlobPriv::MakeFromBuffer(SkReadBuffer& reader) {
     return blobBuilder.make();
 }
 
+bool SkTextBlobPriv::SkipFromBuffer(SkReadBuffer& reader) {
+    SkRect bounds;
+    reader.readRect(&bounds);
+
+    SkSafeMath safe;
+    auto skipArray = [&reader](size_t size) {
+        size_t count;
+        reader.skipByteArray(&count);
+        return reader.validate(count == size);
+    };
+    for (;;) {
+        int glyphCount = reader.read32();
+        if (glyphCount == 0) {
+            // End-of-runs marker.
+            break;
+        }
+
+        PositioningAndExtended pe;
+        pe.intValue = reader.read32();
+        const auto pos = SkTo<SkTextBlob::GlyphPositioning>(pe.positioning);
+        if (glyphCount <= 0 || pos > SkTextBlob::kRSXform_Positioning) {
+            return reader.validate(false);
+        }
+        int textSize = pe.extended ? reader.read32() : 0;
+        if (textSize < 0) {
+            return reader.validate(false);
+        }
+
+        SkPoint offset;
+        reader.readPoint(&offset);
+        SkFont font;
+        SkFontPriv::Unflatten(&font, reader);
+
+        const size_t glyphSize = safe.mul(glyphCount, sizeof(uint16_t)),
+                     posSize =
+                             safe.mul(glyphCount, safe.mul(sizeof(SkScalar),
+                             SkTextBlob::ScalarsPerGlyph(pos))),
+                     clusterSize = pe.extended ? safe.mul(glyphCount, sizeof(uint32_t)) : 0;
+        if (!reader.validate(safe.ok()) || !skipArray(glyphSize) || !skipArray(posSize)) {
+            return false;
+        }
+        if (pe.extended && (!skipArray(clusterSize) || !skipArray(textSize))) {
+            return false;
+        }
+    }
+    return reader.isValid();
+}
+
 sk_sp<SkTextBlob> SkTextBlob::MakeFromText(const void* text, size_t byteLength, const SkFont& font,
                                            SkTextEncoding encoding) {
     // Note: we deliberately promote this to fully positioned blobs, since we'd have to pay the
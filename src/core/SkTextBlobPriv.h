@@ -37,6 +37,12 @@ public:
      *          invalid.
      */
     static sk_sp<SkTextBlob> MakeFromBuffer(SkReadBuffer&);
+
+    /**
+     *  Skip over a blob serialized into a buffer without building it, reading exactly what
+     *  MakeFromBuffer() would. Returns false if the buffer is invalid.
+     */
+    static bool SkipFromBuffer(SkReadBuffer&);
 };
 
 //
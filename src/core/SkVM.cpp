@@ -5,6 +5,7 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkData.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkString.h"
 #include "include/private/SkChecksum.h"
@@ -16,6 +17,7 @@
 #include "src/core/SkColorSpaceXformSteps.h"
 #include "src/core/SkCpu.h"
 #include "src/core/SkEnumerate.h"
+#include "src/core/SkMD5.h"
 #include "src/core/SkOpts.h"
 #include "src/core/SkVM.h"
 #include <algorithm>
@@ -140,6 +142,8 @@ namespace skvm {
         int regs = 0;
         int loop = 0;
         std::vector<int> strides;
+        bool serializable = false;
+        std::vector<OptimizedInstruction> optimized;  // Only kept when serializable.
 
         std::atomic<void*> jit_entry{nullptr};   // TODO: minimal std::memory_orders
         size_t jit_size = 0;
@@ -515,14 +519,14 @@ namespace skvm {
         return    finalize           (std::move(program));
     }
 
-    Program Builder::done(const char* debug_name, bool allow_jit) const {
+    Program Builder::done(const char* debug_name, bool allow_jit, bool serializable) const {
         char buf[64] = "skvm-jit-";
         if (!debug_name) {
             *SkStrAppendU32(buf+9, this->hash()) = '\0';
             debug_name = buf;
         }
 
-        return {this->optimize(), fStrides, debug_name, allow_jit};
+        return {this->optimize(), fStrides, debug_name, allow_jit, serializable};
     }
 
     uint64_t Builder::hash() const {
@@ -2883,8 +2887,12 @@ namespace skvm {
 
     Program::Program(const std::vector<OptimizedInstruction>& instructions,
                      const std::vector<int>& strides,
-                     const char* debug_name, bool allow_jit) : Program() {
-        fImpl->strides = strides;
+                     const char* debug_name, bool allow_jit, bool serializable) : Program() {
+        fImpl->strides   = strides;
+        if (serializable) {
+            fImpl->serializable = true;
+            fImpl->optimized    = instructions;
+        }
         if (gSkVMAllowJIT && allow_jit) {
         #if 1 && defined(SKVM_LLVM)
             this->setupLLVM(instructions, debug_name);
@@ -2897,6 +2905,289 @@ namespace skvm {
         this->setupInterpreter(instructions);
     }
 
+    // Serialized Programs are only valid for the build that wrote them.  Bump this whenever
+    // Op, OptimizedInstruction, or the code generated by jit() changes meaning.
+    static constexpr uint32_t kSerializedMagic   = SkSetFourByteTag('s','k','v','m'),
+                              kSerializedVersion = 2;
+
+    static constexpr uint32_t kOpCount = 0
+    #define M(op) + 1
+        SKVM_OPS(M)
+    #undef M
+    ;
+
+    // Identifies the CPU and calling convention jit() targets.  JIT code saved by serialize() is
+    // only reused if this matches; otherwise Deserialize() JITs again from the instructions.
+    static uint32_t jit_fingerprint() {
+    #if defined(SKVM_JIT) && (defined(__x86_64__) || defined(_M_X64))
+        #if defined(_M_X64)
+            return SkSetFourByteTag('x','6','4','w') ^ SkCpu::Supports(SkCpu::HSW);
+        #else
+            return SkSetFourByteTag('x','6','4','s') ^ SkCpu::Supports(SkCpu::HSW);
+        #endif
+    #elif defined(SKVM_JIT) && defined(__aarch64__)
+        return SkSetFourByteTag('a','6','4','s');
+    #else
+        return 0;
+    #endif
+    }
+
+    // How many of x,y,z,w each Op reads, always starting from x.  The rest must be NA.
+    static int value_args(Op op) {
+        switch (op) {
+            case Op::index:
+            case Op::load8: case Op::load16: case Op::load32: case Op::load64: case Op::load128:
+            case Op::uniform32:
+            case Op::splat:
+                return 0;
+
+            case Op::store8: case Op::store16: case Op::store32:
+            case Op::gather8: case Op::gather16: case Op::gather32:
+            case Op::sqrt_f32:
+            case Op::shl_i32: case Op::shr_i32: case Op::sra_i32:
+            case Op::ceil: case Op::floor: case Op::trunc: case Op::round:
+            case Op::to_fp16: case Op::from_fp16: case Op::to_f32:
+                return 1;
+
+            case Op::assert_true:
+            case Op::store64:
+            case Op::add_f32: case Op::add_i32: case Op::sub_f32: case Op::sub_i32:
+            case Op::mul_f32: case Op::mul_i32: case Op::div_f32:
+            case Op::min_f32: case Op::max_f32:
+            case Op::neq_f32: case Op::eq_f32: case Op::eq_i32:
+            case Op::gte_f32: case Op::gt_f32: case Op::gt_i32:
+            case Op::bit_and: case Op::bit_or: case Op::bit_xor: case Op::bit_clear:
+                return 2;
+
+            case Op::fma_f32: case Op::fms_f32: case Op::fnma_f32:
+            case Op::select:
+                return 3;
+
+            case Op::store128:
+                return 4;
+        }
+        SkUNREACHABLE;
+    }
+
+    // Are the immediates of this Instruction ones a Builder could have produced for a Program
+    // with nargs arguments?  Pointer indices and load lanes are used to index memory, so an
+    // out-of-range one would read or write out of bounds.
+    static bool valid_immediates(const Instruction& inst, int nargs) {
+        auto ptr = [&](int ix) { return 0 <= ix && ix < nargs; };
+        switch (inst.op) {
+            case Op::store8: case Op::store16: case Op::store32:
+            case Op::store64: case Op::store128:
+            case Op::load8: case Op::load16: case Op::load32:
+                return ptr(inst.immA);
+
+            case Op::load64:  return ptr(inst.immA) && 0 <= inst.immB && inst.immB < 2;
+            case Op::load128: return ptr(inst.immA) && 0 <= inst.immB && inst.immB < 4;
+
+            // immB is a byte offset into the uniforms, whose size only the caller knows;
+            // see Program::uniformsFit().
+            case Op::gather8: case Op::gather16: case Op::gather32:
+            case Op::uniform32:
+                return ptr(inst.immA) && 0 <= inst.immB;
+
+            case Op::shl_i32: case Op::shr_i32: case Op::sra_i32:
+                return 0 <= inst.immA && inst.immA < 32;
+
+            default:
+                return true;
+        }
+    }
+
+    sk_sp<SkData> Program::serialize(bool includeJIT) const {
+        if (!fImpl->serializable) {
+            return nullptr;
+        }
+        SkDynamicMemoryWStream stream;
+        stream.write32(kSerializedMagic);
+        stream.write32(kSerializedVersion);
+        stream.write32(kOpCount);
+
+        stream.write32(SkToU32(fImpl->strides.size()));
+        for (int stride : fImpl->strides) {
+            stream.write32(stride);
+        }
+
+        stream.write32(SkToU32(fImpl->optimized.size()));
+        for (const OptimizedInstruction& inst : fImpl->optimized) {
+            for (int v : {(int)inst.op, inst.x, inst.y, inst.z, inst.w, inst.immA, inst.immB}) {
+                stream.write32(v);
+            }
+        }
+
+        // Only plain JIT code can be saved, not LLVM or dylib-backed programs.
+        const void* jit_entry = fImpl->jit_entry.load();
+    #if defined(SKVM_LLVM)
+        jit_entry = nullptr;
+    #endif
+        if (includeJIT && jit_entry && !fImpl->dylib && jit_fingerprint() != 0) {
+            stream.write32(jit_fingerprint());
+            stream.write32(SkToU32(fImpl->jit_size));
+            stream.write(jit_entry, fImpl->jit_size);
+        } else {
+            stream.write32(0);
+        }
+
+        // The digest covers everything above, so corrupt machine code is never mapped in.
+        sk_sp<SkData> data = stream.detachAsData();
+        SkMD5 md5;
+        md5.write(data->data(), data->size());
+        SkMD5::Digest digest = md5.finish();
+        stream.write(data->data(), data->size());
+        stream.write(digest.data, sizeof(digest.data));
+        return stream.detachAsData();
+    }
+
+    Program Program::Deserialize(const void* data, size_t size,
+                                 const char* debug_name, bool allow_jit) {
+        // Check the digest first: past this point we trust only what we validate ourselves,
+        // except for the JIT code, which the digest alone vouches for.
+        SkMD5::Digest digest;
+        if (size < sizeof(digest.data)) {
+            return {};
+        }
+        size -= sizeof(digest.data);
+        memcpy(digest.data, (const char*)data + size, sizeof(digest.data));
+        SkMD5 md5;
+        md5.write(data, size);
+        if (md5.finish() != digest) {
+            return {};
+        }
+
+        SkMemoryStream stream(data, size, /*copyData=*/false);
+        auto read = [&](uint32_t* v) { return stream.readU32(v); };
+
+        uint32_t magic, version, opCount, nstrides, ninstructions;
+        if (!read(&magic)   || magic   != kSerializedMagic   ||
+            !read(&version) || version != kSerializedVersion ||
+            !read(&opCount) || opCount != kOpCount           ||
+            !read(&nstrides) || nstrides > 7) {
+            return {};
+        }
+        std::vector<int> strides(nstrides);
+        for (int& stride : strides) {
+            if (!stream.readS32(&stride) || stride < 0) {
+                return {};
+            }
+        }
+
+        // Each instruction is 7 ints; don't trust ninstructions to size an allocation until
+        // we know the stream is actually that long.
+        if (!read(&ninstructions) || ninstructions > stream.getLength() / (7*sizeof(int))) {
+            return {};
+        }
+        std::vector<Instruction> program(ninstructions);
+        for (Val id = 0; id < (Val)ninstructions; id++) {
+            int32_t v[7];
+            for (int32_t& x : v) {
+                if (!stream.readS32(&x)) {
+                    return {};
+                }
+            }
+            if ((uint32_t)v[0] >= kOpCount) {
+                return {};
+            }
+            Instruction inst = {(Op)v[0], v[1],v[2],v[3],v[4], v[5],v[6]};
+
+            // The arguments the op reads must refer to earlier instructions, and the rest be NA.
+            const int nargs = value_args(inst.op);
+            int i = 0;
+            for (Val arg : {inst.x, inst.y, inst.z, inst.w}) {
+                bool ok = i++ < nargs ? (0 <= arg && arg < id) : arg == NA;
+                if (!ok) {
+                    return {};
+                }
+            }
+            if (!valid_immediates(inst, (int)nstrides)) {
+                return {};
+            }
+            program[id] = inst;
+        }
+        // Lifetimes and hoisting follow from the instructions, so work them out again rather
+        // than trusting the data.
+        std::vector<OptimizedInstruction> instructions = finalize(std::move(program));
+
+        uint32_t fingerprint, jit_size = 0;
+        if (!read(&fingerprint) || (fingerprint != 0 && !read(&jit_size))) {
+            return {};
+        }
+        const void* jit_code = nullptr;
+        if (fingerprint != 0) {
+            jit_code = (const char*)data + stream.getPosition();
+            if (jit_size != stream.getLength() - stream.getPosition()) {
+                return {};
+            }
+        } else if (!stream.isAtEnd()) {
+            return {};
+        }
+
+        // If we have compatible machine code, skip jit() and just map it in.
+        if (jit_code && fingerprint == jit_fingerprint() && gSkVMAllowJIT && allow_jit) {
+            Program program;
+            program.fImpl->strides      = std::move(strides);
+            program.fImpl->serializable = true;
+            program.fImpl->optimized    = std::move(instructions);
+            if (program.loadJIT(jit_code, jit_size, debug_name)) {
+                program.setupInterpreter(program.fImpl->optimized);
+                return program;
+            }
+            return {program.fImpl->optimized, program.fImpl->strides, debug_name, allow_jit,
+                    /*serializable=*/true};
+        }
+        return {instructions, strides, debug_name, allow_jit, /*serializable=*/true};
+    }
+
+    bool Program::uniformsFit(SkSpan<const size_t> uniformBytes) const {
+        if (uniformBytes.size() != fImpl->strides.size()) {
+            return false;
+        }
+        // The interpreter keeps every instruction's op and immediates, serializable or not.
+        for (const InterpreterInstruction& inst : fImpl->instructions) {
+            size_t bytes;
+            switch (inst.op) {
+                case Op::uniform32:
+                    bytes = sizeof(int);
+                    break;
+                // Gathers read the pointer to gather from out of the uniforms.
+                case Op::gather8: case Op::gather16: case Op::gather32:
+                    bytes = sizeof(void*);
+                    break;
+                default:
+                    continue;
+            }
+            const size_t size = uniformBytes[inst.immA];
+            if (fImpl->strides[inst.immA] != 0 || (size_t)inst.immB > size ||
+                bytes > size - (size_t)inst.immB) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool Program::loadJIT(const void* code, size_t size, const char* debug_name) {
+    #if defined(SKVM_JIT) && !defined(SKVM_LLVM)
+        if (size == 0) {
+            return false;
+        }
+        fImpl->jit_size = size;
+        void* jit_entry = alloc_jit_buffer(&fImpl->jit_size);
+        if (!jit_entry) {
+            fImpl->jit_size = 0;
+            return false;
+        }
+        memcpy(jit_entry, code, size);
+        remap_as_executable(jit_entry, fImpl->jit_size);
+        notify_vtune(debug_name, jit_entry, fImpl->jit_size);
+        fImpl->jit_entry.store(jit_entry);
+        return true;
+    #else
+        return false;
+    #endif
+    }
+
     std::vector<InterpreterInstruction> Program::instructions() const { return fImpl->instructions; }
     int  Program::nargs() const { return (int)fImpl->strides.size(); }
     int  Program::nregs() const { return fImpl->regs; }
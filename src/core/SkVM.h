@@ -17,7 +17,9 @@
 #include "src/core/SkVM_fwd.h"
 #include <vector>      // std::vector
 
+class SkData;
 class SkWStream;
+template <typename T> class sk_sp;
 
 #if defined(SKVM_JIT_WHEN_POSSIBLE) && !defined(SK_BUILD_FOR_IOS)
     #if defined(__x86_64__) || defined(_M_X64)
@@ -583,7 +585,9 @@ namespace skvm {
         Builder();
         explicit Builder(Features);
 
-        Program done(const char* debug_name = nullptr, bool allow_jit=true) const;
+        // Only a serializable Program keeps what serialize() needs.
+        Program done(const char* debug_name = nullptr, bool allow_jit=true,
+                     bool serializable=false) const;
 
         // Mostly for debugging, tests, etc.
         std::vector<Instruction> program() const { return fProgram; }
@@ -956,7 +960,7 @@ namespace skvm {
     public:
         Program(const std::vector<OptimizedInstruction>& instructions,
                 const std::vector<int>& strides,
-                const char* debug_name, bool allow_jit);
+                const char* debug_name, bool allow_jit, bool serializable = false);
 
         Program();
         ~Program();
@@ -987,6 +991,24 @@ namespace skvm {
 
         void dump(SkWStream* = nullptr) const;
 
+        // Serialize the optimized instructions this Program was built from, so it can be
+        // recreated later (e.g. in another process) by Deserialize() without a Builder.
+        // If includeJIT is true and this Program has been JITted, the machine code is saved too,
+        // and reused by Deserialize() when loaded on a CPU that would have JITted the same code.
+        // Returns nullptr unless the Program was built serializable (see Builder::done()) or
+        // came from Deserialize().
+        sk_sp<SkData> serialize(bool includeJIT = false) const;
+
+        // Returns an empty() Program if the data is not a valid serialized Program
+        // for this build of Skia.  Uniform offsets depend on the caller's arguments,
+        // so check them with uniformsFit() before calling eval().
+        static Program Deserialize(const void* data, size_t size,
+                                   const char* debug_name, bool allow_jit = true);
+
+        // Do all uniform32 and gather ops read through uniform (stride 0) arguments, and
+        // within the first uniformBytes[i] bytes of argument i?  One entry per argument.
+        bool uniformsFit(SkSpan<const size_t> uniformBytes) const;
+
     private:
         void setupInterpreter(const std::vector<OptimizedInstruction>&);
         void setupJIT        (const std::vector<OptimizedInstruction>&, const char* debug_name);
@@ -995,6 +1017,7 @@ namespace skvm {
         bool jit(const std::vector<OptimizedInstruction>&,
                  int* stack_hint, uint32_t* registers_used,
                  Assembler*) const;
+        bool loadJIT(const void* code, size_t size, const char* debug_name);
 
         void waitForLLVM() const;
         void dropJIT();
@@ -5,6 +5,8 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkData.h"
+#include "include/core/SkGraphics.h"
 #include "include/private/SkImageInfoPriv.h"
 #include "include/private/SkMacros.h"
 #include "src/core/SkArenaAlloc.h"
@@ -20,8 +22,13 @@
 #include "src/core/SkVM.h"
 #include "src/shaders/SkColorFilterShader.h"
 
+#include <atomic>
 #include <cinttypes>
 
+// Set by SkGraphics::SetProgramCache().
+std::atomic<SkGraphics::ProgramCache*> gSkVMProgramCache{nullptr};
+std::atomic<bool>                      gSkVMProgramCacheJIT{false};
+
 namespace {
 
     // Uniforms set by the Blitter itself,
@@ -109,6 +116,17 @@ namespace {
 
     static void release_program_cache() { }
 
+    // Keys for SkGraphics::ProgramCache are content-derived (shader program hashes, not IDs),
+    // so they stay valid across processes.  The tag keeps them distinct from any other keys the
+    // client may be sharing the same storage with.
+    static sk_sp<SkData> persistent_key(const Key& key) {
+        static constexpr uint32_t kTag = SkSetFourByteTag('v','m','b','l');
+        sk_sp<SkData> data = SkData::MakeUninitialized(sizeof(kTag) + sizeof(Key));
+        memcpy(data->writable_data(), &kTag, sizeof(kTag));
+        memcpy(SkTAddOffset<void>(data->writable_data(), sizeof(kTag)), &key, sizeof(Key));
+        return data;
+    }
+
     static skvm::Coord device_coord(skvm::Builder* p, skvm::Uniforms* uniforms) {
         skvm::I32 dx = p->uniform32(uniforms->base, offsetof(BlitterUniforms, right))
                      - p->index(),
@@ -598,6 +616,20 @@ namespace {
                     return p;
                 }
             }
+
+            SkGraphics::ProgramCache* persistent = gSkVMProgramCache.load();
+            sk_sp<SkData> persistentKey;
+            if (persistent) {
+                persistentKey = persistent_key(key);
+                if (sk_sp<SkData> data = persistent->load(*persistentKey)) {
+                    skvm::Program p = skvm::Program::Deserialize(data->data(), data->size(),
+                                                                 debug_name(key).c_str());
+                    if (!p.empty() && this->uniformsFit(p, coverage)) {
+                        return p;
+                    }
+                }
+            }
+
             // We don't really _need_ to rebuild fUniforms here.
             // It's just more natural to have effects unconditionally emit them,
             // and more natural to rebuild fUniforms than to emit them into a dummy buffer.
@@ -609,7 +641,8 @@ namespace {
             SkASSERTF(fUniforms.buf.size() == prev,
                       "%zu, prev was %zu", fUniforms.buf.size(), prev);
 
-            skvm::Program program = builder.done(debug_name(key).c_str());
+            skvm::Program program = builder.done(debug_name(key).c_str(), /*allow_jit=*/true,
+                                                 /*serializable=*/persistent != nullptr);
             if (false) {
                 static std::atomic<int> missed{0},
                                          total{0};
@@ -625,9 +658,28 @@ namespace {
                                         total.load(), missed.load()); });
                 }
             }
+            if (persistent && !program.empty()) {
+                persistent->store(*persistentKey,
+                                  *program.serialize(gSkVMProgramCacheJIT.load()));
+            }
             return program;
         }
 
+        // Does p only read uniforms that eval() will pass it?  The arguments are laid out as in
+        // build_program(): fUniforms, the device, maybe the sprite, then coverage, which is
+        // a single float uniform for Coverage::UniformF.
+        bool uniformsFit(const skvm::Program& p, Coverage coverage) const {
+            std::vector<size_t> uniformBytes(p.nargs(), 0);
+            if (uniformBytes.size() < 2) {
+                return false;
+            }
+            uniformBytes.front() = fUniforms.buf.size() * sizeof(int);
+            if (coverage == Coverage::UniformF) {
+                uniformBytes.back() = sizeof(float);
+            }
+            return p.uniformsFit(SkMakeSpan(uniformBytes));
+        }
+
         void updateUniforms(int right, int y) {
             BlitterUniforms uniforms{right, y};
             memcpy(fUniforms.buf.data(), &uniforms, sizeof(BlitterUniforms));
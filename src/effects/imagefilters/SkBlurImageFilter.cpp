@@ -18,9 +18,11 @@
 #include "src/core/SkAutoPixmapStorage.h"
 #include "src/core/SkGpuBlurUtils.h"
 #include "src/core/SkImageFilter_Base.h"
+#include "src/core/SkMaskBlurFilter.h"
 #include "src/core/SkOpts.h"
 #include "src/core/SkReadBuffer.h"
 #include "src/core/SkSpecialImage.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/core/SkWriteBuffer.h"
 
 #if SK_SUPPORT_GPU
@@ -340,6 +342,37 @@ static void blur_one_direction(Sk4u* buffer, int window,
     }
 }
 
+// Every row (or column) blur_one_direction() blurs is independent of the others. When a blur
+// executor is set, large images are split into tiles of kTileRows rows which are blurred in
+// parallel, each with its own circular buffers. Tiling does not change the result.
+static void blur_one_direction_tiled(int window,
+                                     int srcLeft, int srcRight, int dstRight,
+                                     const uint32_t* src, int srcXStride, int srcYStride, int srcH,
+                                           uint32_t* dst, int dstXStride, int dstYStride) {
+    static constexpr int kTileRows = 64;
+    static constexpr int kMinParallelPixels = 256 * 256;
+
+    auto blurRows = [&](int top, int rows) {
+        // The amount 1024 is enough for buffers up to 10 sigma.
+        SkSTArenaAlloc<1024> alloc;
+        Sk4u* buffer = alloc.makeArrayDefault<Sk4u>(calculate_buffer(window));
+        blur_one_direction(buffer, window, srcLeft, srcRight, dstRight,
+                           src + (ptrdiff_t)top * srcYStride, srcXStride, srcYStride, rows,
+                           dst + (ptrdiff_t)top * dstYStride, dstXStride, dstYStride);
+    };
+
+    int tiles = (srcH + kTileRows - 1) / kTileRows;
+    SkExecutor* executor = SkGraphicsExecutor();
+    if (executor && tiles > 1 && (int64_t)srcH * dstRight >= kMinParallelPixels) {
+        SkTaskGroup(*executor).batch(tiles, [&](int tile) {
+            int top = tile * kTileRows;
+            blurRows(top, std::min(kTileRows, srcH - top));
+        });
+    } else {
+        blurRows(0, srcH);
+    }
+}
+
 static sk_sp<SkSpecialImage> copy_image_with_bounds(
         const SkImageFilter_Base::Context& ctx, const sk_sp<SkSpecialImage> &input,
         SkIRect srcBounds, SkIRect dstBounds) {
@@ -446,14 +479,6 @@ static sk_sp<SkSpecialImage> cpu_blur(
         return nullptr;
     }
 
-    auto bufferSizeW = calculate_buffer(windowW),
-         bufferSizeH = calculate_buffer(windowH);
-
-    // The amount 1024 is enough for buffers up to 10 sigma. The tmp bitmap will be
-    // allocated on the heap.
-    SkSTArenaAlloc<1024> alloc;
-    Sk4u* buffer = alloc.makeArrayDefault<Sk4u>(std::max(bufferSizeW, bufferSizeH));
-
     // Basic Plan: The three cases to handle
     // * Horizontal and Vertical - blur horizontally while copying values from the source to
     //     the destination. Then, do an in-place vertical blur.
@@ -494,16 +519,16 @@ static sk_sp<SkSpecialImage> cpu_blur(
         intermediateWidth = dstW;
         intermediateDst = static_cast<uint32_t *>(dst.getPixels());
 
-        blur_one_direction(
-                buffer, windowW,
+        blur_one_direction_tiled(
+                windowW,
                 srcBounds.left(), srcBounds.right(), dstBounds.right(),
                 static_cast<uint32_t *>(src.getPixels()), 1, src.rowBytesAsPixels(), srcH,
                 intermediateSrc, 1, intermediateRowBytesAsPixels);
     }
 
     if (windowH > 1) {
-        blur_one_direction(
-                buffer, windowH,
+        blur_one_direction_tiled(
+                windowH,
                 srcBounds.top(), srcBounds.bottom(), dstBounds.bottom(),
                 intermediateSrc, intermediateRowBytesAsPixels, 1, intermediateWidth,
                 intermediateDst, dst.rowBytesAsPixels(), 1);
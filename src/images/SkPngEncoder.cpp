@@ -9,17 +9,23 @@
 
 #ifdef SK_ENCODE_PNG
 
+#include "include/core/SkExecutor.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkString.h"
 #include "include/encode/SkPngEncoder.h"
 #include "include/private/SkImageInfoPriv.h"
+#include "include/private/SkMalloc.h"
+#include "include/private/SkVx.h"
 #include "src/codec/SkColorTable.h"
 #include "src/codec/SkPngPriv.h"
+#include "src/core/SkEndian.h"
 #include "src/core/SkMSAN.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/images/SkImageEncoderFns.h"
 #include <vector>
 
 #include "png.h"
+#include "zlib.h"
 
 static_assert(PNG_FILTER_NONE  == (int)SkPngEncoder::FilterFlag::kNone,  "Skia libpng filter err.");
 static_assert(PNG_FILTER_SUB   == (int)SkPngEncoder::FilterFlag::kSub,   "Skia libpng filter err.");
@@ -45,6 +51,320 @@ static void sk_write_fn(png_structp png_ptr, png_bytep data, png_size_t len) {
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+// Filter types, in the order libpng tries them; (0x08 << type) is the matching FilterFlag.
+enum { kNone_Filter, kSub_Filter, kUp_Filter, kAvg_Filter, kPaeth_Filter };
+
+static inline int paeth_predictor(int a, int b, int c) {
+    int pa = std::abs(b - c),
+        pb = std::abs(a - c),
+        pc = std::abs(a + b - 2 * c);
+    return (pa <= pb && pa <= pc) ? a : pb <= pc ? b : c;
+}
+
+// Applies filter to the n bytes of cur, writing the result to dst if it's not null, and returns
+// libpng's estimate of how well the result will compress: the sum of its bytes taken as signed.
+// cur and prev must be readable from bpp bytes before to 15 bytes past their n bytes.
+template <int kFilter>
+static uint32_t apply_filter(const uint8_t* cur, const uint8_t* prev, size_t n, int bpp,
+                             uint8_t* dst) {
+    using I16 = skvx::Vec<16, int16_t>;
+    using U8  = skvx::Vec<16, uint8_t>;
+
+    skvx::Vec<16, int32_t> costs = 0;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        I16 x = skvx::cast<int16_t>(U8::Load(cur  + i)),
+            a = skvx::cast<int16_t>(U8::Load(cur  + i - bpp)),
+            b = skvx::cast<int16_t>(U8::Load(prev + i)),
+            c = skvx::cast<int16_t>(U8::Load(prev + i - bpp));
+        I16 pred = 0;
+        switch (kFilter) {
+            case kNone_Filter:  pred = 0;                break;
+            case kSub_Filter:   pred = a;                break;
+            case kUp_Filter:    pred = b;                break;
+            case kAvg_Filter:   pred = (a + b) >> 1;     break;
+            case kPaeth_Filter: {
+                I16 pa = skvx::max(b - c, c - b),
+                    pb = skvx::max(a - c, c - a),
+                    pc = skvx::max(a + b - c - c, c + c - a - b);
+                pred = skvx::if_then_else((pa <= pb) & (pa <= pc), a,
+                                          skvx::if_then_else(pb <= pc, b, c));
+            } break;
+        }
+        U8 r = skvx::cast<uint8_t>(x - pred);
+        if (dst) {
+            r.store(dst + i);
+        }
+        I16 sr = skvx::cast<int16_t>(skvx::cast<int8_t>(r));
+        costs += skvx::cast<int32_t>(skvx::max(sr, -sr));
+    }
+
+    uint32_t cost = 0;
+    for (int lane = 0; lane < 16; ++lane) {
+        cost += costs[lane];
+    }
+    for (; i < n; ++i) {
+        int x = cur[i], a = cur[i - bpp], b = prev[i], c = prev[i - bpp];
+        int pred = 0;
+        switch (kFilter) {
+            case kNone_Filter:  pred = 0;                          break;
+            case kSub_Filter:   pred = a;                          break;
+            case kUp_Filter:    pred = b;                          break;
+            case kAvg_Filter:   pred = (a + b) >> 1;               break;
+            case kPaeth_Filter: pred = paeth_predictor(a, b, c);   break;
+        }
+        uint8_t r = (uint8_t)(x - pred);
+        if (dst) {
+            dst[i] = r;
+        }
+        cost += std::abs((int)(int8_t)r);
+    }
+    return cost;
+}
+
+static uint32_t apply_filter(int filter, const uint8_t* cur, const uint8_t* prev, size_t n,
+                             int bpp, uint8_t* dst) {
+    switch (filter) {
+        case kNone_Filter:  return apply_filter<kNone_Filter >(cur, prev, n, bpp, dst);
+        case kSub_Filter:   return apply_filter<kSub_Filter  >(cur, prev, n, bpp, dst);
+        case kUp_Filter:    return apply_filter<kUp_Filter   >(cur, prev, n, bpp, dst);
+        case kAvg_Filter:   return apply_filter<kAvg_Filter  >(cur, prev, n, bpp, dst);
+        case kPaeth_Filter: return apply_filter<kPaeth_Filter>(cur, prev, n, bpp, dst);
+    }
+    SkUNREACHABLE;
+}
+
+// Writes the filter type byte and the filtered row to dst, picking the allowed filter libpng's
+// heuristic would pick.
+static void filter_row(int allowedFilters, const uint8_t* cur, const uint8_t* prev, size_t n,
+                       int bpp, uint8_t* dst) {
+    int best = kNone_Filter;
+    if (allowedFilters & (allowedFilters - 1)) {
+        uint32_t bestCost = UINT32_MAX;
+        for (int filter = kNone_Filter; filter <= kPaeth_Filter; ++filter) {
+            if (allowedFilters & (0x08 << filter)) {
+                uint32_t cost = apply_filter(filter, cur, prev, n, bpp, nullptr);
+                if (cost < bestCost) {
+                    best = filter;
+                    bestCost = cost;
+                }
+            }
+        }
+    } else if (allowedFilters) {
+        while (!(allowedFilters & (0x08 << best))) {
+            ++best;
+        }
+    }
+    dst[0] = (uint8_t)best;
+    apply_filter(best, cur, prev, n, bpp, dst + 1);
+}
+
+// Different zlib implementations use different T.
+template <typename T> static void* skia_alloc_func(void*, T items, T size) {
+    return sk_calloc_throw(SkToSizeT(items) * SkToSizeT(size));
+}
+
+static void skia_free_func(void*, void* address) { sk_free(address); }
+
+static bool write_png_chunk(SkWStream* stream, const char tag[4], const void* data, size_t len) {
+    uint32_t crc = crc32(0, (const Bytef*)tag, 4);
+    if (len > 0) {
+        crc = crc32(crc, (const Bytef*)data, SkToUInt(len));
+    }
+    return stream->write32(SkEndian_SwapBE32(SkToU32(len)))
+        && stream->write(tag, 4)
+        && stream->write(data, len)
+        && stream->write32(SkEndian_SwapBE32(crc));
+}
+
+// Filters and compresses rows on an executor, then writes the IDAT and IEND chunks itself.
+//
+// Rows are buffered until there are kChunksPerBatch chunks of about kChunkSize filtered bytes.
+// All rows of a batch are filtered in parallel, then all chunks are compressed in parallel,
+// pigz style: each one as raw deflate primed with the preceding 32K of filtered data and ended
+// with a sync flush, so they concatenate into one zlib stream. Each chunk becomes an IDAT.
+class SkPngParallelWriter {
+public:
+    SkPngParallelWriter(SkWStream* stream, SkExecutor* executor, int zlibLevel, int filters,
+                        int bytesPerPixel, size_t rowBytes, int height)
+        : fStream(stream)
+        , fExecutor(executor)
+        , fZLibLevel(zlibLevel)
+        , fFilters(filters)
+        , fBytesPerPixel(bytesPerPixel)
+        , fRowBytes(rowBytes)
+        , fRowStride(bytesPerPixel + rowBytes + 16)
+        , fRowsPerChunk(SkToInt(std::max<size_t>(1, kChunkSize / (rowBytes + 1))))
+        , fRowsLeft(height)
+        , fRows((1 + fRowsPerChunk * kChunksPerBatch) * fRowStride, 0)
+        , fAdler(adler32(0, nullptr, 0)) {}
+
+    // Takes each transformed row in order. Returns false if writing to the stream failed.
+    bool writeRow(const void* row) {
+        SkASSERT(fRowsLeft > 0);
+        fPendingRows += 1;
+        fRowsLeft -= 1;
+        memcpy(this->row(fPendingRows), row, fRowBytes);
+        if (fRowsLeft == 0 || fPendingRows == fRowsPerChunk * kChunksPerBatch) {
+            return this->flush(fRowsLeft == 0);
+        }
+        return true;
+    }
+
+private:
+    static constexpr size_t kChunkSize      = 128 * 1024;
+    static constexpr int    kChunksPerBatch = 8;
+    static constexpr size_t kWindowSize     = 32 * 1024;
+
+    // Row 0 is the last row of the previous batch, initially zero. Each row has bytesPerPixel
+    // zeros in front for the filters to read, and slack behind for whole-vector loads.
+    uint8_t* row(int i) { return fRows.data() + i * fRowStride + fBytesPerPixel; }
+
+    struct Chunk {
+        std::vector<uint8_t> fData;
+        uLong                fAdler;
+        size_t               fSize;
+        bool                 fOK = false;
+    };
+
+    // Returns false if zlib failed.
+    bool compress(const uint8_t* dictionary, size_t dictionarySize,
+                  const uint8_t* input, size_t inputSize, bool last, Chunk* dst) {
+        dst->fAdler = adler32(1, input, SkToUInt(inputSize));
+        dst->fSize = inputSize;
+
+        z_stream zStream;
+        zStream.zalloc = &skia_alloc_func;
+        zStream.zfree = &skia_free_func;
+        zStream.opaque = nullptr;
+        if (Z_OK != deflateInit2(&zStream, fZLibLevel, Z_DEFLATED, -MAX_WBITS, 8,
+                                 Z_DEFAULT_STRATEGY)) {
+            return false;
+        }
+        if (dictionarySize > 0 &&
+            Z_OK != deflateSetDictionary(&zStream, dictionary, SkToUInt(dictionarySize))) {
+            (void)deflateEnd(&zStream);
+            return false;
+        }
+        dst->fData.resize(deflateBound(&zStream, (uLong)inputSize) + 16);
+        zStream.next_in = const_cast<uint8_t*>(input);
+        zStream.avail_in = SkToUInt(inputSize);
+        zStream.next_out = dst->fData.data();
+        zStream.avail_out = SkToUInt(dst->fData.size());
+        const int flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+        while (true) {
+            int result = deflate(&zStream, flush);
+            if (result != Z_OK && result != Z_STREAM_END) {
+                (void)deflateEnd(&zStream);
+                return false;
+            }
+            if (zStream.avail_out != 0) {
+                break;
+            }
+            // deflateBound() doesn't account for the flush; grow and keep going.
+            size_t used = dst->fData.size();
+            dst->fData.resize(used * 2);
+            zStream.next_out = dst->fData.data() + used;
+            zStream.avail_out = SkToUInt(dst->fData.size() - used);
+        }
+        dst->fData.resize(dst->fData.size() - zStream.avail_out);
+        (void)deflateEnd(&zStream);
+        return true;
+    }
+
+    // Calls fn(i) for every chunk on fExecutor, or inline when already running on it (e.g. when
+    // encoding from a task on the same executor), where waiting for it could deadlock.
+    void forEachChunk(int chunkCount, const std::function<void(int)>& fn) {
+        if (SkTaskGroup::IsRunningOn(*fExecutor)) {
+            for (int i = 0; i < chunkCount; ++i) {
+                fn(i);
+            }
+        } else {
+            SkTaskGroup(*fExecutor).batch(chunkCount, fn);
+        }
+    }
+
+    bool flush(bool last) {
+        const int rows = fPendingRows;
+        const int chunkCount = (rows + fRowsPerChunk - 1) / fRowsPerChunk;
+        const size_t filteredRowBytes = 1 + fRowBytes;
+
+        // fFiltered holds up to a window of the previous batch's filtered data, then this one's.
+        const size_t dictionarySize = fFiltered.size();
+        fFiltered.resize(dictionarySize + rows * filteredRowBytes);
+
+        std::vector<Chunk> chunks(chunkCount);
+        auto chunkRange = [&](int i, size_t* start, size_t* end) {
+            *start = dictionarySize + i * fRowsPerChunk * filteredRowBytes;
+            *end   = dictionarySize + std::min(rows, (i + 1) * fRowsPerChunk) * filteredRowBytes;
+        };
+        this->forEachChunk(chunkCount, [&](int i) {
+            for (int y = i * fRowsPerChunk; y < std::min(rows, (i + 1) * fRowsPerChunk); ++y) {
+                filter_row(fFilters, this->row(y + 1), this->row(y), fRowBytes, fBytesPerPixel,
+                           fFiltered.data() + dictionarySize + y * filteredRowBytes);
+            }
+        });
+        this->forEachChunk(chunkCount, [&](int i) {
+            size_t start, end;
+            chunkRange(i, &start, &end);
+            size_t windowSize = std::min(start, kWindowSize);
+            chunks[i].fOK = this->compress(fFiltered.data() + start - windowSize, windowSize,
+                                           fFiltered.data() + start, end - start,
+                                           last && i == chunkCount - 1, &chunks[i]);
+        });
+
+        for (int i = 0; i < chunkCount; ++i) {
+            if (!chunks[i].fOK) {
+                return false;
+            }
+            std::vector<uint8_t>& data = chunks[i].fData;
+            fAdler = adler32_combine(fAdler, chunks[i].fAdler, (z_off_t)chunks[i].fSize);
+            if (!fWroteHeader) {
+                // CMF: deflate with a 32K window. FLG: FLEVEL, with FCHECK making the pair a
+                // multiple of 31.
+                unsigned flevel = fZLibLevel < 2 ? 0 : fZLibLevel < 6 ? 1 : fZLibLevel == 6 ? 2 : 3;
+                unsigned header = (0x78 << 8) | (flevel << 6);
+                header += 31 - header % 31;
+                data.insert(data.begin(), {(uint8_t)(header >> 8), (uint8_t)(header & 0xff)});
+                fWroteHeader = true;
+            }
+            if (last && i == chunkCount - 1) {
+                uint32_t adler = (uint32_t)fAdler;
+                data.insert(data.end(), {(uint8_t)(adler >> 24), (uint8_t)(adler >> 16),
+                                         (uint8_t)(adler >>  8), (uint8_t)(adler >>  0)});
+            }
+            if (!write_png_chunk(fStream, "IDAT", data.data(), data.size())) {
+                return false;
+            }
+        }
+
+        // Carry the last row and the last window of filtered data over to the next batch.
+        memcpy(this->row(0), this->row(rows), fRowBytes);
+        fPendingRows = 0;
+        size_t keep = std::min(fFiltered.size(), kWindowSize);
+        fFiltered.erase(fFiltered.begin(), fFiltered.end() - keep);
+
+        return !last || write_png_chunk(fStream, "IEND", nullptr, 0);
+    }
+
+    SkWStream*           fStream;
+    SkExecutor*          fExecutor;
+    const int            fZLibLevel;
+    const int            fFilters;
+    const int            fBytesPerPixel;
+    const size_t         fRowBytes;
+    const size_t         fRowStride;
+    const int            fRowsPerChunk;
+    int                  fRowsLeft;
+    std::vector<uint8_t> fRows;
+    int                  fPendingRows = 0;
+    std::vector<uint8_t> fFiltered;
+    uLong                fAdler;
+    bool                 fWroteHeader = false;
+};
+
 class SkPngEncoderMgr final : SkNoncopyable {
 public:
 
@@ -58,11 +378,14 @@ public:
     bool setColorSpace(const SkImageInfo& info);
     bool writeInfo(const SkImageInfo& srcInfo);
     void chooseProc(const SkImageInfo& srcInfo);
+    void useParallelWriter(SkWStream* stream, const SkImageInfo& srcInfo,
+                           const SkPngEncoder::Options& options);
 
     png_structp pngPtr() { return fPngPtr; }
     png_infop infoPtr() { return fInfoPtr; }
     int pngBytesPerPixel() const { return fPngBytesPerPixel; }
     transform_scanline_proc proc() const { return fProc; }
+    SkPngParallelWriter* parallelWriter() const { return fParallelWriter.get(); }
 
     ~SkPngEncoderMgr() {
         png_destroy_write_struct(&fPngPtr, &fInfoPtr);
@@ -79,6 +402,7 @@ private:
     png_infop               fInfoPtr;
     int                     fPngBytesPerPixel;
     transform_scanline_proc fProc;
+    std::unique_ptr<SkPngParallelWriter> fParallelWriter;
 };
 
 std::unique_ptr<SkPngEncoderMgr> SkPngEncoderMgr::Make(SkWStream* stream) {
@@ -392,6 +716,22 @@ void SkPngEncoderMgr::chooseProc(const SkImageInfo& srcInfo) {
     fProc = choose_proc(srcInfo);
 }
 
+void SkPngEncoderMgr::useParallelWriter(SkWStream* stream, const SkImageInfo& srcInfo,
+                                        const SkPngEncoder::Options& options) {
+    // Only when our rows are exactly what libpng would filter, i.e. libpng has no transforms
+    // of its own to apply (like the filler for opaque F16).
+    int channels = png_get_channels(fPngPtr, fInfoPtr),
+        bitDepth = png_get_bit_depth(fPngPtr, fInfoPtr);
+    if (channels * bitDepth != fPngBytesPerPixel * 8) {
+        return;
+    }
+    int filters = (int)options.fFilterFlags & (int)SkPngEncoder::FilterFlag::kAll;
+    int zlibLevel = std::min(std::max(0, options.fZLibLevel), 9);
+    fParallelWriter = std::make_unique<SkPngParallelWriter>(
+            stream, options.fExecutor, zlibLevel, filters, fPngBytesPerPixel,
+            (size_t)fPngBytesPerPixel * srcInfo.width(), srcInfo.height());
+}
+
 std::unique_ptr<SkEncoder> SkPngEncoder::Make(SkWStream* dst, const SkPixmap& src,
                                               const Options& options) {
     if (!SkPixmapIsValid(src)) {
@@ -416,6 +756,9 @@ std::unique_ptr<SkEncoder> SkPngEncoder::Make(SkWStream* dst, const SkPixmap& sr
     }
 
     encoderMgr->chooseProc(src.info());
+    if (options.fExecutor) {
+        encoderMgr->useParallelWriter(dst, src.info(), options);
+    }
 
     return std::unique_ptr<SkPngEncoder>(new SkPngEncoder(std::move(encoderMgr), src));
 }
@@ -433,6 +776,23 @@ bool SkPngEncoder::onEncodeRows(int numRows) {
     }
 
     const void* srcRow = fSrc.addr(0, fCurrRow);
+    if (SkPngParallelWriter* writer = fEncoderMgr->parallelWriter()) {
+        for (int y = 0; y < numRows; y++) {
+            sk_msan_assert_initialized(srcRow, (const uint8_t*)srcRow +
+                                               (fSrc.width() << fSrc.shiftPerPixel()));
+            fEncoderMgr->proc()((char*)fStorage.get(),
+                                (const char*)srcRow,
+                                fSrc.width(),
+                                SkColorTypeBytesPerPixel(fSrc.colorType()));
+            if (!writer->writeRow(fStorage.get())) {
+                return false;
+            }
+            srcRow = SkTAddOffset<const void>(srcRow, fSrc.rowBytes());
+        }
+        fCurrRow += numRows;
+        return true;
+    }
+
     for (int y = 0; y < numRows; y++) {
         sk_msan_assert_initialized(srcRow,
                                    (const uint8_t*)srcRow + (fSrc.width() << fSrc.shiftPerPixel()));
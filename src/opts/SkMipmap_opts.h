@@ -0,0 +1,237 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkMipmap_opts_DEFINED
+#define SkMipmap_opts_DEFINED
+
+#include "include/private/SkHalf.h"
+#include "include/private/SkVx.h"
+
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    #include <immintrin.h>
+#endif
+
+// These are the 2x2 box filters SkMipmap uses for even-sized levels of its most common color
+// types. Each must produce exactly the same bits as the portable downsample_2_2<> in SkMipmap.cpp;
+// they only differ in how many dst pixels they make at a time.
+
+namespace SK_OPTS_NS {
+
+    // Each 64-bit lane holds two side-by-side 8888 pixels. We spread the even (r,b) and odd (g,a)
+    // bytes out into 16-bit slots, which leaves room to sum four pixels without overflow.
+    template <int N>
+    static SK_ALWAYS_INLINE skvx::Vec<N,uint32_t> box_8888(const skvx::Vec<N,uint64_t>& r0,
+                                                           const skvx::Vec<N,uint64_t>& r1) {
+        const uint64_t mask = 0x00ff00ff00ff00ff;
+        skvx::Vec<N,uint64_t> rb = (r0 & mask) + (r1 & mask),
+                              ga = ((r0 >> 8) & mask) + ((r1 >> 8) & mask);
+        // Fold the right pixel of each pair onto the left one, then divide by four.
+        rb = (rb + (rb >> 32)) >> 2;
+        ga = (ga + (ga >> 32)) >> 2;
+        return skvx::cast<uint32_t>((rb & 0x00ff00ff) | ((ga & 0x00ff00ff) << 8));
+    }
+
+    /*not static*/ inline void downsample_2_2_8888(void* dst, const void* src, size_t srcRB,
+                                                   int count) {
+        auto p0 = static_cast<const uint64_t*>(src);
+        auto p1 = (const uint64_t*)((const char*)p0 + srcRB);
+        auto d  = static_cast<uint32_t*>(dst);
+
+    #if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+        // Widen four src pixels from each row to 16-bit channels and sum the rows, then sum each
+        // left pixel with its right neighbor. This leaves two dst pixels per 128 bits.
+        #if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX2
+            using V = __m256i;
+            constexpr int N = 8;
+            auto load    = [](const void* p) { return _mm256_loadu_si256((const V*)p); };
+            auto box     = [](V a, V b) {
+                const V zero = _mm256_setzero_si256();
+                V lo = _mm256_add_epi16(_mm256_unpacklo_epi8(a, zero),
+                                        _mm256_unpacklo_epi8(b, zero)),
+                  hi = _mm256_add_epi16(_mm256_unpackhi_epi8(a, zero),
+                                        _mm256_unpackhi_epi8(b, zero));
+                return _mm256_srli_epi16(_mm256_add_epi16(_mm256_unpacklo_epi64(lo, hi),
+                                                          _mm256_unpackhi_epi64(lo, hi)), 2);
+            };
+            auto store = [](void* p, V x, V y) {
+                // packus works within each 128-bit half, leaving dst pixels 0,1,4,5,2,3,6,7.
+                _mm256_storeu_si256((V*)p, _mm256_permute4x64_epi64(_mm256_packus_epi16(x, y),
+                                                                    _MM_SHUFFLE(3,1,2,0)));
+            };
+        #else
+            using V = __m128i;
+            constexpr int N = 4;
+            auto load    = [](const void* p) { return _mm_loadu_si128((const V*)p); };
+            auto box     = [](V a, V b) {
+                const V zero = _mm_setzero_si128();
+                V lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero)),
+                  hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+                return _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(lo, hi),
+                                                    _mm_unpackhi_epi64(lo, hi)), 2);
+            };
+            auto store = [](void* p, V x, V y) { _mm_storeu_si128((V*)p, _mm_packus_epi16(x, y)); };
+        #endif
+        while (count >= N) {
+            store(d, box(load(p0 +   0), load(p1 +   0)),
+                     box(load(p0 + N/2), load(p1 + N/2)));
+            p0 += N;
+            p1 += N;
+            d  += N;
+            count -= N;
+        }
+    #else
+        constexpr int N = 4;
+        while (count >= N) {
+            box_8888<N>(skvx::Vec<N,uint64_t>::Load(p0),
+                        skvx::Vec<N,uint64_t>::Load(p1)).store(d);
+            p0 += N;
+            p1 += N;
+            d  += N;
+            count -= N;
+        }
+    #endif
+        while (count --> 0) {
+            box_8888<1>(skvx::Vec<1,uint64_t>::Load(p0++),
+                        skvx::Vec<1,uint64_t>::Load(p1++)).store(d++);
+        }
+    }
+
+    /*not static*/ inline void downsample_2_2_a8(void* dst, const void* src, size_t srcRB,
+                                                 int count) {
+        // Each 16-bit lane holds two side-by-side alpha pixels.
+        auto p0 = static_cast<const uint8_t*>(src);
+        auto p1 = p0 + srcRB;
+        auto d  = static_cast<uint8_t*>(dst);
+
+    #if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX2
+        using V = __m256i;
+        constexpr int N = 32;
+        auto box = [](const uint8_t* p0, const uint8_t* p1) {
+            V a = _mm256_loadu_si256((const V*)p0),
+              b = _mm256_loadu_si256((const V*)p1);
+            const V mask = _mm256_set1_epi16(0xff);
+            V c = _mm256_add_epi16(_mm256_add_epi16(_mm256_and_si256(a, mask),
+                                                    _mm256_srli_epi16(a, 8)),
+                                   _mm256_add_epi16(_mm256_and_si256(b, mask),
+                                                    _mm256_srli_epi16(b, 8)));
+            return _mm256_srli_epi16(c, 2);
+        };
+        while (count >= N) {
+            // As above, undo packus working within each 128-bit half.
+            V x = _mm256_packus_epi16(box(p0, p1), box(p0 + N, p1 + N));
+            _mm256_storeu_si256((V*)d, _mm256_permute4x64_epi64(x, _MM_SHUFFLE(3,1,2,0)));
+            p0 += 2*N;
+            p1 += 2*N;
+            d  += N;
+            count -= N;
+        }
+    #elif SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+        using V = __m128i;
+        constexpr int N = 16;
+        auto box = [](const uint8_t* p0, const uint8_t* p1) {
+            V a = _mm_loadu_si128((const V*)p0),
+              b = _mm_loadu_si128((const V*)p1);
+            const V mask = _mm_set1_epi16(0xff);
+            V c = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(a, mask), _mm_srli_epi16(a, 8)),
+                                _mm_add_epi16(_mm_and_si128(b, mask), _mm_srli_epi16(b, 8)));
+            return _mm_srli_epi16(c, 2);
+        };
+        while (count >= N) {
+            _mm_storeu_si128((V*)d, _mm_packus_epi16(box(p0, p1), box(p0 + N, p1 + N)));
+            p0 += 2*N;
+            p1 += 2*N;
+            d  += N;
+            count -= N;
+        }
+    #else
+        constexpr int N = 16;
+        while (count >= N) {
+            auto r0 = skvx::Vec<N,uint16_t>::Load(p0),
+                 r1 = skvx::Vec<N,uint16_t>::Load(p1);
+            auto c  = (r0 & 0xff) + (r0 >> 8) + (r1 & 0xff) + (r1 >> 8);
+            skvx::cast<uint8_t>(c >> 2).store(d);
+            p0 += 2*N;
+            p1 += 2*N;
+            d  += N;
+            count -= N;
+        }
+    #endif
+        while (count --> 0) {
+            unsigned c = p0[0] + p1[0] + p0[1] + p1[1];
+            *d++ = (uint8_t)(c >> 2);
+            p0 += 2;
+            p1 += 2;
+        }
+    }
+
+    /*not static*/ inline void downsample_2_2_f16(void* dst, const void* src, size_t srcRB,
+                                                  int count) {
+        auto p0 = static_cast<const uint64_t*>(src);
+        auto p1 = (const uint64_t*)((const char*)p0 + srcRB);
+        auto d  = static_cast<uint64_t*>(dst);
+
+    #if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX2
+        // With 256-bit registers we can make two dst pixels at once. These conversions are wide
+        // copies of SkHalfToFloat_finite_ftz() and SkFloatToHalf_finite_ftz(); F16C's instructions
+        // would be faster but treat denorms differently.
+        auto half_to_float = [](__m128i h) {
+            __m256i bits     = _mm256_cvtepu16_epi32(h),
+                    sign     = _mm256_and_si256(bits, _mm256_set1_epi32(0x00008000)),
+                    positive = _mm256_xor_si256(bits, sign),
+                    is_norm  = _mm256_cmpgt_epi32(positive, _mm256_set1_epi32(0x03ff)),
+                    norm     = _mm256_add_epi32(_mm256_slli_epi32(positive, 13),
+                                                _mm256_set1_epi32((127 - 15) << 23));
+            return _mm256_castsi256_ps(_mm256_or_si256(_mm256_slli_epi32(sign, 16),
+                                                       _mm256_and_si256(norm, is_norm)));
+        };
+        auto float_to_half = [](__m256 f) {
+            __m256i bits         = _mm256_castps_si256(f),
+                    sign         = _mm256_and_si256(bits, _mm256_set1_epi32(0x80000000)),
+                    positive     = _mm256_xor_si256(bits, sign),
+                    will_be_norm = _mm256_cmpgt_epi32(positive, _mm256_set1_epi32(0x387fdfff)),
+                    norm         = _mm256_srli_epi32(_mm256_sub_epi32(positive,
+                                                         _mm256_set1_epi32((127 - 15) << 23)), 13),
+                    merged       = _mm256_or_si256(_mm256_srli_epi32(sign, 16),
+                                                   _mm256_and_si256(will_be_norm, norm));
+            merged = _mm256_and_si256(merged, _mm256_set1_epi32(0xffff));
+            return _mm_packus_epi32(_mm256_castsi256_si128(merged),
+                                    _mm256_extracti128_si256(merged, 1));
+        };
+        // Split four src pixels from a row into the left and right pixel of each pair.
+        auto split = [](const uint64_t* p) {
+            return _mm256_permute4x64_epi64(_mm256_loadu_si256((const __m256i*)p),
+                                            _MM_SHUFFLE(3,1,2,0));
+        };
+        for (; count >= 2; count -= 2) {
+            __m256i r0 = split(p0),
+                    r1 = split(p1);
+            // Keep the portable filter's order of float additions.
+            __m256 c = _mm256_add_ps(
+                       _mm256_add_ps(
+                       _mm256_add_ps(half_to_float(_mm256_castsi256_si128(r0)),
+                                     half_to_float(_mm256_castsi256_si128(r1))),
+                                     half_to_float(_mm256_extracti128_si256(r0, 1))),
+                                     half_to_float(_mm256_extracti128_si256(r1, 1)));
+            _mm_storeu_si128((__m128i*)d, float_to_half(_mm256_mul_ps(c, _mm256_set1_ps(0.25f))));
+            p0 += 4;
+            p1 += 4;
+            d  += 2;
+        }
+    #endif
+        // Elsewhere one pixel already fills a register.
+        for (; count > 0; --count) {
+            Sk4f c = SkHalfToFloat_finite_ftz(p0[0]) + SkHalfToFloat_finite_ftz(p1[0])
+                   + SkHalfToFloat_finite_ftz(p0[1]) + SkHalfToFloat_finite_ftz(p1[1]);
+            SkFloatToHalf_finite_ftz(c * 0.25f).store(d++);
+            p0 += 2;
+            p1 += 2;
+        }
+    }
+
+}  // namespace SK_OPTS_NS
+
+#endif//SkMipmap_opts_DEFINED
@@ -332,7 +332,199 @@ namespace SK_OPTS_NS {
         }
     }
 
-#elif defined(JUMPER_IS_AVX) || defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
+#elif defined(JUMPER_IS_SKX)
+    // These are __m512 and __m512i, but friendlier and strongly-typed.
+    template <typename T> using V = T __attribute__((ext_vector_type(16)));
+    using F   = V<float   >;
+    using I32 = V< int32_t>;
+    using U64 = V<uint64_t>;
+    using U32 = V<uint32_t>;
+    using U16 = V<uint16_t>;
+    using U8  = V<uint8_t >;
+
+    // A mask enabling the first n lanes of an AVX-512 operation, clamped to the mask's width.
+    // Masked loads never fault on disabled lanes, so this is how we handle tails.
+    template <typename M>
+    SI M first_n(int n) {
+        constexpr int kBits = 8*sizeof(M);
+        return n <= 0     ? (M)0
+             : n >= kBits ? (M)~(M)0
+             :              (M)(((M)1 << n) - 1);
+    }
+    SI int active_lanes(size_t tail) { return tail ? (int)tail : 16; }
+
+    SI F   mad(F f, F m, F a)   { return _mm512_fmadd_ps(f,m,a); }
+    SI F   min(F a, F b)        { return _mm512_min_ps(a,b);     }
+    SI F   max(F a, F b)        { return _mm512_max_ps(a,b);     }
+    SI F   abs_  (F v)          { return _mm512_abs_ps(v);       }
+    SI F   floor_(F v)          { return _mm512_floor_ps(v);     }
+    SI F   rcp   (F v)          { return _mm512_rcp14_ps  (v);   }
+    SI F   rsqrt (F v)          { return _mm512_rsqrt14_ps(v);   }
+    SI F    sqrt_(F v)          { return _mm512_sqrt_ps (v);     }
+    SI U32 round (F v, F scale) { return _mm512_cvtps_epi32(v*scale); }
+
+    // Like _mm256_packus_epi32() and _mm_packus_epi16(), saturate signed values to [0,max].
+    SI U16 pack(U32 v) {
+        return _mm512_cvtusepi32_epi16(_mm512_max_epi32(v, _mm512_setzero_si512()));
+    }
+    SI U8 pack(U16 v) {
+        return _mm256_cvtusepi16_epi8(_mm256_max_epi16(v, _mm256_setzero_si256()));
+    }
+
+    SI F if_then_else(I32 c, F t, F e) {
+        return _mm512_mask_blend_ps(_mm512_movepi32_mask(c), e,t);
+    }
+
+    template <typename T>
+    SI V<T> gather(const T* p, U32 ix) {
+        return { p[ix[ 0]], p[ix[ 1]], p[ix[ 2]], p[ix[ 3]],
+                 p[ix[ 4]], p[ix[ 5]], p[ix[ 6]], p[ix[ 7]],
+                 p[ix[ 8]], p[ix[ 9]], p[ix[10]], p[ix[11]],
+                 p[ix[12]], p[ix[13]], p[ix[14]], p[ix[15]], };
+    }
+    SI F   gather(const float*    p, U32 ix) { return _mm512_i32gather_ps   (ix, p, 4); }
+    SI U32 gather(const uint32_t* p, U32 ix) { return _mm512_i32gather_epi32(ix, p, 4); }
+    SI U64 gather(const uint64_t* p, U32 ix) {
+        __m512i parts[] = {
+            _mm512_i32gather_epi64(_mm512_castsi512_si256   (ix   ), p, 8),
+            _mm512_i32gather_epi64(_mm512_extracti64x4_epi64(ix, 1), p, 8),
+        };
+        return sk_bit_cast<U64>(parts);
+    }
+
+    // The interleaved loads and stores below move whole pixels with masked loads and stores,
+    // then shuffle channels between registers with two-source permutes.
+
+    SI void load2(const uint16_t* ptr, size_t tail, U16* r, U16* g) {
+        __m512i rg = _mm512_maskz_loadu_epi32(first_n<__mmask16>(active_lanes(tail)), ptr);
+        *r = _mm512_cvtepi32_epi16(rg);
+        *g = _mm512_cvtepi32_epi16(_mm512_srli_epi32(rg, 16));
+    }
+    SI void store2(uint16_t* ptr, size_t tail, U16 r, U16 g) {
+        __m512i rg = _mm512_or_si512(_mm512_cvtepu16_epi32(r),
+                                     _mm512_slli_epi32(_mm512_cvtepu16_epi32(g), 16));
+        _mm512_mask_storeu_epi32(ptr, first_n<__mmask16>(active_lanes(tail)), rg);
+    }
+
+    SI void load3(const uint16_t* ptr, size_t tail, U16* r, U16* g, U16* b) {
+        // 16 pixels of 3 uint16_t span 48 values: 32 in lo, 16 in the bottom of hi.
+        const int n = 3*active_lanes(tail);
+        __m512i lo = _mm512_maskz_loadu_epi16(first_n<__mmask32>(n), ptr),
+                hi = _mm512_maskz_loadu_epi16(first_n<__mmask32>(n - 32), ptr + 32);
+
+        auto channel = [&](int c) -> U16 {
+            __m512i ix = _mm512_set_epi16(0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,
+                                          45+c,42+c,39+c,36+c,33+c,30+c,27+c,24+c,
+                                          21+c,18+c,15+c,12+c, 9+c, 6+c, 3+c, 0+c);
+            return _mm512_castsi512_si256(_mm512_permutex2var_epi16(lo, ix, hi));
+        };
+        *r = channel(0);
+        *g = channel(1);
+        *b = channel(2);
+    }
+    SI void load4(const uint16_t* ptr, size_t tail, U16* r, U16* g, U16* b, U16* a) {
+        // Each pixel is 64 bits: pixels 0-7 go in lo, 8-15 in hi.
+        const __mmask16 mask = first_n<__mmask16>(active_lanes(tail));
+        __m512i lo = _mm512_maskz_loadu_epi64((__mmask8)(mask >> 0), ptr +  0),
+                hi = _mm512_maskz_loadu_epi64((__mmask8)(mask >> 8), ptr + 32);
+
+        auto channel = [&](int c) -> U16 {
+            __m512i ix = _mm512_set_epi16(0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,
+                                          60+c,56+c,52+c,48+c,44+c,40+c,36+c,32+c,
+                                          28+c,24+c,20+c,16+c,12+c, 8+c, 4+c, 0+c);
+            return _mm512_castsi512_si256(_mm512_permutex2var_epi16(lo, ix, hi));
+        };
+        *r = channel(0);
+        *g = channel(1);
+        *b = channel(2);
+        *a = channel(3);
+    }
+    SI void store4(uint16_t* ptr, size_t tail, U16 r, U16 g, U16 b, U16 a) {
+        __m512i rg = _mm512_inserti64x4(_mm512_castsi256_si512(r), g, 1),  // r0..r15 g0..g15
+                ba = _mm512_inserti64x4(_mm512_castsi256_si512(b), a, 1);  // b0..b15 a0..a15
+
+        // Pixel p's channels are rg[p], rg[16+p], ba[p], ba[16+p]; ba starts at index 32.
+        auto pixels = [&](int p) -> __m512i {
+            __m512i ix = _mm512_set_epi16(
+                    48+p+7, 32+p+7, 16+p+7, p+7,  48+p+6, 32+p+6, 16+p+6, p+6,
+                    48+p+5, 32+p+5, 16+p+5, p+5,  48+p+4, 32+p+4, 16+p+4, p+4,
+                    48+p+3, 32+p+3, 16+p+3, p+3,  48+p+2, 32+p+2, 16+p+2, p+2,
+                    48+p+1, 32+p+1, 16+p+1, p+1,  48+p+0, 32+p+0, 16+p+0, p+0);
+            return _mm512_permutex2var_epi16(rg, ix, ba);
+        };
+        const __mmask16 mask = first_n<__mmask16>(active_lanes(tail));
+        _mm512_mask_storeu_epi64(ptr +  0, (__mmask8)(mask >> 0), pixels(0));
+        _mm512_mask_storeu_epi64(ptr + 32, (__mmask8)(mask >> 8), pixels(8));
+    }
+
+    SI void load2(const float* ptr, size_t tail, F* r, F* g) {
+        const int n = 2*active_lanes(tail);
+        F lo = _mm512_maskz_loadu_ps(first_n<__mmask16>(n     ), ptr +  0),
+          hi = _mm512_maskz_loadu_ps(first_n<__mmask16>(n - 16), ptr + 16);
+
+        __m512i ix_r = _mm512_set_epi32(30,28,26,24,22,20,18,16,14,12,10, 8, 6, 4, 2, 0),
+                ix_g = _mm512_set_epi32(31,29,27,25,23,21,19,17,15,13,11, 9, 7, 5, 3, 1);
+        *r = _mm512_permutex2var_ps(lo, ix_r, hi);
+        *g = _mm512_permutex2var_ps(lo, ix_g, hi);
+    }
+    SI void store2(float* ptr, size_t tail, F r, F g) {
+        __m512i ix_lo = _mm512_set_epi32(23, 7,22, 6,21, 5,20, 4,19, 3,18, 2,17, 1,16, 0),
+                ix_hi = _mm512_set_epi32(31,15,30,14,29,13,28,12,27,11,26,10,25, 9,24, 8);
+        const int n = 2*active_lanes(tail);
+        _mm512_mask_storeu_ps(ptr +  0, first_n<__mmask16>(n     ),
+                              _mm512_permutex2var_ps(r, ix_lo, g));
+        _mm512_mask_storeu_ps(ptr + 16, first_n<__mmask16>(n - 16),
+                              _mm512_permutex2var_ps(r, ix_hi, g));
+    }
+
+    SI void load4(const float* ptr, size_t tail, F* r, F* g, F* b, F* a) {
+        // _0 holds pixels 0-3, _1 pixels 4-7, etc.
+        const int n = 4*active_lanes(tail);
+        F _0 = _mm512_maskz_loadu_ps(first_n<__mmask16>(n -  0), ptr +  0),
+          _1 = _mm512_maskz_loadu_ps(first_n<__mmask16>(n - 16), ptr + 16),
+          _2 = _mm512_maskz_loadu_ps(first_n<__mmask16>(n - 32), ptr + 32),
+          _3 = _mm512_maskz_loadu_ps(first_n<__mmask16>(n - 48), ptr + 48);
+
+        // First gather 8 pixels worth of two channels into each register...
+        __m512i ix_rg = _mm512_set_epi32(29,25,21,17,13, 9, 5, 1, 28,24,20,16,12, 8, 4, 0),
+                ix_ba = _mm512_set_epi32(31,27,23,19,15,11, 7, 3, 30,26,22,18,14,10, 6, 2);
+        F rg01 = _mm512_permutex2var_ps(_0, ix_rg, _1),  // r0..r7  g0..g7
+          ba01 = _mm512_permutex2var_ps(_0, ix_ba, _1),  // b0..b7  a0..a7
+          rg23 = _mm512_permutex2var_ps(_2, ix_rg, _3),  // r8..r15 g8..g15
+          ba23 = _mm512_permutex2var_ps(_2, ix_ba, _3);  // b8..b15 a8..a15
+
+        // ... then join the low or high halves of those.
+        __m512i ix_lo = _mm512_set_epi32(23,22,21,20,19,18,17,16, 7, 6, 5, 4, 3, 2, 1, 0),
+                ix_hi = _mm512_set_epi32(31,30,29,28,27,26,25,24,15,14,13,12,11,10, 9, 8);
+        *r = _mm512_permutex2var_ps(rg01, ix_lo, rg23);
+        *g = _mm512_permutex2var_ps(rg01, ix_hi, rg23);
+        *b = _mm512_permutex2var_ps(ba01, ix_lo, ba23);
+        *a = _mm512_permutex2var_ps(ba01, ix_hi, ba23);
+    }
+    SI void store4(float* ptr, size_t tail, F r, F g, F b, F a) {
+        // The inverse of load4(): first make r0..r7 g0..g7 and friends...
+        __m512i ix_lo = _mm512_set_epi32(23,22,21,20,19,18,17,16, 7, 6, 5, 4, 3, 2, 1, 0),
+                ix_hi = _mm512_set_epi32(31,30,29,28,27,26,25,24,15,14,13,12,11,10, 9, 8);
+        F rg01 = _mm512_permutex2var_ps(r, ix_lo, g),
+          rg23 = _mm512_permutex2var_ps(r, ix_hi, g),
+          ba01 = _mm512_permutex2var_ps(b, ix_lo, a),
+          ba23 = _mm512_permutex2var_ps(b, ix_hi, a);
+
+        // ... then interleave 4 pixels at a time: pixel p is rg[p], rg[8+p], ba[p], ba[8+p].
+        __m512i ix_0 = _mm512_set_epi32(27,19,11, 3, 26,18,10, 2, 25,17, 9, 1, 24,16, 8, 0),
+                ix_1 = _mm512_set_epi32(31,23,15, 7, 30,22,14, 6, 29,21,13, 5, 28,20,12, 4);
+        const int n = 4*active_lanes(tail);
+        _mm512_mask_storeu_ps(ptr +  0, first_n<__mmask16>(n -  0),
+                              _mm512_permutex2var_ps(rg01, ix_0, ba01));
+        _mm512_mask_storeu_ps(ptr + 16, first_n<__mmask16>(n - 16),
+                              _mm512_permutex2var_ps(rg01, ix_1, ba01));
+        _mm512_mask_storeu_ps(ptr + 32, first_n<__mmask16>(n - 32),
+                              _mm512_permutex2var_ps(rg23, ix_0, ba23));
+        _mm512_mask_storeu_ps(ptr + 48, first_n<__mmask16>(n - 48),
+                              _mm512_permutex2var_ps(rg23, ix_1, ba23));
+    }
+
+#elif defined(JUMPER_IS_AVX) || defined(JUMPER_IS_HSW)
     // These are __m256 and __m256i, but friendlier and strongly-typed.
     template <typename T> using V = T __attribute__((ext_vector_type(8)));
     using F   = V<float   >;
@@ -343,7 +535,7 @@ namespace SK_OPTS_NS {
     using U8  = V<uint8_t >;
 
     SI F mad(F f, F m, F a)  {
-    #if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
+    #if defined(JUMPER_IS_HSW)
         return _mm256_fmadd_ps(f,m,a);
     #else
         return f*m+a;
@@ -375,7 +567,7 @@ namespace SK_OPTS_NS {
         return { p[ix[0]], p[ix[1]], p[ix[2]], p[ix[3]],
                  p[ix[4]], p[ix[5]], p[ix[6]], p[ix[7]], };
     }
-    #if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
+    #if defined(JUMPER_IS_HSW)
         SI F   gather(const float*    p, U32 ix) { return _mm256_i32gather_ps   (p, ix, 4); }
         SI U32 gather(const uint32_t* p, U32 ix) { return _mm256_i32gather_epi32(p, ix, 4); }
         SI U64 gather(const uint64_t* p, U32 ix) {
@@ -980,7 +1172,10 @@ SI F from_half(U16 h) {
     && !defined(SK_BUILD_FOR_GOOGLE3)  // Temporary workaround for some Google3 builds.
     return vcvt_f32_f16(h);
 
-#elif defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
+#elif defined(JUMPER_IS_SKX)
+    return _mm512_cvtph_ps(h);
+
+#elif defined(JUMPER_IS_HSW)
     return _mm256_cvtph_ps(h);
 
 #else
@@ -1001,7 +1196,10 @@ SI U16 to_half(F f) {
     && !defined(SK_BUILD_FOR_GOOGLE3)  // Temporary workaround for some Google3 builds.
     return vcvt_f16_f32(f);
 
-#elif defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
+#elif defined(JUMPER_IS_SKX)
+    return _mm512_cvtps_ph(f, _MM_FROUND_CUR_DIRECTION);
+
+#elif defined(JUMPER_IS_HSW)
     return _mm256_cvtps_ph(f, _MM_FROUND_CUR_DIRECTION);
 
 #else
@@ -1131,7 +1329,26 @@ static void start_pipeline(size_t dx, size_t dy, size_t xlimit, size_t ylimit, v
 
 template <typename V, typename T>
 SI V load(const T* src, size_t tail) {
-#if !defined(JUMPER_IS_SCALAR)
+#if defined(JUMPER_IS_SKX)
+    static_assert(sizeof(V) == N*sizeof(T), "");
+    if (__builtin_expect(tail, 0)) {
+        // Any inactive lanes are zeroed, and never read from memory.
+        const __mmask16 mask = first_n<__mmask16>((int)tail);
+        if constexpr (sizeof(T) == 1) {
+            return sk_bit_cast<V>(_mm_maskz_loadu_epi8(mask, src));
+        } else if constexpr (sizeof(T) == 2) {
+            return sk_bit_cast<V>(_mm256_maskz_loadu_epi16(mask, src));
+        } else if constexpr (sizeof(T) == 4) {
+            return sk_bit_cast<V>(_mm512_maskz_loadu_epi32(mask, src));
+        } else {
+            __m512i parts[] = {
+                _mm512_maskz_loadu_epi64((__mmask8)(mask >> 0), src + 0),
+                _mm512_maskz_loadu_epi64((__mmask8)(mask >> 8), src + 8),
+            };
+            return sk_bit_cast<V>(parts);
+        }
+    }
+#elif !defined(JUMPER_IS_SCALAR)
     __builtin_assume(tail < N);
     if (__builtin_expect(tail, 0)) {
         V v{};  // Any inactive lanes are zeroed.
@@ -1152,7 +1369,25 @@ SI V load(const T* src, size_t tail) {
 
 template <typename V, typename T>
 SI void store(T* dst, V v, size_t tail) {
-#if !defined(JUMPER_IS_SCALAR)
+#if defined(JUMPER_IS_SKX)
+    static_assert(sizeof(V) == N*sizeof(T), "");
+    if (__builtin_expect(tail, 0)) {
+        const __mmask16 mask = first_n<__mmask16>((int)tail);
+        if constexpr (sizeof(T) == 1) {
+            _mm_mask_storeu_epi8(dst, mask, sk_bit_cast<__m128i>(v));
+        } else if constexpr (sizeof(T) == 2) {
+            _mm256_mask_storeu_epi16(dst, mask, sk_bit_cast<__m256i>(v));
+        } else if constexpr (sizeof(T) == 4) {
+            _mm512_mask_storeu_epi32(dst, mask, sk_bit_cast<__m512i>(v));
+        } else {
+            __m512i parts[2];
+            memcpy(parts, &v, sizeof(v));
+            _mm512_mask_storeu_epi64(dst + 0, (__mmask8)(mask >> 0), parts[0]);
+            _mm512_mask_storeu_epi64(dst + 8, (__mmask8)(mask >> 8), parts[1]);
+        }
+        return;
+    }
+#elif !defined(JUMPER_IS_SCALAR)
     __builtin_assume(tail < N);
     if (__builtin_expect(tail, 0)) {
         switch (tail) {
@@ -1272,7 +1507,7 @@ STAGE(seed_shader, Ctx::None) {
 
 STAGE(dither, const float* rate) {
     // Get [(dx,dy), (dx+1,dy), (dx+2,dy), ...] loaded up in integer vectors.
-    uint32_t iota[] = {0,1,2,3,4,5,6,7};
+    static const uint32_t iota[] = {0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15};
     U32 X = dx + sk_unaligned_load<U32>(iota),
         Y = dy;
 
@@ -2398,7 +2633,18 @@ STAGE(matrix_perspective, const float* m) {
 SI void gradient_lookup(const SkRasterPipeline_GradientCtx* c, U32 idx, F t,
                         F* r, F* g, F* b, F* a) {
     F fr, br, fg, bg, fb, bb, fa, ba;
-#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
+#if defined(JUMPER_IS_SKX)
+    if (c->stopCount <= 16) {
+        fr = _mm512_permutexvar_ps(idx, _mm512_loadu_ps(c->fs[0]));
+        br = _mm512_permutexvar_ps(idx, _mm512_loadu_ps(c->bs[0]));
+        fg = _mm512_permutexvar_ps(idx, _mm512_loadu_ps(c->fs[1]));
+        bg = _mm512_permutexvar_ps(idx, _mm512_loadu_ps(c->bs[1]));
+        fb = _mm512_permutexvar_ps(idx, _mm512_loadu_ps(c->fs[2]));
+        bb = _mm512_permutexvar_ps(idx, _mm512_loadu_ps(c->bs[2]));
+        fa = _mm512_permutexvar_ps(idx, _mm512_loadu_ps(c->fs[3]));
+        ba = _mm512_permutexvar_ps(idx, _mm512_loadu_ps(c->bs[3]));
+    } else
+#elif defined(JUMPER_IS_HSW)
     if (c->stopCount <=8) {
         fr = _mm256_permutevar8x32_ps(_mm256_loadu_ps(c->fs[0]), idx);
         br = _mm256_permutevar8x32_ps(_mm256_loadu_ps(c->bs[0]), idx);
@@ -3129,7 +3375,9 @@ SI F rcp(F x) {
 #endif
 }
 SI F sqrt_(F x) {
-#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
+#if defined(JUMPER_IS_SKX)
+    return _mm512_sqrt_ps(x);
+#elif defined(JUMPER_IS_HSW)
     __m256 lo,hi;
     split(x, &lo,&hi);
     return join<F>(_mm256_sqrt_ps(lo), _mm256_sqrt_ps(hi));
@@ -3164,7 +3412,9 @@ SI F floor_(F x) {
     float32x4_t lo,hi;
     split(x, &lo,&hi);
     return join<F>(vrndmq_f32(lo), vrndmq_f32(hi));
-#elif defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
+#elif defined(JUMPER_IS_SKX)
+    return _mm512_floor_ps(x);
+#elif defined(JUMPER_IS_HSW)
     __m256 lo,hi;
     split(x, &lo,&hi);
     return join<F>(_mm256_floor_ps(lo), _mm256_floor_ps(hi));
@@ -3365,10 +3615,26 @@ SI U32 ix_and_ptr(T** ptr, const SkRasterPipeline_GatherCtx* ctx, F x, F y) {
 
 template <typename V, typename T>
 SI V load(const T* ptr, size_t tail) {
+#if defined(JUMPER_IS_SKX)
+    // Masked loads, just like the highp load() above.
+    static_assert(sizeof(V) == N*sizeof(T), "");
+    if (__builtin_expect(tail & (N-1), 0)) {
+        const __mmask16 mask = first_n<__mmask16>((int)(tail & (N-1)));
+        if constexpr (sizeof(T) == 1) {
+            return sk_bit_cast<V>(_mm_maskz_loadu_epi8(mask, ptr));
+        } else if constexpr (sizeof(T) == 2) {
+            return sk_bit_cast<V>(_mm256_maskz_loadu_epi16(mask, ptr));
+        } else {
+            static_assert(sizeof(T) == 4, "");
+            return sk_bit_cast<V>(_mm512_maskz_loadu_epi32(mask, ptr));
+        }
+    }
+    return sk_unaligned_load<V>(ptr);
+#else
     V v = 0;
     switch (tail & (N-1)) {
         case  0: memcpy(&v, ptr, sizeof(v)); break;
-    #if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
+    #if defined(JUMPER_IS_HSW)
         case 15: v[14] = ptr[14]; [[fallthrough]];
         case 14: v[13] = ptr[13]; [[fallthrough]];
         case 13: v[12] = ptr[12]; [[fallthrough]];
@@ -3387,12 +3653,29 @@ SI V load(const T* ptr, size_t tail) {
         case  1: v[ 0] = ptr[ 0];
     }
     return v;
+#endif
 }
 template <typename V, typename T>
 SI void store(T* ptr, size_t tail, V v) {
+#if defined(JUMPER_IS_SKX)
+    static_assert(sizeof(V) == N*sizeof(T), "");
+    if (__builtin_expect(tail & (N-1), 0)) {
+        const __mmask16 mask = first_n<__mmask16>((int)(tail & (N-1)));
+        if constexpr (sizeof(T) == 1) {
+            _mm_mask_storeu_epi8(ptr, mask, sk_bit_cast<__m128i>(v));
+        } else if constexpr (sizeof(T) == 2) {
+            _mm256_mask_storeu_epi16(ptr, mask, sk_bit_cast<__m256i>(v));
+        } else {
+            static_assert(sizeof(T) == 4, "");
+            _mm512_mask_storeu_epi32(ptr, mask, sk_bit_cast<__m512i>(v));
+        }
+        return;
+    }
+    sk_unaligned_store(ptr, v);
+#else
     switch (tail & (N-1)) {
         case  0: memcpy(ptr, &v, sizeof(v)); break;
-    #if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
+    #if defined(JUMPER_IS_HSW)
         case 15: ptr[14] = v[14]; [[fallthrough]];
         case 14: ptr[13] = v[13]; [[fallthrough]];
         case 13: ptr[12] = v[12]; [[fallthrough]];
@@ -3410,6 +3693,7 @@ SI void store(T* ptr, size_t tail, V v) {
         case  2: memcpy(ptr, &v,  2*sizeof(T)); break;
         case  1: ptr[ 0] = v[ 0];
     }
+#endif
 }
 
 #if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
@@ -3421,6 +3705,17 @@ SI void store(T* ptr, size_t tail, V v) {
                   ptr[ix[12]], ptr[ix[13]], ptr[ix[14]], ptr[ix[15]], };
     }
 
+#if defined(JUMPER_IS_SKX)
+    template<>
+    F gather(const float* ptr, U32 ix) {
+        return _mm512_i32gather_ps(ix, ptr, 4);
+    }
+
+    template<>
+    U32 gather(const uint32_t* ptr, U32 ix) {
+        return _mm512_i32gather_epi32(ix, ptr, 4);
+    }
+#else
     template<>
     F gather(const float* ptr, U32 ix) {
         __m256i lo, hi;
@@ -3438,6 +3733,7 @@ SI void store(T* ptr, size_t tail, V v) {
         return join<U32>(_mm256_i32gather_epi32(ptr, lo, 4),
                          _mm256_i32gather_epi32(ptr, hi, 4));
     }
+#endif
 #else
     template <typename V, typename T>
     SI V gather(const T* ptr, U32 ix) {
@@ -3900,7 +4196,18 @@ SI void gradient_lookup(const SkRasterPipeline_GradientCtx* c, U32 idx, F t,
                         U16* r, U16* g, U16* b, U16* a) {
 
     F fr, fg, fb, fa, br, bg, bb, ba;
-#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
+#if defined(JUMPER_IS_SKX)
+    if (c->stopCount <= 16) {
+        fr = _mm512_permutexvar_ps(idx, _mm512_loadu_ps(c->fs[0]));
+        br = _mm512_permutexvar_ps(idx, _mm512_loadu_ps(c->bs[0]));
+        fg = _mm512_permutexvar_ps(idx, _mm512_loadu_ps(c->fs[1]));
+        bg = _mm512_permutexvar_ps(idx, _mm512_loadu_ps(c->bs[1]));
+        fb = _mm512_permutexvar_ps(idx, _mm512_loadu_ps(c->fs[2]));
+        bb = _mm512_permutexvar_ps(idx, _mm512_loadu_ps(c->bs[2]));
+        fa = _mm512_permutexvar_ps(idx, _mm512_loadu_ps(c->fs[3]));
+        ba = _mm512_permutexvar_ps(idx, _mm512_loadu_ps(c->bs[3]));
+    } else
+#elif defined(JUMPER_IS_HSW)
     if (c->stopCount <=8) {
         __m256i lo, hi;
         split(idx, &lo, &hi);
@@ -12,6 +12,9 @@
 
 class SkOpCoincidence;
 
-bool AddIntersectTs(SkOpContour* test, SkOpContour* next, SkOpCoincidence* coincidence);
+// Finds the intersections between every pair of segments in the sorted contour list and adds them
+// to the segments, recording coincident runs in coincidence. Large inputs search for them on
+// SkGraphicsExecutor(), if there is one, with the same result.
+void AddIntersectTs(SkOpContourHead* contourList, SkOpCoincidence* coincidence);
 
 #endif
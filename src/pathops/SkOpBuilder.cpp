@@ -9,9 +9,12 @@
 #include "include/pathops/SkPathOps.h"
 #include "src/core/SkArenaAlloc.h"
 #include "src/core/SkPathPriv.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/pathops/SkOpEdgeBuilder.h"
 #include "src/pathops/SkPathOpsCommon.h"
 
+#include <memory>
+
 static bool one_contour(const SkPath& path) {
     SkSTArenaAlloc<256> allocator;
     int verbCount = path.countVerbs();
@@ -122,6 +125,85 @@ void SkOpBuilder::reset() {
     fOps.reset();
 }
 
+namespace {
+
+struct Operand {
+    SkPath fPath;
+    bool   fSimplified;  // fPath is the result of an op, not one of the inputs.
+};
+
+}  // namespace
+
+// Combines two operands of union, intersect or xor. Operands whose bounds do not overlap don't
+// need the intersection machinery at all: their union and xor are both paths, and they have no
+// intersection.
+static bool combine(const Operand& a, const Operand& b, SkPathOp op, Operand* result) {
+    const SkPath& one = a.fPath;
+    const SkPath& two = b.fPath;
+    if (!one.isInverseFillType() && !two.isInverseFillType() &&
+        !SkRect::Intersects(one.getBounds(), two.getBounds())) {
+        if (kIntersect_SkPathOp == op || one.isEmpty() || two.isEmpty()) {
+            if (kIntersect_SkPathOp == op) {
+                *result = {SkPath(), true};
+                result->fPath.setFillType(SkPathFillType::kEvenOdd);
+            } else {
+                *result = one.isEmpty() ? b : a;
+            }
+            return true;
+        }
+        if (one.getFillType() == two.getFillType()) {
+            SkPath sum = one;
+            sum.addPath(two);
+            *result = {sum, a.fSimplified && b.fSimplified};
+            return true;
+        }
+    }
+    result->fSimplified = true;
+    return Op(one, two, op, &result->fPath);
+}
+
+// Combines all of the operands with one associative op, pairing neighbors in a balanced tree, so
+// each level of the tree only walks every segment once. The ops on one level don't depend on each
+// other, and may run on SkGraphicsExecutor(); the tree, and so the result, is the same either way.
+static bool reduce(SkTArray<Operand>* operands, SkPathOp op, SkPath* result) {
+    SkASSERT(kUnion_SkPathOp == op || kIntersect_SkPathOp == op || kXOR_SkPathOp == op);
+    SkASSERT(!operands->empty());
+    SkExecutor* executor = SkGraphicsExecutor();
+    for (int count = operands->count(); count > 1; count = (count + 1) / 2) {
+        const int pairs = count / 2;
+        std::unique_ptr<bool[]> ok(new bool[pairs]);
+        auto combinePair = [&](int i) {
+            Operand combined;
+            ok[i] = combine((*operands)[2*i], (*operands)[2*i + 1], op, &combined);
+            (*operands)[2*i] = std::move(combined);
+        };
+        if (executor && pairs > 1) {
+            // The ops in these tasks find they are running on the executor, and so run inline.
+            SkTaskGroup(*executor).batch(pairs, combinePair);
+        } else {
+            for (int i = 0; i < pairs; ++i) {
+                combinePair(i);
+            }
+        }
+        for (int i = 0; i < pairs; ++i) {
+            if (!ok[i]) {
+                return false;
+            }
+        }
+        // Pack the survivors, including the odd one out, at the front.
+        for (int i = 1; i < (count + 1) / 2; ++i) {
+            (*operands)[i] = std::move((*operands)[2*i]);
+        }
+    }
+    const Operand& root = operands->front();
+    if (!root.fSimplified) {
+        // Only disjoint inputs were concatenated; give them the same form an op would.
+        return Simplify(root.fPath, result);
+    }
+    *result = root.fPath;
+    return true;
+}
+
 /* OPTIMIZATION: Union doesn't need to be all-or-nothing. A run of three or more convex
    paths with union ops could be locally resolved and still improve over doing the
    ops one at a time. */
@@ -162,12 +244,43 @@ bool SkOpBuilder::resolve(SkPath* result) {
     }
     if (!allUnion) {
         *result = fPathRefs[0];
-        for (int index = 1; index < count; ++index) {
-            if (!Op(*result, fPathRefs[index], fOps[index], result)) {
+        bool resultIsOp = false;
+        for (int index = 1; index < count;) {
+            // (a op b) op c == a op (b op c) for union, intersect and xor, and
+            // (a - b) - c == a - (b U c).
+            const SkPathOp op = fOps[index];
+            int end = index + 1;
+            if (kReverseDifference_SkPathOp != op) {
+                while (end < count && fOps[end] == op) {
+                    ++end;
+                }
+            }
+            bool success;
+            if (end - index == 1) {
+                success = Op(*result, fPathRefs[index], op, result);
+            } else {
+                SkTArray<Operand> operands;
+                if (kDifference_SkPathOp != op) {
+                    operands.push_back({*result, resultIsOp});
+                }
+                for (int i = index; i < end; ++i) {
+                    operands.push_back({fPathRefs[i], false});
+                }
+                if (kDifference_SkPathOp == op) {
+                    SkPath subtrahend;
+                    success = reduce(&operands, kUnion_SkPathOp, &subtrahend) &&
+                              Op(*result, subtrahend, op, result);
+                } else {
+                    success = reduce(&operands, op, result);
+                }
+            }
+            if (!success) {
                 reset();
                 *result = original;
                 return false;
             }
+            resultIsOp = true;
+            index = end;
         }
         reset();
         return true;
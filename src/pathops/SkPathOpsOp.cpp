@@ -324,13 +324,7 @@ bool OpDebug(const SkPath& one, const SkPath& two, SkPathOp op, SkPath* result
         return true;
     }
     // find all intersections between segments
-    SkOpContour* current = contourList;
-    do {
-        SkOpContour* next = current;
-        while (AddIntersectTs(current, next, &coincidence)
-                && (next = next->next()))
-            ;
-    } while ((current = current->next()));
+    AddIntersectTs(contourList, &coincidence);
 #if DEBUG_VALIDATE
     globalState.setPhase(SkOpPhase::kWalking);
 #endif
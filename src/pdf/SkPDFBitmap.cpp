@@ -15,6 +15,7 @@
 #include "include/private/SkColorData.h"
 #include "include/private/SkImageInfoPriv.h"
 #include "include/private/SkTo.h"
+#include "src/core/SkTLazy.h"
 #include "src/pdf/SkDeflate.h"
 #include "src/pdf/SkJpegInfo.h"
 #include "src/pdf/SkPDFDocumentPriv.h"
@@ -66,6 +67,27 @@ static SkColor get_neighbor_avg_color(const SkPixmap& bm, int xOrig, int yOrig)
                  : SK_ColorTRANSPARENT;
 }
 
+// How an image stream's data is encoded.
+enum class ImageEncoding { kRaw, kFlate, kJpeg };
+
+// Image data is deflated unless the document asks for no compression, which like any other
+// stream leaves it as is.
+static ImageEncoding pixel_encoding(const SkPDFDocument* doc) {
+    return doc->metadata().fCompressionLevel == SkPDF::Metadata::CompressionLevel::None
+                   ? ImageEncoding::kRaw
+                   : ImageEncoding::kFlate;
+}
+
+// Returns the stream to write pixel data to buffer through, for this encoding.
+static SkWStream* pixel_stream(ImageEncoding encoding, const SkPDFDocument* doc,
+                               SkDynamicMemoryWStream* buffer,
+                               SkTLazy<SkDeflateWStream>* deflate) {
+    if (encoding == ImageEncoding::kRaw) {
+        return buffer;
+    }
+    return deflate->init(buffer, SkToInt(doc->metadata().fCompressionLevel));
+}
+
 template <typename T>
 static void emit_image_stream(SkPDFDocument* doc,
                               SkPDFIndirectReference ref,
@@ -74,7 +96,7 @@ static void emit_image_stream(SkPDFDocument* doc,
                               const char* colorSpace,
                               SkPDFIndirectReference sMask,
                               int length,
-                              bool isJpeg) {
+                              ImageEncoding encoding) {
     SkPDFDict pdfDict("XObject");
     pdfDict.insertName("Subtype", "Image");
     pdfDict.insertInt("Width", size.width());
@@ -84,15 +106,22 @@ static void emit_image_stream(SkPDFDocument* doc,
         pdfDict.insertRef("SMask", sMask);
     }
     pdfDict.insertInt("BitsPerComponent", 8);
+    const char* filter = encoding == ImageEncoding::kJpeg  ? "DCTDecode"
+                       : encoding == ImageEncoding::kFlate ? "FlateDecode"
+                       : nullptr;
     #ifdef SK_PDF_BASE85_BINARY
     auto filters = SkPDFMakeArray();
     filters->appendName("ASCII85Decode");
-    filters->appendName(isJpeg ? "DCTDecode" : "FlateDecode");
+    if (filter) {
+        filters->appendName(filter);
+    }
     pdfDict.insertObject("Filter", std::move(filters));
     #else
-    pdfDict.insertName("Filter", isJpeg ? "DCTDecode" : "FlateDecode");
+    if (filter) {
+        pdfDict.insertName("Filter", filter);
+    }
     #endif
-    if (isJpeg) {
+    if (encoding == ImageEncoding::kJpeg) {
         pdfDict.insertInt("ColorTransform", 0);
     }
     pdfDict.insertInt("Length", length);
@@ -101,10 +130,12 @@ static void emit_image_stream(SkPDFDocument* doc,
 
 static void do_deflated_alpha(const SkPixmap& pm, SkPDFDocument* doc, SkPDFIndirectReference ref) {
     SkDynamicMemoryWStream buffer;
-    SkDeflateWStream deflateWStream(&buffer);
+    SkTLazy<SkDeflateWStream> deflate;
+    const ImageEncoding encoding = pixel_encoding(doc);
+    SkWStream* out = pixel_stream(encoding, doc, &buffer, &deflate);
     if (kAlpha_8_SkColorType == pm.colorType()) {
         SkASSERT(pm.rowBytes() == (size_t)pm.width());
-        buffer.write(pm.addr8(), pm.width() * pm.height());
+        out->write(pm.addr8(), pm.width() * pm.height());
     } else {
         SkASSERT(pm.alphaType() == kUnpremul_SkAlphaType);
         SkASSERT(pm.colorType() == kBGRA_8888_SkColorType);
@@ -118,13 +149,15 @@ static void do_deflated_alpha(const SkPixmap& pm, SkPDFDocument* doc, SkPDFIndir
         while (ptr != stop) {
             *dst++ = 0xFF & ((*ptr++) >> SK_BGRA_A32_SHIFT);
             if (dst == bufferStop) {
-                deflateWStream.write(byteBuffer, sizeof(byteBuffer));
+                out->write(byteBuffer, sizeof(byteBuffer));
                 dst = byteBuffer;
             }
         }
-        deflateWStream.write(byteBuffer, dst - byteBuffer);
+        out->write(byteBuffer, dst - byteBuffer);
+    }
+    if (deflate.isValid()) {
+        deflate->finalize();
     }
-    deflateWStream.finalize();
 
     #ifdef SK_PDF_BASE85_BINARY
     SkPDFUtils::Base85Encode(buffer.detachAsStream(), &buffer);
@@ -132,7 +165,7 @@ static void do_deflated_alpha(const SkPixmap& pm, SkPDFDocument* doc, SkPDFIndir
     int length = SkToInt(buffer.bytesWritten());
     emit_image_stream(doc, ref, [&buffer](SkWStream* stream) { buffer.writeToAndReset(stream); },
                       pm.info().dimensions(), "DeviceGray", SkPDFIndirectReference(),
-                      length, false);
+                      length, encoding);
 }
 
 static void do_deflated_image(const SkPixmap& pm,
@@ -144,16 +177,18 @@ static void do_deflated_image(const SkPixmap& pm,
         sMask = doc->reserveRef();
     }
     SkDynamicMemoryWStream buffer;
-    SkDeflateWStream deflateWStream(&buffer);
+    SkTLazy<SkDeflateWStream> deflate;
+    const ImageEncoding encoding = pixel_encoding(doc);
+    SkWStream* out = pixel_stream(encoding, doc, &buffer, &deflate);
     const char* colorSpace = "DeviceGray";
     switch (pm.colorType()) {
         case kAlpha_8_SkColorType:
-            fill_stream(&deflateWStream, '\x00', pm.width() * pm.height());
+            fill_stream(out, '\x00', pm.width() * pm.height());
             break;
         case kGray_8_SkColorType:
             SkASSERT(sMask.fValue = -1);
             SkASSERT(pm.rowBytes() == (size_t)pm.width());
-            deflateWStream.write(pm.addr8(), pm.width() * pm.height());
+            out->write(pm.addr8(), pm.width() * pm.height());
             break;
         default:
             colorSpace = "DeviceRGB";
@@ -175,20 +210,22 @@ static void do_deflated_image(const SkPixmap& pm,
                     *dst++ = SkColorGetG(color);
                     *dst++ = SkColorGetB(color);
                     if (dst == bufferStop) {
-                        deflateWStream.write(byteBuffer, sizeof(byteBuffer));
+                        out->write(byteBuffer, sizeof(byteBuffer));
                         dst = byteBuffer;
                     }
                 }
             }
-            deflateWStream.write(byteBuffer, dst - byteBuffer);
+            out->write(byteBuffer, dst - byteBuffer);
+    }
+    if (deflate.isValid()) {
+        deflate->finalize();
     }
-    deflateWStream.finalize();
     #ifdef SK_PDF_BASE85_BINARY
     SkPDFUtils::Base85Encode(buffer.detachAsStream(), &buffer);
     #endif
     int length = SkToInt(buffer.bytesWritten());
     emit_image_stream(doc, ref, [&buffer](SkWStream* stream) { buffer.writeToAndReset(stream); },
-                      pm.info().dimensions(), colorSpace, sMask, length, false);
+                      pm.info().dimensions(), colorSpace, sMask, length, encoding);
     if (!isOpaque) {
         do_deflated_alpha(pm, doc, sMask);
     }
@@ -219,7 +256,7 @@ static bool do_jpeg(sk_sp<SkData> data, SkPDFDocument* doc, SkISize size,
     emit_image_stream(doc, ref,
                       [&data](SkWStream* dst) { dst->write(data->data(), data->size()); },
                       jpegSize, yuv ? "DeviceRGB" : "DeviceGray",
-                      SkPDFIndirectReference(), SkToInt(data->size()), true);
+                      SkPDFIndirectReference(), SkToInt(data->size()), ImageEncoding::kJpeg);
     return true;
 }
 
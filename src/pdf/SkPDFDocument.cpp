@@ -376,6 +376,10 @@ void SkPDFDocument::onEndPage() {
     // 0-based page index.
     page->insertInt("StructParents", SkToInt(this->currentPageIndex()));
     fPages.emplace_back(std::move(page));
+
+    if (fExecutor) {
+        this->waitForJobs(kMaxPendingPageJobs);
+    }
 }
 
 void SkPDFDocument::onAbort() {
@@ -580,7 +584,16 @@ void SkPDFDocument::onClose(SkWStream* stream) {
 
     auto docCatalogRef = this->emit(*docCatalog);
 
-    for (const SkPDFFont* f : get_fonts(*this)) {
+    std::vector<const SkPDFFont*> fonts = get_fonts(*this);
+    if (fExecutor) {
+        // Some fonts are subset and emitted on the executor. Look up every typeface's metrics
+        // and unicode map now so those jobs only ever read the shared tables.
+        for (const SkPDFFont* f : fonts) {
+            SkPDFFont::GetMetrics(f->typeface(), this);
+            SkPDFFont::GetUnicodeMap(f->typeface(), this);
+        }
+    }
+    for (const SkPDFFont* f : fonts) {
         f->emitSubset(this);
     }
 
@@ -595,9 +608,9 @@ void SkPDFDocument::incrementJobCount() { fJobCount++; }
 
 void SkPDFDocument::signalJobComplete() { fSemaphore.signal(); }
 
-void SkPDFDocument::waitForJobs() {
+void SkPDFDocument::waitForJobs(int maxPendingJobs) {
      // fJobCount can increase while we wait.
-     while (fJobCount > 0) {
+     while (fJobCount > maxPendingJobs) {
          fSemaphore.wait();
          --fJobCount;
      }
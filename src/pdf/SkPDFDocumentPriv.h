@@ -178,7 +178,15 @@ private:
     SkMutex fMutex;
     SkSemaphore fSemaphore;
 
-    void waitForJobs();
+    // Page contents are compressed and written out by the executor. To keep them from piling up
+    // in memory when the client draws pages faster than the executor can keep up, onEndPage()
+    // waits while more than this many jobs are outstanding. SkExecutor does not say how many
+    // threads it has, so this is a fixed bound on memory rather than a multiple of the threads;
+    // it is still enough to keep a typical thread pool busy.
+    static constexpr int kMaxPendingPageJobs = 32;
+
+    // Wait until at most maxPendingJobs executor jobs are still outstanding.
+    void waitForJobs(int maxPendingJobs = 0);
     SkWStream* beginObject(SkPDFIndirectReference);
     void endObject();
 };
@@ -7,6 +7,7 @@
 
 #include "include/core/SkBitmap.h"
 #include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFont.h"
 #include "include/core/SkFontMetrics.h"
 #include "include/core/SkFontTypes.h"
@@ -671,6 +672,17 @@ void SkPDFFont::emitSubset(SkPDFDocument* doc) const {
     switch (fFontType) {
         case SkAdvancedTypefaceMetrics::kType1CID_Font:
         case SkAdvancedTypefaceMetrics::kTrueType_Font:
+            // Subsetting is slow, so do it on the executor if there is one. This relies on
+            // SkPDFDocument::onClose() having already cached this typeface's metrics and
+            // unicode map.
+            if (SkExecutor* executor = doc->executor()) {
+                doc->incrementJobCount();
+                executor->add([this, doc]() {
+                    emit_subset_type0(*this, doc);
+                    doc->signalJobComplete();
+                });
+                return;
+            }
             return emit_subset_type0(*this, doc);
 #ifndef SK_PDF_DO_NOT_SUPPORT_TYPE_1_FONTS
         case SkAdvancedTypefaceMetrics::kType1_Font:
@@ -433,9 +433,11 @@ static void serialize_stream(SkPDFDict* origDict,
     SkPDFDict tmpDict;
     SkPDFDict& dict = origDict ? *origDict : tmpDict;
     static const size_t kMinimumSavings = strlen("/Filter_/FlateDecode_");
-    if (deflate && stream->getLength() > kMinimumSavings) {
+    const SkPDF::Metadata::CompressionLevel level = doc->metadata().fCompressionLevel;
+    if (deflate && level != SkPDF::Metadata::CompressionLevel::None &&
+        stream->getLength() > kMinimumSavings) {
         SkDynamicMemoryWStream compressedData;
-        SkDeflateWStream deflateWStream(&compressedData);
+        SkDeflateWStream deflateWStream(&compressedData, SkToInt(level));
         SkStreamCopy(&deflateWStream, stream);
         deflateWStream.finalize();
         #ifdef SK_PDF_BASE85_BINARY
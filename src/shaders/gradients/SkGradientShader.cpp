@@ -343,9 +343,9 @@ bool SkGradientShaderBase::onAppendStages(const SkStageRec& rec) const {
         // Note: In order to handle clamps in search, the search assumes a stop conceptully placed
         // at -inf. Therefore, the max number of stops is fColorCount+1.
         for (int i = 0; i < 4; i++) {
-            // Allocate at least at for the AVX2 gather from a YMM register.
-            ctx->fs[i] = alloc->makeArray<float>(std::max(fColorCount+1, 8));
-            ctx->bs[i] = alloc->makeArray<float>(std::max(fColorCount+1, 8));
+            // Allocate at least enough for the AVX2 or AVX-512 permutes from a YMM or ZMM register.
+            ctx->fs[i] = alloc->makeArray<float>(std::max(fColorCount+1, 16));
+            ctx->bs[i] = alloc->makeArray<float>(std::max(fColorCount+1, 16));
         }
 
         if (fOrigPos == nullptr) {
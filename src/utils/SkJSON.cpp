@@ -13,6 +13,7 @@
 #include "include/utils/SkParse.h"
 #include "src/utils/SkUTF.h"
 
+#include <algorithm>
 #include <cmath>
 #include <tuple>
 #include <vector>
@@ -899,6 +900,203 @@ void Write(const Value& v, SkWStream* stream) {
     }
 }
 
+// Snapshot layout (native byte order):
+//
+//   [SnapshotHeader] [slab_0] ... [slab_n-1]
+//
+// Slabs are vector slabs as built by MakeVector, each padded to kRecAlign. Pointer payloads hold
+// slab offsets from the end of the header instead of addresses. Slabs are written in post-order
+// (children before parents), which lets the loader reject shared or cyclic references.
+static constexpr char     kSnapshotMagic[8] = { '\xff', 's', 'k', 'j', 's', 'o', 'n', '\0' };
+static constexpr uint32_t kSnapshotVersion  = 1;
+static constexpr int      kMaxSnapshotDepth = 512;
+
+struct SnapshotHeader {
+    char     fMagic[8];
+    uint32_t fVersion;
+    uint32_t fSizeTSize;
+    uint64_t fImageSize;
+    Value    fRoot;
+};
+
+// Value's internals, for moving pointer payloads to and from snapshot offsets.
+class SnapshotValue final : public Value {
+public:
+    static const SnapshotValue& From(const Value& v) {
+        return static_cast<const SnapshotValue&>(v);
+    }
+
+    bool hasPointer() const {
+        return this->getTag() == Tag::kString ||
+               this->getTag() == Tag::kArray  ||
+               this->getTag() == Tag::kObject;
+    }
+
+    bool isString() const {
+        return this->getTag() == Tag::kString || this->getTag() == Tag::kShortString;
+    }
+
+    // Short strings must be terminated within the record.
+    bool isValidShortString() const {
+        return this->getTag() != Tag::kShortString ||
+               memchr(this->cast<char>(), '\0', sizeof(Value) - 1) != nullptr;
+    }
+
+    // Bools must hold 0 or 1: any other byte is not a valid bool to read.
+    bool isValidBool() const {
+        return this->getTag() != Tag::kBool || *this->cast<uint8_t>() <= 1;
+    }
+
+    const size_t* slab() const { return this->ptr<size_t>(); }
+
+    uintptr_t offset() const { return reinterpret_cast<uintptr_t>(this->ptr<void>()); }
+
+    // Returns the size of this value's slab, including padding.
+    size_t slabSize(size_t count) const {
+        switch (this->getTag()) {
+        case Tag::kString: return SkAlign8(sizeof(size_t) + count + 1);
+        case Tag::kArray:  return SkAlign8(sizeof(size_t) + count * sizeof(Value));
+        case Tag::kObject: return SkAlign8(sizeof(size_t) + count * sizeof(Member));
+        default:           return 0;
+        }
+    }
+
+    size_t elementSize() const {
+        switch (this->getTag()) {
+        case Tag::kString: return 1;
+        case Tag::kArray:  return sizeof(Value);
+        case Tag::kObject: return sizeof(Member);
+        default:           return 0;
+        }
+    }
+
+    static Value Retarget(const Value& v, uintptr_t target) {
+        SnapshotValue result;
+        result.init_tagged_pointer(From(v).getTag(), reinterpret_cast<void*>(target));
+        return result;
+    }
+
+private:
+    SnapshotValue() = default;
+};
+
+class SnapshotWriter {
+public:
+    explicit SnapshotWriter(SkDynamicMemoryWStream* image) : fImage(image) {}
+
+    // Writes v's slabs (if any), and returns v with offsets in place of pointers.
+    bool write(const Value& v, Value* out, int depth) {
+        const auto& sv = SnapshotValue::From(v);
+        if (!sv.hasPointer()) {
+            *out = v;
+            return true;
+        }
+        if (depth > kMaxSnapshotDepth) {
+            return false;
+        }
+
+        const size_t count = *sv.slab();
+        // Copy the slab as-is, then patch the children's payloads.
+        std::vector<uint8_t> slab(sv.slabSize(count), 0);
+        memcpy(slab.data(), sv.slab(), sizeof(size_t) + count * sv.elementSize() +
+                                       (v.getType() == Value::Type::kString ? 1 : 0));
+        if (v.is<ArrayValue>()) {
+            auto* values = reinterpret_cast<Value*>(slab.data() + sizeof(size_t));
+            for (size_t i = 0; i < count; ++i) {
+                if (!this->write(values[i], &values[i], depth + 1)) {
+                    return false;
+                }
+            }
+        } else if (v.is<ObjectValue>()) {
+            auto* members = reinterpret_cast<Member*>(slab.data() + sizeof(size_t));
+            for (size_t i = 0; i < count; ++i) {
+                if (!this->write(members[i].fKey  , &members[i].fKey  , depth + 1) ||
+                    !this->write(members[i].fValue, &members[i].fValue, depth + 1)) {
+                    return false;
+                }
+            }
+        }
+
+        const auto offset = fImage->bytesWritten();
+        fImage->write(slab.data(), slab.size());
+        *out = SnapshotValue::Retarget(v, offset);
+        return true;
+    }
+
+private:
+    SkDynamicMemoryWStream* fImage;
+};
+
+// Validates a snapshot image in place, turning its offsets into pointers into the image.
+class SnapshotLoader {
+public:
+    SnapshotLoader(uint8_t* image, size_t size) : fImage(image), fSize(size) {}
+
+    bool load(Value* v) {
+        return this->load(v, fSize, 0) && fCursor == fSize;
+    }
+
+private:
+    // Every slab a value refers to must sit before limit, the start of its parent's slab.
+    bool load(Value* v, size_t limit, int depth) {
+        const auto& sv = SnapshotValue::From(*v);
+        if (!sv.hasPointer()) {
+            return sv.isValidShortString() && sv.isValidBool();
+        }
+
+        const uintptr_t offset = sv.offset();
+        if (depth > kMaxSnapshotDepth || offset >= limit || limit - offset < sizeof(size_t) ||
+            !SkIsAlign8(offset)) {
+            return false;
+        }
+        size_t count;
+        memcpy(&count, fImage + offset, sizeof(count));
+        if (count > (limit - offset - sizeof(size_t)) / sv.elementSize()) {
+            return false;
+        }
+        const size_t slabSize = sv.slabSize(count);
+        if (slabSize > limit - offset) {
+            return false;
+        }
+
+        uint8_t* records = fImage + offset + sizeof(size_t);
+        if (v->is<StringValue>()) {
+            if (records[count] != '\0') {
+                return false;
+            }
+        } else if (v->is<ArrayValue>()) {
+            auto* values = reinterpret_cast<Value*>(records);
+            for (size_t i = 0; i < count; ++i) {
+                if (!this->load(&values[i], offset, depth + 1)) {
+                    return false;
+                }
+            }
+        } else {
+            auto* members = reinterpret_cast<Member*>(records);
+            for (size_t i = 0; i < count; ++i) {
+                if (!SnapshotValue::From(members[i].fKey).isString() ||
+                    !this->load(&members[i].fKey  , offset, depth + 1) ||
+                    !this->load(&members[i].fValue, offset, depth + 1)) {
+                    return false;
+                }
+            }
+        }
+
+        // Slabs are visited in the order they were written, so each one must follow the last;
+        // this rules out slabs referenced twice.
+        if (offset != fCursor) {
+            return false;
+        }
+        fCursor = offset + slabSize;
+        *v = SnapshotValue::Retarget(*v, reinterpret_cast<uintptr_t>(fImage + offset));
+        return true;
+    }
+
+    uint8_t*     fImage;
+    const size_t fSize;
+    size_t       fCursor = 0;
+};
+
 } // namespace
 
 SkString Value::toString() const {
@@ -911,8 +1109,16 @@ SkString Value::toString() const {
 
 static constexpr size_t kMinChunkSize = 4096;
 
-DOM::DOM(const char* data, size_t size)
+DOM::DOM(const char* data, size_t size, Format format)
     : fAlloc(kMinChunkSize) {
+    if (format == Format::kJSONOrSnapshot && size >= sizeof(kSnapshotMagic) &&
+        !memcmp(data, kSnapshotMagic, sizeof(kSnapshotMagic))) {
+        if (!this->loadSnapshot(data, size)) {
+            fRoot = NullValue();
+        }
+        return;
+    }
+
     DOMParser parser(fAlloc);
 
     fRoot = parser.parse(data, size);
@@ -922,4 +1128,40 @@ void DOM::write(SkWStream* stream) const {
     Write(fRoot, stream);
 }
 
+bool DOM::writeSnapshot(SkWStream* stream) const {
+    SkDynamicMemoryWStream image;
+    SnapshotHeader header;
+    memcpy(header.fMagic, kSnapshotMagic, sizeof(kSnapshotMagic));
+    header.fVersion   = kSnapshotVersion;
+    header.fSizeTSize = sizeof(size_t);
+    if (!SnapshotWriter(&image).write(fRoot, &header.fRoot, 0)) {
+        return false;
+    }
+    header.fImageSize = image.bytesWritten();
+
+    return stream->write(&header, sizeof(header)) && image.writeToAndReset(stream);
+}
+
+bool DOM::loadSnapshot(const char* data, size_t size) {
+    SnapshotHeader header;
+    if (size < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (header.fVersion != kSnapshotVersion || header.fSizeTSize != sizeof(size_t) ||
+        header.fImageSize != size - sizeof(header)) {
+        return false;
+    }
+
+    // The image is used in place of arena slabs, so it gets copied out of (possibly read-only,
+    // possibly unaligned) data once, and patched there.
+    const size_t imageSize = size - sizeof(header);
+    auto* image = static_cast<uint8_t*>(fAlloc.makeBytesAlignedTo(std::max<size_t>(imageSize, 1),
+                                                                  kRecAlign));
+    sk_careful_memcpy(image, data + sizeof(header), imageSize);
+
+    fRoot = header.fRoot;
+    return SnapshotLoader(image, imageSize).load(&fRoot);
+}
+
 } // namespace skjson
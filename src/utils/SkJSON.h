@@ -334,13 +334,36 @@ public:
 
 class DOM final : public SkNoncopyable {
 public:
-    DOM(const char*, size_t);
+    enum class Format {
+        kJSON,              // JSON text only.
+        kJSONOrSnapshot,    // Also a snapshot written by writeSnapshot(), told apart by its magic.
+    };
+
+    /**
+     * Parses JSON text, or with Format::kJSONOrSnapshot also loads a snapshot written by
+     * writeSnapshot(). Snapshots are only checked for memory safety, so only accept them from
+     * trusted sources. On failure, the root is null.
+     */
+    DOM(const char*, size_t, Format = Format::kJSON);
 
     const Value& root() const { return fRoot; }
 
     void write(SkWStream*) const;
 
+    /**
+     * Writes a binary snapshot of the DOM: its records as laid out in memory, with offsets in
+     * place of pointers. Loading one is a single copy plus a pass to turn the offsets back into
+     * pointers, with no text parsing.
+     *
+     * Snapshots are only readable by builds with the same pointer size and snapshot version.
+     *
+     * @return    false if the DOM is nested too deeply to snapshot.
+     */
+    bool writeSnapshot(SkWStream*) const;
+
 private:
+    bool loadSnapshot(const char*, size_t);
+
     SkArenaAlloc fAlloc;
     Value        fRoot;
 };
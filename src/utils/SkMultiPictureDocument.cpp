@@ -14,6 +14,7 @@
 #include "include/private/SkTArray.h"
 #include "include/private/SkTo.h"
 #include "include/utils/SkNWayCanvas.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/utils/SkMultiPictureDocumentPriv.h"
 
 #include <limits.h>
@@ -30,6 +31,25 @@
           float sizeY
         } * page_count
         skp file
+
+  Indexed file format (pages are written as they end, so the index comes last):
+      BEGINNING_OF_FILE:
+        kMagic
+        uint32_t version_number (==3)
+        {
+          pad to a multiple of 4 bytes
+          skp file
+        } * page_count
+        pad to a multiple of 4 bytes
+        {
+          float sizeX
+          float sizeY
+          uint64_t offset  // of the page's skp, from the beginning of the file
+          uint64_t length
+        } * page_count
+        uint64_t index_offset
+        uint32_t page_count
+        uint32_t kIndexTag
 */
 
 namespace {
@@ -39,6 +59,23 @@ static constexpr char kMagic[] = "Skia Multi-Picture Doc\n\n";
 static constexpr char kEndPage[] = "SkMultiPictureEndPage";
 
 const uint32_t kVersion = 2;
+const uint32_t kIndexedVersion = 3;
+
+const uint32_t kIndexTag = SkSetFourByteTag('m', 'p', 'd', 'i');
+
+struct IndexEntry {
+    SkSize   fSize;
+    uint64_t fOffset;
+    uint64_t fLength;
+};
+static_assert(sizeof(IndexEntry) == 24, "");
+
+struct IndexTrailer {
+    uint64_t fIndexOffset;
+    uint32_t fPageCount;
+    uint32_t fTag;
+};
+static_assert(sizeof(IndexTrailer) == 16, "");
 
 static SkSize join(const SkTArray<SkSize>& sizes) {
     SkSize joined = {0, 0};
@@ -104,6 +141,78 @@ struct MultiPictureDocument final : public SkDocument {
 };
 }  // namespace
 
+namespace {
+struct IndexedMultiPictureDocument final : public SkDocument {
+    SkSerialProcs fProcs;
+    SkPictureRecorder fPictureRecorder;
+    SkSize fCurrentPageSize;
+    SkTArray<IndexEntry> fIndex;
+    std::function<void(const SkPicture*)> fOnEndPage;
+    size_t fStart = 0;
+    bool fWroteHeader = false;
+    IndexedMultiPictureDocument(SkWStream* s, const SkSerialProcs* procs,
+        std::function<void(const SkPicture*)> onEndPage)
+        : SkDocument(s)
+        , fProcs(procs ? *procs : SkSerialProcs())
+        , fOnEndPage(onEndPage)
+    {
+        fProcs.fAlignForMapping = true;
+    }
+    ~IndexedMultiPictureDocument() override { this->close(); }
+
+    void writeHeader(SkWStream* wStream) {
+        if (!fWroteHeader) {
+            fStart = wStream->bytesWritten();
+            wStream->writeText(kMagic);
+            wStream->write32(kIndexedVersion);
+            fWroteHeader = true;
+        }
+    }
+    // Starts the next page or the index on a 4-byte boundary, so readers can use them in place.
+    void padToAlign4(SkWStream* wStream) {
+        static constexpr uint8_t kZeros[4] = {0, 0, 0, 0};
+        wStream->write(kZeros, SkAlign4(wStream->bytesWritten()) - wStream->bytesWritten());
+    }
+
+    SkCanvas* onBeginPage(SkScalar w, SkScalar h) override {
+        this->writeHeader(this->getStream());
+        fCurrentPageSize.set(w, h);
+        return fPictureRecorder.beginRecording(w, h);
+    }
+    void onEndPage() override {
+        SkWStream* wStream = this->getStream();
+        sk_sp<SkPicture> page = fPictureRecorder.finishRecordingAsPicture();
+        this->padToAlign4(wStream);
+        IndexEntry& entry = fIndex.push_back();
+        entry.fSize = fCurrentPageSize;
+        entry.fOffset = wStream->bytesWritten() - fStart;
+        page->serialize(wStream, &fProcs);
+        entry.fLength = wStream->bytesWritten() - fStart - entry.fOffset;
+        if (fOnEndPage) {
+            fOnEndPage(page.get());
+        }
+    }
+    void onClose(SkWStream* wStream) override {
+        SkASSERT(wStream);
+        this->writeHeader(wStream);
+        this->padToAlign4(wStream);
+        IndexTrailer trailer = {wStream->bytesWritten() - fStart, SkToU32(fIndex.count()),
+                                kIndexTag};
+        wStream->write(fIndex.begin(), fIndex.count() * sizeof(IndexEntry));
+        wStream->write(&trailer, sizeof(trailer));
+        fIndex.reset();
+    }
+    void onAbort() override {
+        fIndex.reset();
+    }
+};
+}  // namespace
+
+sk_sp<SkDocument> SkMakeIndexedMultiPictureDocument(SkWStream* wStream,
+    const SkSerialProcs* procs, std::function<void(const SkPicture*)> onEndPage) {
+    return sk_make_sp<IndexedMultiPictureDocument>(wStream, procs, onEndPage);
+}
+
 sk_sp<SkDocument> SkMakeMultiPictureDocument(SkWStream* wStream, const SkSerialProcs* procs,
     std::function<void(const SkPicture*)> onEndPage) {
     return sk_make_sp<MultiPictureDocument>(wStream, procs, onEndPage);
@@ -111,21 +220,62 @@ sk_sp<SkDocument> SkMakeMultiPictureDocument(SkWStream* wStream, const SkSerialP
 
 ////////////////////////////////////////////////////////////////////////////////
 
-int SkMultiPictureDocumentReadPageCount(SkStreamSeekable* stream) {
-    if (!stream) {
-        return 0;
+// Reads the magic and version number, leaving the stream right after them.
+static bool read_version(SkStreamSeekable* stream, uint32_t* version) {
+    if (!stream || !stream->seek(0)) {
+        return false;
     }
-    stream->seek(0);
     const size_t size = sizeof(kMagic) - 1;
     char buffer[size];
     if (size != stream->read(buffer, size) || 0 != memcmp(kMagic, buffer, size)) {
-        stream = nullptr;
-        return 0;
+        return false;
+    }
+    return stream->readU32(version) && (*version == kVersion || *version == kIndexedVersion);
+}
+
+// Reads the index at the end of an indexed document, checking that every page lies between the
+// header and the index.
+static bool read_index(SkStreamSeekable* stream, SkTArray<IndexEntry>* index) {
+    if (!stream->hasLength()) {
+        return false;
+    }
+    const uint64_t length = stream->getLength();
+    const uint64_t headerSize = sizeof(kMagic) - 1 + sizeof(uint32_t);
+    IndexTrailer trailer;
+    if (length < headerSize + sizeof(trailer) ||
+        !stream->seek(length - sizeof(trailer)) ||
+        sizeof(trailer) != stream->read(&trailer, sizeof(trailer)) ||
+        trailer.fTag != kIndexTag || trailer.fPageCount > INT_MAX ||
+        trailer.fIndexOffset < headerSize || trailer.fIndexOffset > length - sizeof(trailer) ||
+        (length - sizeof(trailer) - trailer.fIndexOffset) / sizeof(IndexEntry) !=
+                trailer.fPageCount ||
+        (length - sizeof(trailer) - trailer.fIndexOffset) % sizeof(IndexEntry) != 0 ||
+        !stream->seek(trailer.fIndexOffset)) {
+        return false;
+    }
+    index->reset(SkTo<int>(trailer.fPageCount));
+    size_t indexSize = index->count() * sizeof(IndexEntry);
+    if (indexSize != stream->read(index->begin(), indexSize)) {
+        return false;
+    }
+    for (const IndexEntry& entry : *index) {
+        if (entry.fOffset < headerSize || entry.fOffset > trailer.fIndexOffset ||
+            entry.fLength > trailer.fIndexOffset - entry.fOffset) {
+            return false;
+        }
     }
+    return true;
+}
+
+int SkMultiPictureDocumentReadPageCount(SkStreamSeekable* stream) {
     uint32_t versionNumber;
-    if (!stream->readU32(&versionNumber) || versionNumber != kVersion) {
+    if (!read_version(stream, &versionNumber)) {
         return 0;
     }
+    if (versionNumber == kIndexedVersion) {
+        SkTArray<IndexEntry> index;
+        return read_index(stream, &index) ? index.count() : 0;
+    }
     uint32_t pageCount;
     if (!stream->readU32(&pageCount) || pageCount > INT_MAX) {
         return 0;
@@ -140,6 +290,20 @@ bool SkMultiPictureDocumentReadPageSizes(SkStreamSeekable* stream,
     if (!dstArray || dstArrayCount < 1) {
         return false;
     }
+    uint32_t versionNumber;
+    if (!read_version(stream, &versionNumber)) {
+        return false;
+    }
+    if (versionNumber == kIndexedVersion) {
+        SkTArray<IndexEntry> index;
+        if (!read_index(stream, &index) || index.count() != dstArrayCount) {
+            return false;
+        }
+        for (int i = 0; i < dstArrayCount; ++i) {
+            dstArray[i].fSize = index[i].fSize;
+        }
+        return true;
+    }
     int pageCount = SkMultiPictureDocumentReadPageCount(stream);
     if (pageCount < 1 || pageCount != dstArrayCount) {
         return false;
@@ -189,6 +353,24 @@ bool SkMultiPictureDocumentRead(SkStreamSeekable* stream,
                                 SkDocumentPage* dstArray,
                                 int dstArrayCount,
                                 const SkDeserialProcs* procs) {
+    uint32_t versionNumber;
+    if (!read_version(stream, &versionNumber)) {
+        return false;
+    }
+    if (versionNumber == kIndexedVersion) {
+        SkTArray<IndexEntry> index;
+        if (!dstArray || !read_index(stream, &index) || index.count() != dstArrayCount) {
+            return false;
+        }
+        for (int i = 0; i < dstArrayCount; ++i) {
+            dstArray[i].fSize = index[i].fSize;
+            if (!stream->seek(index[i].fOffset) ||
+                !(dstArray[i].fPicture = SkPicture::MakeFromStream(stream, procs))) {
+                return false;
+            }
+        }
+        return true;
+    }
     if (!SkMultiPictureDocumentReadPageSizes(stream, dstArray, dstArrayCount)) {
         return false;
     }
@@ -213,3 +395,142 @@ bool SkMultiPictureDocumentRead(SkStreamSeekable* stream,
     }
     return true;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct SkMultiPictureDocumentReader::Page {
+    IndexEntry fEntry;
+    SkMutex fMutex;
+    sk_sp<SkPicture> fPicture SK_GUARDED_BY(fMutex);
+};
+
+std::unique_ptr<SkMultiPictureDocumentReader> SkMultiPictureDocumentReader::Make(
+        std::unique_ptr<SkStreamAsset> stream, const SkDeserialProcs* procs,
+        SkExecutor* prefetchExecutor, int prefetchRadius) {
+    uint32_t versionNumber;
+    SkTArray<IndexEntry> index;
+    if (!read_version(stream.get(), &versionNumber) || versionNumber != kIndexedVersion ||
+        !read_index(stream.get(), &index)) {
+        return nullptr;
+    }
+    std::unique_ptr<Page[]> pages(new Page[index.count()]);
+    for (int i = 0; i < index.count(); ++i) {
+        pages[i].fEntry = index[i];
+    }
+    return std::unique_ptr<SkMultiPictureDocumentReader>(new SkMultiPictureDocumentReader(
+            std::move(stream), std::move(pages), index.count(), procs, prefetchExecutor,
+            std::max(0, prefetchRadius)));
+}
+
+SkMultiPictureDocumentReader::SkMultiPictureDocumentReader(
+        std::unique_ptr<SkStreamAsset> stream, std::unique_ptr<Page[]> pages, int pageCount,
+        const SkDeserialProcs* procs, SkExecutor* prefetchExecutor, int radius)
+        : fProcs(procs ? *procs : SkDeserialProcs())
+        , fPages(std::move(pages))
+        , fPageCount(pageCount)
+        , fRadius(radius) {
+    if (const void* base = stream->getMemoryBase()) {
+        // The pages' pictures may outlive the reader, so the mapping owns the stream.
+        size_t length = stream->getLength();
+        fMapping = SkData::MakeWithProc(base, length, [](const void*, void* ctx) {
+            delete static_cast<SkStreamAsset*>(ctx);
+        }, stream.release());
+    } else {
+        fStream = std::move(stream);
+    }
+    if (prefetchExecutor) {
+        fPrefetch = std::make_unique<SkTaskGroup>(*prefetchExecutor);
+    }
+}
+
+SkMultiPictureDocumentReader::~SkMultiPictureDocumentReader() {
+    // Let any prefetches still queued return without reading anything.
+    fClosing.store(true);
+    if (fPrefetch) {
+        fPrefetch->wait();
+    }
+}
+
+SkSize SkMultiPictureDocumentReader::pageSize(int pageIndex) const {
+    SkASSERT(0 <= pageIndex && pageIndex < fPageCount);
+    return fPages[pageIndex].fEntry.fSize;
+}
+
+bool SkMultiPictureDocumentReader::isWanted(int pageIndex) const {
+    return !fClosing.load() && std::abs(pageIndex - fCurrentPage.load()) <= fRadius;
+}
+
+sk_sp<SkData> SkMultiPictureDocumentReader::readPageData(const Page& page) {
+    if (fMapping) {
+        return SkData::MakeSubset(fMapping.get(), page.fEntry.fOffset, page.fEntry.fLength);
+    }
+    SkAutoMutexExclusive lock(fStreamMutex);
+    sk_sp<SkData> data = SkData::MakeUninitialized(page.fEntry.fLength);
+    if (!fStream->seek(page.fEntry.fOffset) ||
+        data->size() != fStream->read(data->writable_data(), data->size())) {
+        return nullptr;
+    }
+    return data;
+}
+
+sk_sp<SkPicture> SkMultiPictureDocumentReader::loadPage(int pageIndex) {
+    Page& page = fPages[pageIndex];
+    SkAutoMutexExclusive lock(page.fMutex);
+    if (!page.fPicture) {
+        if (sk_sp<SkData> data = this->readPageData(page)) {
+            page.fPicture = SkPicture::MakeFromMappedData(std::move(data), &fProcs);
+        }
+        if (page.fPicture) {
+            SkAutoMutexExclusive cacheLock(fCacheMutex);
+            fCachedPages.push_back(pageIndex);
+        }
+    }
+    return page.fPicture;
+}
+
+sk_sp<SkPicture> SkMultiPictureDocumentReader::readPage(int pageIndex) {
+    if (pageIndex < 0 || pageIndex >= fPageCount) {
+        return nullptr;
+    }
+    fCurrentPage.store(pageIndex);
+
+    // Drop the pages we moved away from.
+    SkTDArray<int> evicted;
+    {
+        SkAutoMutexExclusive cacheLock(fCacheMutex);
+        for (int i = 0; i < fCachedPages.count();) {
+            if (!this->isWanted(fCachedPages[i])) {
+                evicted.push_back(fCachedPages[i]);
+                fCachedPages.removeShuffle(i);
+            } else {
+                ++i;
+            }
+        }
+    }
+    for (int i : evicted) {
+        SkAutoMutexExclusive lock(fPages[i].fMutex);
+        if (this->isWanted(i)) {
+            // Another thread came back to this page in the meantime.
+            SkAutoMutexExclusive cacheLock(fCacheMutex);
+            fCachedPages.push_back(i);
+        } else {
+            fPages[i].fPicture.reset();
+        }
+    }
+
+    if (fPrefetch) {
+        // Nearest pages first, and the next page before the previous one.
+        for (int d = 1; d <= fRadius; ++d) {
+            for (int i : {pageIndex + d, pageIndex - d}) {
+                if (0 <= i && i < fPageCount) {
+                    fPrefetch->add([this, i] {
+                        if (this->isWanted(i)) {
+                            this->loadPage(i);
+                        }
+                    });
+                }
+            }
+        }
+    }
+    return this->loadPage(pageIndex);
+}
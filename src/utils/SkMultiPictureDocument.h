@@ -10,13 +10,20 @@
 
 #include "include/core/SkDocument.h"
 #include "include/core/SkPicture.h"
+#include "include/core/SkSerialProcs.h"
 #include "include/core/SkSize.h"
+#include "include/private/SkMutex.h"
+#include "include/private/SkTDArray.h"
 
+#include <atomic>
 #include <functional>
+#include <memory>
 
-struct SkDeserialProcs;
-struct SkSerialProcs;
+class SkData;
+class SkExecutor;
+class SkStreamAsset;
 class SkStreamSeekable;
+class SkTaskGroup;
 /**
  *  Writes into a file format that is similar to SkPicture::serialize()
  *  Accepts a callback for endPage behavior
@@ -24,6 +31,17 @@ class SkStreamSeekable;
 SK_SPI sk_sp<SkDocument> SkMakeMultiPictureDocument(SkWStream* dst, const SkSerialProcs* = nullptr,
   std::function<void(const SkPicture*)> onEndPage = nullptr);
 
+/**
+ *  Like SkMakeMultiPictureDocument(), but writes each page as its own picture as soon as it ends,
+ *  and finishes with an index of where each page starts. SkMultiPictureDocumentReader can then
+ *  read any one page without parsing the others, and the writer never holds more than one page.
+ *
+ *  Pages are deserialized independently, so procs must not share data across pages (e.g.
+ *  SkSharingSerialContext's images).
+ */
+SK_SPI sk_sp<SkDocument> SkMakeIndexedMultiPictureDocument(SkWStream* dst,
+  const SkSerialProcs* = nullptr, std::function<void(const SkPicture*)> onEndPage = nullptr);
+
 struct SkDocumentPage {
     sk_sp<SkPicture> fPicture;
     SkSize fSize;
@@ -44,4 +62,64 @@ SK_SPI bool SkMultiPictureDocumentRead(SkStreamSeekable* src,
                                        int dstArrayCount,
                                        const SkDeserialProcs* = nullptr);
 
+/**
+ *  Reads pages of an indexed SkMultiPictureDocument (see SkMakeIndexedMultiPictureDocument())
+ *  on demand. Only the index is read up front; each page is deserialized the first time it is
+ *  asked for. If the stream has a memory base (e.g. SkStream::MakeFromFile() maps the file), the
+ *  pages are played back straight from that memory (see SkPicture::MakeFromMappedData()).
+ *
+ *  The reader keeps the pages within prefetchRadius of the last page read. Given an executor, it
+ *  also decodes those neighbors in the background, so stepping through a document rarely waits.
+ *  The deserial procs may then be called from the executor's threads.
+ *
+ *  readPage() may be called from any thread.
+ */
+class SK_SPI SkMultiPictureDocumentReader {
+public:
+    /**
+     *  Returns nullptr if the stream does not hold an indexed SkMultiPictureDocument.
+     */
+    static std::unique_ptr<SkMultiPictureDocumentReader> Make(
+            std::unique_ptr<SkStreamAsset>, const SkDeserialProcs* = nullptr,
+            SkExecutor* prefetchExecutor = nullptr, int prefetchRadius = 1);
+
+    ~SkMultiPictureDocumentReader();
+
+    int pageCount() const { return fPageCount; }
+    SkSize pageSize(int pageIndex) const;
+
+    /**
+     *  Returns the page, or nullptr if it cannot be deserialized.
+     */
+    sk_sp<SkPicture> readPage(int pageIndex);
+
+private:
+    struct Page;
+
+    SkMultiPictureDocumentReader(std::unique_ptr<SkStreamAsset>, std::unique_ptr<Page[]>,
+                                 int pageCount, const SkDeserialProcs*, SkExecutor*, int radius);
+
+    bool isWanted(int pageIndex) const;
+    sk_sp<SkPicture> loadPage(int pageIndex);
+    sk_sp<SkData> readPageData(const Page&);
+
+    // When the stream has a memory base, fMapping owns it and fStream is null.
+    std::unique_ptr<SkStreamAsset> fStream;
+    sk_sp<SkData>                  fMapping;
+    SkMutex                        fStreamMutex;
+
+    const SkDeserialProcs    fProcs;
+    std::unique_ptr<Page[]>  fPages;
+    const int                fPageCount;
+    const int                fRadius;
+    std::atomic<int>         fCurrentPage{0};
+    std::atomic<bool>        fClosing{false};
+
+    // Pages currently holding a decoded picture.
+    SkMutex        fCacheMutex;
+    SkTDArray<int> fCachedPages SK_GUARDED_BY(fCacheMutex);
+
+    std::unique_ptr<SkTaskGroup> fPrefetch;
+};
+
 #endif  // SkMultiPictureDocument_DEFINED
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2021 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/utils/SkTiledPicturePlayback.h"
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkSurface.h"
+#include "src/core/SkTaskGroup.h"
+#include "src/core/SkTraceEvent.h"
+
+#include <algorithm>
+#include <vector>
+
+bool SkTiledPicturePlayback::Draw(const SkPixmap& dst, const SkPicture* picture,
+                                  const SkMatrix& matrix, const SkSurfaceProps& props,
+                                  const Options& options) {
+    TRACE_EVENT0("skia", TRACE_FUNC);
+    if (!picture || !dst.addr() || dst.width() <= 0 || dst.height() <= 0) {
+        return false;
+    }
+
+    // Only tiles touched by the picture's cull rect need to draw anything.
+    SkIRect drawBounds;
+    if (!drawBounds.intersect(matrix.mapRect(picture->cullRect()).roundOut(),
+                              SkIRect::MakeWH(dst.width(), dst.height()))) {
+        return true;
+    }
+
+    const int tileW = std::max(options.fTileWidth,  1),
+              tileH = std::max(options.fTileHeight, 1);
+
+    std::vector<SkIRect> tiles;
+    for (int y = drawBounds.fTop; y < drawBounds.fBottom; y += tileH) {
+        for (int x = drawBounds.fLeft; x < drawBounds.fRight; x += tileW) {
+            SkIRect tile = SkIRect::MakeXYWH(x, y, tileW, tileH);
+            SkAssertResult(tile.intersect(drawBounds));
+            tiles.push_back(tile);
+        }
+    }
+
+    // All tiles share the destination pixels. Each canvas is clipped to its own tile, so the
+    // blitters never write outside of it and the tiles can be drawn without synchronization.
+    SkBitmap bitmap;
+    if (!bitmap.installPixels(dst)) {
+        return false;
+    }
+
+    auto drawTile = [&](int i) {
+        SkCanvas canvas(bitmap, props);
+        canvas.clipRect(SkRect::Make(tiles[i]));
+        canvas.drawPicture(picture, &matrix, nullptr);
+    };
+
+    if (tiles.size() == 1) {
+        drawTile(0);
+        return true;
+    }
+
+    SkExecutor& executor = options.fExecutor ? *options.fExecutor : SkExecutor::GetDefault();
+    SkTaskGroup(executor).batch(SkToInt(tiles.size()), drawTile);
+    return true;
+}
+
+bool SkTiledPicturePlayback::Draw(SkSurface* surface, const SkPicture* picture,
+                                  const SkMatrix& matrix, const Options& options) {
+    if (!surface) {
+        return false;
+    }
+    // We write to the pixels directly, so any outstanding snapshot must be detached first. That
+    // may give the surface new pixels, so only peek at them afterwards.
+    surface->notifyContentWillChange(SkSurface::kRetain_ContentChangeMode);
+    SkPixmap pixmap;
+    if (!surface->peekPixels(&pixmap)) {
+        return false;
+    }
+    return Draw(pixmap, picture, matrix, surface->props(), options);
+}
@@ -11,6 +11,7 @@
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkColorPriv.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkMaskFilter.h"
 #include "include/core/SkMath.h"
@@ -26,6 +27,7 @@
 #include "include/core/SkSize.h"
 #include "include/core/SkSurface.h"
 #include "include/core/SkTypes.h"
+#include "include/effects/SkImageFilters.h"
 #include "include/effects/SkPerlinNoiseShader.h"
 #include "include/gpu/GrDirectContext.h"
 #include "include/private/SkFloatBits.h"
@@ -33,8 +35,10 @@
 #include "src/core/SkBlurMask.h"
 #include "src/core/SkGpuBlurUtils.h"
 #include "src/core/SkMask.h"
+#include "src/core/SkMaskBlurFilter.h"
 #include "src/core/SkMaskFilterBase.h"
 #include "src/core/SkMathPriv.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/effects/SkEmbossMaskFilter.h"
 #include "tests/Test.h"
 #include "tools/ToolUtils.h"
@@ -573,3 +577,35 @@ DEF_TEST(zero_blur, reporter) {
     SkIPoint offset;
     bitmap.extractAlpha(&alpha, &paint, nullptr, &offset);
 }
+
+DEF_TEST(Blur_Executor, reporter) {
+    auto draw = [](SkCanvas* canvas) {
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        paint.setMaskFilter(SkMaskFilter::MakeBlur(kNormal_SkBlurStyle, 24));
+        canvas->drawPath(SkPath::Polygon({{40, 40}, {560, 90}, {120, 460}}, true), paint);
+
+        paint.setMaskFilter(nullptr);
+        paint.setColor(SK_ColorBLUE);
+        paint.setImageFilter(SkImageFilters::Blur(30, 18, nullptr));
+        canvas->drawCircle(360, 300, 150, paint);
+    };
+
+    auto render = [&](SkExecutor* executor) {
+        auto surface = SkSurface::MakeRasterN32Premul(600, 500);
+        {
+            SkAutoGraphicsExecutor autoExecutor(executor);
+            draw(surface->getCanvas());
+        }
+
+        SkBitmap bitmap;
+        bitmap.allocPixels(surface->imageInfo());
+        surface->readPixels(bitmap, 0, 0);
+        return bitmap;
+    };
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    SkBitmap serial   = render(nullptr),
+             parallel = render(executor.get());
+    REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(serial, parallel));
+}
@@ -19,6 +19,7 @@
 #include "include/core/SkColorSpace.h"
 #include "include/core/SkData.h"
 #include "include/core/SkEncodedImageFormat.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkImageEncoder.h"
 #include "include/core/SkImageGenerator.h"
@@ -474,6 +475,47 @@ static void check(skiatest::Reporter* r,
     }
 }
 
+DEF_TEST(Codec_executor, r) {
+    // Decoding with an executor must match the serial decode, including truncated images.
+    auto executor = SkExecutor::MakeFIFOThreadPool(4);
+    for (const char* path : {"images/mandrill_512_q075.jpg", "images/CMYK.jpg",
+                             "images/color_wheel.png", "images/yellow_rose.png",
+                             "images/plane_interlaced.png"}) {
+        sk_sp<SkData> data = GetResourceAsData(path);
+        if (!data) {
+            continue;
+        }
+        for (bool truncate : {false, true}) {
+            sk_sp<SkData> input = truncate ? SkData::MakeSubset(data.get(), 0, data->size() / 2)
+                                           : data;
+            for (SkColorType colorType : {kN32_SkColorType, kRGBA_F16_SkColorType}) {
+                SkBitmap bitmaps[2];
+                SkCodec::Result results[2];
+                for (int i = 0; i < 2; ++i) {
+                    auto codec = SkCodec::MakeFromData(input);
+                    if (!codec) {
+                        break;
+                    }
+                    SkImageInfo info = codec->getInfo().makeColorType(colorType)
+                                                       .makeAlphaType(kPremul_SkAlphaType)
+                                                       .makeColorSpace(SkColorSpace::MakeRGB(
+                                                               SkNamedTransferFn::kSRGB,
+                                                               SkNamedGamut::kDisplayP3));
+                    SkCodec::Options options;
+                    options.fExecutor = i ? executor.get() : nullptr;
+                    bitmaps[i].allocPixels(info);
+                    results[i] = codec->getPixels(bitmaps[i].pixmap(), &options);
+                }
+                if (bitmaps[1].drawsNothing()) {
+                    continue;
+                }
+                REPORTER_ASSERT(r, results[0] == results[1], "%s", path);
+                REPORTER_ASSERT(r, md5(bitmaps[0]) == md5(bitmaps[1]), "%s", path);
+            }
+        }
+    }
+}
+
 DEF_TEST(Codec_wbmp, r) {
     check(r, "images/mandrill.wbmp", SkISize::Make(512, 512), true, false, true);
 }
@@ -12,6 +12,7 @@
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColorPriv.h"
 #include "include/core/SkEncodedImageFormat.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkSurface.h"
@@ -332,6 +333,40 @@ DEF_TEST(Encode_PngOptions, r) {
     REPORTER_ASSERT(r, almost_equals(bm0, bm2, 0));
 }
 
+DEF_TEST(Encode_PngExecutor, r) {
+    // Tall enough for several batches of parallel IDAT chunks.
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(1000, 1500);
+    for (int y = 0; y < bitmap.height(); ++y) {
+        for (int x = 0; x < bitmap.width(); ++x) {
+            *bitmap.getAddr32(x, y) = SkPackARGB32(0xFF, x & 0xFF, y & 0xFF, (x * y) >> 8 & 0xFF);
+        }
+    }
+    SkPixmap src;
+    REPORTER_ASSERT(r, bitmap.peekPixels(&src));
+
+    auto executor = SkExecutor::MakeFIFOThreadPool(4);
+    for (auto filters : {SkPngEncoder::FilterFlag::kNone, SkPngEncoder::FilterFlag::kPaeth,
+                         SkPngEncoder::FilterFlag::kAll}) {
+        SkPngEncoder::Options options;
+        options.fFilterFlags = filters;
+
+        SkDynamicMemoryWStream serial, parallel;
+        REPORTER_ASSERT(r, SkPngEncoder::Encode(&serial, src, options));
+        options.fExecutor = executor.get();
+        REPORTER_ASSERT(r, SkPngEncoder::Encode(&parallel, src, options));
+
+        SkBitmap bm0, bm1;
+        SkImage::MakeFromEncoded(serial.detachAsData())->asLegacyBitmap(&bm0);
+        auto image = SkImage::MakeFromEncoded(parallel.detachAsData());
+        REPORTER_ASSERT(r, image);
+        if (image) {
+            image->asLegacyBitmap(&bm1);
+            REPORTER_ASSERT(r, almost_equals(bm0, bm1, 0));
+        }
+    }
+}
+
 #ifndef SK_BUILD_FOR_GOOGLE3
 DEF_TEST(Encode_WebpQuality, r) {
     SkBitmap bm;
@@ -5,10 +5,15 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkPath.h"
 #include "include/core/SkRegion.h"
+#include "include/utils/SkRandom.h"
 #include "src/core/SkBlitter.h"
 #include "src/core/SkScan.h"
+#include "src/core/SkTaskGroup.h"
 #include "tests/Test.h"
 
 struct FakeBlitter : public SkBlitter {
@@ -46,3 +51,63 @@ DEF_TEST(FillPathInverse, reporter) {
 
     REPORTER_ASSERT(reporter, blitter.m_blitCount == expected_lines);
 }
+
+static SkBitmap fill_big_path(const SkPath& path, SkExecutor* executor, int bandHeight = 0) {
+    SkBitmap bm;
+    bm.allocN32Pixels(300, 1000);
+    bm.eraseColor(SK_ColorWHITE);
+
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setColor(0xff336699);
+
+    SkAutoGraphicsExecutor autoExecutor(executor);
+    SkCanvas canvas(bm);
+    if (bandHeight > 0) {
+        for (int y = 0; y < bm.height(); y += bandHeight) {
+            SkAutoCanvasRestore acr(&canvas, true);
+            canvas.clipRect(SkRect::MakeXYWH(0, y, bm.width(), bandHeight));
+            canvas.drawPath(path, paint);
+        }
+    } else {
+        canvas.drawPath(path, paint);
+    }
+    return bm;
+}
+
+// Very large antialiased fills may be rasterized in parallel bands; the result must not depend
+// on the number of threads. Each band clips the path's edges to itself, which moves where they
+// cross the supersampled rows a little, so a whole sample may flip anywhere in the path compared
+// to drawing it in one piece. Drawing the same bands one after another must match exactly,
+// though: any difference there is a seam or a coverage bug at a band edge.
+DEF_TEST(FillPath_Banded, reporter) {
+    SkRandom rand;
+    SkPath path;
+    path.moveTo(150, -10);
+    for (int i = 0; i < 6000; ++i) {
+        path.lineTo(rand.nextRangeF(-10, 310), rand.nextRangeF(-10, 1010));
+    }
+
+    std::unique_ptr<SkExecutor> one  = SkExecutor::MakeFIFOThreadPool(1),
+                                four = SkExecutor::MakeFIFOThreadPool(4);
+    // Matches kBandedAABandHeight in SkDraw.cpp.
+    SkBitmap serial   = fill_big_path(path, nullptr, 128),
+             banded1  = fill_big_path(path, one.get()),
+             banded4  = fill_big_path(path, four.get());
+
+    REPORTER_ASSERT(reporter, 0 == memcmp(banded1.getPixels(), banded4.getPixels(),
+                                          banded1.computeByteSize()));
+    REPORTER_ASSERT(reporter, 0 == memcmp(serial.getPixels(), banded4.getPixels(),
+                                          serial.computeByteSize()));
+
+    // Drawing from a task on the same executor must not wait on that executor, so it fills the
+    // path in one piece. One thread, which waiters may not borrow().
+    std::unique_ptr<SkExecutor> nonBorrowing = SkExecutor::MakeFIFOThreadPool(1, false);
+    SkBitmap whole = fill_big_path(path, nullptr),
+             nested;
+    SkTaskGroup group(*nonBorrowing);
+    group.add([&] { nested = fill_big_path(path, nonBorrowing.get()); });
+    group.wait();
+    REPORTER_ASSERT(reporter, 0 == memcmp(whole.getPixels(), nested.getPixels(),
+                                          whole.computeByteSize()));
+}
@@ -62,7 +62,8 @@ static void test_find_existing(skiatest::Reporter* reporter,
 }
 
 // If either id is different or the clip or the matrix are different the
-// cached image won't be found. Even if it is caching the same bitmap.
+// cached image won't be found. Even if it is caching the same bitmap, and even
+// if the cached clip contains the requested one (see test_dont_find_covering).
 static void test_dont_find_if_diff_key(skiatest::Reporter* reporter,
                                        const sk_sp<SkSpecialImage>& image,
                                        const sk_sp<SkSpecialImage>& subset) {
@@ -115,6 +116,7 @@ static void test_internal_purge(skiatest::Reporter* reporter, const sk_sp<SkSpec
 
     REPORTER_ASSERT(reporter, cache->get(key2, &foundImage));
     REPORTER_ASSERT(reporter, !cache->get(key1, &foundImage));
+    REPORTER_ASSERT(reporter, cache->stats().fEvictions == 1);
 }
 
 // Exercise the purgeByKey and purge methods
@@ -154,6 +156,39 @@ static void test_explicit_purging(skiatest::Reporter* reporter,
     REPORTER_ASSERT(reporter, !cache->get(key2, &foundImage));
 }
 
+// A result cached for larger clip bounds, or under a matrix that differs only by an integer
+// translation, is not reused: filter output depends on where the clip cuts it.
+static void test_dont_find_covering(skiatest::Reporter* reporter,
+                                    const sk_sp<SkSpecialImage>& image) {
+    static const size_t kCacheSize = 1000000;
+    sk_sp<SkImageFilterCache> cache(SkImageFilterCache::Create(kCacheSize));
+
+    SkImageFilterCacheKey key(0, SkMatrix::I(), SkIRect::MakeWH(100, 100),
+                              image->uniqueID(), image->subset());
+    SkIPoint offset = SkIPoint::Make(3, 4);
+    auto filter = make_filter();
+    cache->set(key, filter.get(),
+               skif::FilterResult<For::kOutput>(image, skif::LayerSpace<SkIPoint>(offset)));
+
+    skif::FilterResult<For::kOutput> found;
+    SkImageFilterCacheKey inner(0, SkMatrix::I(), SkIRect::MakeXYWH(5, 6, 4, 3),
+                                image->uniqueID(), image->subset());
+    SkImageFilterCacheKey panned(0, SkMatrix::Translate(-10, -20), SkIRect::MakeXYWH(-5, -14, 4, 3),
+                                 image->uniqueID(), image->subset());
+    REPORTER_ASSERT(reporter, !cache->get(inner, &found));
+    REPORTER_ASSERT(reporter, !cache->get(panned, &found));
+    REPORTER_ASSERT(reporter, cache->get(key, &found));
+
+    SkImageFilterCache::Stats stats = cache->stats();
+    REPORTER_ASSERT(reporter, stats.fHits == 1);
+    REPORTER_ASSERT(reporter, stats.fMisses == 2);
+    REPORTER_ASSERT(reporter, stats.fCount == 1);
+    REPORTER_ASSERT(reporter, stats.fRasterBytes + stats.fGpuBytes == image->getSize());
+
+    cache->purgeByImageFilter(filter.get());
+    REPORTER_ASSERT(reporter, !cache->get(key, &found));
+}
+
 DEF_TEST(ImageFilterCache_RasterBacked, reporter) {
     SkBitmap srcBM = create_bm();
 
@@ -170,6 +205,7 @@ DEF_TEST(ImageFilterCache_RasterBacked, reporter) {
     test_dont_find_if_diff_key(reporter, fullImg, subsetImg);
     test_internal_purge(reporter, fullImg);
     test_explicit_purging(reporter, fullImg, subsetImg);
+    test_dont_find_covering(reporter, fullImg);
 }
 
 
@@ -191,6 +227,7 @@ static void test_image_backed(skiatest::Reporter* reporter,
     test_dont_find_if_diff_key(reporter, fullImg, subsetImg);
     test_internal_purge(reporter, fullImg);
     test_explicit_purging(reporter, fullImg, subsetImg);
+    test_dont_find_covering(reporter, fullImg);
 }
 
 DEF_TEST(ImageFilterCache_ImageBackedRaster, reporter) {
@@ -286,4 +323,5 @@ DEF_GPUTEST_FOR_RENDERING_CONTEXTS(ImageFilterCache_GPUBacked, reporter, ctxInfo
     test_dont_find_if_diff_key(reporter, fullImg, subsetImg);
     test_internal_purge(reporter, fullImg);
     test_explicit_purging(reporter, fullImg, subsetImg);
+    test_dont_find_covering(reporter, fullImg);
 }
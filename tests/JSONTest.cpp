@@ -12,6 +12,9 @@
 #include "src/core/SkArenaAlloc.h"
 #include "src/utils/SkJSON.h"
 
+#include <algorithm>
+#include <vector>
+
 using namespace skjson;
 
 DEF_TEST(JSON_Parse, reporter) {
@@ -454,3 +457,75 @@ DEF_TEST(JSON_ParseNumber, reporter) {
         REPORTER_ASSERT(reporter, SkScalarNearlyEqual(**jnumber, test.value, test.tolerance));
     }
 }
+
+DEF_TEST(JSON_Snapshot, reporter) {
+    static constexpr char json[] =
+        "{ \"k1\": null, \"k2\": [ false, true, 42, -1.5, \"short\", \"a longer string\" ],"
+        "  \"a longer key\": { \"k\": [ [], {}, [ { \"kk\": \"\" } ] ] }, \"k1\": 7 }";
+
+    const DOM dom(json, strlen(json));
+    SkDynamicMemoryWStream stream;
+    REPORTER_ASSERT(reporter, dom.writeSnapshot(&stream));
+    const auto snapshot = stream.detachAsData();
+    const auto* bytes = static_cast<const char*>(snapshot->data());
+
+    // Snapshots are only loaded when asked for; as JSON, they don't parse.
+    static constexpr auto kSnapshot = DOM::Format::kJSONOrSnapshot;
+    REPORTER_ASSERT(reporter, DOM(bytes, snapshot->size()).root().is<NullValue>());
+
+    // A loaded snapshot reads back as the same DOM.
+    const DOM loaded(bytes, snapshot->size(), kSnapshot);
+    REPORTER_ASSERT(reporter, loaded.root().is<ObjectValue>());
+    REPORTER_ASSERT(reporter, loaded.root().toString().equals(dom.root().toString()));
+    const NumberValue* k1 = loaded.root().as<ObjectValue>()["k1"];
+    REPORTER_ASSERT(reporter, k1 && **k1 == 7);
+
+    // So does one at an unaligned address.
+    std::vector<char> unaligned(snapshot->size() + 1);
+    memcpy(unaligned.data() + 1, bytes, snapshot->size());
+    REPORTER_ASSERT(reporter, DOM(unaligned.data() + 1, snapshot->size(), kSnapshot).root()
+                                  .toString().equals(dom.root().toString()));
+
+    // Truncated or corrupted snapshots load as null, rather than crashing.
+    for (size_t size = 0; size < snapshot->size(); size += 5) {
+        REPORTER_ASSERT(reporter, DOM(bytes, size, kSnapshot).root().is<NullValue>());
+    }
+    std::vector<char> corrupted(bytes, bytes + snapshot->size());
+    for (size_t i = 8; i < corrupted.size(); ++i) {
+        for (char flip : { 0x01, 0x08, 0x40 }) {
+            corrupted[i] ^= flip;
+            // Passes if loading, and reading back whatever loaded, doesn't crash.
+            const DOM corruptedDOM(corrupted.data(), corrupted.size(), kSnapshot);
+            corruptedDOM.root().toString();
+            corrupted[i] ^= flip;
+        }
+    }
+
+    // Bools other than 0 or 1 are rejected.
+    const DOM bools("[ true ]", 8);
+    REPORTER_ASSERT(reporter, bools.writeSnapshot(&stream));
+    const auto boolSnapshot = stream.detachAsData();
+    std::vector<char> boolImage(static_cast<const char*>(boolSnapshot->data()),
+                                static_cast<const char*>(boolSnapshot->data()) +
+                                boolSnapshot->size());
+    const BoolValue jtrue(true);
+    const auto* trueBytes = reinterpret_cast<const char*>(&jtrue);
+    auto found = std::search(boolImage.begin(), boolImage.end(),
+                             trueBytes, trueBytes + sizeof(jtrue));
+    REPORTER_ASSERT(reporter, found != boolImage.end());
+    if (found != boolImage.end()) {
+        REPORTER_ASSERT(reporter, DOM(boolImage.data(), boolImage.size(), kSnapshot).root()
+                                      .is<ArrayValue>());
+        // The payload is the byte after the tag.
+        found[1] = 2;
+        REPORTER_ASSERT(reporter, DOM(boolImage.data(), boolImage.size(), kSnapshot).root()
+                                      .is<NullValue>());
+    }
+
+    // Snapshots of unparsable JSON are of a null root.
+    const DOM invalid("{", 1);
+    REPORTER_ASSERT(reporter, invalid.writeSnapshot(&stream));
+    const auto invalidSnapshot = stream.detachAsData();
+    REPORTER_ASSERT(reporter, DOM(static_cast<const char*>(invalidSnapshot->data()),
+                                  invalidSnapshot->size(), kSnapshot).root().is<NullValue>());
+}
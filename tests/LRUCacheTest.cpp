@@ -70,3 +70,21 @@ DEF_TEST(LRUCacheRandom, r) {
     }
     REPORTER_ASSERT(r, 0 == instances);
 }
+
+DEF_TEST(LRUCacheRemoveLRU, r) {
+    int instances = 0;
+    {
+        SkLRUCache<int, std::unique_ptr<Value>> test(5);
+        for (int k = 0; k < 3; k++) {
+            test.insert(k, std::make_unique<Value>(k, &instances));
+        }
+        test.find(0);
+        test.removeLRU();
+        REPORTER_ASSERT(r, !test.find(1));
+        test.removeLRU();
+        REPORTER_ASSERT(r, !test.find(2));
+        REPORTER_ASSERT(r, test.find(0));
+        REPORTER_ASSERT(r, 1 == instances && 1 == test.count());
+    }
+    REPORTER_ASSERT(r, 0 == instances);
+}
@@ -211,6 +211,112 @@ DEF_TEST(MipMap_F16, reporter) {
     sk_sp<SkMipmap> mipmap(SkMipmap::Build(bmp, nullptr));
 }
 
+#include "include/core/SkExecutor.h"
+#include "include/private/SkHalf.h"
+#include "src/core/SkTaskGroup.h"
+
+// Levels built in parallel bands must match the ones built serially, and the fast 2x2 filters
+// must still be plain box filters.
+DEF_TEST(MipMap_Executor, reporter) {
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    SkRandom rand;
+
+    for (SkColorType ct : {kN32_SkColorType, kAlpha_8_SkColorType, kRGBA_F16_SkColorType}) {
+        for (SkISize size : {SkISize{1024, 768}, SkISize{1001, 600}, SkISize{520, 1}}) {
+            SkBitmap bm;
+            bm.allocPixels(SkImageInfo::Make(size, ct, kPremul_SkAlphaType));
+            for (int y = 0; y < bm.height(); ++y) {
+                for (int x = 0; x < bm.width(); ++x) {
+                    switch (ct) {
+                        case kAlpha_8_SkColorType:
+                            *bm.getAddr8(x, y) = (uint8_t)rand.nextU();
+                            break;
+                        case kRGBA_F16_SkColorType: {
+                            auto px = (SkHalf*)bm.getAddr(x, y);
+                            for (int i = 0; i < 4; ++i) {
+                                px[i] = SkFloatToHalf(rand.nextF());
+                            }
+                            break;
+                        }
+                        default:
+                            *bm.getAddr32(x, y) = rand.nextU();
+                            break;
+                    }
+                }
+            }
+
+            sk_sp<SkMipmap> serial(SkMipmap::Build(bm, nullptr));
+            sk_sp<SkMipmap> parallel;
+            {
+                SkAutoGraphicsExecutor autoExecutor(executor.get());
+                parallel.reset(SkMipmap::Build(bm, nullptr));
+            }
+
+            REPORTER_ASSERT(reporter, serial->countLevels() == parallel->countLevels());
+            for (int i = 0; i < serial->countLevels(); ++i) {
+                SkMipmap::Level a, b;
+                REPORTER_ASSERT(reporter, serial->getLevel(i, &a) && parallel->getLevel(i, &b));
+                const SkPixmap& pa = a.fPixmap;
+                const SkPixmap& pb = b.fPixmap;
+                for (int y = 0; y < pa.height(); ++y) {
+                    REPORTER_ASSERT(reporter, !memcmp(pa.addr(0, y), pb.addr(0, y),
+                                                      pa.info().minRowBytes()));
+                }
+            }
+
+            // Level 0 of an even-sized image is a plain 2x2 box filter of the base.
+            if (size.width() % 2 == 0 && size.height() % 2 == 0) {
+                SkMipmap::Level level;
+                serial->getLevel(0, &level);
+                const SkPixmap& pm = level.fPixmap;
+                for (int y = 0; y < pm.height(); ++y) {
+                    for (int x = 0; x < pm.width(); ++x) {
+                        switch (ct) {
+                            case kAlpha_8_SkColorType: {
+                                unsigned sum = *bm.getAddr8(2*x, 2*y+0) + *bm.getAddr8(2*x+1, 2*y+0)
+                                             + *bm.getAddr8(2*x, 2*y+1)
+                                             + *bm.getAddr8(2*x+1, 2*y+1);
+                                REPORTER_ASSERT(reporter, *pm.addr8(x, y) == sum / 4);
+                                break;
+                            }
+                            case kRGBA_F16_SkColorType: {
+                                auto half = [](const void* px, int i) {
+                                    return SkHalfToFloat(static_cast<const SkHalf*>(px)[i]);
+                                };
+                                for (int i = 0; i < 4; ++i) {
+                                    float avg = (half(bm.getAddr(2*x, 2*y+0), i) +
+                                                 half(bm.getAddr(2*x+1, 2*y+0), i) +
+                                                 half(bm.getAddr(2*x, 2*y+1), i) +
+                                                 half(bm.getAddr(2*x+1, 2*y+1), i)) / 4;
+                                    // The vectorized half conversions flush denormals and round
+                                    // differently than SkFloatToHalf(), so allow one half ULP.
+                                    float tolerance = avg / 1024 + 1.0f / (1 << 14),
+                                          actual    = half(pm.addr(x, y), i);
+                                    REPORTER_ASSERT(reporter, fabsf(actual - avg) <= tolerance);
+                                }
+                                break;
+                            }
+                            default: {
+                                auto byte = [](const uint32_t* px, int i) {
+                                    return (unsigned)reinterpret_cast<const uint8_t*>(px)[i];
+                                };
+                                for (int i = 0; i < 4; ++i) {
+                                    unsigned sum = byte(bm.getAddr32(2*x, 2*y+0), i) +
+                                                   byte(bm.getAddr32(2*x+1, 2*y+0), i) +
+                                                   byte(bm.getAddr32(2*x, 2*y+1), i) +
+                                                   byte(bm.getAddr32(2*x+1, 2*y+1), i);
+                                    REPORTER_ASSERT(reporter, byte(pm.addr32(x, y), i) == sum / 4);
+                                }
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
 #include "include/core/SkCanvas.h"
 #include "include/core/SkSurface.h"
 #include "src/core/SkMipmapBuilder.h"
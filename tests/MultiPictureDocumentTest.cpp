@@ -19,8 +19,11 @@
 #include "include/core/SkString.h"
 #include "include/core/SkSurface.h"
 #include "include/core/SkTextBlob.h"
+#include "include/core/SkStream.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/gpu/GrCaps.h"
 #include "src/utils/SkMultiPictureDocument.h"
+#include "src/utils/SkOSPath.h"
 #include "tests/Test.h"
 #include "tools/SkSharingProc.h"
 #include "tools/ToolUtils.h"
@@ -167,6 +170,109 @@ DEF_TEST(SkMultiPictureDocument_Serialize_and_deserialize, reporter) {
     }
 }
 
+// Test reading pages of an indexed multi picture document one at a time.
+DEF_TEST(SkMultiPictureDocument_Indexed, reporter) {
+    SkDynamicMemoryWStream stream;
+    sk_sp<SkDocument> multipic = SkMakeIndexedMultiPictureDocument(&stream);
+
+    static const int NUM_FRAMES = 7;
+
+    auto surface(SkSurface::MakeRasterN32Premul(100, 100));
+    surface->getCanvas()->clear(SK_ColorGREEN);
+    sk_sp<SkImage> image(surface->makeImageSnapshot());
+
+    SkPictureRecorder pr;
+    draw_basic(pr.beginRecording(100, 100), 42, image);
+    sk_sp<SkPicture> sub = pr.finishRecordingAsPicture();
+
+    std::vector<sk_sp<SkImage>> expectedImages;
+    for (int i = 0; i < NUM_FRAMES; i++) {
+        // Vary the page sizes so we can tell the pages apart.
+        const int width = 200 + i, height = 256;
+        draw_advanced(multipic->beginPage(width, height), i, image, sub);
+        multipic->endPage();
+        auto surf = SkSurface::MakeRasterN32Premul(width, height);
+        draw_advanced(surf->getCanvas(), i, image, sub);
+        expectedImages.push_back(surf->makeImageSnapshot());
+    }
+    multipic->close();
+    sk_sp<SkData> data = stream.detachAsData();
+
+    auto check_page = [&](const sk_sp<SkPicture>& page, int i) {
+        if (!page) {
+            ERRORF(reporter, "Page %d could not be read", i);
+            return;
+        }
+        SkImageInfo info = expectedImages[i]->imageInfo();
+        auto surf = SkSurface::MakeRaster(info);
+        surf->getCanvas()->drawPicture(page);
+        auto img = surf->makeImageSnapshot();
+        REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(img.get(), expectedImages[i].get()),
+                        "Page %d differs", i);
+    };
+
+    // The existing entry points read indexed documents too.
+    {
+        SkMemoryStream memStream(data);
+        REPORTER_ASSERT(reporter, SkMultiPictureDocumentReadPageCount(&memStream) == NUM_FRAMES);
+        std::vector<SkDocumentPage> frames(NUM_FRAMES);
+        REPORTER_ASSERT(reporter,
+                        SkMultiPictureDocumentRead(&memStream, frames.data(), NUM_FRAMES));
+        for (int i = 0; i < NUM_FRAMES; ++i) {
+            REPORTER_ASSERT(reporter, frames[i].fSize == SkSize::Make(200 + i, 256));
+            check_page(frames[i].fPicture, i);
+        }
+    }
+
+    auto check_reader = [&](std::unique_ptr<SkStreamAsset> asset, SkExecutor* executor) {
+        auto reader = SkMultiPictureDocumentReader::Make(std::move(asset), nullptr, executor);
+        if (!reader) {
+            ERRORF(reporter, "Could not make reader");
+            return;
+        }
+        REPORTER_ASSERT(reporter, reader->pageCount() == NUM_FRAMES);
+        for (int i : {3, 4, 0, 6, 5, 1, 2, 3}) {
+            REPORTER_ASSERT(reporter, reader->pageSize(i) == SkSize::Make(200 + i, 256));
+            check_page(reader->readPage(i), i);
+        }
+        REPORTER_ASSERT(reporter, !reader->readPage(NUM_FRAMES));
+        // Pages outlive the reader.
+        sk_sp<SkPicture> last = reader->readPage(NUM_FRAMES - 1);
+        reader.reset();
+        check_page(last, NUM_FRAMES - 1);
+    };
+
+    // Pages are played back in place from a memory stream.
+    check_reader(SkMemoryStream::Make(data), nullptr);
+    auto executor = SkExecutor::MakeFIFOThreadPool(2);
+    check_reader(SkMemoryStream::Make(data), executor.get());
+
+    // Or copied out of a file stream.
+    SkString tmpDir = skiatest::GetTmpDir();
+    if (!tmpDir.isEmpty()) {
+        SkString path = SkOSPath::Join(tmpDir.c_str(), "indexed.mskp");
+        {
+            SkFILEWStream file(path.c_str());
+            file.write(data->data(), data->size());
+        }
+        check_reader(std::make_unique<SkFILEStream>(path.c_str()), executor.get());
+    }
+
+    // A truncated document has no index.
+    auto truncated = SkData::MakeSubset(data.get(), 0, data->size() - 1);
+    REPORTER_ASSERT(reporter, !SkMultiPictureDocumentReader::Make(SkMemoryStream::Make(truncated)));
+    SkMemoryStream truncatedStream(truncated);
+    REPORTER_ASSERT(reporter, SkMultiPictureDocumentReadPageCount(&truncatedStream) == 0);
+
+    // Classic documents are not indexed.
+    SkDynamicMemoryWStream classic;
+    sk_sp<SkDocument> classicDoc = SkMakeMultiPictureDocument(&classic);
+    classicDoc->beginPage(10, 10);
+    classicDoc->endPage();
+    classicDoc->close();
+    REPORTER_ASSERT(reporter, !SkMultiPictureDocumentReader::Make(classic.detachAsStream()));
+}
+
 
 #if SK_SUPPORT_GPU && defined(SK_BUILD_FOR_ANDROID) && __ANDROID_API__ >= 26
 
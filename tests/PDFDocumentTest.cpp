@@ -9,6 +9,8 @@
 #include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkExecutor.h"
+#include "include/core/SkFont.h"
+#include "include/core/SkImage.h"
 #include "include/core/SkStream.h"
 #include "include/docs/SkPDFDocument.h"
 #include "src/core/SkOSFile.h"
@@ -256,3 +258,79 @@ DEF_TEST(SkPDF_abort_jobs, rep) {
     doc->abort();
 }
 
+
+// Pages, images and fonts may all be written by the executor, in any order; make sure every
+// reserved object still ends up in the file exactly once.
+DEF_TEST(SkPDF_executor_multiple_pages, r) {
+    REQUIRE_PDF_DOCUMENT(SkPDF_executor_multiple_pages, r);
+    SkBitmap b;
+    b.allocN32Pixels(64, 64);
+    b.eraseColor(0xFF4F9643);
+    SkFont font(ToolUtils::create_portable_typeface(), 12);
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    SkPDF::Metadata metadata;
+    metadata.fExecutor = executor.get();
+    SkDynamicMemoryWStream wStream;
+    {
+        auto doc = SkPDF::MakeDocument(&wStream, metadata);
+        for (int i = 0; i < 100; ++i) {
+            SkCanvas* canvas = doc->beginPage(612, 792);
+            canvas->drawString(SkStringPrintf("Page %d", i), 72, 72, font, SkPaint());
+            if (i % 10 == 0) {
+                canvas->drawImage(b.asImage(), 100, 100);
+            }
+        }
+    }
+    sk_sp<SkData> data(wStream.detachAsData());
+    std::string pdf((const char*)data->data(), data->size());
+    REPORTER_ASSERT(r, pdf.size() > 5 && pdf.compare(pdf.size() - 5, 5, "%%EOF") == 0);
+
+    // Follow startxref to the cross-reference table, and check that every object it lists
+    // starts where it says, and that the trailer's /Size counts them all.
+    size_t startxref = pdf.rfind("startxref\n");
+    REPORTER_ASSERT(r, startxref != std::string::npos);
+    if (startxref == std::string::npos) {
+        return;
+    }
+    size_t xref = std::stoul(pdf.substr(startxref + strlen("startxref\n")));
+    REPORTER_ASSERT(r, pdf.compare(xref, 7, "xref\n0 ") == 0);
+    if (pdf.compare(xref, 7, "xref\n0 ") != 0) {
+        return;
+    }
+    size_t pos = xref + 7;
+    int count = std::stoi(pdf.substr(pos));
+    pos = pdf.find('\n', pos) + 1;
+    REPORTER_ASSERT(r, pdf.compare(pos, 20, "0000000000 65535 f \n") == 0);
+    pos += 20;
+    for (int i = 1; i < count; ++i, pos += 20) {
+        REPORTER_ASSERT(r, pdf.compare(pos + 10, 10, " 00000 n \n") == 0);
+        size_t offset = std::stoul(pdf.substr(pos, 10));
+        std::string header = std::to_string(i) + " 0 obj\n";
+        REPORTER_ASSERT(r, pdf.compare(offset, header.size(), header) == 0, "object %d", i);
+    }
+    REPORTER_ASSERT(r, pdf.compare(pos, 8, "trailer\n") == 0);
+    size_t size = pdf.find("/Size ", pos);
+    REPORTER_ASSERT(r, size != std::string::npos && size < startxref);
+    REPORTER_ASSERT(r, count == std::stoi(pdf.substr(size + strlen("/Size "))));
+}
+
+// CompressionLevel::None leaves images uncompressed, like every other stream.
+DEF_TEST(SkPDF_uncompressed_images, r) {
+    REQUIRE_PDF_DOCUMENT(SkPDF_uncompressed_images, r);
+    SkBitmap b;
+    b.allocN32Pixels(64, 64);
+    b.eraseColor(0x804F9643);
+
+    SkPDF::Metadata metadata;
+    metadata.fCompressionLevel = SkPDF::Metadata::CompressionLevel::None;
+    SkDynamicMemoryWStream wStream;
+    {
+        auto doc = SkPDF::MakeDocument(&wStream, metadata);
+        doc->beginPage(612, 792)->drawImage(b.asImage(), 0, 0);
+    }
+    sk_sp<SkData> data(wStream.detachAsData());
+    std::string pdf((const char*)data->data(), data->size());
+    REPORTER_ASSERT(r, pdf.find("/Subtype /Image") != std::string::npos);
+    REPORTER_ASSERT(r, pdf.find("FlateDecode") == std::string::npos);
+}
@@ -6,6 +6,9 @@
  */
 
 #include "include/core/SkBitmap.h"
+#include "include/core/SkExecutor.h"
+#include "include/utils/SkRandom.h"
+#include "src/core/SkTaskGroup.h"
 #include "tests/PathOpsExtendedTest.h"
 #include "tests/PathOpsTestCommon.h"
 #include "tests/Test.h"
@@ -361,3 +364,92 @@ SkOpBuilder builder;
     builder.add(path1, SkPathOp::kUnion_SkPathOp);
     builder.resolve(&path);
 }
+
+static SkPath make_builder_star(SkScalar x, SkScalar y, SkScalar radius) {
+    SkPath star;
+    star.moveTo(x + radius, y);
+    for (int i = 1; i < 10; ++i) {
+        SkScalar angle = i * SK_ScalarPI / 5,
+                 r = (i & 1) ? radius / 2 : radius;
+        star.lineTo(x + r * SkScalarCos(angle), y + r * SkScalarSin(angle));
+    }
+    star.close();
+    return star;
+}
+
+// Runs of the same op are combined as a tree, possibly in parallel. The area must match doing
+// the ops one at a time, and must not depend on the executor.
+DEF_TEST(SkOpBuilderRuns, reporter) {
+    SkRandom rand;
+    SkTArray<SkPath> paths;
+    SkTDArray<SkPathOp> ops;
+    auto addRun = [&](SkPathOp op, int count, SkScalar spread) {
+        for (int i = 0; i < count; ++i) {
+            paths.push_back(make_builder_star(rand.nextRangeF(0, spread),
+                                              rand.nextRangeF(0, spread),
+                                              rand.nextRangeF(20, 60)));
+            *ops.append() = op;
+        }
+    };
+    addRun(kUnion_SkPathOp, 20, 200);
+    addRun(kDifference_SkPathOp, 6, 200);
+    addRun(kXOR_SkPathOp, 5, 200);
+    addRun(kIntersect_SkPathOp, 2, 50);
+    addRun(kUnion_SkPathOp, 5, 600);  // mostly disjoint
+
+    SkPath expected = paths[0];
+    for (int i = 1; i < paths.count(); ++i) {
+        REPORTER_ASSERT(reporter, Op(expected, paths[i], ops[i], &expected));
+    }
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    SkPath results[2];
+    for (int parallel = 0; parallel < 2; ++parallel) {
+        SkAutoGraphicsExecutor autoExecutor(parallel ? executor.get() : nullptr);
+        SkOpBuilder builder;
+        for (int i = 0; i < paths.count(); ++i) {
+            builder.add(paths[i], ops[i]);
+        }
+        REPORTER_ASSERT(reporter, builder.resolve(&results[parallel]));
+    }
+    REPORTER_ASSERT(reporter, results[0] == results[1]);
+    REPORTER_ASSERT(reporter, comparePaths(reporter, __FUNCTION__, expected, results[0]) == 0);
+
+    // Disjoint operands are only concatenated, then simplified once.
+    SkOpBuilder builder;
+    builder.add(make_builder_star(0, 0, 10), kXOR_SkPathOp);
+    builder.add(make_builder_star(100, 0, 10), kXOR_SkPathOp);
+    builder.add(make_builder_star(200, 0, 10), kXOR_SkPathOp);
+    SkPath disjoint, expectedDisjoint;
+    REPORTER_ASSERT(reporter, builder.resolve(&disjoint));
+    expectedDisjoint.addPath(make_builder_star(0, 0, 10));
+    expectedDisjoint.addPath(make_builder_star(100, 0, 10));
+    expectedDisjoint.addPath(make_builder_star(200, 0, 10));
+    REPORTER_ASSERT(reporter, comparePaths(reporter, __FUNCTION__, expectedDisjoint, disjoint) == 0);
+}
+
+// Each op of the tree is big enough to search for intersections in parallel itself. On a single
+// thread that can't be borrow()ed, that deadlocks unless the ops in the builder's tasks run inline.
+DEF_TEST(SkOpBuilderNestedExecutor, reporter) {
+    SkRandom rand;
+    SkOpBuilder serialBuilder, parallelBuilder;
+    for (int i = 0; i < 4; ++i) {
+        SkPath path;
+        path.moveTo(100 + 80 * i, 100);
+        for (int j = 1; j < 200; ++j) {
+            SkScalar angle = j * 2 * SK_ScalarPI / 200,
+                     r = rand.nextRangeF(60, 100);
+            path.lineTo(100 + 80 * i + r * SkScalarCos(angle), 100 + r * SkScalarSin(angle));
+        }
+        path.close();
+        serialBuilder.add(path, kUnion_SkPathOp);
+        parallelBuilder.add(path, kUnion_SkPathOp);
+    }
+
+    SkPath serial, parallel;
+    REPORTER_ASSERT(reporter, serialBuilder.resolve(&serial));
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(1, false);
+    SkAutoGraphicsExecutor autoExecutor(executor.get());
+    REPORTER_ASSERT(reporter, parallelBuilder.resolve(&parallel));
+    REPORTER_ASSERT(reporter, serial == parallel);
+}
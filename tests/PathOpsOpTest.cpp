@@ -12542,3 +12542,44 @@ DEF_TEST(PathOpsRepOp, reporter) {
   for (int index = 0; index < 1; ++index)
     RunTestSet(reporter, repTests, SK_ARRAY_COUNT(repTests), nullptr, nullptr, nullptr, false);
 }
+
+#include "include/core/SkExecutor.h"
+#include "include/utils/SkRandom.h"
+#include "src/core/SkTaskGroup.h"
+
+// Large inputs search for intersections in parallel; the paths must not change.
+DEF_TEST(PathOpsExecutor, reporter) {
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    SkRandom rand;
+    SkPath one, two;
+    for (int i = 0; i < 40; ++i) {
+        SkScalar x = rand.nextRangeF(0, 500),
+                 y = rand.nextRangeF(0, 500);
+        one.addCircle(x, y, rand.nextRangeF(5, 40));
+        two.addRect(SkRect::MakeXYWH(y, x, rand.nextRangeF(5, 60), rand.nextRangeF(5, 60)));
+        two.addOval(SkRect::MakeXYWH(x, x, rand.nextRangeF(5, 60), rand.nextRangeF(5, 60)));
+    }
+
+    for (SkPathOp op : {kDifference_SkPathOp, kIntersect_SkPathOp, kUnion_SkPathOp,
+                        kXOR_SkPathOp}) {
+        SkPath serial, parallel;
+        bool serialOK = Op(one, two, op, &serial);
+        bool parallelOK;
+        {
+            SkAutoGraphicsExecutor autoExecutor(executor.get());
+            parallelOK = Op(one, two, op, &parallel);
+        }
+        REPORTER_ASSERT(reporter, serialOK == parallelOK);
+        REPORTER_ASSERT(reporter, serial == parallel);
+    }
+
+    SkPath serial, parallel;
+    bool serialOK = Simplify(two, &serial);
+    bool parallelOK;
+    {
+        SkAutoGraphicsExecutor autoExecutor(executor.get());
+        parallelOK = Simplify(two, &parallel);
+    }
+    REPORTER_ASSERT(reporter, serialOK && parallelOK);
+    REPORTER_ASSERT(reporter, serial == parallel);
+}
@@ -11,18 +11,23 @@
 #include "include/core/SkClipOp.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkData.h"
+#include "include/core/SkFont.h"
 #include "include/core/SkFontStyle.h"
+#include "include/core/SkImage.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkMatrix.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkPath.h"
 #include "include/core/SkPictureRecorder.h"
 #include "include/core/SkPixelRef.h"
+#include "include/core/SkRRect.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkScalar.h"
+#include "include/core/SkSerialProcs.h"
 #include "include/core/SkShader.h"
 #include "include/core/SkStream.h"
+#include "include/core/SkTextBlob.h"
 #include "include/core/SkTypeface.h"
 #include "include/core/SkTypes.h"
 #include "include/utils/SkRandom.h"
@@ -998,3 +1003,96 @@ DEF_TEST(Picture_nested_op_count, r) {
     check(make_pic(10, leaf1),  10,  10);
     check(make_pic(10, leaf10), 10, 100);
 }
+
+DEF_TEST(Picture_MakeFromMappedData, r) {
+    SkBitmap bm;
+    bm.allocN32Pixels(16, 16);
+    for (int y = 0; y < 16; y++) {
+        for (int x = 0; x < 16; x++) {
+            *bm.getAddr32(x, y) = SkPreMultiplyARGB(0xFF, x * 16, y * 16, 0x80);
+        }
+    }
+    sk_sp<SkImage> image = SkImage::MakeFromEncoded(bm.asImage()->encodeToData());
+    REPORTER_ASSERT(r, image);
+
+    SkPictureRecorder rec;
+    SkCanvas* c = rec.beginRecording(64, 64);
+    c->drawPath(SkPath::Circle(8, 8, 6), SkPaint{});
+    c->drawPath(SkPath::Polygon({{2, 40}, {30, 44}, {10, 60}}, true), SkPaint{});
+    sk_sp<SkPicture> inner = rec.finishRecordingAsPicture();
+
+    c = rec.beginRecording(64, 64);
+    SkPaint paint;
+    paint.setColor(SK_ColorBLUE);
+    c->drawPath(SkPath::RRect(SkRRect::MakeRectXY({20, 4, 60, 30}, 5, 5)), paint);
+    SkPath cubic;
+    cubic.moveTo(0, 64).cubicTo(20, 0, 40, 64, 64, 0);
+    paint.setStyle(SkPaint::kStroke_Style);
+    c->drawPath(cubic, paint);
+    c->drawTextBlob(SkTextBlob::MakeFromString("mapped", SkFont(nullptr, 10)), 4, 50, paint);
+    c->drawImage(image, 40, 40);
+    c->drawPicture(inner);
+    c->translate(30, 0);
+    c->drawPicture(inner);
+    sk_sp<SkPicture> pic = rec.finishRecordingAsPicture();
+
+    auto draw = [](const SkPicture& p) {
+        SkBitmap bitmap;
+        bitmap.allocN32Pixels(64, 64);
+        SkCanvas canvas(bitmap);
+        canvas.clear(SK_ColorWHITE);
+        canvas.drawPicture(&p);
+        return bitmap;
+    };
+    auto same_pixels = [](const SkBitmap& a, const SkBitmap& b) {
+        return 0 == memcmp(a.getPixels(), b.getPixels(), a.computeByteSize());
+    };
+    const SkBitmap expected = draw(*pic);
+
+    // Notes whether the encoded images handed to the decoder point into the mapping.
+    struct Mapping {
+        const uint8_t* fBegin;
+        const uint8_t* fEnd;
+        int fImages = 0;
+        int fSharedImages = 0;
+    };
+    SkDeserialProcs dprocs;
+    dprocs.fImageProc = [](const void* data, size_t length, void* ctx) -> sk_sp<SkImage> {
+        auto mapping = static_cast<Mapping*>(ctx);
+        auto bytes = static_cast<const uint8_t*>(data);
+        mapping->fImages++;
+        if (bytes >= mapping->fBegin && bytes + length <= mapping->fEnd) {
+            mapping->fSharedImages++;
+        }
+        return nullptr;  // Decode as usual.
+    };
+
+    for (bool aligned : {false, true}) {
+        SkSerialProcs sprocs;
+        sprocs.fAlignForMapping = aligned;
+        sk_sp<SkData> data = pic->serialize(&sprocs);
+
+        Mapping mapping = {data->bytes(), data->bytes() + data->size()};
+        dprocs.fImageCtx = &mapping;
+        sk_sp<SkPicture> mapped = SkPicture::MakeFromMappedData(data, &dprocs);
+        REPORTER_ASSERT(r, mapped);
+        REPORTER_ASSERT(r, mapped->cullRect() == pic->cullRect());
+        REPORTER_ASSERT(r, mapped->approximateOpCount() > 0);
+        REPORTER_ASSERT(r, same_pixels(draw(*mapped), expected));
+        // Lazily decoded paths and text blobs are only decoded once.
+        REPORTER_ASSERT(r, same_pixels(draw(*mapped), expected));
+        REPORTER_ASSERT(r, mapping.fImages == 1);
+        REPORTER_ASSERT(r, mapping.fSharedImages == (aligned ? 1 : 0));
+
+        // The usual loader reads both layouts, and mapped pictures serialize like any other.
+        sk_sp<SkPicture> copied = SkPicture::MakeFromData(data.get());
+        REPORTER_ASSERT(r, copied && same_pixels(draw(*copied), expected));
+        sk_sp<SkPicture> reloaded = SkPicture::MakeFromData(mapped->serialize().get());
+        REPORTER_ASSERT(r, reloaded && same_pixels(draw(*reloaded), expected));
+    }
+
+    // A truncated mapping fails to load rather than playing back garbage.
+    sk_sp<SkData> data = pic->serialize();
+    REPORTER_ASSERT(r, !SkPicture::MakeFromMappedData(SkData::MakeSubset(data.get(), 0,
+                                                                          data->size() / 2)));
+}
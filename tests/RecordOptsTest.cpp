@@ -9,6 +9,7 @@
 #include "tests/Test.h"
 
 #include "include/core/SkColorFilter.h"
+#include "include/core/SkImage.h"
 #include "include/core/SkPictureRecorder.h"
 #include "include/core/SkSurface.h"
 #include "include/effects/SkImageFilters.h"
@@ -414,3 +415,162 @@ DEF_TEST(savelayer_srcmode_alpha, r) {
     do_savelayer_srcmode(r, 0x80FF0000);
 }
 
+
+DEF_TEST(RecordOpts_MergeDraws, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+
+    SkPaint red, blue;
+    red.setColor(SK_ColorRED);
+    blue.setColor(SK_ColorBLUE);
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(8, 8);
+    bitmap.eraseColor(SK_ColorGREEN);
+    sk_sp<SkImage> image = bitmap.asImage();
+
+    recorder.drawRect(SkRect::MakeXYWH( 0, 0, 10, 10), red);     // 0: DrawRects of 3
+    recorder.drawRect(SkRect::MakeXYWH(20, 0, 10, 10), red);
+    recorder.drawRect(SkRect::MakeXYWH(40, 0, 10, 10), red);
+    recorder.drawRect(SkRect::MakeXYWH(60, 0, 10, 10), blue);    // 3: different paint
+    recorder.drawImageRect(image, SkRect::MakeXYWH(0, 20, 10, 10), SkSamplingOptions());
+    recorder.drawImageRect(image, SkRect::MakeXYWH(20, 20, 10, 10), SkSamplingOptions());
+    recorder.translate(5, 5);                                    // 6: breaks the run
+    recorder.drawImageRect(image, SkRect::MakeXYWH(40, 20, 10, 10), SkSamplingOptions());
+
+    SkRecordOptStats stats;
+    SkRecordMergeDraws(&record, &stats);
+    record.defrag();
+
+    REPORTER_ASSERT(r, record.count() == 5);
+    const SkRecords::DrawRects* rects = assert_type<SkRecords::DrawRects>(r, record, 0);
+    REPORTER_ASSERT(r, rects && rects->count == 3 && rects->paint == red);
+    assert_type<SkRecords::DrawRect>(r, record, 1);
+    const SkRecords::DrawEdgeAAImageSet* set =
+            assert_type<SkRecords::DrawEdgeAAImageSet>(r, record, 2);
+    REPORTER_ASSERT(r, set && set->count == 2 && !set->paint);
+    assert_type<SkRecords::Translate>(r, record, 3);
+    assert_type<SkRecords::DrawImageRect>(r, record, 4);
+
+    REPORTER_ASSERT(r, stats.fMergedDraws == 5);
+    REPORTER_ASSERT(r, stats.fBatches == 2);
+}
+
+DEF_TEST(RecordOpts_CullOverdrawnDraws, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+
+    SkPaint opaque, translucent, aa;
+    translucent.setColor(0x80FF0000);
+    aa.setAntiAlias(true);
+
+    recorder.drawRect(SkRect::MakeXYWH(10, 10, 10, 10), SkPaint());    // 0: culled
+    recorder.drawOval(SkRect::MakeXYWH(20, 20, 10, 10), aa);           // 1: antialiased
+    recorder.drawRect(SkRect::MakeXYWH(30, 30, 90, 90), SkPaint());    // 2: partly uncovered
+    recorder.drawRect(SkRect::MakeXYWH(103, 103, 3, 3), SkPaint());    // 3: under 4 only
+    recorder.drawRect(SkRect::MakeWH(110, 110), translucent);          // 4: not an occluder
+    recorder.drawRect(SkRect::MakeWH(100, 100), opaque);               // 5: occluder
+    recorder.clipRect(SkRect::MakeWH(50, 50));                         // 6: ends the search
+    recorder.drawRect(SkRect::MakeWH(10, 10), SkPaint());              // 7: culled by 8
+    recorder.drawPaint(opaque);                                        // 8
+
+    SkRecordOptStats stats;
+    SkRecordCullOverdrawnDraws(&record, &stats);
+
+    assert_type<SkRecords::NoOp>(r, record, 0);
+    assert_type<SkRecords::DrawOval>(r, record, 1);
+    assert_type<SkRecords::DrawRect>(r, record, 2);
+    assert_type<SkRecords::DrawRect>(r, record, 3);
+    assert_type<SkRecords::DrawRect>(r, record, 4);
+    assert_type<SkRecords::DrawRect>(r, record, 5);
+    assert_type<SkRecords::NoOp>(r, record, 7);
+    assert_type<SkRecords::DrawPaint>(r, record, 8);
+    REPORTER_ASSERT(r, stats.fCulledDraws == 2);
+}
+
+DEF_TEST(RecordOpts_CullOverdrawnDraws_NestedBackdrop, r) {
+    // A picture whose layer blurs what is under it, well past the occluder drawn after it.
+    SkPictureRecorder pictureRecorder;
+    SkCanvas* nested = pictureRecorder.beginRecording(SkRect::MakeWH(W, H));
+    auto blur = SkImageFilters::Blur(8, 8, nullptr);
+    SkRect layerBounds = SkRect::MakeWH(100, 100);
+    nested->saveLayer(SkCanvas::SaveLayerRec(&layerBounds, nullptr, blur.get(), 0));
+    nested->restore();
+    sk_sp<SkPicture> backdrop = pictureRecorder.finishRecordingAsPicture();
+
+    auto draw = [&](SkCanvas* canvas) {
+        SkPaint red, blue;
+        red.setColor(SK_ColorRED);
+        blue.setColor(SK_ColorBLUE);
+        canvas->drawRect(SkRect::MakeXYWH(10, 10, 30, 30), red);   // 0: blurred by 1
+        canvas->drawPicture(backdrop);                              // 1
+        canvas->drawRect(SkRect::MakeWH(50, 50), blue);             // 2: covers 0
+    };
+
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+    draw(&recorder);
+    SkRecordOptStats stats;
+    SkRecordCullOverdrawnDraws(&record, &stats);
+    assert_type<SkRecords::DrawRect>(r, record, 0);
+    assert_type<SkRecords::DrawPicture>(r, record, 1);
+    assert_type<SkRecords::DrawRect>(r, record, 2);
+    REPORTER_ASSERT(r, stats.fCulledDraws == 0);
+
+    SkPictureRecorder plainRecorder, optimizedRecorder;
+    draw(plainRecorder.beginRecording(SkRect::MakeWH(W, H)));
+    draw(optimizedRecorder.beginRecording(SkRect::MakeWH(W, H)));
+    sk_sp<SkPicture> plain = plainRecorder.finishRecordingAsPicture(),
+                     optimized = optimizedRecorder.finishRecordingAsPicture(
+                             SkPictureRecorder::kOptimizeForPlayback_FinishFlag);
+    auto surf0 = SkSurface::MakeRasterN32Premul(100, 100),
+         surf1 = SkSurface::MakeRasterN32Premul(100, 100);
+    surf0->getCanvas()->drawPicture(plain);
+    surf1->getCanvas()->drawPicture(optimized);
+    SkBitmap bm0, bm1;
+    bm0.allocPixels(surf0->imageInfo());
+    bm1.allocPixels(surf1->imageInfo());
+    REPORTER_ASSERT(r, surf0->readPixels(bm0, 0, 0) && surf1->readPixels(bm1, 0, 0));
+    REPORTER_ASSERT(r, 0 == memcmp(bm0.getPixels(), bm1.getPixels(), bm0.computeByteSize()));
+}
+
+DEF_TEST(RecordOpts_OptimizeForPlayback, r) {
+    // Same-paint runs and covered draws, played back through a picture, must draw the same.
+    auto draw = [](SkCanvas* canvas) {
+        SkPaint paint;
+        for (int y = 0; y < 20; y++) {
+            paint.setColor(y < 10 ? 0x80FF0000 : SK_ColorBLUE);
+            paint.setAntiAlias(y % 4 == 0);
+            for (int x = 0; x < 20; x++) {
+                canvas->drawRect(SkRect::MakeXYWH(x * 5.5f, y * 5.5f, 4.25f, 4.25f), paint);
+            }
+        }
+        canvas->drawRect(SkRect::MakeXYWH(10, 10, 40, 40), SkPaint());
+        canvas->drawCircle(30, 30, 15, paint);
+    };
+
+    SkPictureRecorder recorder;
+    draw(recorder.beginRecording(SkRect::MakeWH(120, 120)));
+    sk_sp<SkPicture> plain = recorder.finishRecordingAsPicture();
+    draw(recorder.beginRecording(SkRect::MakeWH(120, 120)));
+    sk_sp<SkPicture> optimized =
+            recorder.finishRecordingAsPicture(SkPictureRecorder::kOptimizeForPlayback_FinishFlag);
+    REPORTER_ASSERT(r, optimized->approximateOpCount() < plain->approximateOpCount());
+
+    for (SkScalar scale : {1.0f, 0.7f, 2.3f}) {
+        auto surf0 = SkSurface::MakeRasterN32Premul(120, 120),
+             surf1 = SkSurface::MakeRasterN32Premul(120, 120);
+        for (auto [surf, pic] : {std::make_pair(surf0.get(), plain.get()),
+                                 std::make_pair(surf1.get(), optimized.get())}) {
+            surf->getCanvas()->clear(SK_ColorWHITE);
+            surf->getCanvas()->rotate(scale * 7);
+            surf->getCanvas()->scale(scale, scale);
+            surf->getCanvas()->drawPicture(pic);
+        }
+        SkBitmap bm0, bm1;
+        bm0.allocN32Pixels(120, 120);
+        bm1.allocN32Pixels(120, 120);
+        surf0->readPixels(bm0, 0, 0);
+        surf1->readPixels(bm1, 0, 0);
+        REPORTER_ASSERT(r, 0 == memcmp(bm0.getPixels(), bm1.getPixels(), bm0.computeByteSize()));
+    }
+}
@@ -346,6 +346,48 @@ DEF_TEST(SkRasterPipeline_tail, r) {
     }
 }
 
+DEF_TEST(SkRasterPipeline_tail_widths, r) {
+    // Run loads and stores over every width up to a few multiples of the widest stride (16),
+    // making sure the tail handling reads and writes exactly the pixels it should.
+    struct {
+        SkRasterPipeline::StockStage load, store;
+        size_t bpp;
+        uint16_t lo, hi;  // Range of each 16-bit word of source data, to keep halfs sensible.
+    } kStages[] = {
+        {SkRasterPipeline::load_a8,       SkRasterPipeline::store_a8,        1, 0, 0xffff},
+        {SkRasterPipeline::load_8888,     SkRasterPipeline::store_8888,      4, 0, 0xffff},
+        {SkRasterPipeline::load_rg1616,   SkRasterPipeline::store_rg1616,    4, 0, 0xffff},
+        {SkRasterPipeline::load_16161616, SkRasterPipeline::store_16161616,  8, 0, 0xffff},
+        {SkRasterPipeline::load_f16,      SkRasterPipeline::store_f16,       8, 0x3c00, 0x3fff},
+        {SkRasterPipeline::load_f32,      SkRasterPipeline::store_f32,      16, 0x3f80, 0x3fff},
+    };
+
+    constexpr int kMaxWidth = 50;
+    for (const auto& stage : kStages) {
+        std::vector<uint16_t> data(kMaxWidth * stage.bpp / 2 + 1);
+        for (size_t i = 0; i < data.size(); i++) {
+            data[i] = (uint16_t)(stage.lo + (i * 7919) % (stage.hi - stage.lo + 1));
+        }
+
+        for (int width = 1; width <= kMaxWidth; width++) {
+            std::vector<uint8_t> buffer(kMaxWidth * stage.bpp, 0xab);
+            SkRasterPipeline_MemoryCtx src = { data.data(), 0 },
+                                       dst = { buffer.data(), 0 };
+            SkRasterPipeline_<256> p;
+            p.append(stage.load, &src);
+            p.append(stage.store, &dst);
+            p.run(0,0, width,1);
+
+            const size_t bytes = width * stage.bpp;
+            REPORTER_ASSERT(r, 0 == memcmp(buffer.data(), data.data(), bytes),
+                            "stage %d width %d", (int)stage.load, width);
+            for (size_t i = bytes; i < buffer.size(); i++) {
+                REPORTER_ASSERT(r, buffer[i] == 0xab, "stage %d width %d", (int)stage.load, width);
+            }
+        }
+    }
+}
+
 DEF_TEST(SkRasterPipeline_u16, r) {
     {
         alignas(8) uint16_t data[][2] = {
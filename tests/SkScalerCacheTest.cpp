@@ -5,6 +5,7 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFont.h"
 #include "include/core/SkTypeface.h"
 #include "src/core/SkScalerCache.h"
@@ -83,3 +84,88 @@ DEF_TEST(SkScalerCacheMultiThread, Reporter) {
         SkTaskGroup(*executor).batch(kThreadCount, perThread);
     }
 }
+
+DEF_TEST(SkScalerCachePrefetchImages, reporter) {
+    auto executor = SkExecutor::MakeFIFOThreadPool(4);
+    for (sk_sp<SkTypeface> typeface : {ToolUtils::create_portable_typeface("serif",
+                                                                           SkFontStyle::Italic()),
+                                       SkTypeface::MakeDefault()}) {
+        SkFont font;
+        font.setEdging(SkFont::Edging::kAntiAlias);
+        font.setSubpixel(true);
+        font.setTypeface(typeface);
+        font.setSize(24);
+
+        SkPaint defaultPaint;
+        SkStrikeSpec strikeSpec = SkStrikeSpec::MakeMask(
+                font, defaultPaint, SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                SkScalerContextFlags::kNone, SkMatrix::I());
+
+        // Every subpixel position of every printable character, plus a few repeats.
+        std::vector<SkPackedGlyphID> glyphIDs;
+        for (int c = ' '; c < 127; c++) {
+            for (SkFixed x : {0, SK_Fixed1/4, SK_Fixed1/2, 3*SK_Fixed1/4}) {
+                glyphIDs.push_back(SkPackedGlyphID{font.unicharToGlyph(c), x, 0});
+            }
+        }
+        glyphIDs.insert(glyphIDs.end(), glyphIDs.begin(), glyphIDs.begin() + 10);
+        SkSpan<const SkPackedGlyphID> ids = SkMakeSpan(glyphIDs);
+
+        auto make_cache = [&]() {
+            SkScalerContextEffects effects;
+            return std::make_unique<SkScalerCache>(
+                    strikeSpec.descriptor(),
+                    typeface->createScalerContext(effects, &strikeSpec.descriptor()));
+        };
+        auto serial = make_cache(),
+             parallel = make_cache();
+        std::vector<const SkGlyph*> expected(glyphIDs.size()),
+                                    actual(glyphIDs.size());
+        serial->prepareImages(ids, expected.data());
+        size_t delta = parallel->prefetchImages(ids, executor.get());
+        REPORTER_ASSERT(reporter, delta > 0);
+        // Every image is ready now.
+        auto [_, increase] = parallel->prepareImages(ids, actual.data());
+        REPORTER_ASSERT(reporter, increase == 0);
+        REPORTER_ASSERT(reporter, parallel->countCachedGlyphs() == serial->countCachedGlyphs());
+
+        for (size_t i = 0; i < glyphIDs.size(); i++) {
+            const SkGlyph* e = expected[i];
+            const SkGlyph* a = actual[i];
+            REPORTER_ASSERT(reporter, a->iRect() == e->iRect());
+            REPORTER_ASSERT(reporter, a->maskFormat() == e->maskFormat());
+            REPORTER_ASSERT(reporter, (a->image() == nullptr) == (e->image() == nullptr));
+            if (a->image() && e->image()) {
+                REPORTER_ASSERT(reporter, 0 == memcmp(a->image(), e->image(), e->imageSize()));
+            }
+        }
+
+        // Drawing with an executor finds the same glyphs, in the same order.
+        SkGlyphID glyphs[95];
+        SkPoint pos[95];
+        for (int i = 0; i < 95; i++) {
+            glyphs[i] = font.unicharToGlyph(' ' + i);
+            pos[i] = {17.25f * i, 30.5f * (i % 3)};
+        }
+        auto drawCache = make_cache();
+        SkDrawableGlyphBuffer drawable;
+        SkSourceGlyphBuffer rejects;
+        drawable.ensureSize(SK_ARRAY_COUNT(glyphs));
+        rejects.setSource(SkMakeZip(glyphs, pos));
+        drawable.startBitmapDevice(rejects.source(), {0, 0}, SkMatrix::I(),
+                                   drawCache->roundingSpec());
+        drawCache->prepareForDrawingMasksCPU(&drawable, executor.get());
+        int drawn = 0;
+        for (auto [variant, p] : drawable.drawable()) {
+            const SkGlyph* glyph = variant.glyph();
+            REPORTER_ASSERT(reporter, glyph->image() != nullptr);
+            const SkGlyph* e;
+            SkPackedGlyphID id = glyph->getPackedID();
+            serial->prepareImages({&id, 1}, &e);
+            REPORTER_ASSERT(reporter, 0 == memcmp(glyph->image(), e->image(), e->imageSize()));
+            drawn++;
+        }
+        // Everything but the space has an image.
+        REPORTER_ASSERT(reporter, drawn == 94, "%d", drawn);
+    }
+}
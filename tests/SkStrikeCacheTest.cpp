@@ -5,11 +5,20 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkGraphics.h"
+#include "include/private/SkMutex.h"
+#include "src/core/SkPersistentStrike.h"
 #include "src/core/SkStrikeCache.h"
 #include "src/core/SkStrikeSpec.h"
+#include "src/core/SkTaskGroup.h"
+#include "src/utils/SkOSPath.h"
 #include "tests/Test.h"
 #include "tools/ToolUtils.h"
 
+#include <atomic>
+#include <map>
+#include <string>
+
 DEF_TEST(SkStrikeCache_CachePurge, Reporter) {
     SkStrikeCache cache;
 
@@ -51,3 +60,194 @@ DEF_TEST(SkStrikeCache_CachePurge, Reporter) {
 
 
 }
+
+DEF_TEST(SkStrikeCache_Threaded, Reporter) {
+    SkStrikeCache cache;
+
+    sk_sp<SkTypeface> typeface =
+            ToolUtils::create_portable_typeface("serif", SkFontStyle::Italic());
+
+    constexpr int kStrikeCount = 32;
+    std::vector<SkStrikeSpec> strikeSpecs;
+    for (int i = 0; i < kStrikeCount; ++i) {
+        SkFont font;
+        font.setEdging(SkFont::Edging::kAntiAlias);
+        font.setTypeface(typeface);
+        font.setSize(8 + i);
+        strikeSpecs.push_back(SkStrikeSpec::MakeMask(
+                font, SkPaint(), SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                SkScalerContextFlags::kNone, SkMatrix::I()));
+    }
+
+    // Small enough that threads keep purging each other's strikes.
+    cache.setCacheCountLimit(kStrikeCount / 4);
+
+    auto executor = SkExecutor::MakeFIFOThreadPool(8);
+    SkTaskGroup(*executor).batch(1000, [&](int i) {
+        sk_sp<SkStrike> strike = strikeSpecs[i % kStrikeCount].findOrCreateStrike(&cache);
+        SkGlyphID glyphs[] = {1, 2, 3, 4};
+        const SkGlyph* results[SK_ARRAY_COUNT(glyphs)];
+        strike->metrics(SkMakeSpan(glyphs), results);
+        REPORTER_ASSERT(Reporter, strike->getDescriptor() ==
+                                  strikeSpecs[i % kStrikeCount].descriptor());
+    });
+
+    REPORTER_ASSERT(Reporter, cache.getCacheCountUsed() <= kStrikeCount);
+    REPORTER_ASSERT(Reporter, cache.getLockStats().fAcquires >= 1000);
+
+    cache.purgeAll();
+    REPORTER_ASSERT(Reporter, cache.getCacheCountUsed() == 0);
+    REPORTER_ASSERT(Reporter, cache.getTotalMemoryUsed() == 0);
+}
+
+DEF_TEST(SkStrikeCache_PersistentGlyphs, Reporter) {
+    // Strikes may load and store from any thread.
+    class MemoryGlyphCache final : public SkGraphics::GlyphCache {
+    public:
+        sk_sp<SkData> load(const SkData& key) override {
+            fLoads++;
+            SkAutoMutexExclusive lock{fMutex};
+            auto found = fEntries.find(std::string((const char*)key.data(), key.size()));
+            return found != fEntries.end() ? found->second : nullptr;
+        }
+        void store(const SkData& key, const SkData& data) override {
+            fStores++;
+            SkAutoMutexExclusive lock{fMutex};
+            fEntries[std::string((const char*)key.data(), key.size())] =
+                    SkData::MakeWithCopy(data.data(), data.size());
+        }
+
+        SkMutex fMutex;
+        std::map<std::string, sk_sp<SkData>> fEntries;
+        std::atomic<int> fLoads{0},
+                         fStores{0};
+    };
+
+    // Test typefaces have no font data to identify them across processes.
+    sk_sp<SkTypeface> typeface = SkTypeface::MakeDefault();
+    SkFont font;
+    font.setEdging(SkFont::Edging::kAntiAlias);
+    font.setSubpixel(true);
+    font.setTypeface(typeface);
+    font.setSize(19);
+    SkStrikeSpec strikeSpec = SkStrikeSpec::MakeMask(
+            font, SkPaint(), SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+            SkScalerContextFlags::kNone, SkMatrix::I());
+    if (!SkPersistentStrike::MakeKey(strikeSpec.descriptor(), *typeface)) {
+        INFOF(Reporter, "Default typeface has no font data; skipping.\n");
+        return;
+    }
+
+    std::vector<SkPackedGlyphID> ids;
+    std::vector<SkGlyphID> glyphIDs;
+    for (int c = '!'; c < 127; c++) {
+        glyphIDs.push_back(font.unicharToGlyph(c));
+        ids.push_back(SkPackedGlyphID{glyphIDs.back(), SK_Fixed1/4, 0});
+    }
+    std::vector<const SkGlyph*> images(ids.size()),
+                                paths(ids.size());
+
+    MemoryGlyphCache glyphCache;
+    SkStrikeCache cache;
+    cache.setGlyphCacheForTesting(&glyphCache);
+
+    // The first strike is made by the scaler; its glyphs are stored when flushed or purged. We
+    // keep it alive to compare with.
+    sk_sp<SkStrike> first = strikeSpec.findOrCreateStrike(&cache);
+    REPORTER_ASSERT(Reporter, glyphCache.fLoads == 1);
+    std::vector<const SkGlyph*> expected(ids.size());
+    first->prepareImages(SkMakeSpan(ids), expected.data());
+    first->preparePaths(SkMakeSpan(glyphIDs), paths.data());
+    cache.flushGlyphCache();
+    REPORTER_ASSERT(Reporter, glyphCache.fStores == 1);
+    cache.flushGlyphCache();
+    REPORTER_ASSERT(Reporter, glyphCache.fStores == 1);
+    cache.purgeAll();
+    REPORTER_ASSERT(Reporter, glyphCache.fStores == 1);
+
+    // The next strike finds everything in the store, so has nothing new to store.
+    {
+        sk_sp<SkStrike> strike = strikeSpec.findOrCreateStrike(&cache);
+        REPORTER_ASSERT(Reporter, glyphCache.fLoads == 2);
+        strike->prepareImages(SkMakeSpan(ids), images.data());
+        strike->preparePaths(SkMakeSpan(glyphIDs), paths.data());
+        for (size_t i = 0; i < ids.size(); i++) {
+            const SkGlyph& e = *expected[i];
+            const SkGlyph* a = images[i];
+            REPORTER_ASSERT(Reporter, a->iRect() == e.iRect());
+            REPORTER_ASSERT(Reporter, a->advanceX() == e.advanceX());
+            REPORTER_ASSERT(Reporter, a->maskFormat() == e.maskFormat());
+            REPORTER_ASSERT(Reporter, (a->image() == nullptr) == (e.image() == nullptr));
+            if (a->image() && e.image()) {
+                REPORTER_ASSERT(Reporter, 0 == memcmp(a->image(), e.image(), e.imageSize()));
+            }
+            REPORTER_ASSERT(Reporter, paths[i]->path() != nullptr);
+        }
+    }
+    cache.purgeAll();
+    REPORTER_ASSERT(Reporter, glyphCache.fStores == 1);
+
+    // New glyphs are stored along with the ones that were loaded.
+    {
+        sk_sp<SkStrike> strike = strikeSpec.findOrCreateStrike(&cache);
+        SkPackedGlyphID id{font.unicharToGlyph('A'), SK_Fixed1/2, 0};
+        const SkGlyph* glyph;
+        strike->prepareImages({&id, 1}, &glyph);
+    }
+    cache.purgeAll();
+    REPORTER_ASSERT(Reporter, glyphCache.fStores == 2);
+
+    REPORTER_ASSERT(Reporter, glyphCache.fEntries.size() == 1);
+    sk_sp<SkData> key = SkPersistentStrike::MakeKey(strikeSpec.descriptor(), *typeface);
+    sk_sp<SkData> data = glyphCache.fEntries.begin()->second;
+    auto persistent = SkPersistentStrike::Make(data, *key);
+    REPORTER_ASSERT(Reporter, persistent);
+    if (persistent) {
+        SkGlyph glyph{SkPackedGlyphID{font.unicharToGlyph('A'), SK_Fixed1/2, 0}};
+        REPORTER_ASSERT(Reporter, persistent->findGlyph(glyph.getPackedID(), &glyph));
+        REPORTER_ASSERT(Reporter, persistent->findImage(glyph.getPackedID()));
+        REPORTER_ASSERT(Reporter, persistent->findImage(ids[0]));
+    }
+
+    // Data for another strike, or that has been damaged, is ignored.
+    font.setSize(20);
+    SkStrikeSpec otherSpec = SkStrikeSpec::MakeMask(
+            font, SkPaint(), SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+            SkScalerContextFlags::kNone, SkMatrix::I());
+    sk_sp<SkData> otherKey = SkPersistentStrike::MakeKey(otherSpec.descriptor(), *typeface);
+    REPORTER_ASSERT(Reporter, !SkPersistentStrike::Make(data, *otherKey));
+    REPORTER_ASSERT(Reporter, !SkPersistentStrike::Make(
+            SkData::MakeSubset(data.get(), 0, data->size() - 4), *key));
+    sk_sp<SkData> damaged = SkData::MakeWithCopy(data->data(), data->size());
+    ((uint32_t*)damaged->writable_data())[1] += 1;  // The version.
+    REPORTER_ASSERT(Reporter, !SkPersistentStrike::Make(damaged, *key));
+
+    // The directory cache round trips through files.
+    SkString tmpDir = skiatest::GetTmpDir();
+    if (tmpDir.isEmpty()) {
+        return;
+    }
+    SkString dir = SkOSPath::Join(tmpDir.c_str(), "SkStrikeCache_glyphs");
+    auto directory = SkGraphics::GlyphCache::MakeDirectory(dir.c_str());
+    REPORTER_ASSERT(Reporter, directory);
+    if (directory) {
+        directory->store(*key, *data);
+        sk_sp<SkData> loaded = directory->load(*key);
+        REPORTER_ASSERT(Reporter, loaded && loaded->equals(data.get()));
+        REPORTER_ASSERT(Reporter, SkPersistentStrike::Make(loaded, *key));
+        REPORTER_ASSERT(Reporter, !directory->load(*otherKey));
+    }
+
+    // Once over its budget, the directory cache deletes the least recently used files.
+    SkString budgetDir = SkOSPath::Join(tmpDir.c_str(), "SkStrikeCache_glyph_budget");
+    directory = SkGraphics::GlyphCache::MakeDirectory(budgetDir.c_str(), data->size() * 3 / 2);
+    REPORTER_ASSERT(Reporter, directory);
+    if (directory) {
+        directory->store(*key, *data);
+        directory->store(*otherKey, *data);
+        directory.reset();  // Waits for the writes.
+        directory = SkGraphics::GlyphCache::MakeDirectory(budgetDir.c_str(), data->size() * 3 / 2);
+        REPORTER_ASSERT(Reporter, !directory->load(*key));
+        REPORTER_ASSERT(Reporter, directory->load(*otherKey));
+    }
+}
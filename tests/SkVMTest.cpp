@@ -6,8 +6,10 @@
  */
 
 #include "include/core/SkColorPriv.h"
+#include "include/core/SkData.h"
 #include "include/private/SkColorData.h"
 #include "src/core/SkCpu.h"
+#include "src/core/SkMD5.h"
 #include "src/core/SkMSAN.h"
 #include "src/core/SkVM.h"
 #include "tests/Test.h"
@@ -107,6 +109,95 @@ DEF_TEST(SkVM_allow_jit, r) {
     }
 }
 
+DEF_TEST(SkVM_serialize, r) {
+    skvm::Builder b;
+    {
+        auto src = b.varying<int>(),
+             dst = b.varying<int>();
+        b.store32(dst, b.load32(src) * 3 + b.splat(7));
+    }
+    skvm::Program original = b.done(nullptr, /*allow_jit=*/true, /*serializable=*/true);
+    REPORTER_ASSERT(r, !b.done().serialize());
+
+    for (bool includeJIT : {false, true}) {
+        sk_sp<SkData> data = original.serialize(includeJIT);
+        skvm::Program p = skvm::Program::Deserialize(data->data(), data->size(), "serialized");
+        REPORTER_ASSERT(r, !p.empty());
+        REPORTER_ASSERT(r, p.nargs() == original.nargs());
+        REPORTER_ASSERT(r, p.hasJIT() == original.hasJIT());
+
+        int src[] = {1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17},
+            dst[SK_ARRAY_COUNT(src)] = {};
+        p.eval(SK_ARRAY_COUNT(src), src, dst);
+        for (size_t i = 0; i < SK_ARRAY_COUNT(src); i++) {
+            REPORTER_ASSERT(r, dst[i] == src[i]*3 + 7);
+        }
+
+        // Truncated or corrupted data should be rejected, never crash.
+        for (size_t len = 0; len < data->size(); len += 3) {
+            REPORTER_ASSERT(r, skvm::Program::Deserialize(data->data(), len, "").empty());
+        }
+        for (size_t i = 0; i < data->size(); i++) {
+            std::vector<uint8_t> corrupt(data->bytes(), data->bytes() + data->size());
+            corrupt[i] ^= 0x40;
+            REPORTER_ASSERT(r, skvm::Program::Deserialize(corrupt.data(), corrupt.size(),
+                                                          "").empty(), "byte %zu", i);
+        }
+
+        // Instructions no Builder could produce are rejected even when the digest matches.
+        auto resign = [](std::vector<uint8_t>* bytes) {
+            SkMD5 md5;
+            md5.write(bytes->data(), bytes->size() - sizeof(SkMD5::Digest));
+            SkMD5::Digest digest = md5.finish();
+            memcpy(bytes->data() + bytes->size() - sizeof(digest), digest.data, sizeof(digest));
+        };
+        // The magic, version, op count, stride count, 2 strides and instruction count come first.
+        // The last instruction is the store: op, x,y,z,w, immA,immB.
+        const int32_t ninstructions = reinterpret_cast<const int32_t*>(data->bytes())[6];
+        const size_t store = (7 + 7 * (ninstructions - 1)) * sizeof(int32_t);
+        struct { size_t field; int32_t value; } edits[] = {
+            {1, -1},  // The stored value is missing.
+            {2,  0},  // An extra argument.
+            {5,  2},  // There is no third pointer.
+        };
+        for (auto edit : edits) {
+            std::vector<uint8_t> corrupt(data->bytes(), data->bytes() + data->size());
+            int32_t* inst = reinterpret_cast<int32_t*>(corrupt.data() + store);
+            REPORTER_ASSERT(r, inst[0] == (int32_t)skvm::Op::store32);
+            inst[edit.field] = edit.value;
+            resign(&corrupt);
+            REPORTER_ASSERT(r, skvm::Program::Deserialize(corrupt.data(), corrupt.size(),
+                                                          "").empty());
+        }
+    }
+}
+
+DEF_TEST(SkVM_uniformsFit, r) {
+    skvm::Builder b;
+    {
+        auto uniforms = b.uniform(),
+                  dst = b.varying<int>();
+        b.store32(dst, b.uniform32(uniforms, 8));
+    }
+    skvm::Program p = b.done();
+
+    const size_t enough[]   = {12, 0},
+                 tooShort[] = {11, 0},
+                 varying[]  = {12, 12};
+    REPORTER_ASSERT(r,  p.uniformsFit(SkMakeSpan(enough)));
+    REPORTER_ASSERT(r, !p.uniformsFit(SkMakeSpan(tooShort)));
+    REPORTER_ASSERT(r, !p.uniformsFit(SkMakeSpan(enough, 1)));
+
+    // A uniform read through a varying argument is never in bounds.
+    skvm::Builder bad;
+    {
+        auto dst = bad.varying<int>();
+        bad.uniform();
+        bad.store32(dst, bad.uniform32(dst, 0));
+    }
+    REPORTER_ASSERT(r, !bad.done().uniformsFit(SkMakeSpan(varying)));
+}
+
 DEF_TEST(SkVM_LoopCounts, r) {
     // Make sure we cover all the exact N we want.
 
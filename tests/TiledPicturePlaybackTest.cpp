@@ -0,0 +1,146 @@
+/*
+ * Copyright 2021 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkBBHFactory.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkPath.h"
+#include "include/core/SkPictureRecorder.h"
+#include "include/core/SkSurface.h"
+#include "include/effects/SkGradientShader.h"
+#include "include/utils/SkRandom.h"
+#include "include/utils/SkTiledPicturePlayback.h"
+#include "tests/Test.h"
+
+static sk_sp<SkPicture> make_random_picture(SkRandom* rand, int w, int h) {
+    SkRTreeFactory factory;
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording(SkRect::MakeIWH(w, h), &factory);
+
+    const SkPoint pts[] = {{0, 0}, {SkIntToScalar(w), SkIntToScalar(h)}};
+    const SkColor colors[] = {SK_ColorRED, SK_ColorBLUE};
+    for (int i = 0; i < 500; ++i) {
+        SkPaint paint;
+        paint.setAntiAlias(rand->nextBool());
+        paint.setColor(rand->nextU() | 0x80000000);
+        if (rand->nextU() % 4 == 0) {
+            paint.setShader(SkGradientShader::MakeLinear(pts, colors, nullptr, 2,
+                                                         SkTileMode::kClamp));
+            paint.setDither(true);
+        }
+        SkRect r = SkRect::MakeXYWH(rand->nextRangeF(-20, w), rand->nextRangeF(-20, h),
+                                    rand->nextRangeF(1, 80), rand->nextRangeF(1, 80));
+        switch (rand->nextU() % 3) {
+            case 0: canvas->drawRect(r, paint); break;
+            case 1: canvas->drawOval(r, paint); break;
+            case 2: {
+                canvas->save();
+                canvas->rotate(rand->nextRangeF(0, 360), r.centerX(), r.centerY());
+                canvas->drawPath(SkPath::Polygon({{r.fLeft, r.fTop}, {r.fRight, r.fTop},
+                                                  {r.centerX(), r.fBottom}}, true), paint);
+                canvas->restore();
+            } break;
+        }
+    }
+    return recorder.finishRecordingAsPicture();
+}
+
+DEF_TEST(TiledPicturePlayback, reporter) {
+    constexpr int kW = 333,
+                  kH = 257;
+
+    SkRandom rand;
+    sk_sp<SkPicture> picture = make_random_picture(&rand, kW, kH);
+
+    const SkMatrix matrices[] = {
+        SkMatrix::I(),
+        SkMatrix::Scale(1.5f, 0.75f),
+        SkMatrix::RotateDeg(10, {kW * 0.5f, kH * 0.5f}),
+    };
+
+    auto info = SkImageInfo::MakeN32Premul(kW, kH);
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+
+    for (const SkMatrix& matrix : matrices) {
+        for (int tileSize : {16, 37, 100, 1000}) {
+            // Clipping a curve or an antialiased edge to a tile is not bit-exact with drawing it
+            // whole, so the reference draws the same tiles one after another.
+            SkIRect bounds = matrix.mapRect(picture->cullRect()).roundOut();
+            SkAssertResult(bounds.intersect(SkIRect::MakeWH(kW, kH)));
+            auto expected = SkSurface::MakeRaster(info);
+            for (int y = bounds.fTop; y < bounds.fBottom; y += tileSize) {
+                for (int x = bounds.fLeft; x < bounds.fRight; x += tileSize) {
+                    SkIRect tile = SkIRect::MakeXYWH(x, y, tileSize, tileSize);
+                    SkAssertResult(tile.intersect(bounds));
+                    SkAutoCanvasRestore acr(expected->getCanvas(), true);
+                    expected->getCanvas()->clipRect(SkRect::Make(tile));
+                    expected->getCanvas()->drawPicture(picture, &matrix, nullptr);
+                }
+            }
+
+            auto actual = SkSurface::MakeRaster(info);
+
+            SkTiledPicturePlayback::Options options;
+            options.fTileWidth  = tileSize;
+            options.fTileHeight = tileSize;
+            options.fExecutor   = executor.get();
+            REPORTER_ASSERT(reporter, SkTiledPicturePlayback::Draw(actual.get(), picture.get(),
+                                                                   matrix, options));
+
+            SkPixmap e, a;
+            SkAssertResult(expected->peekPixels(&e));
+            SkAssertResult(actual->peekPixels(&a));
+            bool same = true;
+            for (int y = 0; y < kH && same; ++y) {
+                same = 0 == memcmp(e.addr32(0, y), a.addr32(0, y), e.info().minRowBytes());
+            }
+            REPORTER_ASSERT(reporter, same, "tile size %d", tileSize);
+        }
+    }
+}
+
+DEF_TEST(TiledPicturePlayback_NonRaster, reporter) {
+    SkRandom rand;
+    sk_sp<SkPicture> picture = make_random_picture(&rand, 64, 64);
+    REPORTER_ASSERT(reporter, !SkTiledPicturePlayback::Draw(nullptr, picture.get(),
+                                                            SkMatrix::I(), {}));
+}
+
+DEF_TEST(TiledPicturePlayback_Snapshot, reporter) {
+    SkPictureRecorder recorder;
+    SkPaint paint;
+    paint.setColor(SK_ColorRED);
+    recorder.beginRecording(SkRect::MakeWH(64, 64))->drawRect(SkRect::MakeWH(64, 64), paint);
+    sk_sp<SkPicture> picture = recorder.finishRecordingAsPicture();
+
+    auto surface = SkSurface::MakeRaster(SkImageInfo::MakeN32Premul(64, 64));
+    surface->getCanvas()->clear(SK_ColorWHITE);
+    sk_sp<SkImage> snapshot = surface->makeImageSnapshot();
+
+    SkTiledPicturePlayback::Options options;
+    options.fTileWidth  = 16;
+    options.fTileHeight = 16;
+    REPORTER_ASSERT(reporter, SkTiledPicturePlayback::Draw(surface.get(), picture.get(),
+                                                           SkMatrix::I(), options));
+
+    // The snapshot keeps what the surface held before, and the surface gets the drawing.
+    SkPixmap before, after;
+    SkAssertResult(snapshot->peekPixels(&before));
+    SkAssertResult(surface->peekPixels(&after));
+    REPORTER_ASSERT(reporter, before.addr() != after.addr());
+    bool snapshotUnchanged = true,
+         surfaceDrawn      = true;
+    for (int y = 0; y < 64; ++y) {
+        for (int x = 0; x < 64; ++x) {
+            snapshotUnchanged &= before.getColor(x, y) == SK_ColorWHITE;
+            surfaceDrawn      &= after.getColor(x, y) == SK_ColorRED;
+        }
+    }
+    REPORTER_ASSERT(reporter, snapshotUnchanged);
+    REPORTER_ASSERT(reporter, surfaceDrawn);
+}
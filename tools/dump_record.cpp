@@ -169,7 +169,10 @@ int main(int argc, char** argv) {
             SkRecordOptimize(&record);
         }
         if (FLAGS_optimize2) {
-            SkRecordOptimize2(&record);
+            SkRecordOptStats stats;
+            SkRecordOptimize2(&record, &stats);
+            SkDebugf("%s: merged %d draws into %d batches, culled %d draws.\n",
+                     FLAGS_skps[i], stats.fMergedDraws, stats.fBatches, stats.fCulledDraws);
         }
 
         SkBitmap bitmap;
@@ -7,12 +7,14 @@
 
 #include "experimental/ffmpeg/SkVideoEncoder.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkGraphics.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkSurface.h"
 #include "include/core/SkTime.h"
 #include "include/private/SkTPin.h"
 #include "modules/skottie/include/Skottie.h"
+#include "modules/skottie/utils/SkottieUtils.h"
 #include "modules/skresources/include/SkResources.h"
 #include "src/utils/SkOSPath.h"
 
@@ -21,6 +23,9 @@
 
 #include "include/gpu/GrContextOptions.h"
 
+#include <algorithm>
+#include <thread>
+
 static DEFINE_string2(input, i, "", "skottie animation to render");
 static DEFINE_string2(output, o, "", "mp4 file to create");
 static DEFINE_string2(assetPath, a, "", "path to assets needed for json file");
@@ -29,11 +34,16 @@ static DEFINE_bool2(verbose, v, false, "verbose mode");
 static DEFINE_bool2(loop, l, false, "loop mode for profiling");
 static DEFINE_int(set_dst_width, 0, "set destination width (height will be computed)");
 static DEFINE_bool2(gpu, g, false, "use GPU for rendering");
+static DEFINE_int(threads, 0, "raster rendering threads (0 -> cores count)");
+
+static void draw_frame(SkSurface* surf, const skottie::Animation& anim) {
+    surf->getCanvas()->clear(SK_ColorWHITE);
+    anim.render(surf->getCanvas());
+}
 
 static void produce_frame(SkSurface* surf, skottie::Animation* anim, double frame) {
     anim->seekFrame(frame);
-    surf->getCanvas()->clear(SK_ColorWHITE);
-    anim->render(surf->getCanvas());
+    draw_frame(surf, *anim);
 }
 
 struct AsyncRec {
@@ -64,9 +74,31 @@ int main(int argc, char** argv) {
     }
     SkDebugf("assetPath %s\n", assetPath.c_str());
 
-    auto animation = skottie::Animation::Builder()
-        .setResourceProvider(skresources::FileResourceProvider::Make(assetPath))
-        .makeFromFile(FLAGS_input[0]);
+    auto json = SkData::MakeFromFileName(FLAGS_input[0]);
+    if (!json) {
+        SkDebugf("failed to read %s\n", FLAGS_input[0]);
+        return -1;
+    }
+
+    skottie::Animation::Builder builder;
+    builder.setResourceProvider(skresources::FileResourceProvider::Make(assetPath));
+
+    // Raster frames are rendered in parallel, each thread seeking its own animation instance.
+    std::unique_ptr<SkExecutor> executor;
+    std::unique_ptr<skottie_utils::FrameRenderer> renderer;
+    sk_sp<skottie::Animation> animation;
+    if (FLAGS_gpu) {
+        animation = builder.make(static_cast<const char*>(json->data()), json->size());
+    } else {
+        const int threads = FLAGS_threads > 0 ? FLAGS_threads
+                                               : std::max(1u, std::thread::hardware_concurrency());
+        renderer = skottie_utils::FrameRenderer::Make(
+                builder, static_cast<const char*>(json->data()), json->size(), threads);
+        if (renderer) {
+            animation = sk_ref_sp(renderer->animation());
+            executor = SkExecutor::MakeFIFOThreadPool(threads);
+        }
+    }
     if (!animation) {
         SkDebugf("failed to load %s\n", FLAGS_input[0]);
         return -1;
@@ -98,6 +130,16 @@ int main(int argc, char** argv) {
     sk_sp<SkData> data;
 
     const auto info = SkImageInfo::MakeN32Premul(dim);
+
+    // One surface per frame in flight, so a batch of frames can be rendered before it is encoded.
+    std::vector<sk_sp<SkSurface>> batch_surfs;
+    if (renderer) {
+        for (int i = 0; i < renderer->workerCount() * 2; ++i) {
+            batch_surfs.push_back(SkSurface::MakeRaster(info));
+            batch_surfs.back()->getCanvas()->scale(scale, scale);
+        }
+    }
+
     do {
         double loop_start = SkTime::GetSecs();
 
@@ -106,8 +148,30 @@ int main(int argc, char** argv) {
             return -1;
         }
 
+        if (renderer) {
+            std::vector<double> batch;
+            for (int start = 0; start <= frames; start += (int)batch_surfs.size()) {
+                batch.clear();
+                for (int i = start; i <= frames && batch.size() < batch_surfs.size(); ++i) {
+                    batch.push_back(i * fps_scale);
+                }
+                if (FLAGS_verbose) {
+                    SkDebugf("rendering frames %g..%g\n", batch.front(), batch.back());
+                }
+                renderer->renderFrames(batch, executor.get(),
+                                       [&](int, size_t i, const skottie::Animation& anim) {
+                    draw_frame(batch_surfs[i].get(), anim);
+                });
+                for (size_t i = 0; i < batch.size(); ++i) {
+                    SkPixmap pm;
+                    SkAssertResult(batch_surfs[i]->peekPixels(&pm));
+                    encoder.addFrame(pm);
+                }
+            }
+        }
+
         // lazily allocate the surfaces
-        if (!surf) {
+        if (!renderer && !surf) {
             if (FLAGS_gpu) {
                 context = factory.getContextInfo(contextType).directContext();
                 surf = SkSurface::MakeRenderTarget(context,
@@ -126,7 +190,7 @@ int main(int argc, char** argv) {
             surf->getCanvas()->scale(scale, scale);
         }
 
-        for (int i = 0; i <= frames; ++i) {
+        for (int i = 0; !renderer && i <= frames; ++i) {
             const double frame = i * fps_scale;
             if (FLAGS_verbose) {
                 SkDebugf("rendering frame %g\n", frame);